@@ -20,6 +20,7 @@ import (
 	"runtime/debug"
 	"strings"
 	"sync"
+	"sync/atomic"
 	"syscall"
 	"time"
 
@@ -44,6 +45,7 @@ import (
 	"github.com/google/gops/agent"
 	"github.com/gorilla/handlers"
 	"github.com/gorilla/mux"
+	"github.com/prometheus/client_golang/prometheus/promhttp"
 	httpSwagger "github.com/swaggo/http-swagger"
 
 	_ "github.com/go-sql-driver/mysql"
@@ -137,10 +139,11 @@ func initEnv() {
 }
 
 func main() {
-	var flagReinitDB, flagInit, flagServer, flagSyncLDAP, flagGops, flagMigrateDB, flagRevertDB, flagForceDB, flagDev, flagVersion, flagLogDateTime bool
+	var flagReinitDB, flagResumeInitDB, flagInit, flagServer, flagSyncLDAP, flagGops, flagMigrateDB, flagRevertDB, flagForceDB, flagDev, flagVersion, flagLogDateTime bool
 	var flagNewUser, flagDelUser, flagGenJWT, flagConfigFile, flagImportJob, flagLogLevel string
 	flag.BoolVar(&flagInit, "init", false, "Setup var directory, initialize swlite database file, config.json and .env")
 	flag.BoolVar(&flagReinitDB, "init-db", false, "Go through job-archive and re-initialize the 'job', 'tag', and 'jobtag' tables (all running jobs will be lost!)")
+	flag.BoolVar(&flagResumeInitDB, "resume-init-db", false, "Continue an interrupted -init-db run, skipping the parts of the job-archive already imported")
 	flag.BoolVar(&flagSyncLDAP, "sync-ldap", false, "Sync the 'user' table with ldap")
 	flag.BoolVar(&flagServer, "server", false, "Start a server, continues listening on port after initialization and argument handling")
 	flag.BoolVar(&flagGops, "gops", false, "Listen via github.com/google/gops/agent (for debugging)")
@@ -226,7 +229,30 @@ func main() {
 		os.Exit(0)
 	}
 
-	repository.Connect(config.Keys.DBDriver, config.Keys.DB)
+	// With fast-startup the server is listening during the rest of the
+	// startup, but only answers /readyz until the routes are set up.
+	var wg sync.WaitGroup
+	var serverHandler atomic.Value
+	serverHandler.Store(http.Handler(http.HandlerFunc(runtimeEnv.StartupHandler)))
+	server := http.Server{
+		ReadTimeout:  10 * time.Second,
+		WriteTimeout: 10 * time.Second,
+		Handler: http.HandlerFunc(func(rw http.ResponseWriter, r *http.Request) {
+			serverHandler.Load().(http.Handler).ServeHTTP(rw, r)
+		}),
+		Addr: config.Keys.Addr,
+	}
+
+	var listener net.Listener
+	if flagServer && config.Keys.FastStartup {
+		listener = listen()
+		serve(&wg, &server, listener)
+	}
+
+	runtimeEnv.Startup("db", func() error {
+		repository.Connect(config.Keys.DBDriver, config.Keys.DB)
+		return nil
+	})
 	db := repository.GetConnection()
 
 	var authentication *auth.Authentication
@@ -294,16 +320,20 @@ func main() {
 		log.Fatal("arguments --add-user and --del-user can only be used if authentication is enabled")
 	}
 
-	if err := archive.Init(config.Keys.Archive, config.Keys.DisableArchive); err != nil {
+	if err := runtimeEnv.Startup("archive", func() error {
+		return archive.Init(config.Keys.Archive, config.Keys.DisableArchive)
+	}); err != nil {
 		log.Fatalf("failed to initialize archive: %s", err.Error())
 	}
 
-	if err := metricdata.Init(config.Keys.DisableArchive); err != nil {
+	if err := runtimeEnv.Startup("metricdata", func() error {
+		return metricdata.Init(config.Keys.DisableArchive)
+	}); err != nil {
 		log.Fatalf("failed to initialize metricdata repository: %s", err.Error())
 	}
 
-	if flagReinitDB {
-		if err := importer.InitDB(); err != nil {
+	if flagReinitDB || flagResumeInitDB {
+		if err := importer.InitDB(flagResumeInitDB); err != nil {
 			log.Fatalf("failed to re-initialize repository DB: %s", err.Error())
 		}
 	}
@@ -370,6 +400,12 @@ func main() {
 		web.RenderTemplate(rw, "privacy.tmpl", &web.Page{Title: "Privacy", Build: buildInfo})
 	})
 
+	// Internal metrics (archiver queue etc.) in the prometheus exposition format
+	r.Handle("/metrics", promhttp.Handler()).Methods(http.MethodGet)
+
+	// The startup steps and whether the server is ready
+	r.HandleFunc("/readyz", runtimeEnv.ReadinessHandler).Methods(http.MethodGet)
+
 	secured := r.PathPrefix("/").Subrouter()
 
 	if !config.Keys.DisableAuthentication {
@@ -488,59 +524,25 @@ func main() {
 		}
 	})
 
-	var wg sync.WaitGroup
-	server := http.Server{
-		ReadTimeout:  10 * time.Second,
-		WriteTimeout: 10 * time.Second,
-		Handler:      handler,
-		Addr:         config.Keys.Addr,
-	}
-
-	// Start http or https server
-	listener, err := net.Listen("tcp", config.Keys.Addr)
-	if err != nil {
-		log.Fatalf("starting http listener failed: %v", err)
-	}
-
-	if !strings.HasSuffix(config.Keys.Addr, ":80") && config.Keys.RedirectHttpTo != "" {
-		go func() {
-			http.ListenAndServe(":80", http.RedirectHandler(config.Keys.RedirectHttpTo, http.StatusMovedPermanently))
-		}()
-	}
-
-	if config.Keys.HttpsCertFile != "" && config.Keys.HttpsKeyFile != "" {
-		cert, err := tls.LoadX509KeyPair(config.Keys.HttpsCertFile, config.Keys.HttpsKeyFile)
-		if err != nil {
-			log.Fatalf("loading X509 keypair failed: %v", err)
-		}
-		listener = tls.NewListener(listener, &tls.Config{
-			Certificates: []tls.Certificate{cert},
-			CipherSuites: []uint16{
-				tls.TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256,
-				tls.TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256,
-			},
-			MinVersion:               tls.VersionTLS12,
-			PreferServerCipherSuites: true,
-		})
-		fmt.Printf("HTTPS server listening at %s...", config.Keys.Addr)
-	} else {
-		fmt.Printf("HTTP server listening at %s...", config.Keys.Addr)
+	if listener == nil {
+		listener = listen()
 	}
 
 	// Because this program will want to bind to a privileged port (like 80), the listener must
 	// be established first, then the user can be changed, and after that,
 	// the actual http server can be started.
+	var err error
 	if err = runtimeEnv.DropPrivileges(config.Keys.Group, config.Keys.User); err != nil {
 		log.Fatalf("error while preparing server start: %s", err.Error())
 	}
 
-	wg.Add(1)
-	go func() {
-		defer wg.Done()
-		if err = server.Serve(listener); err != nil && err != http.ErrServerClosed {
-			log.Fatalf("starting server failed: %v", err)
-		}
-	}()
+	// With a fast startup, only the start-up handler served requests so
+	// far, the routes go live once the privileges are dropped.
+	serverHandler.Store(http.Handler(handler))
+
+	if !config.Keys.FastStartup {
+		serve(&wg, &server, listener)
+	}
 
 	wg.Add(1)
 	sigs := make(chan os.Signal, 1)
@@ -643,7 +645,9 @@ func main() {
 			if startTime == lastTime {
 				log.Info("Compression Service - Complete archive run")
 				jobs, err = jobRepo.FindJobsBetween(0, startTime)
-
+			} else if lastTime > startTime {
+				log.Info("Compression Service - Nothing to do")
+				return
 			} else {
 				jobs, err = jobRepo.FindJobsBetween(lastTime, startTime)
 			}
@@ -660,7 +664,53 @@ func main() {
 	if os.Getenv("GOGC") == "" {
 		debug.SetGCPercent(25)
 	}
+	runtimeEnv.SetReady()
 	runtimeEnv.SystemdNotifiy(true, "running")
 	wg.Wait()
 	log.Print("Graceful shutdown completed!")
 }
+
+// Start the http or https listener of the server.
+func listen() net.Listener {
+	listener, err := net.Listen("tcp", config.Keys.Addr)
+	if err != nil {
+		log.Fatalf("starting http listener failed: %v", err)
+	}
+
+	if !strings.HasSuffix(config.Keys.Addr, ":80") && config.Keys.RedirectHttpTo != "" {
+		go func() {
+			http.ListenAndServe(":80", http.RedirectHandler(config.Keys.RedirectHttpTo, http.StatusMovedPermanently))
+		}()
+	}
+
+	if config.Keys.HttpsCertFile != "" && config.Keys.HttpsKeyFile != "" {
+		cert, err := tls.LoadX509KeyPair(config.Keys.HttpsCertFile, config.Keys.HttpsKeyFile)
+		if err != nil {
+			log.Fatalf("loading X509 keypair failed: %v", err)
+		}
+		listener = tls.NewListener(listener, &tls.Config{
+			Certificates: []tls.Certificate{cert},
+			CipherSuites: []uint16{
+				tls.TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256,
+				tls.TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256,
+			},
+			MinVersion:               tls.VersionTLS12,
+			PreferServerCipherSuites: true,
+		})
+		fmt.Printf("HTTPS server listening at %s...", config.Keys.Addr)
+	} else {
+		fmt.Printf("HTTP server listening at %s...", config.Keys.Addr)
+	}
+
+	return listener
+}
+
+func serve(wg *sync.WaitGroup, server *http.Server, listener net.Listener) {
+	wg.Add(1)
+	go func() {
+		defer wg.Done()
+		if err := server.Serve(listener); err != nil && err != http.ErrServerClosed {
+			log.Fatalf("starting server failed: %v", err)
+		}
+	}()
+}
@@ -6,6 +6,7 @@ package api_test
 
 import (
 	"bytes"
+	"compress/gzip"
 	"context"
 	"encoding/json"
 	"fmt"
@@ -26,6 +27,7 @@ import (
 	"github.com/ClusterCockpit/cc-backend/pkg/archive"
 	"github.com/ClusterCockpit/cc-backend/pkg/log"
 	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+	"github.com/gorilla/handlers"
 	"github.com/gorilla/mux"
 
 	_ "github.com/mattn/go-sqlite3"
@@ -337,6 +339,44 @@ func TestRestApi(t *testing.T) {
 		}
 	})
 
+	t.Run("ExportJobs", func(t *testing.T) {
+		req := httptest.NewRequest(http.MethodGet, "/api/jobs/export/?with-metrics&metric=load_one", nil)
+		req.Header.Set("Accept-Encoding", "gzip")
+		ctx := context.WithValue(req.Context(), repository.ContextUserKey,
+			&schema.User{Username: "api", Roles: []string{schema.GetRoleString(schema.RoleApi)}})
+		recorder := httptest.NewRecorder()
+
+		// Compressed by the middleware of the server
+		handlers.CompressHandler(r).ServeHTTP(recorder, req.WithContext(ctx))
+		response := recorder.Result()
+		if response.StatusCode != http.StatusOK {
+			t.Fatal(response.Status, recorder.Body.String())
+		}
+		if response.Header.Get("Content-Encoding") != "gzip" {
+			t.Fatal("expected gzip compressed response")
+		}
+
+		zr, err := gzip.NewReader(recorder.Body)
+		if err != nil {
+			t.Fatal(err)
+		}
+		dec := json.NewDecoder(zr)
+		lines := 0
+		for dec.More() {
+			var line api.ExportJobLine
+			if err := dec.Decode(&line); err != nil {
+				t.Fatal(err)
+			}
+			lines++
+			if line.JobID != 123 || !reflect.DeepEqual(line.Data, testData) {
+				t.Fatalf("unexpected job exported: %#v", line.JobMeta)
+			}
+		}
+		if lines != 1 {
+			t.Fatalf("unexpected number of jobs exported: %d", lines)
+		}
+	})
+
 	t.Run("CheckDoubleStart", func(t *testing.T) {
 		// Starting a job with the same jobId and cluster should only be allowed if the startTime is far appart!
 		body := strings.Replace(startJobBody, `"startTime": 123456789`, `"startTime": 123456790`, -1)
@@ -416,4 +456,70 @@ func TestRestApi(t *testing.T) {
 	if !ok {
 		t.Fatal("subtest failed")
 	}
+
+	batchStart := "[" + strings.Replace(startJobBodyFailed, "12345,", "2001,", 1) + "," +
+		strings.Replace(startJobBodyFailed, "12345,", "2002,", 1) + "," + startJobBodyFailed + "]"
+	var batchIds []int64
+	ok = t.Run("StartJobs", func(t *testing.T) {
+		req := httptest.NewRequest(http.MethodPost, "/api/jobs/start_jobs/", bytes.NewBuffer([]byte(batchStart)))
+		recorder := httptest.NewRecorder()
+
+		r.ServeHTTP(recorder, req)
+		response := recorder.Result()
+		if response.StatusCode != http.StatusOK {
+			t.Fatal(response.Status, recorder.Body.String())
+		}
+
+		var res api.BatchApiResponse
+		if err := json.NewDecoder(response.Body).Decode(&res); err != nil {
+			t.Fatal(err)
+		}
+		if len(res.Results) != 3 || res.Results[0].Status != http.StatusCreated ||
+			res.Results[1].Status != http.StatusCreated || res.Results[2].Status != http.StatusUnprocessableEntity {
+			t.Fatalf("unexpected results: %#v", res.Results)
+		}
+		batchIds = []int64{res.Results[0].DBID, res.Results[1].DBID}
+	})
+	if !ok {
+		t.Fatal("subtest failed")
+	}
+
+	batchStop := `[
+		{ "jobId": 2001, "cluster": "testcluster", "startTime": 12345678, "jobState": "completed", "stopTime": 12355678 },
+		{ "jobId": 2002, "cluster": "testcluster", "startTime": 12345678, "jobState": "failed", "stopTime": 12355678 },
+		{ "jobId": 2003, "cluster": "testcluster", "startTime": 12345678, "jobState": "failed", "stopTime": 12355678 },
+		{ "jobId": 2001, "cluster": "testcluster", "startTime": 12345678, "jobState": "failed", "stopTime": 12355678 }
+	]`
+	t.Run("StopJobs", func(t *testing.T) {
+		req := httptest.NewRequest(http.MethodPost, "/api/jobs/stop_jobs/", bytes.NewBuffer([]byte(batchStop)))
+		recorder := httptest.NewRecorder()
+
+		r.ServeHTTP(recorder, req)
+		response := recorder.Result()
+		if response.StatusCode != http.StatusOK {
+			t.Fatal(response.Status, recorder.Body.String())
+		}
+
+		var res api.BatchApiResponse
+		if err := json.NewDecoder(response.Body).Decode(&res); err != nil {
+			t.Fatal(err)
+		}
+		// The second stop of job 2001 finds it stopped by the first one
+		if len(res.Results) != 4 || res.Results[0].Status != http.StatusOK ||
+			res.Results[1].Status != http.StatusOK || res.Results[2].Status != http.StatusUnprocessableEntity ||
+			res.Results[3].Status != http.StatusUnprocessableEntity {
+			t.Fatalf("unexpected results: %#v", res.Results)
+		}
+
+		restapi.JobRepository.WaitForArchiving()
+		for i, state := range []schema.JobState{schema.JobStateCompleted, schema.JobStateFailed} {
+			job, err := restapi.JobRepository.FindById(batchIds[i])
+			if err != nil {
+				t.Fatal(err)
+			}
+			if job.State != state || job.Duration != 10000 {
+				t.Fatalf("unexpected job properties: %#v", job)
+			}
+		}
+	})
 }
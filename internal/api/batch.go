@@ -0,0 +1,190 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package api
+
+import (
+	"bytes"
+	"encoding/json"
+	"fmt"
+	"net/http"
+
+	"github.com/ClusterCockpit/cc-backend/internal/repository"
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+// Maximum number of jobs per batch request
+const maxBatchSize = 10000
+
+// BatchApiResult model, the outcome for one job of a batch request
+type BatchApiResult struct {
+	DBID   int64  `json:"id,omitempty"`    // Database ID of the job
+	Status int    `json:"status"`          // HTTP status code the single request would have returned
+	Error  string `json:"error,omitempty"` // Error message if the job failed
+}
+
+// BatchApiResponse model
+type BatchApiResponse struct {
+	Results []BatchApiResult `json:"results"` // One result per job, in the order of the request
+}
+
+func decodeBatch(rw http.ResponseWriter, r *http.Request, val interface{}, n func() int) bool {
+	if err := decode(r.Body, val); err != nil {
+		handleError(fmt.Errorf("parsing request body failed: %w", err), http.StatusBadRequest, rw)
+		return false
+	}
+	if n() > maxBatchSize {
+		handleError(fmt.Errorf("too many jobs in one request (max. %d)", maxBatchSize), http.StatusBadRequest, rw)
+		return false
+	}
+	return true
+}
+
+func writeBatchResponse(rw http.ResponseWriter, results []BatchApiResult) {
+	rw.Header().Add("Content-Type", "application/json")
+	rw.WriteHeader(http.StatusOK)
+	json.NewEncoder(rw).Encode(BatchApiResponse{Results: results})
+}
+
+// startJobs godoc
+// @summary     Adds new jobs as "running"
+// @tags Job add and modify
+// @description Like start_job, but for a list of jobs. All jobs are written in as few transactions as possible.
+// @description A job failing does not affect the others, the outcome of every job is returned in the order of the request.
+// @accept      json
+// @produce     json
+// @param       request body     []schema.JobMeta        true "Jobs to add"
+// @success     200     {object} api.BatchApiResponse         "Result per job"
+// @failure     400     {object} api.ErrorResponse            "Bad Request"
+// @failure     401     {object} api.ErrorResponse            "Unauthorized"
+// @failure     403     {object} api.ErrorResponse            "Forbidden"
+// @security    ApiKeyAuth
+// @router      /jobs/start_jobs/ [post]
+func (api *RestApi) startJobs(rw http.ResponseWriter, r *http.Request) {
+	if user := repository.GetUserFromContext(r.Context()); user != nil &&
+		!user.HasRole(schema.RoleApi) {
+
+		handleError(fmt.Errorf("missing role: %v", schema.GetRoleString(schema.RoleApi)), http.StatusForbidden, rw)
+		return
+	}
+
+	var raw []json.RawMessage
+	if !decodeBatch(rw, r, &raw, func() int { return len(raw) }) {
+		return
+	}
+
+	results := make([]BatchApiResult, len(raw))
+	jobs := make([]*schema.JobMeta, 0, len(raw))
+	index := make([]int, 0, len(raw))
+	for i, msg := range raw {
+		req := &schema.JobMeta{BaseJob: schema.JobDefaults}
+		if err := decode(bytes.NewReader(msg), req); err != nil {
+			results[i] = BatchApiResult{Status: http.StatusBadRequest, Error: fmt.Sprintf("parsing job failed: %s", err.Error())}
+			continue
+		}
+		if err := checkStartJob(req); err != nil {
+			results[i] = BatchApiResult{Status: http.StatusBadRequest, Error: err.Error()}
+			continue
+		}
+		jobs = append(jobs, req)
+		index = append(index, i)
+	}
+
+	ids, errs := api.JobRepository.StartJobs(jobs)
+	for j, i := range index {
+		if errs[j] != nil {
+			results[i] = BatchApiResult{Status: startJobErrorStatus(errs[j]), Error: errs[j].Error()}
+			continue
+		}
+		results[i] = BatchApiResult{DBID: ids[j], Status: http.StatusCreated}
+	}
+
+	log.Printf("new jobs: %d of %d started", countStatus(results, http.StatusCreated), len(results))
+	writeBatchResponse(rw, results)
+}
+
+// stopJobs godoc
+// @summary     Marks jobs as completed and triggers archiving
+// @tags Job add and modify
+// @description Like stop_job with the job specified by request body, but for a list of jobs. All fields are required.
+// @description A job failing does not affect the others, the outcome of every job is returned in the order of the request.
+// @accept      json
+// @produce     json
+// @param       request body     []api.StopJobApiRequest true "Jobs to stop"
+// @success     200     {object} api.BatchApiResponse         "Result per job"
+// @failure     400     {object} api.ErrorResponse            "Bad Request"
+// @failure     401     {object} api.ErrorResponse            "Unauthorized"
+// @failure     403     {object} api.ErrorResponse            "Forbidden"
+// @security    ApiKeyAuth
+// @router      /jobs/stop_jobs/ [post]
+func (api *RestApi) stopJobs(rw http.ResponseWriter, r *http.Request) {
+	if user := repository.GetUserFromContext(r.Context()); user != nil &&
+		!user.HasRole(schema.RoleApi) {
+
+		handleError(fmt.Errorf("missing role: %v", schema.GetRoleString(schema.RoleApi)), http.StatusForbidden, rw)
+		return
+	}
+
+	var reqs []StopJobApiRequest
+	if !decodeBatch(rw, r, &reqs, func() int { return len(reqs) }) {
+		return
+	}
+
+	results := make([]BatchApiResult, len(reqs))
+	stops := make([]repository.JobStop, 0, len(reqs))
+	jobs := make([]*schema.Job, 0, len(reqs))
+	index := make([]int, 0, len(reqs))
+	for i, req := range reqs {
+		if req.JobId == nil {
+			results[i] = BatchApiResult{Status: http.StatusBadRequest, Error: "the field 'jobId' is required"}
+			continue
+		}
+
+		job, err := api.JobRepository.Find(req.JobId, req.Cluster, req.StartTime)
+		if err != nil {
+			results[i] = BatchApiResult{Status: http.StatusUnprocessableEntity, Error: fmt.Sprintf("finding job failed: %s", err.Error())}
+			continue
+		}
+
+		stop, err := checkStopJob(job, req)
+		if err != nil {
+			results[i] = BatchApiResult{DBID: job.ID, Status: http.StatusBadRequest, Error: err.Error()}
+			continue
+		}
+
+		stops = append(stops, stop)
+		jobs = append(jobs, job)
+		index = append(index, i)
+	}
+
+	errs := api.JobRepository.StopJobs(stops)
+	for j, i := range index {
+		job := jobs[j]
+		if errs[j] != nil {
+			results[i] = BatchApiResult{DBID: job.ID, Status: stopJobErrorStatus(errs[j]),
+				Error: fmt.Sprintf("marking job as stopped failed: %s", errs[j].Error())}
+			continue
+		}
+		results[i] = BatchApiResult{DBID: job.ID, Status: http.StatusOK}
+
+		job.Duration, job.State = stops[j].Duration, stops[j].State
+		if job.MonitoringStatus != schema.MonitoringStatusDisabled {
+			api.JobRepository.TriggerArchiving(job)
+		}
+	}
+
+	log.Printf("stopped jobs: %d of %d stopped", countStatus(results, http.StatusOK), len(results))
+	writeBatchResponse(rw, results)
+}
+
+func countStatus(results []BatchApiResult, status int) int {
+	n := 0
+	for _, res := range results {
+		if res.Status == status {
+			n++
+		}
+	}
+	return n
+}
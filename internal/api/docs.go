@@ -87,7 +87,7 @@ const docTemplate = `{
                         "ApiKeyAuth": []
                     }
                 ],
-                "description": "Get a list of all jobs. Filters can be applied using query parameters.\nNumber of results can be limited by page. Results are sorted by descending startTime.",
+                "description": "Get a list of all jobs. Filters can be applied using query parameters.\nNumber of results can be limited by page. Results are sorted by descending startTime.\nFor paging through many jobs pass an empty cursor for the first page and the nextCursor\nof the response for the following ones, each page then takes the same time.",
                 "produces": [
                     "application/json"
                 ],
@@ -134,6 +134,12 @@ const docTemplate = `{
                         "name": "page",
                         "in": "query"
                     },
+                    {
+                        "type": "string",
+                        "description": "Cursor returned as nextCursor by the previous page, empty for the first page. Replaces page.",
+                        "name": "cursor",
+                        "in": "query"
+                    },
                     {
                         "type": "boolean",
                         "description": "Include metadata (e.g. jobScript) in response",
@@ -460,6 +466,173 @@ const docTemplate = `{
                 }
             }
         },
+        "/jobs/export/": {
+            "get": {
+                "security": [
+                    {
+                        "ApiKeyAuth": []
+                    }
+                ],
+                "description": "Streams all jobs matching the filters as newline delimited JSON, one job per line, sorted by database id.\nThe response is gzip compressed if the client accepts it. Memory usage does not depend on the number of jobs and the write timeout of the server does not apply.\nIf the export fails on the way, the last line is an error object.",
+                "produces": [
+                    "application/x-ndjson"
+                ],
+                "tags": [
+                    "Job query"
+                ],
+                "summary": "Exports jobs as a stream",
+                "parameters": [
+                    {
+                        "enum": [
+                            "running",
+                            "completed",
+                            "failed",
+                            "cancelled",
+                            "stopped",
+                            "timeout"
+                        ],
+                        "type": "string",
+                        "description": "Job State",
+                        "name": "state",
+                        "in": "query"
+                    },
+                    {
+                        "type": "string",
+                        "description": "Job Cluster",
+                        "name": "cluster",
+                        "in": "query"
+                    },
+                    {
+                        "type": "string",
+                        "description": "Syntax: '$from-$to', as unix epoch timestamps in seconds",
+                        "name": "start-time",
+                        "in": "query"
+                    },
+                    {
+                        "type": "boolean",
+                        "description": "Include metadata (e.g. jobScript)",
+                        "name": "with-metadata",
+                        "in": "query"
+                    },
+                    {
+                        "type": "boolean",
+                        "description": "Include the metric data of archived jobs",
+                        "name": "with-metrics",
+                        "in": "query"
+                    },
+                    {
+                        "type": "array",
+                        "items": {
+                            "type": "string"
+                        },
+                        "collectionFormat": "csv",
+                        "description": "Metrics to include (Default: all)",
+                        "name": "metric",
+                        "in": "query"
+                    }
+                ],
+                "responses": {
+                    "200": {
+                        "description": "One job per line",
+                        "schema": {
+                            "$ref": "#/definitions/api.ExportJobLine"
+                        }
+                    },
+                    "400": {
+                        "description": "Bad Request",
+                        "schema": {
+                            "$ref": "#/definitions/api.ErrorResponse"
+                        }
+                    },
+                    "401": {
+                        "description": "Unauthorized",
+                        "schema": {
+                            "$ref": "#/definitions/api.ErrorResponse"
+                        }
+                    },
+                    "403": {
+                        "description": "Forbidden",
+                        "schema": {
+                            "$ref": "#/definitions/api.ErrorResponse"
+                        }
+                    }
+                }
+            }
+        },
+        "/jobs/live/{id}": {
+            "get": {
+                "security": [
+                    {
+                        "ApiKeyAuth": []
+                    }
+                ],
+                "description": "Server-sent events with the node scope metric data appended since the previous event, in the format of the metric data of a job.\nThe data of all jobs and views on a cluster is polled in one query per timestep.\nEach stream ends after a few seconds, clients reconnect with the Last-Event-ID header (EventSource does so) to continue.\nEnds with 422 once the job is not running anymore.",
+                "produces": [
+                    "text/event-stream"
+                ],
+                "tags": [
+                    "Job query"
+                ],
+                "summary": "Streams the metric data of a running job",
+                "parameters": [
+                    {
+                        "type": "integer",
+                        "description": "Database ID of Job",
+                        "name": "id",
+                        "in": "path",
+                        "required": true
+                    },
+                    {
+                        "type": "array",
+                        "items": {
+                            "type": "string"
+                        },
+                        "collectionFormat": "csv",
+                        "description": "Metrics to stream (Default: all)",
+                        "name": "metric",
+                        "in": "query"
+                    },
+                    {
+                        "type": "string",
+                        "description": "ID of the last event received",
+                        "name": "Last-Event-ID",
+                        "in": "header"
+                    }
+                ],
+                "responses": {
+                    "200": {
+                        "description": "Events of type 'metrics', data is an object with 'from', 'to' and 'data'",
+                        "schema": {
+                            "type": "string"
+                        }
+                    },
+                    "400": {
+                        "description": "Bad Request",
+                        "schema": {
+                            "$ref": "#/definitions/api.ErrorResponse"
+                        }
+                    },
+                    "401": {
+                        "description": "Unauthorized",
+                        "schema": {
+                            "$ref": "#/definitions/api.ErrorResponse"
+                        }
+                    },
+                    "403": {
+                        "description": "Forbidden",
+                        "schema": {
+                            "$ref": "#/definitions/api.ErrorResponse"
+                        }
+                    },
+                    "422": {
+                        "description": "Unprocessable Entity: job not running",
+                        "schema": {
+                            "$ref": "#/definitions/api.ErrorResponse"
+                        }
+                    }
+                }
+            }
+        },
         "/jobs/start_job/": {
             "post": {
                 "security": [
@@ -529,6 +702,66 @@ const docTemplate = `{
                 }
             }
         },
+        "/jobs/start_jobs/": {
+            "post": {
+                "security": [
+                    {
+                        "ApiKeyAuth": []
+                    }
+                ],
+                "description": "Like start_job, but for a list of jobs. All jobs are written in as few transactions as possible.\nA job failing does not affect the others, the outcome of every job is returned in the order of the request.",
+                "consumes": [
+                    "application/json"
+                ],
+                "produces": [
+                    "application/json"
+                ],
+                "tags": [
+                    "Job add and modify"
+                ],
+                "summary": "Adds new jobs as \"running\"",
+                "parameters": [
+                    {
+                        "description": "Jobs to add",
+                        "name": "request",
+                        "in": "body",
+                        "required": true,
+                        "schema": {
+                            "type": "array",
+                            "items": {
+                                "$ref": "#/definitions/schema.JobMeta"
+                            }
+                        }
+                    }
+                ],
+                "responses": {
+                    "200": {
+                        "description": "Result per job",
+                        "schema": {
+                            "$ref": "#/definitions/api.BatchApiResponse"
+                        }
+                    },
+                    "400": {
+                        "description": "Bad Request",
+                        "schema": {
+                            "$ref": "#/definitions/api.ErrorResponse"
+                        }
+                    },
+                    "401": {
+                        "description": "Unauthorized",
+                        "schema": {
+                            "$ref": "#/definitions/api.ErrorResponse"
+                        }
+                    },
+                    "403": {
+                        "description": "Forbidden",
+                        "schema": {
+                            "$ref": "#/definitions/api.ErrorResponse"
+                        }
+                    }
+                }
+            }
+        },
         "/jobs/stop_job/": {
             "post": {
                 "security": [
@@ -683,6 +916,66 @@ const docTemplate = `{
                 }
             }
         },
+        "/jobs/stop_jobs/": {
+            "post": {
+                "security": [
+                    {
+                        "ApiKeyAuth": []
+                    }
+                ],
+                "description": "Like stop_job with the job specified by request body, but for a list of jobs. All fields are required.\nA job failing does not affect the others, the outcome of every job is returned in the order of the request.",
+                "consumes": [
+                    "application/json"
+                ],
+                "produces": [
+                    "application/json"
+                ],
+                "tags": [
+                    "Job add and modify"
+                ],
+                "summary": "Marks jobs as completed and triggers archiving",
+                "parameters": [
+                    {
+                        "description": "Jobs to stop",
+                        "name": "request",
+                        "in": "body",
+                        "required": true,
+                        "schema": {
+                            "type": "array",
+                            "items": {
+                                "$ref": "#/definitions/api.StopJobApiRequest"
+                            }
+                        }
+                    }
+                ],
+                "responses": {
+                    "200": {
+                        "description": "Result per job",
+                        "schema": {
+                            "$ref": "#/definitions/api.BatchApiResponse"
+                        }
+                    },
+                    "400": {
+                        "description": "Bad Request",
+                        "schema": {
+                            "$ref": "#/definitions/api.ErrorResponse"
+                        }
+                    },
+                    "401": {
+                        "description": "Unauthorized",
+                        "schema": {
+                            "$ref": "#/definitions/api.ErrorResponse"
+                        }
+                    },
+                    "403": {
+                        "description": "Forbidden",
+                        "schema": {
+                            "$ref": "#/definitions/api.ErrorResponse"
+                        }
+                    }
+                }
+            }
+        },
         "/jobs/tag_job/{id}": {
             "post": {
                 "security": [
@@ -915,6 +1208,85 @@ const docTemplate = `{
                 }
             }
         },
+        "/nodes/live/{cluster}": {
+            "get": {
+                "security": [
+                    {
+                        "ApiKeyAuth": []
+                    }
+                ],
+                "description": "Like /jobs/live/{id}, but for the given nodes of a cluster. Only accessible by admins.",
+                "produces": [
+                    "text/event-stream"
+                ],
+                "tags": [
+                    "Nodes"
+                ],
+                "summary": "Streams the metric data of nodes",
+                "parameters": [
+                    {
+                        "type": "string",
+                        "description": "Cluster",
+                        "name": "cluster",
+                        "in": "path",
+                        "required": true
+                    },
+                    {
+                        "type": "array",
+                        "items": {
+                            "type": "string"
+                        },
+                        "collectionFormat": "csv",
+                        "description": "Nodes to stream",
+                        "name": "host",
+                        "in": "query",
+                        "required": true
+                    },
+                    {
+                        "type": "array",
+                        "items": {
+                            "type": "string"
+                        },
+                        "collectionFormat": "csv",
+                        "description": "Metrics to stream (Default: all)",
+                        "name": "metric",
+                        "in": "query"
+                    },
+                    {
+                        "type": "string",
+                        "description": "ID of the last event received",
+                        "name": "Last-Event-ID",
+                        "in": "header"
+                    }
+                ],
+                "responses": {
+                    "200": {
+                        "description": "Events of type 'metrics', data is an object with 'from', 'to' and 'data'",
+                        "schema": {
+                            "type": "string"
+                        }
+                    },
+                    "400": {
+                        "description": "Bad Request",
+                        "schema": {
+                            "$ref": "#/definitions/api.ErrorResponse"
+                        }
+                    },
+                    "401": {
+                        "description": "Unauthorized",
+                        "schema": {
+                            "$ref": "#/definitions/api.ErrorResponse"
+                        }
+                    },
+                    "403": {
+                        "description": "Forbidden",
+                        "schema": {
+                            "$ref": "#/definitions/api.ErrorResponse"
+                        }
+                    }
+                }
+            }
+        },
         "/user/{id}": {
             "post": {
                 "security": [
@@ -1290,6 +1662,35 @@ const docTemplate = `{
                 }
             }
         },
+        "api.BatchApiResponse": {
+            "type": "object",
+            "properties": {
+                "results": {
+                    "description": "One result per job, in the order of the request",
+                    "type": "array",
+                    "items": {
+                        "$ref": "#/definitions/api.BatchApiResult"
+                    }
+                }
+            }
+        },
+        "api.BatchApiResult": {
+            "type": "object",
+            "properties": {
+                "error": {
+                    "description": "Error message if the job failed",
+                    "type": "string"
+                },
+                "id": {
+                    "description": "Database ID of the job",
+                    "type": "integer"
+                },
+                "status": {
+                    "description": "HTTP status code the single request would have returned",
+                    "type": "integer"
+                }
+            }
+        },
         "api.DeleteJobApiRequest": {
             "type": "object",
             "required": [
@@ -1347,6 +1748,20 @@ const docTemplate = `{
                 }
             }
         },
+        "api.ExportJobLine": {
+            "type": "object",
+            "allOf": [
+                {
+                    "$ref": "#/definitions/schema.JobMeta"
+                }
+            ],
+            "properties": {
+                "data": {
+                    "description": "Metric data, if requested and archived",
+                    "type": "object"
+                }
+            }
+        },
         "api.GetClustersApiResponse": {
             "type": "object",
             "properties": {
@@ -1387,6 +1802,10 @@ const docTemplate = `{
                         "$ref": "#/definitions/schema.JobMeta"
                     }
                 },
+                "nextCursor": {
+                    "description": "Cursor of the next page if requested by cursor and there are more jobs",
+                    "type": "string"
+                },
                 "page": {
                     "description": "Page id returned",
                     "type": "integer"
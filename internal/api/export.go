@@ -0,0 +1,264 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package api
+
+import (
+	"bufio"
+	"context"
+	"encoding/json"
+	"fmt"
+	"net/http"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/internal/graph/model"
+	"github.com/ClusterCockpit/cc-backend/internal/repository"
+	"github.com/ClusterCockpit/cc-backend/pkg/archive"
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+const (
+	// Jobs fetched from the database at once
+	exportPageSize = 500
+	// Jobs whose tags, metadata and metric data are loaded concurrently
+	exportWorkers = 4
+)
+
+// ExportJobLine model, one line of the export
+type ExportJobLine struct {
+	*schema.JobMeta
+	Data schema.JobData `json:"data,omitempty"` // Metric data, if requested and archived
+}
+
+// ExportErrorLine model, last line of an export that failed on the way
+type ExportErrorLine struct {
+	Error string `json:"error"` // Error message
+}
+
+type exportItem struct {
+	job  *schema.Job
+	line *ExportJobLine
+	err  error
+	done chan struct{}
+}
+
+type exportOptions struct {
+	withMetadata bool
+	withMetrics  bool
+	metrics      []string
+}
+
+// exportJobs godoc
+// @summary     Exports jobs as a stream
+// @tags Job query
+// @description Streams all jobs matching the filters as newline delimited JSON, one job per line, sorted by database id.
+// @description The response is gzip compressed if the client accepts it. Memory usage does not depend on the number of jobs and the write timeout of the server does not apply.
+// @description If the export fails on the way, the last line is an error object.
+// @produce     application/x-ndjson
+// @param       state          query    string            false "Job State" Enums(running, completed, failed, cancelled, stopped, timeout)
+// @param       cluster        query    string            false "Job Cluster"
+// @param       start-time     query    string            false "Syntax: '$from-$to', as unix epoch timestamps in seconds"
+// @param       with-metadata  query    bool              false "Include metadata (e.g. jobScript)"
+// @param       with-metrics   query    bool              false "Include the metric data of archived jobs"
+// @param       metric         query    []string          false "Metrics to include (Default: all)"
+// @success     200            {object} api.ExportJobLine       "One job per line"
+// @failure     400            {object} api.ErrorResponse       "Bad Request"
+// @failure     401            {object} api.ErrorResponse       "Unauthorized"
+// @failure     403            {object} api.ErrorResponse       "Forbidden"
+// @security    ApiKeyAuth
+// @router      /jobs/export/ [get]
+func (api *RestApi) exportJobs(rw http.ResponseWriter, r *http.Request) {
+	if user := repository.GetUserFromContext(r.Context()); user != nil &&
+		!user.HasRole(schema.RoleApi) {
+
+		handleError(fmt.Errorf("missing role: %v", schema.GetRoleString(schema.RoleApi)), http.StatusForbidden, rw)
+		return
+	}
+
+	filter := &model.JobFilter{}
+	opts := exportOptions{}
+	for key, vals := range r.URL.Query() {
+		switch key {
+		case "with-metadata":
+			opts.withMetadata = true
+		case "with-metrics":
+			opts.withMetrics = true
+		case "metric":
+			opts.metrics = append(opts.metrics, vals...)
+		default:
+			if err := parseJobFilterParam(filter, key, vals); err != nil {
+				handleError(err, http.StatusBadRequest, rw)
+				return
+			}
+		}
+	}
+
+	ctx, cancel := context.WithCancel(r.Context())
+	defer cancel()
+
+	// An export takes as long as it takes, the write timeout of the server
+	// would cut it off after a few seconds
+	if err := http.NewResponseController(rw).SetWriteDeadline(time.Time{}); err != nil {
+		log.Warnf("/api/jobs/export: clearing the write deadline failed, the export may be cut off: %v", err)
+	}
+
+	// Compressed by the CompressHandler of the router, if the client accepts it
+	rw.Header().Add("Content-Type", "application/x-ndjson")
+	bw := bufio.NewWriterSize(rw, 64*1024)
+	flusher, _ := rw.(http.Flusher)
+	flush := func() error {
+		if err := bw.Flush(); err != nil {
+			return err
+		}
+		if flusher != nil {
+			flusher.Flush()
+		}
+		return nil
+	}
+
+	rw.WriteHeader(http.StatusOK)
+	if err := flush(); err != nil {
+		return
+	}
+
+	pending := make(chan *exportItem, 2*exportWorkers)
+	go api.exportProducer(ctx, filter, opts, pending)
+
+	// Lines are written in the order of the jobs, the output is only
+	// flushed when the next line is not ready yet.
+	enc := json.NewEncoder(bw)
+	count := 0
+	for {
+		var item *exportItem
+		var ok bool
+		select {
+		case item, ok = <-pending:
+		default:
+			if err := flush(); err != nil {
+				return
+			}
+			item, ok = <-pending
+		}
+		if !ok {
+			break
+		}
+
+		select {
+		case <-item.done:
+		default:
+			if err := flush(); err != nil {
+				return
+			}
+			<-item.done
+		}
+
+		if item.err != nil {
+			log.Warnf("REST ERROR : export failed after %d jobs: %s", count, item.err.Error())
+			enc.Encode(ExportErrorLine{Error: item.err.Error()})
+			break
+		}
+
+		if err := enc.Encode(item.line); err != nil {
+			// Most likely the client went away
+			log.Debugf("/api/jobs/export: write failed after %d jobs: %v", count, err)
+			return
+		}
+		count++
+	}
+
+	flush()
+	log.Debugf("/api/jobs/export: %d jobs exported", count)
+}
+
+// Page through the jobs and queue them in their order, the lines are built
+// by at most exportWorkers goroutines at a time. Closes pending when done.
+func (api *RestApi) exportProducer(
+	ctx context.Context,
+	filter *model.JobFilter,
+	opts exportOptions,
+	pending chan<- *exportItem) {
+
+	defer close(pending)
+	sem := make(chan struct{}, exportWorkers)
+	queue := func(item *exportItem) bool {
+		select {
+		case pending <- item:
+			return true
+		case <-ctx.Done():
+			return false
+		}
+	}
+
+	cursor := ""
+	for {
+		jobs, next, err := api.JobRepository.QueryJobsCursor(ctx, []*model.JobFilter{filter},
+			&model.PageRequest{ItemsPerPage: exportPageSize, Cursor: &cursor}, nil)
+		if err != nil {
+			item := &exportItem{err: err, done: make(chan struct{})}
+			close(item.done)
+			queue(item)
+			return
+		}
+
+		for _, job := range jobs {
+			item := &exportItem{job: job, done: make(chan struct{})}
+			if !queue(item) {
+				return
+			}
+
+			sem <- struct{}{}
+			go func() {
+				defer func() { <-sem }()
+				item.line, item.err = api.exportLine(item.job, opts)
+				close(item.done)
+			}()
+		}
+
+		if next == "" {
+			return
+		}
+		cursor = next
+	}
+}
+
+func (api *RestApi) exportLine(job *schema.Job, opts exportOptions) (*ExportJobLine, error) {
+	if opts.withMetadata {
+		if _, err := api.JobRepository.FetchMetadata(job); err != nil {
+			return nil, err
+		}
+	}
+
+	line := &ExportJobLine{JobMeta: &schema.JobMeta{
+		ID:        &job.ID,
+		BaseJob:   job.BaseJob,
+		StartTime: job.StartTime.Unix(),
+	}}
+
+	var err error
+	line.Tags, err = api.JobRepository.GetTags(&job.ID)
+	if err != nil {
+		return nil, err
+	}
+
+	if job.MonitoringStatus != schema.MonitoringStatusArchivingSuccessful {
+		return line, nil
+	}
+
+	line.Statistics, err = archive.GetStatistics(job)
+	if err != nil {
+		return nil, err
+	}
+
+	if opts.withMetrics {
+		// Not through metricdata.LoadData, an export would only evict
+		// everything else from the cache.
+		line.Data, err = archive.GetHandle().LoadJobDataSubset(job, opts.metrics, nil)
+		if err != nil {
+			return nil, err
+		}
+	}
+
+	return line, nil
+}
@@ -0,0 +1,172 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package api
+
+import (
+	"errors"
+	"fmt"
+	"net/http"
+	"strconv"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/internal/metricdata"
+	"github.com/ClusterCockpit/cc-backend/internal/repository"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+	"github.com/gorilla/mux"
+)
+
+const (
+	// A live stream ends after this time, before the write timeout of the
+	// server does. Clients reconnect with the Last-Event-ID header and get
+	// the updates missed in between.
+	liveStreamDuration = 8 * time.Second
+	// Reconnect delay for clients, in milliseconds
+	liveRetry = 1000
+)
+
+// getJobLive godoc
+// @summary     Streams the metric data of a running job
+// @tags Job query
+// @description Server-sent events with the node scope metric data appended since the previous event, in the format of the metric data of a job.
+// @description The data of all jobs and views on a cluster is polled in one query per timestep.
+// @description Each stream ends after a few seconds, clients reconnect with the Last-Event-ID header (EventSource does so) to continue.
+// @description Ends with 422 once the job is not running anymore.
+// @produce     text/event-stream
+// @param       id            path     int                  true  "Database ID of Job"
+// @param       metric        query    []string             false "Metrics to stream (Default: all)"
+// @param       Last-Event-ID header   string               false "ID of the last event received"
+// @success     200           {string} string                     "Events of type 'metrics', data is an object with 'from', 'to' and 'data'"
+// @failure     400           {object} api.ErrorResponse          "Bad Request"
+// @failure     401           {object} api.ErrorResponse          "Unauthorized"
+// @failure     403           {object} api.ErrorResponse          "Forbidden"
+// @failure     422           {object} api.ErrorResponse          "Unprocessable Entity: job not running"
+// @security    ApiKeyAuth
+// @router      /jobs/live/{id} [get]
+func (api *RestApi) getJobLive(rw http.ResponseWriter, r *http.Request) {
+	id, err := strconv.ParseInt(mux.Vars(r)["id"], 10, 64)
+	if err != nil {
+		handleError(fmt.Errorf("integer expected in path for id: %w", err), http.StatusBadRequest, rw)
+		return
+	}
+	job, err := api.JobRepository.FindById(id)
+	if err != nil {
+		handleError(fmt.Errorf("finding job failed: %w", err), http.StatusUnprocessableEntity, rw)
+		return
+	}
+	// Same access rules as for the job query of the GraphQL API
+	if user := repository.GetUserFromContext(r.Context()); user != nil &&
+		job.User != user.Username &&
+		user.HasNotRoles([]schema.Role{schema.RoleAdmin, schema.RoleSupport, schema.RoleManager}) {
+
+		handleError(errors.New("you are not allowed to see this job"), http.StatusForbidden, rw)
+		return
+	}
+	if job.State != schema.JobStateRunning {
+		handleError(fmt.Errorf("job %d is not running", job.ID), http.StatusUnprocessableEntity, rw)
+		return
+	}
+
+	nodes := make([]string, 0, len(job.Resources))
+	for _, res := range job.Resources {
+		nodes = append(nodes, res.Hostname)
+	}
+	streamLive(rw, r, job.Cluster, nodes, r.URL.Query()["metric"])
+}
+
+// getNodesLive godoc
+// @summary     Streams the metric data of nodes
+// @tags Nodes
+// @description Like /jobs/live/{id}, but for the given nodes of a cluster. Only accessible by admins.
+// @produce     text/event-stream
+// @param       cluster       path     string               true  "Cluster"
+// @param       host          query    []string             true  "Nodes to stream"
+// @param       metric        query    []string             false "Metrics to stream (Default: all)"
+// @param       Last-Event-ID header   string               false "ID of the last event received"
+// @success     200           {string} string                     "Events of type 'metrics', data is an object with 'from', 'to' and 'data'"
+// @failure     400           {object} api.ErrorResponse          "Bad Request"
+// @failure     401           {object} api.ErrorResponse          "Unauthorized"
+// @failure     403           {object} api.ErrorResponse          "Forbidden"
+// @security    ApiKeyAuth
+// @router      /nodes/live/{cluster} [get]
+func (api *RestApi) getNodesLive(rw http.ResponseWriter, r *http.Request) {
+	if user := repository.GetUserFromContext(r.Context()); user != nil &&
+		!user.HasRole(schema.RoleAdmin) {
+
+		handleError(fmt.Errorf("missing role: %v", schema.GetRoleString(schema.RoleAdmin)), http.StatusForbidden, rw)
+		return
+	}
+
+	nodes := r.URL.Query()["host"]
+	if len(nodes) == 0 {
+		handleError(errors.New("the parameter 'host' is required"), http.StatusBadRequest, rw)
+		return
+	}
+	streamLive(rw, r, mux.Vars(r)["cluster"], nodes, r.URL.Query()["metric"])
+}
+
+func streamLive(rw http.ResponseWriter, r *http.Request, cluster string, nodes, metrics []string) {
+	var after uint64
+	if id := r.Header.Get("Last-Event-ID"); id != "" {
+		var err error
+		if after, err = strconv.ParseUint(id, 10, 64); err != nil {
+			handleError(fmt.Errorf("invalid Last-Event-ID: %w", err), http.StatusBadRequest, rw)
+			return
+		}
+	}
+
+	sub, err := metricdata.SubscribeLive(cluster, nodes, metrics, after)
+	if err != nil {
+		handleError(err, http.StatusBadRequest, rw)
+		return
+	}
+	defer sub.Close()
+
+	flusher, _ := rw.(http.Flusher)
+	rw.Header().Add("Content-Type", "text/event-stream")
+	rw.Header().Add("Cache-Control", "no-cache")
+	rw.Header().Add("X-Accel-Buffering", "no")
+	rw.WriteHeader(http.StatusOK)
+	// A new client gets an ID right away, so that it does not miss updates
+	// when reconnecting before the first one
+	if after == 0 {
+		_, err = fmt.Fprintf(rw, "retry: %d\nid: %d\n\n", liveRetry, sub.Seq)
+	} else {
+		_, err = fmt.Fprintf(rw, "retry: %d\n\n", liveRetry)
+	}
+	if err != nil {
+		return
+	}
+	if flusher != nil {
+		flusher.Flush()
+	}
+
+	timeout := time.NewTimer(liveStreamDuration)
+	defer timeout.Stop()
+	buf := make([]byte, 0, 4096)
+	for {
+		select {
+		case <-r.Context().Done():
+			return
+		case <-timeout.C:
+			return
+		case u := <-sub.C:
+			buf = append(buf[:0], "id: "...)
+			buf = strconv.AppendUint(buf, u.Seq, 10)
+			buf = append(buf, "\nevent: metrics\ndata: {\"from\":"...)
+			buf = strconv.AppendInt(buf, u.From.Unix(), 10)
+			buf = append(buf, ",\"to\":"...)
+			buf = strconv.AppendInt(buf, u.To.Unix(), 10)
+			buf = append(buf, ",\"data\":"...)
+			buf = u.Data.AppendJSON(buf)
+			buf = append(buf, "}\n\n"...)
+			if _, err := rw.Write(buf); err != nil {
+				return
+			}
+			if flusher != nil {
+				flusher.Flush()
+			}
+		}
+	}
+}
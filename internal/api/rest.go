@@ -6,7 +6,6 @@ package api
 
 import (
 	"bufio"
-	"database/sql"
 	"encoding/json"
 	"errors"
 	"fmt"
@@ -66,19 +65,24 @@ func (api *RestApi) MountRoutes(r *mux.Router) {
 	r.HandleFunc("/jobs/start_job/", api.startJob).Methods(http.MethodPost, http.MethodPut)
 	r.HandleFunc("/jobs/stop_job/", api.stopJobByRequest).Methods(http.MethodPost, http.MethodPut)
 	r.HandleFunc("/jobs/stop_job/{id}", api.stopJobById).Methods(http.MethodPost, http.MethodPut)
+	r.HandleFunc("/jobs/start_jobs/", api.startJobs).Methods(http.MethodPost, http.MethodPut)
+	r.HandleFunc("/jobs/stop_jobs/", api.stopJobs).Methods(http.MethodPost, http.MethodPut)
 	// r.HandleFunc("/jobs/import/", api.importJob).Methods(http.MethodPost, http.MethodPut)
 
 	r.HandleFunc("/jobs/", api.getJobs).Methods(http.MethodGet)
+	r.HandleFunc("/jobs/export/", api.exportJobs).Methods(http.MethodGet)
 	r.HandleFunc("/jobs/{id}", api.getJobById).Methods(http.MethodPost)
 	r.HandleFunc("/jobs/{id}", api.getCompleteJobById).Methods(http.MethodGet)
 	r.HandleFunc("/jobs/tag_job/{id}", api.tagJob).Methods(http.MethodPost, http.MethodPatch)
 	r.HandleFunc("/jobs/edit_meta/{id}", api.editMeta).Methods(http.MethodPost, http.MethodPatch)
 	r.HandleFunc("/jobs/metrics/{id}", api.getJobMetrics).Methods(http.MethodGet)
+	r.HandleFunc("/jobs/live/{id}", api.getJobLive).Methods(http.MethodGet)
 	r.HandleFunc("/jobs/delete_job/", api.deleteJobByRequest).Methods(http.MethodDelete)
 	r.HandleFunc("/jobs/delete_job/{id}", api.deleteJobById).Methods(http.MethodDelete)
 	r.HandleFunc("/jobs/delete_job_before/{ts}", api.deleteJobBefore).Methods(http.MethodDelete)
 
 	r.HandleFunc("/clusters/", api.getClusters).Methods(http.MethodGet)
+	r.HandleFunc("/nodes/live/{cluster}", api.getNodesLive).Methods(http.MethodGet)
 
 	if api.MachineStateDir != "" {
 		r.HandleFunc("/machine_state/{cluster}/{host}", api.getMachineState).Methods(http.MethodGet)
@@ -130,9 +134,10 @@ type DeleteJobApiRequest struct {
 
 // GetJobsApiResponse model
 type GetJobsApiResponse struct {
-	Jobs  []*schema.JobMeta `json:"jobs"`  // Array of jobs
-	Items int               `json:"items"` // Number of jobs returned
-	Page  int               `json:"page"`  // Page id returned
+	Jobs       []*schema.JobMeta `json:"jobs"`                 // Array of jobs
+	Items      int               `json:"items"`                // Number of jobs returned
+	Page       int               `json:"page"`                 // Page id returned
+	NextCursor string            `json:"nextCursor,omitempty"` // Cursor of the next page if requested by cursor and there are more jobs
 }
 
 // GetClustersApiResponse model
@@ -291,17 +296,55 @@ func (api *RestApi) getClusters(rw http.ResponseWriter, r *http.Request) {
 	}
 }
 
+// Add the query parameter key (state, cluster or start-time) of the job
+// list endpoints to filter.
+func parseJobFilterParam(filter *model.JobFilter, key string, vals []string) error {
+	switch key {
+	case "state":
+		for _, s := range vals {
+			state := schema.JobState(s)
+			if !state.Valid() {
+				return fmt.Errorf("invalid query parameter value: state")
+			}
+			filter.State = append(filter.State, state)
+		}
+	case "cluster":
+		filter.Cluster = &model.StringInput{Eq: &vals[0]}
+	case "start-time":
+		st := strings.Split(vals[0], "-")
+		if len(st) != 2 {
+			return fmt.Errorf("invalid query parameter value: startTime")
+		}
+		from, err := strconv.ParseInt(st[0], 10, 64)
+		if err != nil {
+			return err
+		}
+		to, err := strconv.ParseInt(st[1], 10, 64)
+		if err != nil {
+			return err
+		}
+		ufrom, uto := time.Unix(from, 0), time.Unix(to, 0)
+		filter.StartTime = &schema.TimeRange{From: &ufrom, To: &uto}
+	default:
+		return fmt.Errorf("invalid query parameter: %s", key)
+	}
+	return nil
+}
+
 // getJobs godoc
 // @summary     Lists all jobs
 // @tags Job query
 // @description Get a list of all jobs. Filters can be applied using query parameters.
 // @description Number of results can be limited by page. Results are sorted by descending startTime.
+// @description For paging through many jobs pass an empty cursor for the first page and the nextCursor
+// @description of the response for the following ones, each page then takes the same time.
 // @produce     json
 // @param       state          query    string            false "Job State" Enums(running, completed, failed, cancelled, stopped, timeout)
 // @param       cluster        query    string            false "Job Cluster"
 // @param       start-time     query    string            false "Syntax: '$from-$to', as unix epoch timestamps in seconds"
 // @param       items-per-page query    int               false "Items per page (Default: 25)"
 // @param       page           query    int               false "Page Number (Default: 1)"
+// @param       cursor         query    string            false "Cursor returned as nextCursor by the previous page, empty for the first page. Replaces page."
 // @param       with-metadata  query    bool              false "Include metadata (e.g. jobScript) in response"
 // @success     200            {object} api.GetJobsApiResponse  "Job array and page info"
 // @failure     400            {object} api.ErrorResponse       "Bad Request"
@@ -325,37 +368,11 @@ func (api *RestApi) getJobs(rw http.ResponseWriter, r *http.Request) {
 
 	for key, vals := range r.URL.Query() {
 		switch key {
-		case "state":
-			for _, s := range vals {
-				state := schema.JobState(s)
-				if !state.Valid() {
-					handleError(fmt.Errorf("invalid query parameter value: state"),
-						http.StatusBadRequest, rw)
-					return
-				}
-				filter.State = append(filter.State, state)
-			}
-		case "cluster":
-			filter.Cluster = &model.StringInput{Eq: &vals[0]}
-		case "start-time":
-			st := strings.Split(vals[0], "-")
-			if len(st) != 2 {
-				handleError(fmt.Errorf("invalid query parameter value: startTime"),
-					http.StatusBadRequest, rw)
-				return
-			}
-			from, err := strconv.ParseInt(st[0], 10, 64)
-			if err != nil {
-				handleError(err, http.StatusBadRequest, rw)
-				return
-			}
-			to, err := strconv.ParseInt(st[1], 10, 64)
-			if err != nil {
+		case "state", "cluster", "start-time":
+			if err := parseJobFilterParam(filter, key, vals); err != nil {
 				handleError(err, http.StatusBadRequest, rw)
 				return
 			}
-			ufrom, uto := time.Unix(from, 0), time.Unix(to, 0)
-			filter.StartTime = &schema.TimeRange{From: &ufrom, To: &uto}
 		case "page":
 			x, err := strconv.Atoi(vals[0])
 			if err != nil {
@@ -370,6 +387,8 @@ func (api *RestApi) getJobs(rw http.ResponseWriter, r *http.Request) {
 				return
 			}
 			page.ItemsPerPage = x
+		case "cursor":
+			page.Cursor = &vals[0]
 		case "with-metadata":
 			withMetadata = true
 		default:
@@ -379,7 +398,18 @@ func (api *RestApi) getJobs(rw http.ResponseWriter, r *http.Request) {
 		}
 	}
 
-	jobs, err := api.JobRepository.QueryJobs(r.Context(), []*model.JobFilter{filter}, page, order)
+	var jobs []*schema.Job
+	var next string
+	var err error
+	if page.Cursor != nil {
+		jobs, next, err = api.JobRepository.QueryJobsCursor(r.Context(), []*model.JobFilter{filter}, page, order)
+	} else {
+		jobs, err = api.JobRepository.QueryJobs(r.Context(), []*model.JobFilter{filter}, page, order)
+	}
+	if errors.Is(err, repository.ErrInvalidCursor) {
+		handleError(err, http.StatusBadRequest, rw)
+		return
+	}
 	if err != nil {
 		handleError(err, http.StatusInternalServerError, rw)
 		return
@@ -423,9 +453,10 @@ func (api *RestApi) getJobs(rw http.ResponseWriter, r *http.Request) {
 	defer bw.Flush()
 
 	payload := GetJobsApiResponse{
-		Jobs:  results,
-		Items: page.ItemsPerPage,
-		Page:  page.Page,
+		Jobs:       results,
+		Items:      page.ItemsPerPage,
+		Page:       page.Page,
+		NextCursor: next,
 	}
 
 	if err := json.NewEncoder(bw).Encode(payload); err != nil {
@@ -782,48 +813,18 @@ func (api *RestApi) startJob(rw http.ResponseWriter, r *http.Request) {
 		return
 	}
 
-	if req.State == "" {
-		req.State = schema.JobStateRunning
-	}
-	if err := importer.SanityChecks(&req.BaseJob); err != nil {
+	if err := checkStartJob(&req); err != nil {
 		handleError(err, http.StatusBadRequest, rw)
 		return
 	}
 
-	// aquire lock to avoid race condition between API calls
-	var unlockOnce sync.Once
-	api.RepositoryMutex.Lock()
-	defer unlockOnce.Do(api.RepositoryMutex.Unlock)
-
-	// Check if combination of (job_id, cluster_id, start_time) already exists:
-	jobs, err := api.JobRepository.FindAll(&req.JobID, &req.Cluster, nil)
-	if err != nil && err != sql.ErrNoRows {
-		handleError(fmt.Errorf("checking for duplicate failed: %w", err), http.StatusInternalServerError, rw)
+	// Written together with concurrent requests, see JobRepository.StartJobs
+	ids, errs := api.JobRepository.StartJobs([]*schema.JobMeta{&req})
+	if errs[0] != nil {
+		handleError(errs[0], startJobErrorStatus(errs[0]), rw)
 		return
-	} else if err == nil {
-		for _, job := range jobs {
-			if (req.StartTime - job.StartTimeUnix) < 86400 {
-				handleError(fmt.Errorf("a job with that jobId, cluster and startTime already exists: dbid: %d, jobid: %d", job.ID, job.JobID), http.StatusUnprocessableEntity, rw)
-				return
-			}
-		}
-	}
-
-	id, err := api.JobRepository.Start(&req)
-	if err != nil {
-		handleError(fmt.Errorf("insert into database failed: %w", err), http.StatusInternalServerError, rw)
-		return
-	}
-	// unlock here, adding Tags can be async
-	unlockOnce.Do(api.RepositoryMutex.Unlock)
-
-	for _, tag := range req.Tags {
-		if _, err := api.JobRepository.AddTagOrCreate(id, tag.Type, tag.Name); err != nil {
-			http.Error(rw, err.Error(), http.StatusInternalServerError)
-			handleError(fmt.Errorf("adding tag to new job %d failed: %w", id, err), http.StatusInternalServerError, rw)
-			return
-		}
 	}
+	id := ids[0]
 
 	log.Printf("new job (id: %d): cluster=%s, jobId=%d, user=%s, startTime=%d", id, req.Cluster, req.JobID, req.User, req.StartTime)
 	rw.Header().Add("Content-Type", "application/json")
@@ -833,6 +834,29 @@ func (api *RestApi) startJob(rw http.ResponseWriter, r *http.Request) {
 	})
 }
 
+// Defaults and sanity checks for a job to start.
+func checkStartJob(req *schema.JobMeta) error {
+	if req.State == "" {
+		req.State = schema.JobStateRunning
+	}
+	return importer.SanityChecks(&req.BaseJob)
+}
+
+func startJobErrorStatus(err error) int {
+	if errors.Is(err, repository.ErrJobExists) {
+		return http.StatusUnprocessableEntity
+	}
+	return http.StatusInternalServerError
+}
+
+// The status for an error of JobRepository.StopJobs.
+func stopJobErrorStatus(err error) int {
+	if errors.Is(err, repository.ErrJobNotRunning) {
+		return http.StatusUnprocessableEntity
+	}
+	return http.StatusInternalServerError
+}
+
 // stopJobById godoc
 // @summary     Marks job as completed and triggers archiving
 // @tags Job add and modify
@@ -1094,26 +1118,19 @@ func (api *RestApi) deleteJobBefore(rw http.ResponseWriter, r *http.Request) {
 }
 
 func (api *RestApi) checkAndHandleStopJob(rw http.ResponseWriter, job *schema.Job, req StopJobApiRequest) {
-	// Sanity checks
-	if job == nil || job.StartTime.Unix() >= req.StopTime || job.State != schema.JobStateRunning {
-		handleError(errors.New("stopTime must be larger than startTime and only running jobs can be stopped"), http.StatusBadRequest, rw)
-		return
-	}
-
-	if req.State != "" && !req.State.Valid() {
-		handleError(fmt.Errorf("invalid job state: %#v", req.State), http.StatusBadRequest, rw)
+	stop, err := checkStopJob(job, req)
+	if err != nil {
+		handleError(err, http.StatusBadRequest, rw)
 		return
-	} else if req.State == "" {
-		req.State = schema.JobStateCompleted
 	}
 
-	// Mark job as stopped in the database (update state and duration)
-	job.Duration = int32(req.StopTime - job.StartTime.Unix())
-	job.State = req.State
-	if err := api.JobRepository.Stop(job.ID, job.Duration, job.State, job.MonitoringStatus); err != nil {
-		handleError(fmt.Errorf("marking job as stopped failed: %w", err), http.StatusInternalServerError, rw)
+	// Mark job as stopped in the database (update state and duration),
+	// written together with concurrent requests, see JobRepository.StopJobs
+	if errs := api.JobRepository.StopJobs([]repository.JobStop{stop}); errs[0] != nil {
+		handleError(fmt.Errorf("marking job as stopped failed: %w", errs[0]), stopJobErrorStatus(errs[0]), rw)
 		return
 	}
+	job.Duration, job.State = stop.Duration, stop.State
 
 	log.Printf("archiving job... (dbid: %d): cluster=%s, jobId=%d, user=%s, startTime=%s", job.ID, job.Cluster, job.JobID, job.User, job.StartTime)
 
@@ -1133,6 +1150,26 @@ func (api *RestApi) checkAndHandleStopJob(rw http.ResponseWriter, job *schema.Jo
 	api.JobRepository.TriggerArchiving(job)
 }
 
+// Sanity checks for stopping job as requested by req.
+func checkStopJob(job *schema.Job, req StopJobApiRequest) (repository.JobStop, error) {
+	if job == nil || job.StartTime.Unix() >= req.StopTime || job.State != schema.JobStateRunning {
+		return repository.JobStop{}, errors.New("stopTime must be larger than startTime and only running jobs can be stopped")
+	}
+
+	if req.State != "" && !req.State.Valid() {
+		return repository.JobStop{}, fmt.Errorf("invalid job state: %#v", req.State)
+	} else if req.State == "" {
+		req.State = schema.JobStateCompleted
+	}
+
+	return repository.JobStop{
+		ID:               job.ID,
+		Duration:         int32(req.StopTime - job.StartTime.Unix()),
+		State:            req.State,
+		MonitoringStatus: job.MonitoringStatus,
+	}, nil
+}
+
 func (api *RestApi) getJobMetrics(rw http.ResponseWriter, r *http.Request) {
 	id := mux.Vars(r)["id"]
 	metrics := r.URL.Query()["metric"]
@@ -1145,6 +1182,15 @@ func (api *RestApi) getJobMetrics(rw http.ResponseWriter, r *http.Request) {
 		}
 		scopes = append(scopes, s)
 	}
+	var resolution *int
+	if r.URL.Query().Has("resolution") {
+		res, err := strconv.Atoi(r.URL.Query().Get("resolution"))
+		if err != nil {
+			http.Error(rw, err.Error(), http.StatusBadRequest)
+			return
+		}
+		resolution = &res
+	}
 
 	rw.Header().Add("Content-Type", "application/json")
 	rw.WriteHeader(http.StatusOK)
@@ -1158,7 +1204,7 @@ func (api *RestApi) getJobMetrics(rw http.ResponseWriter, r *http.Request) {
 		} `json:"error"`
 	}
 
-	data, err := api.Resolver.Query().JobMetrics(r.Context(), id, metrics, scopes)
+	data, err := api.Resolver.Query().JobMetrics(r.Context(), id, metrics, scopes, resolution)
 	if err != nil {
 		json.NewEncoder(rw).Encode(Respone{
 			Error: &struct {
@@ -6,6 +6,7 @@ package auth
 
 import (
 	"crypto/ed25519"
+	"crypto/sha256"
 	"encoding/base64"
 	"errors"
 	"net/http"
@@ -16,16 +17,29 @@ import (
 	"github.com/ClusterCockpit/cc-backend/internal/config"
 	"github.com/ClusterCockpit/cc-backend/internal/repository"
 	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/lrucache"
 	"github.com/ClusterCockpit/cc-backend/pkg/schema"
 	"github.com/golang-jwt/jwt/v5"
 )
 
+// Verified tokens are cached until they expire, but not for longer than
+// this, keyed by the SHA-256 of the token.
+const jwtCacheTTL = 10 * time.Minute
+
 type JWTAuthenticator struct {
 	publicKey  ed25519.PublicKey
 	privateKey ed25519.PrivateKey
+	cache      *lrucache.Cache
+}
+
+// The claims of a verified token used by AuthViaJWT.
+type verifiedToken struct {
+	sub   string
+	roles []string
 }
 
 func (ja *JWTAuthenticator) Init() error {
+	ja.cache = lrucache.New(1024 * 1024)
 	pubKey, privKey := os.Getenv("JWT_PUBLIC_KEY"), os.Getenv("JWT_PRIVATE_KEY")
 	if pubKey == "" || privKey == "" {
 		log.Warn("environment variables 'JWT_PUBLIC_KEY' or 'JWT_PRIVATE_KEY' not set (token based authentication will not work)")
@@ -62,25 +76,20 @@ func (ja *JWTAuthenticator) AuthViaJWT(
 		return nil, nil
 	}
 
-	token, err := jwt.Parse(rawtoken, func(t *jwt.Token) (interface{}, error) {
-		if t.Method != jwt.SigningMethodEdDSA {
-			return nil, errors.New("only Ed25519/EdDSA supported")
+	key := sha256.Sum256([]byte(rawtoken))
+	data := ja.cache.Get(string(key[:]), func() (interface{}, time.Duration, int) {
+		vt, ttl, err := ja.verify(rawtoken)
+		if err != nil {
+			// Expires right away, the size makes sure that it is evicted
+			return err, 0, len(key)
 		}
-
-		return ja.publicKey, nil
+		return vt, ttl, len(key) + len(vt.sub) + 16*len(vt.roles) + 64
 	})
-	if err != nil {
-		log.Warn("Error while parsing JWT token")
+	if err, ok := data.(error); ok {
 		return nil, err
 	}
-	if !token.Valid {
-		log.Warn("jwt token claims are not valid")
-		return nil, errors.New("jwt token claims are not valid")
-	}
-
-	// Token is valid, extract payload
-	claims := token.Claims.(jwt.MapClaims)
-	sub, _ := claims["sub"].(string)
+	vt := data.(*verifiedToken)
+	sub := vt.sub
 
 	var roles []string
 
@@ -96,14 +105,7 @@ func (ja *JWTAuthenticator) AuthViaJWT(
 		// Take user roles from database instead of trusting the JWT
 		roles = user.Roles
 	} else {
-		// Extract roles from JWT (if present)
-		if rawroles, ok := claims["roles"].([]interface{}); ok {
-			for _, rr := range rawroles {
-				if r, ok := rr.(string); ok {
-					roles = append(roles, r)
-				}
-			}
-		}
+		roles = append(roles, vt.roles...)
 	}
 
 	return &schema.User{
@@ -114,6 +116,48 @@ func (ja *JWTAuthenticator) AuthViaJWT(
 	}, nil
 }
 
+// Checks the signature and claims of rawtoken and returns its subject and
+// roles, with the time until the token expires.
+func (ja *JWTAuthenticator) verify(rawtoken string) (*verifiedToken, time.Duration, error) {
+	token, err := jwt.Parse(rawtoken, func(t *jwt.Token) (interface{}, error) {
+		if t.Method != jwt.SigningMethodEdDSA {
+			return nil, errors.New("only Ed25519/EdDSA supported")
+		}
+
+		return ja.publicKey, nil
+	})
+	if err != nil {
+		log.Warn("Error while parsing JWT token")
+		return nil, 0, err
+	}
+	if !token.Valid {
+		log.Warn("jwt token claims are not valid")
+		return nil, 0, errors.New("jwt token claims are not valid")
+	}
+
+	// Token is valid, extract payload
+	claims := token.Claims.(jwt.MapClaims)
+	vt := &verifiedToken{}
+	vt.sub, _ = claims["sub"].(string)
+
+	// Extract roles from JWT (if present)
+	if rawroles, ok := claims["roles"].([]interface{}); ok {
+		for _, rr := range rawroles {
+			if r, ok := rr.(string); ok {
+				vt.roles = append(vt.roles, r)
+			}
+		}
+	}
+
+	ttl := jwtCacheTTL
+	if exp, err := claims.GetExpirationTime(); err == nil && exp != nil {
+		if d := time.Until(exp.Time); d < ttl {
+			ttl = d
+		}
+	}
+	return vt, ttl, nil
+}
+
 // Generate a new JWT that can be used for authentication
 func (ja *JWTAuthenticator) ProvideJWT(user *schema.User) (string, error) {
 	if ja.privateKey == nil {
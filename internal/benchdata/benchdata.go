@@ -0,0 +1,418 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+
+// Package benchdata generates a synthetic cluster with jobs and their metric
+// data for the benchmarks. The scale is read from the environment (see
+// FromEnv), so that `make bench` runs the same benchmarks on a small or a
+// huge data set. Everything is derived from the seed, the same configuration
+// always produces the same jobs.
+package benchdata
+
+import (
+	"encoding/json"
+	"fmt"
+	"math"
+	"math/rand"
+	"os"
+	"path/filepath"
+	"strconv"
+	"strings"
+
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+const (
+	ClusterName    = "bench"
+	SubClusterName = "main"
+
+	socketsPerNode = 2
+	coresPerSocket = 16
+	coresPerNode   = socketsPerNode * coresPerSocket
+
+	// 2023-01-01, the jobs are spread over one year from there
+	firstStartTime = 1672531200
+	timeRange      = 365 * 86400
+)
+
+// The metrics of the synthetic cluster, the ones with a footprint column
+// in the job table.
+var Metrics = []string{"cpu_load", "flops_any", "mem_bw", "mem_used"}
+
+type metric struct {
+	unit  schema.Unit
+	scope schema.MetricScope
+	peak  float64
+}
+
+var metrics = map[string]metric{
+	"cpu_load":  {unit: schema.Unit{Base: ""}, scope: schema.MetricScopeNode, peak: coresPerNode},
+	"flops_any": {unit: schema.Unit{Base: "F/s", Prefix: "G"}, scope: schema.MetricScopeCore, peak: 40},
+	"mem_bw":    {unit: schema.Unit{Base: "B/s", Prefix: "G"}, scope: schema.MetricScopeSocket, peak: 150},
+	"mem_used":  {unit: schema.Unit{Base: "B", Prefix: "G"}, scope: schema.MetricScopeNode, peak: 256},
+}
+
+type Config struct {
+	// Number of jobs in the synthetic database (CC_BENCH_JOBS, default: 10000)
+	Jobs int
+	// Number of jobs in the synthetic job archive (CC_BENCH_ARCHIVE_JOBS, default: 100)
+	ArchiveJobs int
+	// Maximum number of nodes of a job (CC_BENCH_NODES, default: 64)
+	MaxNodes int
+	// Scopes the metric data is generated for, as far as the native scope
+	// of a metric allows (CC_BENCH_SCOPES, default: node,socket,core)
+	Scopes []schema.MetricScope
+	// Number of samples of every series (CC_BENCH_SAMPLES, default: 360)
+	Samples int
+	// Seed of the generator (CC_BENCH_SEED, default: 1)
+	Seed int64
+}
+
+// The configuration from the environment variables listed in Config.
+func FromEnv() (*Config, error) {
+	c := &Config{
+		Jobs:        10000,
+		ArchiveJobs: 100,
+		MaxNodes:    64,
+		Scopes:      []schema.MetricScope{schema.MetricScopeNode, schema.MetricScopeSocket, schema.MetricScopeCore},
+		Samples:     360,
+		Seed:        1,
+	}
+
+	ints := []struct {
+		name string
+		dst  *int
+	}{
+		{"CC_BENCH_JOBS", &c.Jobs},
+		{"CC_BENCH_ARCHIVE_JOBS", &c.ArchiveJobs},
+		{"CC_BENCH_NODES", &c.MaxNodes},
+		{"CC_BENCH_SAMPLES", &c.Samples},
+	}
+	for _, v := range ints {
+		if s := os.Getenv(v.name); s != "" {
+			n, err := strconv.Atoi(s)
+			if err != nil || n <= 0 {
+				return nil, fmt.Errorf("BENCHDATA > invalid %s '%s'", v.name, s)
+			}
+			*v.dst = n
+		}
+	}
+
+	if s := os.Getenv("CC_BENCH_SEED"); s != "" {
+		seed, err := strconv.ParseInt(s, 10, 64)
+		if err != nil {
+			return nil, fmt.Errorf("BENCHDATA > invalid CC_BENCH_SEED '%s'", s)
+		}
+		c.Seed = seed
+	}
+
+	if s := os.Getenv("CC_BENCH_SCOPES"); s != "" {
+		c.Scopes = c.Scopes[:0]
+		for _, name := range strings.Split(s, ",") {
+			scope := schema.MetricScope(strings.TrimSpace(name))
+			if _, ok := map[schema.MetricScope]bool{
+				schema.MetricScopeNode:   true,
+				schema.MetricScopeSocket: true,
+				schema.MetricScopeCore:   true,
+			}[scope]; !ok {
+				return nil, fmt.Errorf("BENCHDATA > unsupported scope '%s' in CC_BENCH_SCOPES", name)
+			}
+			c.Scopes = append(c.Scopes, scope)
+		}
+	}
+
+	return c, nil
+}
+
+// A name for the jobs of this configuration, e.g. for a database caching them.
+func (c *Config) Name(jobs int) string {
+	return fmt.Sprintf("%s-%djobs-%dnodes-seed%d", ClusterName, jobs, c.MaxNodes, c.Seed)
+}
+
+// A name for the jobs with their metric data, e.g. for an archive.
+func (c *Config) DataName(jobs int) string {
+	scopes := make([]string, 0, len(c.Scopes))
+	for _, s := range c.Scopes {
+		scopes = append(scopes, string(s))
+	}
+	return fmt.Sprintf("%s-%dsamples-%s", c.Name(jobs), c.Samples, strings.Join(scopes, "+"))
+}
+
+// The directory the generated data sets are kept in, $CC_BENCH_DIR or
+// cc-backend-bench in the temporary directory.
+func Dir() string {
+	if dir := os.Getenv("CC_BENCH_DIR"); dir != "" {
+		return dir
+	}
+	return filepath.Join(os.TempDir(), "cc-backend-bench")
+}
+
+// The path of the data set name in Dir(). As generating millions of jobs
+// takes a while, it is only built by build if it does not exist yet. That
+// happens under a temporary name, an interrupted run leaves nothing
+// incomplete behind.
+func Cached(name string, build func(path string) error) (string, error) {
+	if err := os.MkdirAll(Dir(), 0777); err != nil {
+		return "", err
+	}
+
+	path := filepath.Join(Dir(), name)
+	if _, err := os.Stat(path); err == nil {
+		return path, nil
+	}
+
+	tmp := path + ".tmp"
+	os.RemoveAll(tmp)
+	if err := build(tmp); err != nil {
+		os.RemoveAll(tmp)
+		return "", err
+	}
+	return path, os.Rename(tmp, path)
+}
+
+func (c *Config) numClusterNodes() int {
+	n := 4 * c.MaxNodes
+	if n < 64 {
+		n = 64
+	}
+	return n
+}
+
+// The cluster the jobs run on, in the format of a cluster.json.
+func (c *Config) Cluster() *schema.Cluster {
+	topo := schema.Topology{}
+	for s := 0; s < socketsPerNode; s++ {
+		socket := make([]int, 0, coresPerSocket)
+		for i := 0; i < coresPerSocket; i++ {
+			hwt := s*coresPerSocket + i
+			topo.Node = append(topo.Node, hwt)
+			topo.Core = append(topo.Core, []int{hwt})
+			socket = append(socket, hwt)
+		}
+		topo.Socket = append(topo.Socket, socket)
+		topo.MemoryDomain = append(topo.MemoryDomain, socket)
+	}
+
+	cluster := &schema.Cluster{
+		Name: ClusterName,
+		SubClusters: []*schema.SubCluster{{
+			Name:            SubClusterName,
+			Nodes:           fmt.Sprintf("n[0000-%04d]", c.numClusterNodes()-1),
+			ProcessorType:   "Synthetic",
+			SocketsPerNode:  socketsPerNode,
+			CoresPerSocket:  coresPerSocket,
+			ThreadsPerCore:  1,
+			FlopRateScalar:  schema.MetricValue{Unit: schema.Unit{Base: "F/s", Prefix: "G"}, Value: 400},
+			FlopRateSimd:    schema.MetricValue{Unit: schema.Unit{Base: "F/s", Prefix: "G"}, Value: 1200},
+			MemoryBandwidth: schema.MetricValue{Unit: schema.Unit{Base: "B/s", Prefix: "G"}, Value: 300},
+			Topology:        topo,
+		}},
+	}
+
+	for _, name := range Metrics {
+		m := metrics[name]
+		cluster.MetricConfig = append(cluster.MetricConfig, &schema.MetricConfig{
+			Name:        name,
+			Unit:        m.unit,
+			Scope:       m.scope,
+			Aggregation: "sum",
+			Timestep:    60,
+			Peak:        m.peak,
+			Normal:      m.peak / 2,
+			Caution:     m.peak / 10,
+			Alert:       m.peak / 20,
+		})
+	}
+	return cluster
+}
+
+// Generator produces the jobs of a configuration one after the other.
+type Generator struct {
+	c    *Config
+	rng  *rand.Rand
+	n    int
+	i    int
+	step int64
+}
+
+// A generator for n jobs, the last 2% of them are still running.
+func (c *Config) Generator(n int) *Generator {
+	step := int64(timeRange)
+	if n > 0 {
+		step /= int64(n)
+	}
+	if step == 0 {
+		step = 1
+	}
+	return &Generator{c: c, rng: rand.New(rand.NewSource(c.Seed)), n: n, step: step}
+}
+
+// The next job or nil after n jobs.
+func (g *Generator) Next() *schema.JobMeta {
+	if g.i >= g.n {
+		return nil
+	}
+	i, rng := g.i, g.rng
+	g.i++
+
+	numNodes := 1
+	if g.c.MaxNodes > 1 && rng.Intn(10) >= 6 {
+		numNodes = 2 + rng.Intn(g.c.MaxNodes-1)
+	}
+	first := rng.Intn(g.c.numClusterNodes())
+	hwthreads := make([]int, coresPerNode)
+	for k := range hwthreads {
+		hwthreads[k] = k
+	}
+
+	job := &schema.JobMeta{
+		BaseJob:   schema.JobDefaults,
+		StartTime: firstStartTime + int64(i)*g.step + rng.Int63n(g.step),
+	}
+	job.JobID = int64(1000000 + i)
+	job.User = fmt.Sprintf("user%03d", rng.Intn(200))
+	job.Project = fmt.Sprintf("project%02d", rng.Intn(50))
+	job.Cluster = ClusterName
+	job.SubCluster = SubClusterName
+	job.Partition = "main"
+	job.NumNodes = int32(numNodes)
+	job.NumHWThreads = int32(numNodes * coresPerNode)
+	job.Walltime = 86400
+	job.MetaData = map[string]string{"jobName": fmt.Sprintf("bench-%d", i)}
+	for k := 0; k < numNodes; k++ {
+		job.Resources = append(job.Resources, &schema.Resource{
+			Hostname:  fmt.Sprintf("n%04d", (first+k)%g.c.numClusterNodes()),
+			HWThreads: hwthreads,
+		})
+	}
+	if rng.Intn(20) == 0 {
+		job.Tags = []*schema.Tag{{Type: "bench", Name: fmt.Sprintf("tag%d", rng.Intn(10))}}
+	}
+
+	if i >= g.n-g.n/50 {
+		job.State = schema.JobStateRunning
+		return job
+	}
+
+	switch r := rng.Intn(20); {
+	case r < 17:
+		job.State = schema.JobStateCompleted
+	case r < 19:
+		job.State = schema.JobStateFailed
+	default:
+		job.State = schema.JobStateTimeout
+	}
+	job.Duration = int32(60 + rng.Intn(86400-60))
+	job.MonitoringStatus = schema.MonitoringStatusArchivingSuccessful
+
+	job.Statistics = make(map[string]schema.JobStatistics, len(Metrics))
+	for _, name := range Metrics {
+		m := metrics[name]
+		avg := rng.Float64() * m.peak
+		job.Statistics[name] = schema.JobStatistics{
+			Unit: m.unit,
+			Avg:  avg,
+			Min:  avg * rng.Float64(),
+			Max:  avg + (m.peak-avg)*rng.Float64(),
+		}
+	}
+	return job
+}
+
+// The footprint of a job as stored in the job table.
+func Footprint(meta *schema.JobMeta) (loadAvg, flopsAnyAvg, memBwAvg, memUsedMax float64) {
+	return meta.Statistics["cpu_load"].Avg, meta.Statistics["flops_any"].Avg,
+		meta.Statistics["mem_bw"].Avg, meta.Statistics["mem_used"].Max
+}
+
+// The metric data of the job for all configured scopes.
+func (c *Config) JobData(meta *schema.JobMeta) schema.JobData {
+	rng := rand.New(rand.NewSource(c.Seed ^ meta.JobID))
+	data := make(schema.JobData, len(Metrics))
+
+	for _, name := range Metrics {
+		m := metrics[name]
+		data[name] = make(map[schema.MetricScope]*schema.JobMetric)
+		for _, scope := range c.Scopes {
+			if !m.scope.LTE(scope) {
+				continue
+			}
+
+			perNode, div := 1, 1.0
+			switch scope {
+			case schema.MetricScopeSocket:
+				perNode, div = socketsPerNode, socketsPerNode
+			case schema.MetricScopeCore:
+				perNode, div = coresPerNode, coresPerNode
+			}
+
+			jm := &schema.JobMetric{
+				Unit:     m.unit,
+				Timestep: 60,
+				Series:   make([]schema.Series, 0, len(meta.Resources)*perNode),
+			}
+			for _, res := range meta.Resources {
+				for k := 0; k < perNode; k++ {
+					s := schema.Series{Hostname: res.Hostname, Data: make([]schema.Float, c.Samples)}
+					if scope != schema.MetricScopeNode {
+						id := strconv.Itoa(k)
+						s.Id = &id
+					}
+
+					level := rng.Float64() * m.peak / div
+					lo, hi, sum := math.MaxFloat64, -math.MaxFloat64, 0.0
+					for t := range s.Data {
+						v := level * (0.8 + 0.4*rng.Float64())
+						s.Data[t] = schema.Float(v)
+						lo, hi, sum = math.Min(lo, v), math.Max(hi, v), sum+v
+					}
+					s.Statistics = schema.MetricStatistics{Avg: sum / float64(c.Samples), Min: lo, Max: hi}
+					jm.Series = append(jm.Series, s)
+				}
+			}
+			data[name][scope] = jm
+		}
+	}
+	return data
+}
+
+// Create an empty job archive in dir with version.txt and the cluster.json
+// of the synthetic cluster.
+func (c *Config) InitArchive(dir string, version uint64) error {
+	if err := os.MkdirAll(filepath.Join(dir, ClusterName), 0777); err != nil {
+		return err
+	}
+	if err := os.WriteFile(filepath.Join(dir, "version.txt"), []byte(fmt.Sprintf("%d\n", version)), 0666); err != nil {
+		return err
+	}
+
+	cluster, err := json.Marshal(c.Cluster())
+	if err != nil {
+		return err
+	}
+	return os.WriteFile(filepath.Join(dir, ClusterName, "cluster.json"), cluster, 0666)
+}
+
+// Pass the first n jobs to importJob (e.g. ArchiveBackend.ImportJob), with
+// their metric data only if withData is true. Running jobs are skipped.
+func (c *Config) ImportJobs(
+	n int,
+	withData bool,
+	importJob func(*schema.JobMeta, *schema.JobData) error) error {
+
+	g := c.Generator(n)
+	for job := g.Next(); job != nil; job = g.Next() {
+		if job.State == schema.JobStateRunning {
+			continue
+		}
+		data := schema.JobData{}
+		if withData {
+			data = c.JobData(job)
+		}
+		if err := importJob(job, &data); err != nil {
+			return err
+		}
+	}
+	return nil
+}
@@ -3,3 +3,28 @@
 // Use of this source code is governed by a MIT-style
 // license that can be found in the LICENSE file.
 package model
+
+import (
+	"github.com/99designs/gqlgen/graphql"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+// Marshaler of the NullableFloatArray scalar, a list of NullableFloat
+// written at once instead of element by element (see schema.FloatArray).
+func MarshalFloatArray(v []schema.Float) graphql.Marshaler {
+	return schema.FloatArray(v)
+}
+
+func UnmarshalFloatArray(v interface{}) ([]schema.Float, error) {
+	var vSlice []interface{}
+	if v != nil {
+		vSlice = graphql.CoerceList(v)
+	}
+	res := make([]schema.Float, len(vSlice))
+	for i := range vSlice {
+		if err := res[i].UnmarshalGQL(vSlice[i]); err != nil {
+			return nil, err
+		}
+	}
+	return res, nil
+}
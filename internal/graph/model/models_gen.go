@@ -83,6 +83,7 @@ type JobResultList struct {
 	Limit       *int          `json:"limit,omitempty"`
 	Count       *int          `json:"count,omitempty"`
 	HasNextPage *bool         `json:"hasNextPage,omitempty"`
+	NextCursor  *string       `json:"nextCursor,omitempty"`
 }
 
 type JobsStatistics struct {
@@ -138,8 +139,9 @@ type OrderByInput struct {
 }
 
 type PageRequest struct {
-	ItemsPerPage int `json:"itemsPerPage"`
-	Page         int `json:"page"`
+	ItemsPerPage int     `json:"itemsPerPage"`
+	Page         int     `json:"page"`
+	Cursor       *string `json:"cursor,omitempty"`
 }
 
 type Query struct {
@@ -188,23 +188,27 @@ func (r *queryResolver) Job(ctx context.Context, id string) (*schema.Job, error)
 }
 
 // JobMetrics is the resolver for the jobMetrics field.
-func (r *queryResolver) JobMetrics(ctx context.Context, id string, metrics []string, scopes []schema.MetricScope) ([]*model.JobMetricWithName, error) {
+func (r *queryResolver) JobMetrics(ctx context.Context, id string, metrics []string, scopes []schema.MetricScope, resolution *int) ([]*model.JobMetricWithName, error) {
 	job, err := r.Query().Job(ctx, id)
 	if err != nil {
 		log.Warn("Error while querying job for metrics")
 		return nil, err
 	}
 
-	data, err := metricdata.LoadData(job, metrics, scopes, ctx)
+	res := 0
+	if resolution != nil {
+		res = *resolution
+	}
+	data, err := metricdata.LoadDataDownsampled(job, metrics, scopes, res, ctx)
 	if err != nil {
 		log.Warn("Error while loading job data")
 		return nil, err
 	}
 
-	res := []*model.JobMetricWithName{}
+	list := []*model.JobMetricWithName{}
 	for name, md := range data {
 		for scope, metric := range md {
-			res = append(res, &model.JobMetricWithName{
+			list = append(list, &model.JobMetricWithName{
 				Name:   name,
 				Scope:  scope,
 				Metric: metric,
@@ -212,7 +216,7 @@ func (r *queryResolver) JobMetrics(ctx context.Context, id string, metrics []str
 		}
 	}
 
-	return res, err
+	return list, err
 }
 
 // JobsFootprints is the resolver for the jobsFootprints field.
@@ -229,11 +233,38 @@ func (r *queryResolver) Jobs(ctx context.Context, filter []*model.JobFilter, pag
 		}
 	}
 
+	if page.Cursor != nil {
+		jobs, next, err := r.Repo.QueryJobsCursor(ctx, filter, page, order)
+		if err != nil {
+			log.Warn("Error while querying jobs")
+			return nil, err
+		}
+		prefetchJobMetrics(ctx, filter, jobs)
+
+		res := &model.JobResultList{Items: jobs}
+		if requireField(ctx, "count") {
+			count, err := r.Repo.CountJobs(ctx, filter)
+			if err != nil {
+				log.Warn("Error while counting jobs")
+				return nil, err
+			}
+			res.Count = &count
+		}
+
+		hasNextPage := next != ""
+		res.HasNextPage = &hasNextPage
+		if hasNextPage {
+			res.NextCursor = &next
+		}
+		return res, nil
+	}
+
 	jobs, err := r.Repo.QueryJobs(ctx, filter, page, order)
 	if err != nil {
 		log.Warn("Error while querying jobs")
 		return nil, err
 	}
+	prefetchJobMetrics(ctx, filter, jobs)
 
 	count, err := r.Repo.CountJobs(ctx, filter)
 	if err != nil {
@@ -353,13 +384,20 @@ func (r *queryResolver) NodeMetrics(ctx context.Context, cluster string, nodes [
 		return nil, err
 	}
 
+	hostnames := make([]string, 0, len(data))
+	for hostname := range data {
+		hostnames = append(hostnames, hostname)
+	}
+	subClusters, _ := archive.GetSubClustersByNodes(cluster, hostnames)
+
 	nodeMetrics := make([]*model.NodeMetrics, 0, len(data))
-	for hostname, metrics := range data {
+	for i, hostname := range hostnames {
+		metrics := data[hostname]
 		host := &model.NodeMetrics{
-			Host:    hostname,
-			Metrics: make([]*model.JobMetricWithName, 0, len(metrics)*len(scopes)),
+			Host:       hostname,
+			SubCluster: subClusters[i],
+			Metrics:    make([]*model.JobMetricWithName, 0, len(metrics)*len(scopes)),
 		}
-		host.SubCluster, _ = archive.GetSubClusterByNode(cluster, hostname)
 
 		for metric, scopedMetrics := range metrics {
 			for _, scopedMetric := range scopedMetrics {
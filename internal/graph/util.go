@@ -12,6 +12,7 @@ import (
 	"github.com/99designs/gqlgen/graphql"
 	"github.com/ClusterCockpit/cc-backend/internal/graph/model"
 	"github.com/ClusterCockpit/cc-backend/internal/metricdata"
+	"github.com/ClusterCockpit/cc-backend/internal/repository"
 	"github.com/ClusterCockpit/cc-backend/pkg/log"
 	"github.com/ClusterCockpit/cc-backend/pkg/schema"
 	// "github.com/ClusterCockpit/cc-backend/pkg/archive"
@@ -42,17 +43,36 @@ func (r *queryResolver) rooflineHeatmap(
 		tiles[i] = make([]float64, cols)
 	}
 
+	// Archived jobs come with a pre-aggregated histogram, only the remaining
+	// jobs need their metric data loaded.
+	ids := make([]int64, 0, len(jobs))
 	for _, job := range jobs {
-		if job.MonitoringStatus == schema.MonitoringStatusDisabled || job.MonitoringStatus == schema.MonitoringStatusArchivingFailed {
-			continue
-		}
+		ids = append(ids, job.ID)
+	}
+	rooflines, err := r.Repo.FetchRooflines(ids)
+	if err != nil {
+		log.Error("Error while fetching roofline histograms")
+		return nil, err
+	}
 
-		jobdata, err := metricdata.LoadData(job, []string{"flops_any", "mem_bw"}, []schema.MetricScope{schema.MetricScopeNode}, ctx)
-		if err != nil {
-			log.Errorf("Error while loading roofline metrics for job %d", job.ID)
-			return nil, err
+	remaining := make([]*schema.Job, 0, len(jobs)-len(rooflines))
+	for _, job := range jobs {
+		if h, ok := rooflines[job.ID]; ok {
+			h.AddTo(tiles, minX, minY, maxX, maxY)
+		} else {
+			remaining = append(remaining, job)
 		}
+	}
 
+	jobs = withMetricData(remaining)
+	jobsdata, err := metricdata.LoadDataBatch(jobs, []string{"flops_any", "mem_bw"}, []schema.MetricScope{schema.MetricScopeNode}, ctx)
+	if err != nil {
+		log.Error("Error while loading roofline metrics")
+		return nil, err
+	}
+
+	for j, job := range jobs {
+		jobdata := jobsdata[j]
 		flops_, membw_ := jobdata["flops_any"], jobdata["mem_bw"]
 		if flops_ == nil && membw_ == nil {
 			log.Infof("rooflineHeatmap(): 'flops_any' or 'mem_bw' missing for job %d", job.ID)
@@ -115,16 +135,13 @@ func (r *queryResolver) jobsFootprints(ctx context.Context, filter []*model.JobF
 	timeweights.AccHours = make([]schema.Float, 0, len(jobs))
 	timeweights.CoreHours = make([]schema.Float, 0, len(jobs))
 
-	for _, job := range jobs {
-		if job.MonitoringStatus == schema.MonitoringStatusDisabled || job.MonitoringStatus == schema.MonitoringStatusArchivingFailed {
-			continue
-		}
-
-		if err := metricdata.LoadAverages(job, metrics, avgs, ctx); err != nil {
-			log.Error("Error while loading averages for footprint")
-			return nil, err
-		}
+	jobs = withMetricData(jobs)
+	if err := metricdata.LoadAveragesBatch(jobs, metrics, avgs, ctx); err != nil {
+		log.Error("Error while loading averages for footprint")
+		return nil, err
+	}
 
+	for _, job := range jobs {
 		// #166 collect arrays: Null values or no null values?
 		timeweights.NodeHours = append(timeweights.NodeHours, schema.Float(float64(job.Duration)/60.0*float64(job.NumNodes)))
 		if job.NumAcc > 0 {
@@ -153,6 +170,18 @@ func (r *queryResolver) jobsFootprints(ctx context.Context, filter []*model.JobF
 	}, nil
 }
 
+// Drop jobs for which no metric data is available.
+func withMetricData(jobs []*schema.Job) []*schema.Job {
+	res := make([]*schema.Job, 0, len(jobs))
+	for _, job := range jobs {
+		if job.MonitoringStatus == schema.MonitoringStatusDisabled || job.MonitoringStatus == schema.MonitoringStatusArchivingFailed {
+			continue
+		}
+		res = append(res, job)
+	}
+	return res
+}
+
 // func numCoresForJob(job *schema.Job) (numCores int) {
 
 // 	subcluster, scerr := archive.GetSubCluster(job.Cluster, job.SubCluster)
@@ -176,6 +205,46 @@ func (r *queryResolver) jobsFootprints(ctx context.Context, filter []*model.JobF
 // 	return totalJobCores
 // }
 
+// Start loading the metric data the rows of the job list in the web UI
+// request for the jobs of a page (see metricdata.Prefetch). The metrics
+// are selected like in the frontend: the cluster specific list of the
+// user if the jobs are filtered by cluster, the general one otherwise.
+func prefetchJobMetrics(ctx context.Context, filter []*model.JobFilter, jobs []*schema.Job) {
+	if len(jobs) == 0 {
+		return
+	}
+
+	uiconfig, err := repository.GetUserCfgRepo().GetUIConfig(repository.GetUserFromContext(ctx))
+	if err != nil {
+		log.Warn("Error while loading ui config for prefetching")
+		return
+	}
+
+	key := "plot_list_selectedMetrics"
+	for _, f := range filter {
+		if f.Cluster != nil && f.Cluster.Eq != nil {
+			if _, ok := uiconfig[key+":"+*f.Cluster.Eq]; ok {
+				key += ":" + *f.Cluster.Eq
+			}
+			break
+		}
+	}
+
+	var metrics []string
+	switch selected := uiconfig[key].(type) {
+	case []string:
+		metrics = selected
+	case []interface{}:
+		for _, m := range selected {
+			if name, ok := m.(string); ok {
+				metrics = append(metrics, name)
+			}
+		}
+	}
+
+	metricdata.Prefetch(jobs, metrics)
+}
+
 func requireField(ctx context.Context, name string) bool {
 	fields := graphql.CollectAllFields(ctx)
 
@@ -0,0 +1,62 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package importer_test
+
+import (
+	"encoding/json"
+	"fmt"
+	"path/filepath"
+	"testing"
+
+	"github.com/ClusterCockpit/cc-backend/internal/benchdata"
+	"github.com/ClusterCockpit/cc-backend/internal/importer"
+	"github.com/ClusterCockpit/cc-backend/internal/repository"
+	"github.com/ClusterCockpit/cc-backend/pkg/archive"
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+)
+
+// Builds the job table from a synthetic archive with the metadata of the
+// jobs of benchdata.FromEnv(). The database connection is a singleton: run
+// it on its own (`make bench` does) to not import into the test database.
+func BenchmarkInitDB(b *testing.B) {
+	log.Init("warn", true)
+	cfg, err := benchdata.FromEnv()
+	if err != nil {
+		b.Fatal(err)
+	}
+
+	archiveCfg := func(path string) json.RawMessage {
+		return json.RawMessage(fmt.Sprintf(`{"kind": "file", "path": "%s"}`, path))
+	}
+
+	path, err := benchdata.Cached(cfg.Name(cfg.Jobs)+"-archive-meta", func(path string) error {
+		if err := cfg.InitArchive(path, archive.Version); err != nil {
+			return err
+		}
+		if err := archive.Init(archiveCfg(path), false); err != nil {
+			return err
+		}
+		return cfg.ImportJobs(cfg.Jobs, false, archive.GetHandle().ImportJob)
+	})
+	if err != nil {
+		b.Fatal(err)
+	}
+	if err := archive.Init(archiveCfg(path), false); err != nil {
+		b.Fatal(err)
+	}
+
+	dbfile := filepath.Join(b.TempDir(), "job.db")
+	if err := repository.MigrateDB("sqlite3", dbfile); err != nil {
+		b.Fatal(err)
+	}
+	repository.Connect("sqlite3", dbfile)
+
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if err := importer.InitDB(false); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
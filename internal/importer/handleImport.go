@@ -69,6 +69,12 @@ func HandleImportFlag(flag string) error {
 
 		// checkJobData(&jobData)
 
+		// Stored with the job, so that the job view does not have to compute
+		// them on every load
+		jobData.AddStatisticsSeries()
+		jobData.AddNodeScope("flops_any")
+		jobData.AddNodeScope("mem_bw")
+
 		jobMeta.MonitoringStatus = schema.MonitoringStatusArchivingSuccessful
 
 		// if _, err = r.Find(&jobMeta.JobID, &jobMeta.Cluster, &jobMeta.StartTime); err != sql.ErrNoRows {
@@ -105,6 +111,21 @@ func HandleImportFlag(flag string) error {
 			return err
 		}
 
+		if jobMeta.Roofline == nil {
+			if flops, ok := jobData["flops_any"]; ok {
+				if membw, ok := jobData["mem_bw"]; ok {
+					jobMeta.Roofline = schema.NewRooflineHistogram(flops[schema.MetricScopeNode], membw[schema.MetricScopeNode])
+				}
+			}
+		}
+		if jobMeta.Roofline != nil {
+			job.RawRoofline, err = json.Marshal(jobMeta.Roofline)
+			if err != nil {
+				log.Warn("Error while marshaling job roofline")
+				return err
+			}
+		}
+
 		if err = SanityChecks(&job.BaseJob); err != nil {
 			log.Warn("BaseJob SanityChecks failed")
 			return err
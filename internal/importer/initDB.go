@@ -10,6 +10,7 @@ import (
 	"strings"
 	"time"
 
+	"github.com/ClusterCockpit/cc-backend/internal/config"
 	"github.com/ClusterCockpit/cc-backend/internal/repository"
 	"github.com/ClusterCockpit/cc-backend/pkg/archive"
 	"github.com/ClusterCockpit/cc-backend/pkg/log"
@@ -17,22 +18,37 @@ import (
 )
 
 // Delete the tables "job", "tag" and "jobtag" from the database and
-// repopulate them using the jobs found in `archive`.
-func InitDB() error {
+// repopulate them using the jobs found in `archive`. The archive is scanned
+// in parallel, every shard of it (see ArchiveBackend.IterShards) is inserted
+// in one transaction together with a checkpoint using multi row INSERTs of
+// `import-batch-size` jobs (see repository.BulkLoader). If resume is true, the
+// tables are not deleted and the shards imported before are skipped.
+func InitDB(resume bool) error {
 	r := repository.GetJobRepository()
-	if err := r.Flush(); err != nil {
-		log.Errorf("repository initDB(): %v", err)
-		return err
+	var done map[string]bool
+	var err error
+
+	if resume {
+		if done, err = r.Checkpoints(); err != nil {
+			log.Errorf("repository initDB(): %v", err)
+			return err
+		}
+		log.Printf("Resume building job table, skipping %d shards done before...", len(done))
+	} else {
+		if err := r.Flush(); err != nil {
+			log.Errorf("repository initDB(): %v", err)
+			return err
+		}
+		log.Print("Building job table...")
 	}
 	starttime := time.Now()
-	log.Print("Building job table...")
 
-	t, err := r.TransactionInit()
+	bl, err := r.NewBulkLoader(config.Keys.ImportBatchSize)
 	if err != nil {
-		log.Warn("Error while initializing SQL transactions")
+		log.Warn("Error while initializing bulk load")
 		return err
 	}
-	tags := make(map[string]int64)
+	defer bl.Close()
 
 	// Not using log.Print because we want the line to end with `\r` and
 	// this function is only ever called when a special command line flag
@@ -40,89 +56,82 @@ func InitDB() error {
 	fmt.Printf("%d jobs inserted...\r", 0)
 
 	ar := archive.GetHandle()
-	i := 0
 	errorOccured := 0
 
-	for jobContainer := range ar.Iter(false) {
-
-		jobMeta := jobContainer.Meta
-
-		// Bundle 100 inserts into one transaction for better performance
-		if i%100 == 0 {
-			r.TransactionCommit(t)
-			fmt.Printf("%d jobs inserted...\r", i)
+	for shard := range ar.IterShards(done, 0) {
+		if err := bl.Begin(); err != nil {
+			return err
 		}
 
-		jobMeta.MonitoringStatus = schema.MonitoringStatusArchivingSuccessful
-		job := schema.Job{
-			BaseJob:       jobMeta.BaseJob,
-			StartTime:     time.Unix(jobMeta.StartTime, 0),
-			StartTimeUnix: jobMeta.StartTime,
-		}
-
-		// TODO: Other metrics...
-		job.LoadAvg = loadJobStat(jobMeta, "cpu_load")
-		job.FlopsAnyAvg = loadJobStat(jobMeta, "flops_any")
-		job.MemUsedMax = loadJobStat(jobMeta, "mem_used")
-		job.MemBwAvg = loadJobStat(jobMeta, "mem_bw")
-		job.NetBwAvg = loadJobStat(jobMeta, "net_bw")
-		job.FileBwAvg = loadJobStat(jobMeta, "file_bw")
-
-		job.RawResources, err = json.Marshal(job.Resources)
-		if err != nil {
-			log.Errorf("repository initDB(): %v", err)
-			errorOccured++
-			continue
-		}
-
-		job.RawMetaData, err = json.Marshal(job.MetaData)
-		if err != nil {
-			log.Errorf("repository initDB(): %v", err)
-			errorOccured++
-			continue
-		}
+		for _, jobMeta := range shard.Jobs {
+			jobMeta.MonitoringStatus = schema.MonitoringStatusArchivingSuccessful
+			job := schema.Job{
+				BaseJob:       jobMeta.BaseJob,
+				StartTime:     time.Unix(jobMeta.StartTime, 0),
+				StartTimeUnix: jobMeta.StartTime,
+			}
 
-		if err := SanityChecks(&job.BaseJob); err != nil {
-			log.Errorf("repository initDB(): %v", err)
-			errorOccured++
-			continue
-		}
+			// TODO: Other metrics...
+			job.LoadAvg = loadJobStat(jobMeta, "cpu_load")
+			job.FlopsAnyAvg = loadJobStat(jobMeta, "flops_any")
+			job.MemUsedMax = loadJobStat(jobMeta, "mem_used")
+			job.MemBwAvg = loadJobStat(jobMeta, "mem_bw")
+			job.NetBwAvg = loadJobStat(jobMeta, "net_bw")
+			job.FileBwAvg = loadJobStat(jobMeta, "file_bw")
+
+			job.RawResources, err = json.Marshal(job.Resources)
+			if err != nil {
+				log.Errorf("repository initDB(): %v", err)
+				errorOccured++
+				continue
+			}
 
-		id, err := r.TransactionAdd(t, job)
-		if err != nil {
-			log.Errorf("repository initDB(): %v", err)
-			errorOccured++
-			continue
-		}
+			job.RawMetaData, err = json.Marshal(job.MetaData)
+			if err != nil {
+				log.Errorf("repository initDB(): %v", err)
+				errorOccured++
+				continue
+			}
 
-		for _, tag := range job.Tags {
-			tagstr := tag.Name + ":" + tag.Type
-			tagId, ok := tags[tagstr]
-			if !ok {
-				tagId, err = r.TransactionAddTag(t, tag)
+			if jobMeta.Roofline != nil {
+				job.RawRoofline, err = json.Marshal(jobMeta.Roofline)
 				if err != nil {
-					log.Errorf("Error adding tag: %v", err)
+					log.Errorf("repository initDB(): %v", err)
 					errorOccured++
 					continue
 				}
-				tags[tagstr] = tagId
 			}
 
-			r.TransactionSetTag(t, id, tagId)
+			if err := SanityChecks(&job.BaseJob); err != nil {
+				log.Errorf("repository initDB(): %v", err)
+				errorOccured++
+				continue
+			}
+
+			if err := bl.Add(job); err != nil {
+				return err
+			}
 		}
 
-		if err == nil {
-			i += 1
+		if err := bl.Commit(shard.Name); err != nil {
+			return err
 		}
+		inserted, _ := bl.Stats()
+		fmt.Printf("%d jobs inserted...\r", inserted)
 	}
 
+	i, failed := bl.Stats()
+	errorOccured += failed
 	if errorOccured > 0 {
 		log.Warnf("Error in import of %d jobs!", errorOccured)
 	}
 
-	r.TransactionEnd(t)
 	log.Printf("A total of %d jobs have been registered in %.3f seconds.\n", i, time.Since(starttime).Seconds())
-	return nil
+	if err := bl.Close(); err != nil {
+		return err
+	}
+
+	return r.RebuildRollup()
 }
 
 // This function also sets the subcluster if necessary!
@@ -10,7 +10,9 @@ import (
 	"context"
 	"encoding/json"
 	"fmt"
+	"math"
 	"net/http"
+	"sort"
 	"strconv"
 	"strings"
 	"time"
@@ -184,10 +186,23 @@ func (ccms *CCMetricStore) LoadData(
 		return nil, err
 	}
 
+	return ccms.buildJobData(job, req.Queries, assignedScope, resBody.Results, nil)
+}
+
+// Assemble the JobData of a job from the results of its queries. If window is
+// not nil, the results were fetched for a larger time range than the job ran
+// (see LoadDataBatch) and are cut down to the job's own time range first.
+func (ccms *CCMetricStore) buildJobData(
+	job *schema.Job,
+	queries []ApiQuery,
+	assignedScope []schema.MetricScope,
+	results [][]ApiMetricData,
+	window *jobWindow,
+) (schema.JobData, error) {
 	var errors []string
 	jobData := make(schema.JobData)
-	for i, row := range resBody.Results {
-		query := req.Queries[i]
+	for i, row := range results {
+		query := queries[i]
 		metric := ccms.toLocalName(query.Metric)
 		scope := assignedScope[i]
 		mc := archive.GetMetricConfig(job.Cluster, metric)
@@ -212,6 +227,10 @@ func (ccms *CCMetricStore) LoadData(
 				continue
 			}
 
+			if window != nil {
+				res = window.slice(res, mc.Timestep)
+			}
+
 			id := (*string)(nil)
 			if query.Type != nil {
 				id = new(string)
@@ -531,9 +550,20 @@ func (ccms *CCMetricStore) LoadStats(
 		return nil, err
 	}
 
-	stats := make(map[string]map[string]schema.MetricStatistics, len(metrics))
-	for i, res := range resBody.Results {
-		query := req.Queries[i]
+	return ccms.buildStats(job, req.Queries, resBody.Results, nil), nil
+}
+
+// Collect the per node statistics of a job from the results of its queries.
+// For window see buildJobData.
+func (ccms *CCMetricStore) buildStats(
+	job *schema.Job,
+	queries []ApiQuery,
+	results [][]ApiMetricData,
+	window *jobWindow,
+) map[string]map[string]schema.MetricStatistics {
+	stats := make(map[string]map[string]schema.MetricStatistics)
+	for i, res := range results {
+		query := queries[i]
 		metric := ccms.toLocalName(query.Metric)
 		data := res[0]
 		if data.Error != nil {
@@ -542,6 +572,10 @@ func (ccms *CCMetricStore) LoadStats(
 			// return nil, fmt.Errorf("METRICDATA/CCMS > fetching %s for node %s failed: %s", metric, query.Hostname, *data.Error)
 		}
 
+		if window != nil {
+			data = window.slice(data, archive.GetMetricConfig(job.Cluster, metric).Timestep)
+		}
+
 		metricdata, ok := stats[metric]
 		if !ok {
 			metricdata = make(map[string]schema.MetricStatistics, job.NumNodes)
@@ -561,7 +595,7 @@ func (ccms *CCMetricStore) LoadStats(
 		}
 	}
 
-	return stats, nil
+	return stats
 }
 
 // TODO: Support sub-node-scope metrics! For this, the partition of a node needs to be known!
@@ -662,3 +696,254 @@ func intToStringSlice(is []int) []string {
 	}
 	return ss
 }
+
+// Jobs are only merged into one request if the merged time range is at most
+// this many times longer than the longest job of the batch. Otherwise short
+// jobs far apart in time would pull in a lot of data nobody asked for.
+const ccmsBatchMaxSpanFactor = 2
+
+// Upper bound for the number of queries sent within a single request.
+const ccmsBatchMaxQueries = 8192
+
+// Time range of a single job within a batched request.
+type jobWindow struct {
+	from, to int64
+}
+
+func newJobWindow(job *schema.Job) jobWindow {
+	return jobWindow{
+		from: job.StartTime.Unix(),
+		to:   job.StartTime.Add(time.Duration(job.Duration) * time.Second).Unix(),
+	}
+}
+
+// Cut a result fetched for a larger time range down to the window and
+// recompute its statistics for the remaining data points.
+func (w *jobWindow) slice(res ApiMetricData, timestep int) ApiMetricData {
+	if timestep <= 0 || res.Data == nil || (res.From >= w.from && res.To <= w.to) {
+		return res
+	}
+
+	// Results may start later or end earlier than requested (sparse data,
+	// clock skew), so both bounds are clamped to the data available. A window
+	// not overlapping the data at all leaves no data points.
+	ts, n := int64(timestep), int64(len(res.Data))
+	start, end := int64(0), n
+	if w.from > res.From {
+		start = (w.from - res.From) / ts
+	}
+	if w.to < res.From {
+		end = 0
+	} else if e := (w.to-res.From)/ts + 1; e < end {
+		end = e
+	}
+	if start > end {
+		start = end
+	}
+
+	res.Data = res.Data[start:end]
+	res.From += start * ts
+	res.To = res.From + int64(len(res.Data))*ts
+
+	min, max, avg := MinMaxMean(res.Data)
+	if math.IsNaN(avg) || len(res.Data) == 0 {
+		res.Avg, res.Min, res.Max = schema.NaN, schema.NaN, schema.NaN
+	} else {
+		res.Avg, res.Min, res.Max = schema.Float(avg), schema.Float(min), schema.Float(max)
+	}
+
+	return res
+}
+
+// Several jobs of one cluster combined into a single request.
+type ccmsBatch struct {
+	req     ApiQueryRequest
+	jobs    []int                // Indices into the jobs slice passed to buildBatches
+	windows []jobWindow          // Time range of every job
+	offsets []int                // Index of the first query of every job (plus one past the end)
+	scopes  []schema.MetricScope // Assigned scope of every query
+	maxSpan int64
+}
+
+func (b *ccmsBatch) fits(w jobWindow, numQueries int) bool {
+	if len(b.jobs) == 0 {
+		return true
+	}
+
+	if len(b.req.Queries)+numQueries > ccmsBatchMaxQueries {
+		return false
+	}
+
+	from, to, maxSpan := b.req.From, b.req.To, b.maxSpan
+	if w.from < from {
+		from = w.from
+	}
+	if w.to > to {
+		to = w.to
+	}
+	if span := w.to - w.from; span > maxSpan {
+		maxSpan = span
+	}
+
+	return to-from <= ccmsBatchMaxSpanFactor*maxSpan
+}
+
+func (b *ccmsBatch) add(idx int, w jobWindow, queries []ApiQuery, scopes []schema.MetricScope) {
+	if len(b.jobs) == 0 {
+		b.req.From, b.req.To = w.from, w.to
+	}
+	if w.from < b.req.From {
+		b.req.From = w.from
+	}
+	if w.to > b.req.To {
+		b.req.To = w.to
+	}
+	if span := w.to - w.from; span > b.maxSpan {
+		b.maxSpan = span
+	}
+
+	b.jobs = append(b.jobs, idx)
+	b.windows = append(b.windows, w)
+	b.offsets = append(b.offsets, len(b.req.Queries))
+	b.req.Queries = append(b.req.Queries, queries...)
+	b.scopes = append(b.scopes, scopes...)
+}
+
+// Whether one of the jobs in this batch ran for a shorter time range than requested.
+func (b *ccmsBatch) needsSlicing() bool {
+	for _, w := range b.windows {
+		if w.from != b.req.From || w.to != b.req.To {
+			return true
+		}
+	}
+	return false
+}
+
+// Sort the jobs by cluster and start time and combine neighbours into batched
+// requests. Jobs for which no queries could be built are reported in errs.
+func (ccms *CCMetricStore) buildBatches(
+	jobs []*schema.Job,
+	metrics []string,
+	scopes []schema.MetricScope,
+) (batches []*ccmsBatch, errs []string) {
+	order := make([]int, len(jobs))
+	for i := range order {
+		order[i] = i
+	}
+	sort.Slice(order, func(i, j int) bool {
+		a, b := jobs[order[i]], jobs[order[j]]
+		if a.Cluster != b.Cluster {
+			return a.Cluster < b.Cluster
+		}
+		return a.StartTime.Before(b.StartTime)
+	})
+
+	var current *ccmsBatch
+	for _, idx := range order {
+		job := jobs[idx]
+		queries, assignedScope, err := ccms.buildQueries(job, metrics, scopes)
+		if err != nil {
+			errs = append(errs, fmt.Sprintf("building queries for job %d failed: %s", job.JobID, err.Error()))
+			continue
+		}
+
+		w := newJobWindow(job)
+		if current == nil || current.req.Cluster != job.Cluster || !current.fits(w, len(queries)) {
+			current = &ccmsBatch{req: ApiQueryRequest{Cluster: job.Cluster, WithStats: true}}
+			batches = append(batches, current)
+		}
+		current.add(idx, w, queries, assignedScope)
+	}
+
+	for _, b := range batches {
+		b.offsets = append(b.offsets, len(b.req.Queries))
+	}
+
+	return batches, errs
+}
+
+// Fetch the data of many jobs with as few requests as possible. The queries of
+// jobs running at about the same time are merged into one request and the
+// results are split up and cut down to the time range of each job afterwards.
+// An entry of the result is nil if loading that job failed completely.
+func (ccms *CCMetricStore) LoadDataBatch(
+	jobs []*schema.Job,
+	metrics []string,
+	scopes []schema.MetricScope,
+	ctx context.Context,
+) ([]schema.JobData, error) {
+	batches, errors := ccms.buildBatches(jobs, metrics, scopes)
+	result := make([]schema.JobData, len(jobs))
+
+	for _, b := range batches {
+		slicing := b.needsSlicing()
+		b.req.WithData = true
+		resBody, err := ccms.doRequest(ctx, &b.req)
+		if err != nil {
+			log.Error("Error while performing batched request")
+			errors = append(errors, err.Error())
+			continue
+		}
+
+		for i, idx := range b.jobs {
+			start, end := b.offsets[i], b.offsets[i+1]
+			window := &b.windows[i]
+			if !slicing {
+				window = nil
+			}
+
+			jobData, err := ccms.buildJobData(jobs[idx], b.req.Queries[start:end],
+				b.scopes[start:end], resBody.Results[start:end], window)
+			if err != nil {
+				errors = append(errors, err.Error())
+			}
+			result[idx] = jobData
+		}
+	}
+
+	if len(errors) != 0 {
+		/* Returns list for "partial errors" */
+		return result, fmt.Errorf("METRICDATA/CCMS > Errors: %s", strings.Join(errors, ", "))
+	}
+
+	return result, nil
+}
+
+// Like LoadStats, but for many jobs at once (see LoadDataBatch). If the jobs of
+// a batch ran for different time ranges, the statistics are computed from the
+// data of each job's own time range.
+func (ccms *CCMetricStore) LoadStatsBatch(
+	jobs []*schema.Job,
+	metrics []string,
+	ctx context.Context,
+) ([]map[string]map[string]schema.MetricStatistics, error) {
+	batches, errors := ccms.buildBatches(jobs, metrics, []schema.MetricScope{schema.MetricScopeNode})
+	result := make([]map[string]map[string]schema.MetricStatistics, len(jobs))
+
+	for _, b := range batches {
+		slicing := b.needsSlicing()
+		b.req.WithData = slicing
+		resBody, err := ccms.doRequest(ctx, &b.req)
+		if err != nil {
+			log.Error("Error while performing batched request")
+			errors = append(errors, err.Error())
+			continue
+		}
+
+		for i, idx := range b.jobs {
+			start, end := b.offsets[i], b.offsets[i+1]
+			window := &b.windows[i]
+			if !slicing {
+				window = nil
+			}
+
+			result[idx] = ccms.buildStats(jobs[idx], b.req.Queries[start:end], resBody.Results[start:end], window)
+		}
+	}
+
+	if len(errors) != 0 {
+		return result, fmt.Errorf("METRICDATA/CCMS > Errors: %s", strings.Join(errors, ", "))
+	}
+
+	return result, nil
+}
@@ -0,0 +1,232 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package metricdata
+
+import (
+	"context"
+	"encoding/json"
+	"fmt"
+	"net/http"
+	"net/http/httptest"
+	"reflect"
+	"testing"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/pkg/archive"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+func TestJobWindowSlice(t *testing.T) {
+	// Samples at 1000, 1010, ..., 1090, the value of a sample is its time
+	res := ApiMetricData{From: 1000, To: 1100, Avg: 1045, Min: 1000, Max: 1090}
+	for x := res.From; x < res.To; x += 10 {
+		res.Data = append(res.Data, schema.Float(x))
+	}
+
+	for _, tc := range []struct {
+		name     string
+		w        jobWindow
+		from, to int64 // First and last value expected, none if from > to
+	}{
+		{"contains data", jobWindow{900, 1200}, 1000, 1090},
+		{"equal", jobWindow{1000, 1100}, 1000, 1090},
+		{"overlaps start", jobWindow{1030, 1200}, 1030, 1090},
+		{"overlaps end", jobWindow{900, 1045}, 1000, 1040},
+		{"within data", jobWindow{1020, 1050}, 1020, 1050},
+		{"after data", jobWindow{1200, 1300}, 1, 0},
+		{"before data", jobWindow{800, 900}, 1, 0},
+		{"ends shortly before data", jobWindow{800, 995}, 1, 0},
+		{"ends long before data", jobWindow{0, 500}, 1, 0},
+	} {
+		got := tc.w.slice(res, 10)
+		var want []schema.Float
+		for x := tc.from; x <= tc.to; x += 10 {
+			want = append(want, schema.Float(x))
+		}
+		if len(got.Data) != len(want) || (len(want) != 0 && !reflect.DeepEqual(got.Data, want)) {
+			t.Errorf("%s: want %v, got %v", tc.name, want, got.Data)
+			continue
+		}
+		if len(want) == 0 {
+			if !got.Avg.IsNaN() || !got.Min.IsNaN() || !got.Max.IsNaN() {
+				t.Errorf("%s: want NaN statistics, got %v/%v/%v", tc.name, got.Min, got.Avg, got.Max)
+			}
+			continue
+		}
+		if got.From != tc.from || got.Min != want[0] || got.Max != want[len(want)-1] ||
+			got.Avg != (want[0]+want[len(want)-1])/2 {
+			t.Errorf("%s: unexpected result from %d: %v/%v/%v", tc.name, got.From, got.Min, got.Avg, got.Max)
+		}
+	}
+}
+
+func setupCCMSTestClusters() {
+	for _, name := range []string{"testcluster", "othercluster"} {
+		archive.Clusters = append(archive.Clusters, &schema.Cluster{
+			Name: name,
+			MetricConfig: []*schema.MetricConfig{
+				{Name: "flops_any", Scope: schema.MetricScopeNode, Timestep: 10},
+				{Name: "mem_bw", Scope: schema.MetricScopeNode, Timestep: 10},
+			},
+			SubClusters: []*schema.SubCluster{
+				{Name: "sc", Topology: schema.Topology{Node: []int{0, 1}}},
+			},
+		})
+	}
+}
+
+func testJob(id int64, cluster, subCluster string, start, duration int64, hosts ...string) *schema.Job {
+	job := &schema.Job{}
+	job.JobID = id
+	job.Cluster = cluster
+	job.SubCluster = subCluster
+	job.StartTime = time.Unix(start, 0)
+	job.Duration = int32(duration)
+	job.NumNodes = int32(len(hosts))
+	for _, host := range hosts {
+		job.Resources = append(job.Resources, &schema.Resource{Hostname: host})
+	}
+	return job
+}
+
+func TestBuildBatches(t *testing.T) {
+	clusters := archive.Clusters
+	defer func() { archive.Clusters = clusters }()
+	archive.Clusters = nil
+	setupCCMSTestClusters()
+
+	jobs := []*schema.Job{
+		testJob(0, "testcluster", "sc", 5000, 100, "n1"),
+		testJob(1, "testcluster", "sc", 1050, 100, "n1", "n2"),
+		testJob(2, "othercluster", "sc", 1000, 100, "n1"),
+		testJob(3, "testcluster", "sc", 1000, 100, "n3"),
+		testJob(4, "testcluster", "unknown", 1000, 100, "n4"),
+		// Long enough for job 0 to be merged into its batch
+		testJob(5, "testcluster", "sc", 4000, 600, "n5"),
+	}
+
+	ccms := &CCMetricStore{}
+	batches, errs := ccms.buildBatches(jobs, []string{"flops_any", "mem_bw"}, []schema.MetricScope{schema.MetricScopeNode})
+	if len(errs) != 1 {
+		t.Errorf("want one error for the unknown subcluster, got %v", errs)
+	}
+
+	type batch struct {
+		cluster  string
+		jobs     []int
+		from, to int64
+		offsets  []int
+		slicing  bool
+	}
+	want := []batch{
+		{"othercluster", []int{2}, 1000, 1100, []int{0, 2}, false},
+		{"testcluster", []int{3, 1}, 1000, 1150, []int{0, 2, 6}, true},
+		{"testcluster", []int{5, 0}, 4000, 5100, []int{0, 2, 4}, true},
+	}
+	if len(batches) != len(want) {
+		t.Fatalf("want %d batches, got %d", len(want), len(batches))
+	}
+	for i, b := range batches {
+		got := batch{b.req.Cluster, b.jobs, b.req.From, b.req.To, b.offsets, b.needsSlicing()}
+		if !reflect.DeepEqual(got, want[i]) {
+			t.Errorf("batch %d: want %v, got %v", i, want[i], got)
+		}
+		if len(b.req.Queries) != b.offsets[len(b.offsets)-1] || len(b.scopes) != len(b.req.Queries) {
+			t.Errorf("batch %d: %d queries, %d scopes, offsets %v", i, len(b.req.Queries), len(b.scopes), b.offsets)
+		}
+	}
+}
+
+// A cc-metric-store returning one sample every 10 seconds for each query,
+// the value of a sample is its time. Counts the requests received.
+func newTestCCMS(t *testing.T, requests *int) *CCMetricStore {
+	srv := httptest.NewServer(http.HandlerFunc(func(rw http.ResponseWriter, r *http.Request) {
+		*requests++
+		var req ApiQueryRequest
+		if err := json.NewDecoder(r.Body).Decode(&req); err != nil {
+			http.Error(rw, err.Error(), http.StatusBadRequest)
+			return
+		}
+
+		res := ApiMetricData{From: req.From, To: req.To}
+		sum, n := 0.0, 0
+		for x := req.From; x < req.To; x += 10 {
+			if req.WithData {
+				res.Data = append(res.Data, schema.Float(x))
+			}
+			sum, n = sum+float64(x), n+1
+		}
+		res.Min, res.Max, res.Avg = schema.Float(req.From), schema.Float(req.To-10), schema.Float(sum/float64(n))
+
+		body := ApiQueryResponse{}
+		for range req.Queries {
+			body.Results = append(body.Results, []ApiMetricData{res})
+		}
+		json.NewEncoder(rw).Encode(body)
+	}))
+	t.Cleanup(srv.Close)
+
+	ccms := &CCMetricStore{}
+	if err := ccms.Init(json.RawMessage(fmt.Sprintf(`{"kind": "cc-metric-store", "url": %q}`, srv.URL))); err != nil {
+		t.Fatal(err)
+	}
+	return ccms
+}
+
+func TestLoadDataBatch(t *testing.T) {
+	clusters := archive.Clusters
+	defer func() { archive.Clusters = clusters }()
+	archive.Clusters = nil
+	setupCCMSTestClusters()
+
+	jobs := []*schema.Job{
+		testJob(0, "testcluster", "sc", 1000, 100, "n1"),
+		testJob(1, "testcluster", "sc", 1050, 100, "n1", "n2"),
+		testJob(2, "testcluster", "sc", 9000, 30, "n3"),
+	}
+	var requests int
+	ccms := newTestCCMS(t, &requests)
+	result, err := ccms.LoadDataBatch(jobs, []string{"flops_any"}, []schema.MetricScope{schema.MetricScopeNode}, context.Background())
+	if err != nil {
+		t.Fatal(err)
+	}
+	if requests != 2 {
+		t.Errorf("want 2 requests, got %d", requests)
+	}
+
+	// The batch of the first two jobs was fetched from 1000 to 1150
+	for i, want := range [][2]schema.Float{{1000, 1100}, {1050, 1140}, {9000, 9020}} {
+		series := result[i]["flops_any"][schema.MetricScopeNode].Series
+		if len(series) != len(jobs[i].Resources) {
+			t.Fatalf("job %d: want %d series, got %d", i, len(jobs[i].Resources), len(series))
+		}
+		for _, s := range series {
+			if s.Data[0] != want[0] || s.Data[len(s.Data)-1] != want[1] || len(s.Data) != int(want[1]-want[0])/10+1 {
+				t.Errorf("job %d, %s: want data from %v to %v, got %v", i, s.Hostname, want[0], want[1], s.Data)
+			}
+			if s.Statistics.Min != float64(want[0]) || s.Statistics.Max != float64(want[1]) {
+				t.Errorf("job %d, %s: unexpected statistics %v", i, s.Hostname, s.Statistics)
+			}
+		}
+	}
+
+	requests = 0
+	stats, err := ccms.LoadStatsBatch(jobs, []string{"flops_any", "mem_bw"}, context.Background())
+	if err != nil {
+		t.Fatal(err)
+	}
+	if requests != 2 {
+		t.Errorf("want 2 requests, got %d", requests)
+	}
+	for i, want := range []float64{1050, 1095, 9010} {
+		for _, metric := range []string{"flops_any", "mem_bw"} {
+			for _, res := range jobs[i].Resources {
+				if got := stats[i][metric][res.Hostname].Avg; got != want {
+					t.Errorf("job %d, %s, %s: want avg %v, got %v", i, metric, res.Hostname, want, got)
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,321 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package metricdata
+
+import (
+	"bytes"
+	"container/list"
+	"crypto/sha256"
+	"encoding/binary"
+	"encoding/hex"
+	"errors"
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+	"sync"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/pkg/archive"
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/runtimeEnv"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+// Entries expiring sooner than this are not worth writing to disk
+// (for example those of running jobs).
+const diskCacheMinTTL = 5 * time.Minute
+
+// Demotions waiting to be written, further ones are dropped.
+const diskCacheQueueSize = 64
+
+// A size bounded second level cache for JobData on local disk. Entries
+// evicted from the in-memory cache are demoted to it (see lrucache.OnEvict)
+// and read back on a miss. Every entry is a file in dir:
+//
+//	expiration unix nanoseconds, int64
+//	keySize    uint32
+//	key        keySize bytes
+//	data       job data in the binary archive format (see archive.EncodeJobDataBinary)
+//
+// The index of the entries is rebuilt from the files on start, so the cache
+// survives restarts. With fast-startup, that is done in the background and
+// files not indexed yet are misses.
+type diskCache struct {
+	dir     string
+	maxsize int64
+
+	mutex   sync.Mutex
+	used    int64
+	lru     *list.List // of *diskEntry, most recently used first
+	entries map[string]*list.Element
+
+	queue chan diskDemotion
+}
+
+type diskEntry struct {
+	name       string
+	size       int64
+	expiration time.Time
+}
+
+type diskDemotion struct {
+	key        string
+	data       schema.JobData
+	expiration time.Time
+}
+
+const diskHeaderSize = 12
+
+func newDiskCache(dir string, maxsize int64, background bool) (*diskCache, error) {
+	if err := os.MkdirAll(dir, 0o750); err != nil {
+		log.Errorf("Error while creating metric data cache directory %s", dir)
+		return nil, err
+	}
+
+	dc := &diskCache{
+		dir:     dir,
+		maxsize: maxsize,
+		lru:     list.New(),
+		entries: make(map[string]*list.Element),
+		queue:   make(chan diskDemotion, diskCacheQueueSize),
+	}
+
+	if background {
+		runtimeEnv.StartupTask("metric-data-cache-scan", dc.scan)
+	} else if err := dc.scan(); err != nil {
+		return nil, err
+	}
+
+	go dc.writer()
+	return dc, nil
+}
+
+// Rebuild the index from the files present, the modification time of a file
+// is the time of its last use.
+func (dc *diskCache) scan() error {
+	files, err := os.ReadDir(dc.dir)
+	if err != nil {
+		log.Errorf("Error while reading metric data cache directory %s", dc.dir)
+		return err
+	}
+
+	type found struct {
+		entry   *diskEntry
+		lastUse time.Time
+	}
+	now := time.Now()
+	entries := make([]found, 0, len(files))
+	for _, f := range files {
+		name := f.Name()
+		path := filepath.Join(dc.dir, name)
+		info, err := f.Info()
+		if err != nil {
+			continue
+		}
+
+		if strings.HasSuffix(name, ".tmp") {
+			// Left over from an interrupted write (files written since
+			// the scan started are not)
+			if info.ModTime().Before(now) {
+				os.Remove(path)
+			}
+			continue
+		}
+		if !strings.HasSuffix(name, ".bin") {
+			continue
+		}
+
+		expiration, err := readDiskExpiration(path)
+		if err != nil || now.After(expiration) {
+			os.Remove(path)
+			continue
+		}
+
+		entries = append(entries, found{
+			entry:   &diskEntry{name: name, size: info.Size(), expiration: expiration},
+			lastUse: info.ModTime(),
+		})
+	}
+
+	sort.Slice(entries, func(i, j int) bool {
+		return entries[i].lastUse.After(entries[j].lastUse)
+	})
+
+	dc.mutex.Lock()
+	defer dc.mutex.Unlock()
+	for _, e := range entries {
+		// Written or read since the scan started, that is more recent
+		if _, ok := dc.entries[e.entry.name]; ok {
+			continue
+		}
+		dc.entries[e.entry.name] = dc.lru.PushBack(e.entry)
+		dc.used += e.entry.size
+	}
+	dc.evict()
+
+	log.Infof("Metric data cache on disk: %d entries, %d bytes", dc.lru.Len(), dc.used)
+	return nil
+}
+
+func readDiskExpiration(path string) (time.Time, error) {
+	f, err := os.Open(path)
+	if err != nil {
+		return time.Time{}, err
+	}
+	defer f.Close()
+
+	var header [diskHeaderSize]byte
+	if _, err := f.ReadAt(header[:], 0); err != nil {
+		return time.Time{}, err
+	}
+	return time.Unix(0, int64(binary.LittleEndian.Uint64(header[:8]))), nil
+}
+
+func diskCacheName(key string) string {
+	sum := sha256.Sum256([]byte(key))
+	return hex.EncodeToString(sum[:16]) + ".bin"
+}
+
+// Queue JobData evicted from the in-memory cache for writing. Never blocks,
+// values that are no JobData or expire soon are ignored.
+func (dc *diskCache) demote(key string, value interface{}, expiration time.Time) {
+	jd, ok := value.(schema.JobData)
+	if !ok || time.Until(expiration) < diskCacheMinTTL {
+		return
+	}
+
+	select {
+	case dc.queue <- diskDemotion{key: key, data: jd, expiration: expiration}:
+	default:
+		log.Debugf("metric data cache on disk: queue full, dropping %s", key)
+	}
+}
+
+func (dc *diskCache) writer() {
+	for d := range dc.queue {
+		if err := dc.put(d.key, d.data, d.expiration); err != nil {
+			log.Warnf("Error while writing %s to metric data cache on disk: %v", d.key, err)
+		}
+	}
+}
+
+func (dc *diskCache) put(key string, data schema.JobData, expiration time.Time) error {
+	name := diskCacheName(key)
+
+	dc.mutex.Lock()
+	if elem, ok := dc.entries[name]; ok && elem.Value.(*diskEntry).expiration.Equal(expiration) {
+		// Demoted before and still up to date
+		dc.lru.MoveToFront(elem)
+		dc.mutex.Unlock()
+		return nil
+	}
+	dc.mutex.Unlock()
+
+	buf := &bytes.Buffer{}
+	var header [diskHeaderSize]byte
+	binary.LittleEndian.PutUint64(header[:8], uint64(expiration.UnixNano()))
+	binary.LittleEndian.PutUint32(header[8:], uint32(len(key)))
+	buf.Write(header[:])
+	buf.WriteString(key)
+	if err := archive.EncodeJobDataBinary(buf, &data); err != nil {
+		return err
+	}
+
+	if int64(buf.Len()) > dc.maxsize {
+		return nil
+	}
+
+	path := filepath.Join(dc.dir, name)
+	if err := os.WriteFile(path+".tmp", buf.Bytes(), 0o640); err != nil {
+		os.Remove(path + ".tmp")
+		return err
+	}
+	if err := os.Rename(path+".tmp", path); err != nil {
+		os.Remove(path + ".tmp")
+		return err
+	}
+
+	dc.mutex.Lock()
+	defer dc.mutex.Unlock()
+	if elem, ok := dc.entries[name]; ok {
+		dc.used -= elem.Value.(*diskEntry).size
+		dc.lru.Remove(elem)
+	}
+	entry := &diskEntry{name: name, size: int64(buf.Len()), expiration: expiration}
+	dc.entries[name] = dc.lru.PushFront(entry)
+	dc.used += entry.size
+	dc.evict()
+
+	return nil
+}
+
+// Remove the least recently used entries until the budget is met.
+// Must be called with the mutex held.
+func (dc *diskCache) evict() {
+	for dc.used > dc.maxsize {
+		elem := dc.lru.Back()
+		if elem == nil {
+			return
+		}
+		dc.remove(elem)
+	}
+}
+
+func (dc *diskCache) remove(elem *list.Element) {
+	entry := elem.Value.(*diskEntry)
+	dc.lru.Remove(elem)
+	delete(dc.entries, entry.name)
+	dc.used -= entry.size
+	if err := os.Remove(filepath.Join(dc.dir, entry.name)); err != nil && !errors.Is(err, os.ErrNotExist) {
+		log.Warnf("Error while removing %s from metric data cache on disk: %v", entry.name, err)
+	}
+}
+
+// Return the JobData cached for key and its expiration or nil if there is
+// no valid entry.
+func (dc *diskCache) get(key string) (schema.JobData, time.Time) {
+	name := diskCacheName(key)
+
+	dc.mutex.Lock()
+	elem, ok := dc.entries[name]
+	if !ok {
+		dc.mutex.Unlock()
+		return nil, time.Time{}
+	}
+	entry := elem.Value.(*diskEntry)
+	if time.Now().After(entry.expiration) {
+		dc.remove(elem)
+		dc.mutex.Unlock()
+		return nil, time.Time{}
+	}
+	dc.lru.MoveToFront(elem)
+	dc.mutex.Unlock()
+
+	path := filepath.Join(dc.dir, name)
+	raw, err := os.ReadFile(path)
+	if err != nil {
+		log.Warnf("Error while reading %s from metric data cache on disk: %v", key, err)
+		return nil, time.Time{}
+	}
+	if len(raw) < diskHeaderSize {
+		return nil, time.Time{}
+	}
+	keySize := int(binary.LittleEndian.Uint32(raw[8:diskHeaderSize]))
+	if len(raw) < diskHeaderSize+keySize || string(raw[diskHeaderSize:diskHeaderSize+keySize]) != key {
+		// Hash collision or corrupt file
+		return nil, time.Time{}
+	}
+
+	jd, err := archive.DecodeJobDataBinary(bytes.NewReader(raw[diskHeaderSize+keySize:]), nil, nil)
+	if err != nil {
+		log.Warnf("Error while decoding %s from metric data cache on disk: %v", key, err)
+		return nil, time.Time{}
+	}
+
+	now := time.Now()
+	os.Chtimes(path, now, now)
+	return jd, entry.expiration
+}
@@ -0,0 +1,115 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package metricdata
+
+import (
+	"testing"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+func testJobData(host string) schema.JobData {
+	return schema.JobData{
+		"flops_any": {
+			schema.MetricScopeNode: &schema.JobMetric{
+				Unit:     schema.Unit{Base: "F/s"},
+				Timestep: 60,
+				Series: []schema.Series{
+					{Hostname: host, Data: []schema.Float{1, 2, 3, schema.NaN}},
+				},
+			},
+		},
+	}
+}
+
+func TestDiskCache(t *testing.T) {
+	dir := t.TempDir()
+	dc, err := newDiskCache(dir, 1024*1024, false)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	expiration := time.Now().Add(time.Hour)
+	if err := dc.put("a", testJobData("a"), expiration); err != nil {
+		t.Fatal(err)
+	}
+
+	jd, exp := dc.get("a")
+	if jd == nil || !exp.Equal(time.Unix(0, expiration.UnixNano())) {
+		t.Fatalf("expected cached entry, got %v (expires %v)", jd, exp)
+	}
+	if host := jd["flops_any"][schema.MetricScopeNode].Series[0].Hostname; host != "a" {
+		t.Errorf("unexpected hostname %s", host)
+	}
+
+	if jd, _ := dc.get("b"); jd != nil {
+		t.Error("unexpected entry for b")
+	}
+
+	// The index is rebuilt from the files
+	dc, err = newDiskCache(dir, 1024*1024, false)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if jd, _ := dc.get("a"); jd == nil {
+		t.Error("entry lost on restart")
+	}
+
+	// With a budget for only one entry, the least recently used one goes
+	size := dc.used
+	dc.maxsize = size + size/2
+	if err := dc.put("b", testJobData("b"), expiration); err != nil {
+		t.Fatal(err)
+	}
+	if jd, _ := dc.get("a"); jd != nil {
+		t.Error("a should have been evicted")
+	}
+	if jd, _ := dc.get("b"); jd == nil {
+		t.Error("b should be cached")
+	}
+	if dc.used > dc.maxsize {
+		t.Errorf("budget exceeded: %d > %d", dc.used, dc.maxsize)
+	}
+}
+
+func TestDiskCacheBackgroundScan(t *testing.T) {
+	dir := t.TempDir()
+	dc, err := newDiskCache(dir, 1024*1024, false)
+	if err != nil {
+		t.Fatal(err)
+	}
+	expiration := time.Now().Add(time.Hour)
+	if err := dc.put("a", testJobData("a"), expiration); err != nil {
+		t.Fatal(err)
+	}
+
+	dc, err = newDiskCache(dir, 1024*1024, true)
+	if err != nil {
+		t.Fatal(err)
+	}
+	// Written while the index is rebuilt
+	if err := dc.put("b", testJobData("b"), expiration); err != nil {
+		t.Fatal(err)
+	}
+
+	for start := time.Now(); ; time.Sleep(10 * time.Millisecond) {
+		if jd, _ := dc.get("a"); jd != nil {
+			break
+		}
+		if time.Since(start) > 5*time.Second {
+			t.Fatal("entry not found after background scan")
+		}
+	}
+	if jd, _ := dc.get("b"); jd == nil {
+		t.Error("b should be cached")
+	}
+
+	dc.mutex.Lock()
+	defer dc.mutex.Unlock()
+	if dc.lru.Len() != 2 || dc.used != dc.lru.Front().Value.(*diskEntry).size+dc.lru.Back().Value.(*diskEntry).size {
+		t.Errorf("unexpected index: %d entries, %d bytes", dc.lru.Len(), dc.used)
+	}
+}
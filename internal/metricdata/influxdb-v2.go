@@ -11,6 +11,7 @@ import (
 	"errors"
 	"fmt"
 	"strings"
+	"sync"
 	"time"
 
 	"github.com/ClusterCockpit/cc-backend/pkg/archive"
@@ -26,12 +27,15 @@ type InfluxDBv2DataRepositoryConfig struct {
 	Bucket  string `json:"bucket"`
 	Org     string `json:"org"`
 	SkipTls bool   `json:"skiptls"`
+	// Maximum number of queries sent at the same time (default: 8)
+	Concurrency int `json:"concurrency,omitempty"`
 }
 
 type InfluxDBv2DataRepository struct {
 	client              influxdb2.Client
 	queryClient         influxdb2Api.QueryAPI
 	bucket, measurement string
+	concurrency         int
 }
 
 func (idb *InfluxDBv2DataRepository) Init(rawConfig json.RawMessage) error {
@@ -44,6 +48,7 @@ func (idb *InfluxDBv2DataRepository) Init(rawConfig json.RawMessage) error {
 	idb.client = influxdb2.NewClientWithOptions(config.Url, config.Token, influxdb2.DefaultOptions().SetTLSConfig(&tls.Config{InsecureSkipVerify: config.SkipTls}))
 	idb.queryClient = idb.client.QueryAPI(config.Org)
 	idb.bucket = config.Bucket
+	idb.concurrency = config.Concurrency
 
 	return nil
 }
@@ -56,53 +61,43 @@ func (idb *InfluxDBv2DataRepository) epochToTime(epoch int64) time.Time {
 	return time.Unix(epoch, 0)
 }
 
-func (idb *InfluxDBv2DataRepository) LoadData(
-	job *schema.Job,
-	metrics []string,
-	scopes []schema.MetricScope,
-	ctx context.Context) (schema.JobData, error) {
-
-	measurementsConds := make([]string, 0, len(metrics))
-	for _, m := range metrics {
-		measurementsConds = append(measurementsConds, fmt.Sprintf(`r["_measurement"] == "%s"`, m))
-	}
-	measurementsCond := strings.Join(measurementsConds, " or ")
-
+func (idb *InfluxDBv2DataRepository) hostsCond(job *schema.Job) (string, error) {
 	hostsConds := make([]string, 0, len(job.Resources))
 	for _, h := range job.Resources {
 		if h.HWThreads != nil || h.Accelerators != nil {
 			// TODO
-			return nil, errors.New("METRICDATA/INFLUXV2 > the InfluxDB metric data repository does not yet support HWThreads or Accelerators")
+			return "", errors.New("METRICDATA/INFLUXV2 > the InfluxDB metric data repository does not yet support HWThreads or Accelerators")
 		}
 		hostsConds = append(hostsConds, fmt.Sprintf(`r["hostname"] == "%s"`, h.Hostname))
 	}
-	hostsCond := strings.Join(hostsConds, " or ")
+	return strings.Join(hostsConds, " or "), nil
+}
+
+// The data and the statistics of a metric are two separate queries. Each
+// metric is queried on its own and all queries run in parallel, the results
+// are added to jobData as they arrive.
+func (idb *InfluxDBv2DataRepository) LoadData(
+	job *schema.Job,
+	metrics []string,
+	scopes []schema.MetricScope,
+	ctx context.Context) (schema.JobData, error) {
+
+	hostsCond, err := idb.hostsCond(job)
+	if err != nil {
+		return nil, err
+	}
 
 	jobData := make(schema.JobData) // Empty Schema: map[<string>FIELD]map[<MetricScope>SCOPE]<*JobMetric>METRIC
 	// Requested Scopes
+	nodeScope := false
 	for _, scope := range scopes {
-		query := ""
 		switch scope {
 		case "node":
-			// Get Finest Granularity, Groupy By Measurement and Hostname (== Metric / Node), Calculate Mean for 60s windows
-			// log.Info("Scope 'node' requested. ")
-			query = fmt.Sprintf(`
-								from(bucket: "%s")
-								|> range(start: %s, stop: %s)
-								|> filter(fn: (r) => (%s) and (%s) )
-								|> drop(columns: ["_start", "_stop"])
-								|> group(columns: ["hostname", "_measurement"])
-		            |> aggregateWindow(every: 60s, fn: mean)
-								|> drop(columns: ["_time"])`,
-				idb.bucket,
-				idb.formatTime(job.StartTime), idb.formatTime(idb.epochToTime(job.StartTimeUnix+int64(job.Duration)+int64(1))),
-				measurementsCond, hostsCond)
+			nodeScope = true
 		case "socket":
 			log.Info("Scope 'socket' requested, but not yet supported: Will return 'node' scope only. ")
-			continue
 		case "core":
 			log.Info(" Scope 'core' requested, but not yet supported: Will return 'node' scope only. ")
-			continue
 			// Get Finest Granularity only, Set NULL to 0.0
 			// query = fmt.Sprintf(`
 			//  	from(bucket: "%s")
@@ -116,187 +111,242 @@ func (idb *InfluxDBv2DataRepository) LoadData(
 			//  	measurementsCond, hostsCond)
 		default:
 			log.Infof("Unknown scope '%s' requested: Will return 'node' scope.", scope)
-			continue
 			// return nil, errors.New("METRICDATA/INFLUXV2 > the InfluxDB metric data repository does not yet support other scopes than 'node'")
 		}
+	}
+	if !nodeScope {
+		return jobData, nil
+	}
+	scope := schema.MetricScopeNode
 
-		rows, err := idb.queryClient.Query(ctx, query)
-		if err != nil {
-			log.Error("Error while performing query")
-			return nil, err
+	// Init Metrics: Only Node level now -> TODO: Matching /check on scope level ...
+	for _, metric := range metrics {
+		if _, ok := jobData[metric]; ok {
+			continue
 		}
+		mc := archive.GetMetricConfig(job.Cluster, metric)
+		if mc == nil {
+			log.Warnf("Error in LoadData: Metric %s for cluster %s not configured", metric, job.Cluster)
+			return nil, errors.New("METRICDATA/INFLUXV2 > metric not configured")
+		}
+		jobData[metric] = map[schema.MetricScope]*schema.JobMetric{
+			scope: {
+				Unit:             mc.Unit,
+				Timestep:         mc.Timestep,
+				Series:           make([]schema.Series, 0, len(job.Resources)),
+				StatisticsSeries: nil, // Should be: &schema.StatsSeries{},
+			},
+		}
+	}
 
-		// Init Metrics: Only Node level now -> TODO: Matching /check on scope level ...
-		for _, metric := range metrics {
-			jobMetric, ok := jobData[metric]
-			if !ok {
-				mc := archive.GetMetricConfig(job.Cluster, metric)
-				jobMetric = map[schema.MetricScope]*schema.JobMetric{
-					scope: { // uses scope var from above!
-						Unit:             mc.Unit,
-						Timestep:         mc.Timestep,
-						Series:           make([]schema.Series, 0, len(job.Resources)),
-						StatisticsSeries: nil, // Should be: &schema.StatsSeries{},
-					},
-				}
+	// Even tasks load the data of metrics[i/2], odd tasks the statistics
+	var lock sync.Mutex
+	stats := make(map[string]map[string]schema.MetricStatistics, len(metrics))
+	err = fanOut(ctx, idb.concurrency, 2*len(metrics), func(ctx context.Context, i int) error {
+		metric := metrics[i/2]
+		if i%2 == 1 {
+			nodes, err := idb.loadMetricStats(ctx, job, metric, hostsCond)
+			if err != nil {
+				log.Warn("Error while loading statistics")
+				return err
 			}
-			jobData[metric] = jobMetric
+			lock.Lock()
+			stats[metric] = nodes
+			lock.Unlock()
+			return nil
 		}
 
-		// Process Result: Time-Data
-		field, host, hostSeries := "", "", schema.Series{}
-		// typeId := 0
-		switch scope {
-		case "node":
-			for rows.Next() {
-				row := rows.Record()
-				if host == "" || host != row.ValueByKey("hostname").(string) || rows.TableChanged() {
-					if host != "" {
-						// Append Series before reset
-						jobData[field][scope].Series = append(jobData[field][scope].Series, hostSeries)
-					}
-					field, host = row.Measurement(), row.ValueByKey("hostname").(string)
-					hostSeries = schema.Series{
-						Hostname:   host,
-						Statistics: schema.MetricStatistics{}, //TODO Add Statistics
-						Data:       make([]schema.Float, 0),
-					}
-				}
-				val, ok := row.Value().(float64)
-				if ok {
-					hostSeries.Data = append(hostSeries.Data, schema.Float(val))
-				} else {
-					hostSeries.Data = append(hostSeries.Data, schema.Float(0))
-				}
+		series, err := idb.loadMetricData(ctx, job, metric, hostsCond)
+		if err != nil {
+			return err
+		}
+		lock.Lock()
+		jobData[metric][scope].Series = append(jobData[metric][scope].Series, series...)
+		lock.Unlock()
+		return nil
+	})
+	if err != nil {
+		return nil, err
+	}
+
+	for metric, nodes := range stats {
+		for index := range jobData[metric][scope].Series {
+			series := &jobData[metric][scope].Series[index]
+			if stats, ok := nodes[series.Hostname]; ok {
+				series.Statistics = schema.MetricStatistics{Avg: stats.Avg, Min: stats.Min, Max: stats.Max}
 			}
-		case "socket":
-			continue
-		case "core":
-			continue
-			// Include Series.Id in hostSeries
-			// for rows.Next() {
-			// 		row := rows.Record()
-			// 		if ( host == "" || host != row.ValueByKey("hostname").(string) || typeId != row.ValueByKey("type-id").(int) || rows.TableChanged() ) {
-			// 		 		if ( host != "" ) {
-			// 						// Append Series before reset
-			// 		 		  	jobData[field][scope].Series = append(jobData[field][scope].Series, hostSeries)
-			// 		 		}
-			// 		 		field, host, typeId = row.Measurement(), row.ValueByKey("hostname").(string), row.ValueByKey("type-id").(int)
-			// 		 		hostSeries  = schema.Series{
-			// 		 				Hostname:   host,
-			// 						Id:					&typeId,
-			// 		 				Statistics: nil,
-			// 		 				Data:       make([]schema.Float, 0),
-			// 		 		}
-			// 		}
-			// 		val := row.Value().(float64)
-			// 		hostSeries.Data = append(hostSeries.Data, schema.Float(val))
-			// }
-		default:
-			log.Infof("Unknown scope '%s' requested: Will return 'node' scope.", scope)
-			continue
-			// return nil, errors.New("the InfluxDB metric data repository does not yet support other scopes than 'node, core'")
 		}
-		// Append last Series
-		jobData[field][scope].Series = append(jobData[field][scope].Series, hostSeries)
 	}
 
-	// Get Stats
-	stats, err := idb.LoadStats(job, metrics, ctx)
+	return jobData, nil
+}
+
+// Node scope series of one metric for all hosts of the job.
+func (idb *InfluxDBv2DataRepository) loadMetricData(
+	ctx context.Context,
+	job *schema.Job,
+	metric, hostsCond string) ([]schema.Series, error) {
+
+	// Get Finest Granularity, Groupy By Hostname (== Node), Calculate Mean for 60s windows
+	query := fmt.Sprintf(`
+						from(bucket: "%s")
+						|> range(start: %s, stop: %s)
+						|> filter(fn: (r) => r["_measurement"] == "%s" and (%s) )
+						|> drop(columns: ["_start", "_stop"])
+						|> group(columns: ["hostname", "_measurement"])
+						|> aggregateWindow(every: 60s, fn: mean)
+						|> drop(columns: ["_time"])`,
+		idb.bucket,
+		idb.formatTime(job.StartTime), idb.formatTime(idb.epochToTime(job.StartTimeUnix+int64(job.Duration)+int64(1))),
+		metric, hostsCond)
+
+	rows, err := idb.queryClient.Query(ctx, query)
 	if err != nil {
-		log.Warn("Error while loading statistics")
+		log.Error("Error while performing query")
 		return nil, err
 	}
 
-	for _, scope := range scopes {
-		if scope == "node" { // No 'socket/core' support yet
-			for metric, nodes := range stats {
-				for node, stats := range nodes {
-					for index, _ := range jobData[metric][scope].Series {
-						if jobData[metric][scope].Series[index].Hostname == node {
-							jobData[metric][scope].Series[index].Statistics = schema.MetricStatistics{Avg: stats.Avg, Min: stats.Min, Max: stats.Max}
-						}
-					}
-				}
+	// Process Result: Time-Data
+	series := make([]schema.Series, 0, len(job.Resources))
+	host, hostSeries := "", schema.Series{}
+	for rows.Next() {
+		row := rows.Record()
+		if host == "" || host != row.ValueByKey("hostname").(string) || rows.TableChanged() {
+			if host != "" {
+				// Append Series before reset
+				series = append(series, hostSeries)
+			}
+			host = row.ValueByKey("hostname").(string)
+			hostSeries = schema.Series{
+				Hostname:   host,
+				Statistics: schema.MetricStatistics{}, //TODO Add Statistics
+				Data:       make([]schema.Float, 0),
 			}
 		}
+		val, ok := row.Value().(float64)
+		if ok {
+			hostSeries.Data = append(hostSeries.Data, schema.Float(val))
+		} else {
+			hostSeries.Data = append(hostSeries.Data, schema.Float(0))
+		}
 	}
-
-	return jobData, nil
+	if err := rows.Err(); err != nil {
+		log.Error("Error while reading query result")
+		return nil, err
+	}
+	// Append last Series
+	if host != "" {
+		series = append(series, hostSeries)
+	}
+	return series, nil
 }
 
+// The statistics of the metrics are queried in parallel, see LoadData.
 func (idb *InfluxDBv2DataRepository) LoadStats(
 	job *schema.Job,
 	metrics []string,
 	ctx context.Context) (map[string]map[string]schema.MetricStatistics, error) {
 
-	stats := map[string]map[string]schema.MetricStatistics{}
+	hostsCond, err := idb.hostsCond(job)
+	if err != nil {
+		return nil, err
+	}
 
-	hostsConds := make([]string, 0, len(job.Resources))
-	for _, h := range job.Resources {
-		if h.HWThreads != nil || h.Accelerators != nil {
-			// TODO
-			return nil, errors.New("METRICDATA/INFLUXV2 > the InfluxDB metric data repository does not yet support HWThreads or Accelerators")
+	var lock sync.Mutex
+	stats := make(map[string]map[string]schema.MetricStatistics, len(metrics))
+	err = fanOut(ctx, idb.concurrency, len(metrics), func(ctx context.Context, i int) error {
+		nodes, err := idb.loadMetricStats(ctx, job, metrics[i], hostsCond)
+		if err != nil {
+			return err
 		}
-		hostsConds = append(hostsConds, fmt.Sprintf(`r["hostname"] == "%s"`, h.Hostname))
+		lock.Lock()
+		stats[metrics[i]] = nodes
+		lock.Unlock()
+		return nil
+	})
+	if err != nil {
+		return nil, err
 	}
-	hostsCond := strings.Join(hostsConds, " or ")
 
-	// lenMet := len(metrics)
+	return stats, nil
+}
 
-	for _, metric := range metrics {
-		// log.Debugf("<< You are here: %s (Index %d of %d metrics)", metric, index, lenMet)
-
-		query := fmt.Sprintf(`
-				  data = from(bucket: "%s")
-				  |> range(start: %s, stop: %s)
-				  |> filter(fn: (r) => r._measurement == "%s" and r._field == "value" and (%s))
-				  union(tables: [data |> mean(column: "_value") |> set(key: "_field", value: "avg"),
-				                 data |>  min(column: "_value") |> set(key: "_field", value: "min"),
-				                 data |>  max(column: "_value") |> set(key: "_field", value: "max")])
-				  |> pivot(rowKey: ["hostname"], columnKey: ["_field"], valueColumn: "_value")
-				  |> group()`,
-			idb.bucket,
-			idb.formatTime(job.StartTime), idb.formatTime(idb.epochToTime(job.StartTimeUnix+int64(job.Duration)+int64(1))),
-			metric, hostsCond)
-
-		rows, err := idb.queryClient.Query(ctx, query)
-		if err != nil {
-			log.Error("Error while performing query")
-			return nil, err
-		}
+// Statistics of one metric per host of the job.
+func (idb *InfluxDBv2DataRepository) loadMetricStats(
+	ctx context.Context,
+	job *schema.Job,
+	metric, hostsCond string) (map[string]schema.MetricStatistics, error) {
+
+	query := fmt.Sprintf(`
+			  data = from(bucket: "%s")
+			  |> range(start: %s, stop: %s)
+			  |> filter(fn: (r) => r._measurement == "%s" and r._field == "value" and (%s))
+			  union(tables: [data |> mean(column: "_value") |> set(key: "_field", value: "avg"),
+			                 data |>  min(column: "_value") |> set(key: "_field", value: "min"),
+			                 data |>  max(column: "_value") |> set(key: "_field", value: "max")])
+			  |> pivot(rowKey: ["hostname"], columnKey: ["_field"], valueColumn: "_value")
+			  |> group()`,
+		idb.bucket,
+		idb.formatTime(job.StartTime), idb.formatTime(idb.epochToTime(job.StartTimeUnix+int64(job.Duration)+int64(1))),
+		metric, hostsCond)
+
+	rows, err := idb.queryClient.Query(ctx, query)
+	if err != nil {
+		log.Error("Error while performing query")
+		return nil, err
+	}
 
-		nodes := map[string]schema.MetricStatistics{}
-		for rows.Next() {
-			row := rows.Record()
-			host := row.ValueByKey("hostname").(string)
+	nodes := map[string]schema.MetricStatistics{}
+	for rows.Next() {
+		row := rows.Record()
+		host := row.ValueByKey("hostname").(string)
 
-			avg, avgok := row.ValueByKey("avg").(float64)
-			if !avgok {
-				// log.Debugf(">> Assertion error for metric %s, statistic AVG. Expected 'float64', got %v", metric, avg)
-				avg = 0.0
-			}
-			min, minok := row.ValueByKey("min").(float64)
-			if !minok {
-				// log.Debugf(">> Assertion error for metric %s, statistic MIN. Expected 'float64', got %v", metric, min)
-				min = 0.0
-			}
-			max, maxok := row.ValueByKey("max").(float64)
-			if !maxok {
-				// log.Debugf(">> Assertion error for metric %s, statistic MAX. Expected 'float64', got %v", metric, max)
-				max = 0.0
-			}
+		avg, avgok := row.ValueByKey("avg").(float64)
+		if !avgok {
+			// log.Debugf(">> Assertion error for metric %s, statistic AVG. Expected 'float64', got %v", metric, avg)
+			avg = 0.0
+		}
+		min, minok := row.ValueByKey("min").(float64)
+		if !minok {
+			// log.Debugf(">> Assertion error for metric %s, statistic MIN. Expected 'float64', got %v", metric, min)
+			min = 0.0
+		}
+		max, maxok := row.ValueByKey("max").(float64)
+		if !maxok {
+			// log.Debugf(">> Assertion error for metric %s, statistic MAX. Expected 'float64', got %v", metric, max)
+			max = 0.0
+		}
 
-			nodes[host] = schema.MetricStatistics{
-				Avg: avg,
-				Min: min,
-				Max: max,
-			}
+		nodes[host] = schema.MetricStatistics{
+			Avg: avg,
+			Min: min,
+			Max: max,
 		}
-		stats[metric] = nodes
+	}
+	if err := rows.Err(); err != nil {
+		log.Error("Error while reading query result")
+		return nil, err
 	}
 
-	return stats, nil
+	return nodes, nil
+}
+
+// The InfluxDB queries are built per job, so batches are loaded job by job.
+func (idb *InfluxDBv2DataRepository) LoadDataBatch(
+	jobs []*schema.Job,
+	metrics []string,
+	scopes []schema.MetricScope,
+	ctx context.Context) ([]schema.JobData, error) {
+
+	return loadDataBatchSequential(idb, jobs, metrics, scopes, ctx)
+}
+
+func (idb *InfluxDBv2DataRepository) LoadStatsBatch(
+	jobs []*schema.Job,
+	metrics []string,
+	ctx context.Context) ([]map[string]map[string]schema.MetricStatistics, error) {
+
+	return loadStatsBatchSequential(idb, jobs, metrics, ctx)
 }
 
 func (idb *InfluxDBv2DataRepository) LoadNodeData(
@@ -0,0 +1,120 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package metricdata
+
+import (
+	"context"
+	"encoding/json"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/pkg/archive"
+	"github.com/ClusterCockpit/cc-backend/pkg/lrucache"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+	"github.com/prometheus/client_golang/prometheus"
+	"github.com/prometheus/client_golang/prometheus/promauto"
+)
+
+var (
+	backendDuration = promauto.NewHistogramVec(prometheus.HistogramOpts{
+		Namespace: "cc_backend",
+		Subsystem: "metricdata",
+		Name:      "request_duration_seconds",
+		Help:      "Time it took to load metric data by backend (the kind of metric data repository or archive), cluster and method.",
+		Buckets:   prometheus.ExponentialBuckets(0.001, 2, 16),
+	}, []string{"backend", "cluster", "method"})
+	backendErrors = promauto.NewCounterVec(prometheus.CounterOpts{
+		Namespace: "cc_backend",
+		Subsystem: "metricdata",
+		Name:      "request_errors_total",
+		Help:      "Number of failed requests for metric data by backend, cluster and method.",
+	}, []string{"backend", "cluster", "method"})
+)
+
+func observeBackend(backend, cluster, method string, start time.Time, err error) {
+	backendDuration.WithLabelValues(backend, cluster, method).Observe(time.Since(start).Seconds())
+	if err != nil {
+		backendErrors.WithLabelValues(backend, cluster, method).Inc()
+	}
+}
+
+func init() {
+	RegisterCacheMetrics("metricdata", func() *lrucache.Cache { return cache })
+	RegisterCacheMetrics("archive", archive.Cache)
+}
+
+// Export the counters of the cache returned by get (called on every scrape,
+// so the cache may be replaced) labeled with name.
+func RegisterCacheMetrics(name string, get func() *lrucache.Cache) {
+	labels := prometheus.Labels{"cache": name}
+	counter := func(metric, help string, value func(s lrucache.Stats) float64) {
+		promauto.NewCounterFunc(prometheus.CounterOpts{
+			Namespace:   "cc_backend",
+			Subsystem:   "cache",
+			Name:        metric,
+			Help:        help,
+			ConstLabels: labels,
+		}, func() float64 { return value(get().Stats()) })
+	}
+
+	counter("hits_total", "Number of cache lookups that found a value.",
+		func(s lrucache.Stats) float64 { return float64(s.Hits) })
+	counter("misses_total", "Number of cache lookups that did not find a value.",
+		func(s lrucache.Stats) float64 { return float64(s.Misses) })
+	counter("evictions_total", "Number of entries evicted because the cache ran out of memory.",
+		func(s lrucache.Stats) float64 { return float64(s.Evictions) })
+	promauto.NewGaugeFunc(prometheus.GaugeOpts{
+		Namespace:   "cc_backend",
+		Subsystem:   "cache",
+		Name:        "used_bytes",
+		Help:        "Sum of the size estimates of the cached entries.",
+		ConstLabels: labels,
+	}, func() float64 { return float64(get().Stats().UsedMemory) })
+}
+
+// Wraps a MetricDataRepository to record the duration of every request.
+type instrumentedRepository struct {
+	kind    string
+	cluster string
+	repo    MetricDataRepository
+}
+
+func (r *instrumentedRepository) Init(rawConfig json.RawMessage) error {
+	return r.repo.Init(rawConfig)
+}
+
+func (r *instrumentedRepository) LoadData(job *schema.Job, metrics []string, scopes []schema.MetricScope, ctx context.Context) (schema.JobData, error) {
+	start := time.Now()
+	data, err := r.repo.LoadData(job, metrics, scopes, ctx)
+	observeBackend(r.kind, r.cluster, "LoadData", start, err)
+	return data, err
+}
+
+func (r *instrumentedRepository) LoadStats(job *schema.Job, metrics []string, ctx context.Context) (map[string]map[string]schema.MetricStatistics, error) {
+	start := time.Now()
+	stats, err := r.repo.LoadStats(job, metrics, ctx)
+	observeBackend(r.kind, r.cluster, "LoadStats", start, err)
+	return stats, err
+}
+
+func (r *instrumentedRepository) LoadDataBatch(jobs []*schema.Job, metrics []string, scopes []schema.MetricScope, ctx context.Context) ([]schema.JobData, error) {
+	start := time.Now()
+	data, err := r.repo.LoadDataBatch(jobs, metrics, scopes, ctx)
+	observeBackend(r.kind, r.cluster, "LoadDataBatch", start, err)
+	return data, err
+}
+
+func (r *instrumentedRepository) LoadStatsBatch(jobs []*schema.Job, metrics []string, ctx context.Context) ([]map[string]map[string]schema.MetricStatistics, error) {
+	start := time.Now()
+	stats, err := r.repo.LoadStatsBatch(jobs, metrics, ctx)
+	observeBackend(r.kind, r.cluster, "LoadStatsBatch", start, err)
+	return stats, err
+}
+
+func (r *instrumentedRepository) LoadNodeData(cluster string, metrics, nodes []string, scopes []schema.MetricScope, from, to time.Time, ctx context.Context) (map[string]map[string][]*schema.JobMetric, error) {
+	start := time.Now()
+	data, err := r.repo.LoadNodeData(cluster, metrics, nodes, scopes, from, to, ctx)
+	observeBackend(r.kind, r.cluster, "LoadNodeData", start, err)
+	return data, err
+}
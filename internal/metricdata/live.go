@@ -0,0 +1,318 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package metricdata
+
+import (
+	"context"
+	"fmt"
+	"sort"
+	"sync"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/pkg/archive"
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+const (
+	// Lower bound of the poll interval, which is the smallest timestep of the
+	// subscribed metrics otherwise
+	liveMinInterval = 10 * time.Second
+	// Updates kept for subscribers resuming after a reconnect
+	liveHistory = 32
+	// Updates queued for a subscriber not reading, further ones are dropped
+	liveQueueSize = 8
+	// Polls in a row without subscriptions before a poller stops. Clients
+	// of the REST API reconnect every few seconds, which is well within one
+	// poll interval, so that their state (sequence numbers, history and the
+	// time of the last poll) survives the reconnect.
+	liveIdlePolls = 2
+)
+
+// Metric data appended since the previous update, at node scope and with one
+// series per node.
+type LiveUpdate struct {
+	// Increasing per cluster, consecutive updates have consecutive numbers
+	Seq  uint64
+	From time.Time
+	To   time.Time
+	Data schema.JobData
+}
+
+// The live metric data of some nodes of a cluster, see SubscribeLive.
+type LiveSubscription struct {
+	// Closed by Close only
+	C <-chan *LiveUpdate
+	// Sequence number of the last update before the subscription
+	Seq uint64
+
+	c       chan *LiveUpdate
+	poller  *livePoller
+	nodes   []string
+	metrics []string
+}
+
+type liveLoadFunc func(metrics, nodes []string, from, to time.Time, ctx context.Context) (map[string]map[string][]*schema.JobMetric, error)
+
+// Polls the metric data repository of a cluster for the union of the nodes
+// and metrics of all subscriptions, so that the load on the repository does
+// not depend on the number of subscribers. Every poll only requests the time
+// range since the previous one.
+type livePoller struct {
+	cluster string
+	load    liveLoadFunc
+
+	lock    sync.Mutex
+	subs    map[*LiveSubscription]struct{}
+	seq     uint64
+	last    time.Time
+	history []*liveBatch
+	idle    int
+}
+
+// What a poll returned: metric -> node -> data
+type liveBatch struct {
+	seq      uint64
+	from, to time.Time
+	data     map[string]map[string]*schema.JobMetric
+}
+
+var livePollers = struct {
+	lock    sync.Mutex
+	pollers map[string]*livePoller
+}{pollers: map[string]*livePoller{}}
+
+func newLivePoller(cluster string, load liveLoadFunc) *livePoller {
+	now := time.Now()
+	return &livePoller{
+		cluster: cluster,
+		load:    load,
+		subs:    make(map[*LiveSubscription]struct{}),
+		// Sequence numbers of a poller started later on are larger, so
+		// that resuming subscribers do not confuse the two.
+		seq:  uint64(now.UnixMilli()),
+		last: now,
+	}
+}
+
+// Subscribe to the metric data of nodes (at node scope) as it comes in. The
+// poller of the cluster is started with the first subscription and stops
+// once there were none left for liveIdlePolls polls. If after is not zero, the updates with a larger
+// sequence number still known are queued first. Fails for metrics not in the
+// metric config of the cluster. Subscriptions must be closed.
+func SubscribeLive(cluster string, nodes, metrics []string, after uint64) (*LiveSubscription, error) {
+	if _, ok := metricDataRepos[cluster]; !ok {
+		return nil, fmt.Errorf("METRICDATA/LIVE > no metric data repository configured for '%s'", cluster)
+	}
+	if len(nodes) == 0 {
+		return nil, fmt.Errorf("METRICDATA/LIVE > no nodes to subscribe to")
+	}
+	if metrics == nil {
+		for _, mc := range archive.GetCluster(cluster).MetricConfig {
+			metrics = append(metrics, mc.Name)
+		}
+	}
+	// An unknown metric would fail the poll of the cluster for everyone
+	for _, metric := range metrics {
+		if archive.GetMetricConfig(cluster, metric) == nil {
+			return nil, fmt.Errorf("METRICDATA/LIVE > unknown metric '%s' for cluster '%s'", metric, cluster)
+		}
+	}
+
+	livePollers.lock.Lock()
+	defer livePollers.lock.Unlock()
+	p, ok := livePollers.pollers[cluster]
+	if !ok {
+		p = newLivePoller(cluster, func(metrics, nodes []string, from, to time.Time, ctx context.Context) (map[string]map[string][]*schema.JobMetric, error) {
+			return LoadNodeData(cluster, metrics, nodes, []schema.MetricScope{schema.MetricScopeNode}, from, to, ctx)
+		})
+		livePollers.pollers[cluster] = p
+		go p.run()
+	}
+	return p.subscribe(nodes, metrics, after), nil
+}
+
+// Stop receiving updates and close C.
+func (s *LiveSubscription) Close() {
+	p := s.poller
+	p.lock.Lock()
+	defer p.lock.Unlock()
+	if _, ok := p.subs[s]; ok {
+		delete(p.subs, s)
+		close(s.c)
+	}
+}
+
+func (p *livePoller) subscribe(nodes, metrics []string, after uint64) *LiveSubscription {
+	c := make(chan *LiveUpdate, liveHistory+liveQueueSize)
+	s := &LiveSubscription{C: c, c: c, poller: p, nodes: nodes, metrics: metrics}
+
+	p.lock.Lock()
+	defer p.lock.Unlock()
+	s.Seq = p.seq
+	if after != 0 {
+		for _, b := range p.history {
+			if b.seq > after {
+				c <- b.update(s)
+			}
+		}
+	}
+	p.subs[s] = struct{}{}
+	return s
+}
+
+// Polls until stopIfIdle stops the poller.
+func (p *livePoller) run() {
+	for {
+		time.Sleep(p.interval())
+		if p.stopIfIdle() {
+			log.Debugf("METRICDATA/LIVE > stopped polling cluster %s", p.cluster)
+			return
+		}
+		p.poll()
+	}
+}
+
+// Remove the poller once there were no subscriptions at liveIdlePolls polls
+// in a row. Polls without subscriptions load nothing, the next one covers
+// their time range as well.
+func (p *livePoller) stopIfIdle() bool {
+	livePollers.lock.Lock()
+	defer livePollers.lock.Unlock()
+	p.lock.Lock()
+	defer p.lock.Unlock()
+	if len(p.subs) != 0 {
+		p.idle = 0
+		return false
+	}
+	if p.idle++; p.idle < liveIdlePolls {
+		return false
+	}
+	if livePollers.pollers[p.cluster] == p {
+		delete(livePollers.pollers, p.cluster)
+	}
+	return true
+}
+
+// The smallest timestep of the subscribed metrics, at least liveMinInterval.
+func (p *livePoller) interval() time.Duration {
+	_, metrics := p.subscribed()
+	interval := time.Duration(0)
+	for _, metric := range metrics {
+		if mc := archive.GetMetricConfig(p.cluster, metric); mc != nil {
+			if ts := time.Duration(mc.Timestep) * time.Second; interval == 0 || ts < interval {
+				interval = ts
+			}
+		}
+	}
+	if interval < liveMinInterval {
+		interval = liveMinInterval
+	}
+	return interval
+}
+
+// The sorted union of the nodes and metrics of all subscriptions.
+func (p *livePoller) subscribed() (nodes, metrics []string) {
+	p.lock.Lock()
+	defer p.lock.Unlock()
+	nodeSet, metricSet := map[string]struct{}{}, map[string]struct{}{}
+	for s := range p.subs {
+		for _, node := range s.nodes {
+			nodeSet[node] = struct{}{}
+		}
+		for _, metric := range s.metrics {
+			metricSet[metric] = struct{}{}
+		}
+	}
+	for node := range nodeSet {
+		nodes = append(nodes, node)
+	}
+	for metric := range metricSet {
+		metrics = append(metrics, metric)
+	}
+	sort.Strings(nodes)
+	sort.Strings(metrics)
+	return nodes, metrics
+}
+
+// Load the data since the previous poll and hand it to all subscriptions.
+// If nothing could be loaded, the next poll covers the time range again.
+func (p *livePoller) poll() {
+	nodes, metrics := p.subscribed()
+	if len(nodes) == 0 || len(metrics) == 0 {
+		return
+	}
+
+	p.lock.Lock()
+	from, to := p.last, time.Now()
+	p.lock.Unlock()
+
+	ctx, cancel := context.WithTimeout(context.Background(), liveMinInterval)
+	data, err := p.load(metrics, nodes, from, to, ctx)
+	cancel()
+	if err != nil && len(data) == 0 {
+		log.Warnf("METRICDATA/LIVE > polling cluster %s failed: %s", p.cluster, err.Error())
+		return
+	}
+
+	b := &liveBatch{from: from, to: to, data: make(map[string]map[string]*schema.JobMetric, len(metrics))}
+	for node, nodeData := range data {
+		for metric, jms := range nodeData {
+			if len(jms) == 0 {
+				continue
+			}
+			if b.data[metric] == nil {
+				b.data[metric] = make(map[string]*schema.JobMetric, len(nodes))
+			}
+			b.data[metric][node] = jms[0]
+		}
+	}
+
+	p.lock.Lock()
+	defer p.lock.Unlock()
+	p.seq++
+	b.seq = p.seq
+	p.last = to
+	if len(p.history) == liveHistory {
+		copy(p.history, p.history[1:])
+		p.history = p.history[:liveHistory-1]
+	}
+	p.history = append(p.history, b)
+
+	for s := range p.subs {
+		select {
+		case s.c <- b.update(s):
+		default:
+			log.Debugf("METRICDATA/LIVE > subscriber of cluster %s too slow, update %d dropped", p.cluster, b.seq)
+		}
+	}
+}
+
+// The part of the batch subscribed to by s.
+func (b *liveBatch) update(s *LiveSubscription) *LiveUpdate {
+	u := &LiveUpdate{Seq: b.seq, From: b.from, To: b.to, Data: make(schema.JobData, len(s.metrics))}
+	for _, metric := range s.metrics {
+		nodeData, ok := b.data[metric]
+		if !ok {
+			continue
+		}
+
+		var jm *schema.JobMetric
+		for _, node := range s.nodes {
+			data, ok := nodeData[node]
+			if !ok {
+				continue
+			}
+			if jm == nil {
+				jm = &schema.JobMetric{Unit: data.Unit, Timestep: data.Timestep, Series: make([]schema.Series, 0, len(s.nodes))}
+			}
+			jm.Series = append(jm.Series, data.Series...)
+		}
+		if jm != nil {
+			u.Data[metric] = map[schema.MetricScope]*schema.JobMetric{schema.MetricScopeNode: jm}
+		}
+	}
+	return u
+}
@@ -0,0 +1,182 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package metricdata
+
+import (
+	"context"
+	"reflect"
+	"testing"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/pkg/archive"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+func TestLivePoller(t *testing.T) {
+	type query struct {
+		metrics, nodes []string
+		from, to       time.Time
+	}
+	var queries []query
+	p := newLivePoller("testcluster", func(metrics, nodes []string, from, to time.Time, ctx context.Context) (map[string]map[string][]*schema.JobMetric, error) {
+		queries = append(queries, query{metrics, nodes, from, to})
+		data := make(map[string]map[string][]*schema.JobMetric)
+		for _, node := range nodes {
+			data[node] = make(map[string][]*schema.JobMetric)
+			for _, metric := range metrics {
+				data[node][metric] = []*schema.JobMetric{{
+					Timestep: 60,
+					Series:   []schema.Series{{Hostname: node, Data: []schema.Float{schema.Float(len(queries))}}},
+				}}
+			}
+		}
+		return data, nil
+	})
+
+	a := p.subscribe([]string{"n2", "n1"}, []string{"flops_any"}, 0)
+	b := p.subscribe([]string{"n2", "n3"}, []string{"flops_any", "mem_bw"}, 0)
+	p.poll()
+	p.poll()
+
+	// One query per poll for all subscriptions, each one continuing the last
+	if len(queries) != 2 {
+		t.Fatalf("want 2 queries, got %d", len(queries))
+	}
+	if q := queries[0]; !reflect.DeepEqual(q.nodes, []string{"n1", "n2", "n3"}) || !reflect.DeepEqual(q.metrics, []string{"flops_any", "mem_bw"}) {
+		t.Errorf("unexpected query: %v", q)
+	}
+	if !queries[1].from.Equal(queries[0].to) {
+		t.Errorf("time ranges not consecutive: %v", queries)
+	}
+
+	u := <-a.C
+	if len(u.Data) != 1 {
+		t.Fatalf("unexpected metrics: %v", u.Data)
+	}
+	series := u.Data["flops_any"][schema.MetricScopeNode].Series
+	if len(series) != 2 || series[0].Hostname != "n2" || series[1].Hostname != "n1" || series[0].Data[0] != 1 {
+		t.Errorf("unexpected series: %v", series)
+	}
+	if u2 := <-a.C; u2.Seq != u.Seq+1 || u2.Data["flops_any"][schema.MetricScopeNode].Series[0].Data[0] != 2 {
+		t.Errorf("unexpected second update: %d %v", u2.Seq, u2.Data)
+	}
+	if u := <-b.C; len(u.Data) != 2 || len(u.Data["mem_bw"][schema.MetricScopeNode].Series) != 2 {
+		t.Errorf("unexpected update: %v", u.Data)
+	}
+
+	// Resuming after the first update replays the second one only
+	c := p.subscribe([]string{"n1"}, []string{"flops_any"}, u.Seq)
+	if c.Seq != u.Seq+1 {
+		t.Errorf("want sequence number %d, got %d", u.Seq+1, c.Seq)
+	}
+	if len(c.C) != 1 {
+		t.Fatalf("want 1 replayed update, got %d", len(c.C))
+	}
+	if u2 := <-c.C; u2.Seq != u.Seq+1 {
+		t.Errorf("unexpected update replayed: %d", u2.Seq)
+	}
+
+	a.Close()
+	b.Close()
+	c.Close()
+	if _, ok := <-a.C; ok {
+		t.Error("channel not closed")
+	}
+	if len(p.subs) != 0 {
+		t.Errorf("%d subscriptions left", len(p.subs))
+	}
+	p.poll()
+	if len(queries) != 2 {
+		t.Error("polled without subscriptions")
+	}
+}
+
+func TestLivePollerResume(t *testing.T) {
+	var queries [][2]time.Time
+	p := newLivePoller("testcluster", func(metrics, nodes []string, from, to time.Time, ctx context.Context) (map[string]map[string][]*schema.JobMetric, error) {
+		queries = append(queries, [2]time.Time{from, to})
+		return map[string]map[string][]*schema.JobMetric{
+			"n1": {"flops_any": {{Timestep: 60, Series: []schema.Series{{Hostname: "n1", Data: []schema.Float{1}}}}}},
+		}, nil
+	})
+	livePollers.lock.Lock()
+	livePollers.pollers[p.cluster] = p
+	livePollers.lock.Unlock()
+	defer func() {
+		livePollers.lock.Lock()
+		delete(livePollers.pollers, p.cluster)
+		livePollers.lock.Unlock()
+	}()
+
+	a := p.subscribe([]string{"n1"}, []string{"flops_any"}, 0)
+	if p.stopIfIdle() {
+		t.Fatal("stopped with a subscription")
+	}
+	p.poll()
+	u := <-a.C
+	a.Close()
+
+	// A poll while the client reconnects loads nothing and keeps the poller
+	if p.stopIfIdle() {
+		t.Fatal("stopped after a single idle poll")
+	}
+	p.poll()
+	if len(queries) != 1 {
+		t.Fatalf("want 1 query, got %d", len(queries))
+	}
+
+	// The reconnected client continues where it left off, the next poll
+	// covers the time without subscriptions as well
+	b := p.subscribe([]string{"n1"}, []string{"flops_any"}, u.Seq)
+	if len(b.C) != 0 || b.Seq != u.Seq {
+		t.Fatalf("unexpected state after resubscribing: %d queued, sequence number %d", len(b.C), b.Seq)
+	}
+	if p.stopIfIdle() {
+		t.Fatal("stopped with a subscription")
+	}
+	p.poll()
+	u2 := <-b.C
+	if u2.Seq != u.Seq+1 || !u2.From.Equal(u.To) || !queries[1][0].Equal(queries[0][1]) {
+		t.Errorf("update %d from %v does not continue update %d until %v", u2.Seq, u2.From, u.Seq, u.To)
+	}
+	b.Close()
+
+	// Stops after liveIdlePolls polls without subscriptions
+	for i := 1; i < liveIdlePolls; i++ {
+		if p.stopIfIdle() {
+			t.Fatalf("stopped after %d idle polls", i)
+		}
+	}
+	if !p.stopIfIdle() {
+		t.Fatalf("not stopped after %d idle polls", liveIdlePolls)
+	}
+	livePollers.lock.Lock()
+	_, ok := livePollers.pollers[p.cluster]
+	livePollers.lock.Unlock()
+	if ok {
+		t.Error("stopped poller still registered")
+	}
+}
+
+func TestSubscribeLiveUnknownMetric(t *testing.T) {
+	clusters := archive.Clusters
+	defer func() { archive.Clusters = clusters }()
+	archive.Clusters = []*schema.Cluster{{
+		Name:         "livecluster",
+		MetricConfig: []*schema.MetricConfig{{Name: "flops_any", Scope: schema.MetricScopeNode, Timestep: 60}},
+	}}
+	metricDataRepos["livecluster"] = nil
+	defer delete(metricDataRepos, "livecluster")
+
+	if _, err := SubscribeLive("livecluster", []string{"n1"}, []string{"flops_any", "bogus"}, 0); err == nil {
+		t.Fatal("subscribed to an unknown metric")
+	}
+	livePollers.lock.Lock()
+	_, ok := livePollers.pollers["livecluster"]
+	livePollers.lock.Unlock()
+	if ok {
+		t.Error("poller started for a failed subscription")
+	}
+}
@@ -29,6 +29,13 @@ type MetricDataRepository interface {
 	// Return a map of metrics to a map of nodes to the metric statistics of the job. node scope assumed for now.
 	LoadStats(job *schema.Job, metrics []string, ctx context.Context) (map[string]map[string]schema.MetricStatistics, error)
 
+	// Return the JobData for each of the given jobs (in the same order), combining the queries
+	// of several jobs where possible. An entry is nil if loading that job failed.
+	LoadDataBatch(jobs []*schema.Job, metrics []string, scopes []schema.MetricScope, ctx context.Context) ([]schema.JobData, error)
+
+	// Return the node statistics for each of the given jobs (in the same order), see LoadStats.
+	LoadStatsBatch(jobs []*schema.Job, metrics []string, ctx context.Context) ([]map[string]map[string]schema.MetricStatistics, error)
+
 	// Return a map of hosts to a map of metrics at the requested scopes for that node.
 	LoadNodeData(cluster string, metrics, nodes []string, scopes []schema.MetricScope, from, to time.Time, ctx context.Context) (map[string]map[string][]*schema.JobMetric, error)
 }
@@ -37,8 +44,18 @@ var metricDataRepos map[string]MetricDataRepository = map[string]MetricDataRepos
 
 var useArchive bool
 
+const (
+	defaultCacheMemoryBudget = 128  // MB
+	defaultCacheDiskBudget   = 1024 // MB
+)
+
 func Init(disableArchive bool) error {
 	useArchive = !disableArchive
+	if err := initCache(config.Keys.MetricDataCache); err != nil {
+		return err
+	}
+	initPrefetch(config.Keys.MetricDataPrefetch)
+
 	for _, cluster := range config.Keys.Clusters {
 		if cluster.MetricDataRepository != nil {
 			var kind struct {
@@ -67,13 +84,58 @@ func Init(disableArchive bool) error {
 				log.Errorf("Error initializing MetricDataRepository %v for cluster %v", kind.Kind, cluster.Name)
 				return err
 			}
-			metricDataRepos[cluster.Name] = mdr
+			metricDataRepos[cluster.Name] = &instrumentedRepository{kind: kind.Kind, cluster: cluster.Name, repo: mdr}
 		}
 	}
 	return nil
 }
 
-var cache *lrucache.Cache = lrucache.New(128 * 1024 * 1024)
+var cache *lrucache.Cache = lrucache.NewSharded(defaultCacheMemoryBudget*1024*1024, lrucache.DefaultShards)
+
+// Optional second level of cache, nil if not configured.
+var diskTier *diskCache
+
+func initCache(cfg *schema.MetricDataCacheConfig) error {
+	if cfg == nil {
+		return nil
+	}
+
+	memoryBudget := defaultCacheMemoryBudget
+	if cfg.MemoryBudget > 0 {
+		memoryBudget = cfg.MemoryBudget
+	}
+	cache = lrucache.NewSharded(memoryBudget*1024*1024, lrucache.DefaultShards)
+
+	if cfg.DiskPath == "" {
+		return nil
+	}
+
+	diskBudget := defaultCacheDiskBudget
+	if cfg.DiskBudget > 0 {
+		diskBudget = cfg.DiskBudget
+	}
+	dc, err := newDiskCache(cfg.DiskPath, int64(diskBudget)*1024*1024, config.Keys.FastStartup)
+	if err != nil {
+		return err
+	}
+	diskTier = dc
+	cache.OnEvict(dc.demote)
+	return nil
+}
+
+// Look for the key in the disk cache, the result is to be returned by the
+// closure passed to cache.Get.
+func loadFromDisk(key string) (schema.JobData, time.Duration, int) {
+	if diskTier == nil {
+		return nil, 0, 0
+	}
+
+	jd, expiration := diskTier.get(key)
+	if jd == nil {
+		return nil, 0, 0
+	}
+	return jd, time.Until(expiration), jd.Size()
+}
 
 // Fetches the metric data for a job.
 func LoadData(job *schema.Job,
@@ -81,14 +143,16 @@ func LoadData(job *schema.Job,
 	scopes []schema.MetricScope,
 	ctx context.Context,
 ) (schema.JobData, error) {
-	data := cache.Get(cacheKey(job, metrics, scopes), func() (_ interface{}, ttl time.Duration, size int) {
+	key := cacheKey(job, metrics, scopes)
+	data := cache.Get(key, func() (_ interface{}, ttl time.Duration, size int) {
+		if jd, ttl, size := loadFromDisk(key); jd != nil {
+			return jd, ttl, size
+		}
+
 		var jd schema.JobData
 		var err error
 
-		if job.State == schema.JobStateRunning ||
-			job.MonitoringStatus == schema.MonitoringStatusRunningOrArchiving ||
-			!useArchive {
-
+		if !isArchived(job) {
 			repo, ok := metricDataRepos[job.Cluster]
 
 			if !ok {
@@ -118,53 +182,19 @@ func LoadData(job *schema.Job,
 			}
 			size = jd.Size()
 		} else {
-			jd, err = archive.GetHandle().LoadJobData(job)
+			start := time.Now()
+			jd, err = archive.GetHandle().LoadJobDataSubset(job, metrics, scopes)
+			observeBackend("archive", job.Cluster, "LoadJobData", start, err)
 			if err != nil {
 				log.Error("Error while loading job data from archive")
 				return err, 0, 0
 			}
-
-			// Avoid sending unrequested data to the client:
-			if metrics != nil || scopes != nil {
-				if metrics == nil {
-					metrics = make([]string, 0, len(jd))
-					for k := range jd {
-						metrics = append(metrics, k)
-					}
-				}
-
-				res := schema.JobData{}
-				for _, metric := range metrics {
-					if perscope, ok := jd[metric]; ok {
-						if len(perscope) > 1 {
-							subset := make(map[schema.MetricScope]*schema.JobMetric)
-							for _, scope := range scopes {
-								if jm, ok := perscope[scope]; ok {
-									subset[scope] = jm
-								}
-							}
-
-							if len(subset) > 0 {
-								perscope = subset
-							}
-						}
-
-						res[metric] = perscope
-					}
-				}
-				jd = res
-			}
 			size = jd.Size()
 		}
 
-		ttl = 5 * time.Hour
-		if job.State == schema.JobStateRunning {
-			ttl = 2 * time.Minute
-		}
-
 		prepareJobData(job, jd, scopes)
 
-		return jd, ttl, size
+		return jd, cacheTTL(job), size
 	})
 
 	if err, ok := data.(error); ok {
@@ -175,6 +205,129 @@ func LoadData(job *schema.Job,
 	return data.(schema.JobData), nil
 }
 
+// Like LoadData, but downsampled to a timestep of at most resolution seconds
+// (see schema.JobMetric.Downsample). The downsampled data is cached next to
+// the full resolution data it is made from. A resolution of 0 or less loads
+// the full resolution.
+func LoadDataDownsampled(job *schema.Job,
+	metrics []string,
+	scopes []schema.MetricScope,
+	resolution int,
+	ctx context.Context,
+) (schema.JobData, error) {
+	if resolution <= 0 {
+		return LoadData(job, metrics, scopes, ctx)
+	}
+
+	key := fmt.Sprintf("%s:%ds", cacheKey(job, metrics, scopes), resolution)
+	data := cache.Get(key, func() (_ interface{}, ttl time.Duration, size int) {
+		jd, err := LoadData(job, metrics, scopes, ctx)
+		if err != nil {
+			return err, 0, 0
+		}
+
+		jd = jd.Downsample(resolution)
+		return jd, cacheTTL(job), jd.Size()
+	})
+
+	if err, ok := data.(error); ok {
+		return nil, err
+	}
+
+	return data.(schema.JobData), nil
+}
+
+// Fetches the metric data for many jobs at once, for example for the analysis
+// views. Jobs not yet archived are requested in batches from the metric data
+// repositories (see MetricDataRepository.LoadDataBatch), archived jobs are
+// loaded via LoadData. The result has the same order as jobs.
+func LoadDataBatch(
+	jobs []*schema.Job,
+	metrics []string,
+	scopes []schema.MetricScope,
+	ctx context.Context,
+) ([]schema.JobData, error) {
+	result := make([]schema.JobData, len(jobs))
+	pending := make(map[string][]int)
+	for i, job := range jobs {
+		key := cacheKey(job, metrics, scopes)
+		if cached, ok := cache.Get(key, nil).(schema.JobData); ok {
+			result[i] = cached
+			continue
+		}
+
+		if jd, ttl, size := loadFromDisk(key); jd != nil {
+			result[i] = cache.Get(key, func() (interface{}, time.Duration, int) {
+				return jd, ttl, size
+			}).(schema.JobData)
+			continue
+		}
+
+		if _, ok := metricDataRepos[job.Cluster]; isArchived(job) || !ok {
+			jd, err := LoadData(job, metrics, scopes, ctx)
+			if err != nil {
+				return nil, err
+			}
+			result[i] = jd
+			continue
+		}
+
+		pending[job.Cluster] = append(pending[job.Cluster], i)
+	}
+
+	reqScopes := scopes
+	if reqScopes == nil {
+		reqScopes = []schema.MetricScope{schema.MetricScopeNode}
+	}
+
+	for cluster, indices := range pending {
+		reqMetrics := metrics
+		if reqMetrics == nil {
+			for _, mc := range archive.GetCluster(cluster).MetricConfig {
+				reqMetrics = append(reqMetrics, mc.Name)
+			}
+		}
+
+		batch := make([]*schema.Job, len(indices))
+		for i, idx := range indices {
+			batch[i] = jobs[idx]
+		}
+
+		data, err := metricDataRepos[cluster].LoadDataBatch(batch, reqMetrics, reqScopes, ctx)
+		if err != nil {
+			log.Warnf("partial error: %s", err.Error())
+		}
+
+		for i, idx := range indices {
+			job := jobs[idx]
+			if data == nil || len(data[i]) == 0 {
+				// Nothing usable in the batch, retry on its own to get a proper error
+				jd, err := LoadData(job, metrics, scopes, ctx)
+				if err != nil {
+					return nil, err
+				}
+				result[idx] = jd
+				continue
+			}
+
+			jd := data[i]
+			size := jd.Size()
+			prepareJobData(job, jd, reqScopes)
+			// Get instead of Put so that the size is accounted for and, should another
+			// goroutine have loaded the job meanwhile, its result is shared.
+			cached := cache.Get(cacheKey(job, metrics, scopes), func() (interface{}, time.Duration, int) {
+				return jd, cacheTTL(job), size
+			})
+			if cachedJd, ok := cached.(schema.JobData); ok {
+				jd = cachedJd
+			}
+			result[idx] = jd
+		}
+	}
+
+	return result, nil
+}
+
 // Used for the jobsFootprint GraphQL-Query. TODO: Rename/Generalize.
 func LoadAverages(
 	job *schema.Job,
@@ -183,7 +336,10 @@ func LoadAverages(
 	ctx context.Context,
 ) error {
 	if job.State != schema.JobStateRunning && useArchive {
-		return archive.LoadAveragesFromArchive(job, metrics, data) // #166 change also here?
+		start := time.Now()
+		err := archive.LoadAveragesFromArchive(job, metrics, data) // #166 change also here?
+		observeBackend("archive", job.Cluster, "LoadAverages", start, err)
+		return err
 	}
 
 	repo, ok := metricDataRepos[job.Cluster]
@@ -214,6 +370,81 @@ func LoadAverages(
 	return nil
 }
 
+// Like LoadAverages, but for many jobs at once. Statistics of jobs not yet
+// archived are requested in batches from the metric data repositories.
+// The averages are appended to data in the order of jobs.
+func LoadAveragesBatch(
+	jobs []*schema.Job,
+	metrics []string,
+	data [][]schema.Float,
+	ctx context.Context,
+) error {
+	avgs := make([][]schema.Float, len(jobs))
+	pending := make(map[string][]int)
+	for i, job := range jobs {
+		if job.State != schema.JobStateRunning && useArchive {
+			avgs[i] = make([]schema.Float, 0, len(metrics))
+			tmp := make([][]schema.Float, len(metrics))
+			start := time.Now()
+			err := archive.LoadAveragesFromArchive(job, metrics, tmp)
+			observeBackend("archive", job.Cluster, "LoadAverages", start, err)
+			if err != nil {
+				return err
+			}
+			for _, values := range tmp {
+				avgs[i] = append(avgs[i], values...)
+			}
+			continue
+		}
+
+		if _, ok := metricDataRepos[job.Cluster]; !ok {
+			return fmt.Errorf("METRICDATA/METRICDATA > no metric data repository configured for '%s'", job.Cluster)
+		}
+		pending[job.Cluster] = append(pending[job.Cluster], i)
+	}
+
+	for cluster, indices := range pending {
+		batch := make([]*schema.Job, len(indices))
+		for i, idx := range indices {
+			batch[i] = jobs[idx]
+		}
+
+		stats, err := metricDataRepos[cluster].LoadStatsBatch(batch, metrics, ctx)
+		if err != nil {
+			if stats == nil {
+				log.Errorf("Error while loading statistics for %d jobs of cluster %s", len(batch), cluster)
+				return err
+			}
+			log.Warnf("partial error: %s", err.Error())
+		}
+
+		for i, idx := range indices {
+			avgs[idx] = make([]schema.Float, len(metrics))
+			for j, m := range metrics {
+				nodes, ok := stats[i][m]
+				if !ok {
+					avgs[idx][j] = schema.NaN
+					continue
+				}
+
+				sum := 0.0
+				for _, node := range nodes {
+					sum += node.Avg
+				}
+				avgs[idx][j] = schema.Float(sum)
+			}
+		}
+	}
+
+	for _, jobAvgs := range avgs {
+		for i := range metrics {
+			data[i] = append(data[i], jobAvgs[i])
+		}
+	}
+
+	return nil
+}
+
 // Used for the node/system view. Returns a map of nodes to a map of metrics.
 func LoadNodeData(
 	cluster string,
@@ -250,6 +481,20 @@ func LoadNodeData(
 	return data, nil
 }
 
+// Whether the metric data of the job is to be loaded from the job archive.
+func isArchived(job *schema.Job) bool {
+	return job.State != schema.JobStateRunning &&
+		job.MonitoringStatus != schema.MonitoringStatusRunningOrArchiving &&
+		useArchive
+}
+
+func cacheTTL(job *schema.Job) time.Duration {
+	if job.State == schema.JobStateRunning {
+		return 2 * time.Minute
+	}
+	return 5 * time.Hour
+}
+
 func cacheKey(
 	job *schema.Job,
 	metrics []string,
@@ -270,16 +515,7 @@ func prepareJobData(
 	jobData schema.JobData,
 	scopes []schema.MetricScope,
 ) {
-	const maxSeriesSize int = 15
-	for _, scopes := range jobData {
-		for _, jm := range scopes {
-			if jm.StatisticsSeries != nil || len(jm.Series) <= maxSeriesSize {
-				continue
-			}
-
-			jm.AddStatisticsSeries()
-		}
-	}
+	jobData.AddStatisticsSeries()
 
 	nodeScopeRequested := false
 	for _, scope := range scopes {
@@ -345,6 +581,12 @@ func ArchiveJob(job *schema.Job, ctx context.Context) (*schema.JobMeta, error) {
 		}
 	}
 
+	if flops, ok := jobData["flops_any"]; ok {
+		if membw, ok := jobData["mem_bw"]; ok {
+			jobMeta.Roofline = schema.NewRooflineHistogram(flops[schema.MetricScopeNode], membw[schema.MetricScopeNode])
+		}
+	}
+
 	// If the file based archive is disabled,
 	// only return the JobMeta structure as the
 	// statistics in there are needed.
@@ -0,0 +1,120 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package metricdata
+
+import (
+	"context"
+	"fmt"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+const (
+	defaultPrefetchWorkers = 4
+	defaultPrefetchMaxJobs = 50
+	prefetchTimeout        = 2 * time.Minute
+)
+
+type prefetchTask struct {
+	jobs    []*schema.Job
+	metrics []string
+	scopes  []schema.MetricScope
+}
+
+// Nil if prefetching is disabled.
+var prefetchQueue chan prefetchTask
+
+var prefetchMaxJobs int
+
+func initPrefetch(cfg *schema.MetricDataPrefetchConfig) {
+	if cfg == nil {
+		return
+	}
+
+	numWorkers, maxJobs := defaultPrefetchWorkers, defaultPrefetchMaxJobs
+	if cfg.NumWorkers > 0 {
+		numWorkers = cfg.NumWorkers
+	}
+	if cfg.MaxJobs > 0 {
+		maxJobs = cfg.MaxJobs
+	}
+
+	prefetchMaxJobs = maxJobs
+	prefetchQueue = make(chan prefetchTask, 4*numWorkers)
+	log.Infof("Start %d metric data prefetch workers (max. %d jobs per page)", numWorkers, maxJobs)
+	for i := 0; i < numWorkers; i++ {
+		go prefetchWorker()
+	}
+}
+
+func prefetchWorker() {
+	for task := range prefetchQueue {
+		ctx, cancel := context.WithTimeout(context.Background(), prefetchTimeout)
+		if _, err := LoadDataBatch(task.jobs, task.metrics, task.scopes, ctx); err != nil {
+			log.Debugf("prefetching metric data of %d jobs failed: %s", len(task.jobs), err.Error())
+		}
+		cancel()
+	}
+}
+
+// The scopes the rows of the job list in the web UI request.
+func prefetchScopes(job *schema.Job) []schema.MetricScope {
+	if job.NumNodes != 1 {
+		return []schema.MetricScope{schema.MetricScopeNode}
+	}
+	if job.NumAcc >= 1 {
+		return []schema.MetricScope{schema.MetricScopeCore, schema.MetricScopeAccelerator}
+	}
+	return []schema.MetricScope{schema.MetricScopeCore}
+}
+
+// Load the metrics of the jobs of a job list page into the cache in the
+// background, so that the requests of the single rows hit the cache. Metrics
+// and scopes must be the ones the rows request as both are part of the cache
+// key. Jobs not yet archived are loaded in batches per cluster and scopes,
+// archived ones one at a time. Returns right away, tasks are dropped if the
+// workers can not keep up. Does nothing if disabled in the configuration.
+func Prefetch(jobs []*schema.Job, metrics []string) {
+	if prefetchQueue == nil || len(metrics) == 0 {
+		return
+	}
+
+	if len(jobs) > prefetchMaxJobs {
+		jobs = jobs[:prefetchMaxJobs]
+	}
+
+	batches := make(map[string]*prefetchTask)
+	tasks := make([]*prefetchTask, 0, len(jobs))
+	for _, job := range jobs {
+		scopes := prefetchScopes(job)
+		if cache.Get(cacheKey(job, metrics, scopes), nil) != nil {
+			continue
+		}
+
+		if isArchived(job) {
+			tasks = append(tasks, &prefetchTask{jobs: []*schema.Job{job}, metrics: metrics, scopes: scopes})
+			continue
+		}
+
+		key := fmt.Sprintf("%s:%v", job.Cluster, scopes)
+		task, ok := batches[key]
+		if !ok {
+			task = &prefetchTask{metrics: metrics, scopes: scopes}
+			batches[key] = task
+			tasks = append(tasks, task)
+		}
+		task.jobs = append(task.jobs, job)
+	}
+
+	for _, task := range tasks {
+		select {
+		case prefetchQueue <- *task:
+		default:
+			log.Debugf("metric data prefetch queue full, dropping %d jobs", len(task.jobs))
+		}
+	}
+}
@@ -34,13 +34,20 @@ type PrometheusDataRepositoryConfig struct {
 	Username  string            `json:"username,omitempty"`
 	Suffix    string            `json:"suffix,omitempty"`
 	Templates map[string]string `json:"query-templates"`
+	// Maximum number of queries sent at the same time (default: 8)
+	Concurrency int `json:"concurrency,omitempty"`
+	// Jobs with more nodes are queried in several parts in parallel
+	// (default: all nodes in one query)
+	NodesPerQuery int `json:"nodes-per-query,omitempty"`
 }
 
 type PrometheusDataRepository struct {
-	client      promapi.Client
-	queryClient promv1.API
-	suffix      string
-	templates   map[string]*template.Template
+	client        promapi.Client
+	queryClient   promv1.API
+	suffix        string
+	templates     map[string]*template.Template
+	concurrency   int
+	nodesPerQuery int
 }
 
 type PromQLArgs struct {
@@ -186,6 +193,8 @@ func (pdb *PrometheusDataRepository) Init(rawConfig json.RawMessage) error {
 	pdb.queryClient = promv1.NewAPI(pdb.client)
 	// site config
 	pdb.suffix = config.Suffix
+	pdb.concurrency = config.Concurrency
+	pdb.nodesPerQuery = config.NodesPerQuery
 	// init query templates
 	pdb.templates = make(map[string]*template.Template)
 	for metric, templ := range config.Templates {
@@ -259,86 +268,141 @@ func (pdb *PrometheusDataRepository) RowToSeries(
 	}
 }
 
-func (pdb *PrometheusDataRepository) LoadData(
-	job *schema.Job,
-	metrics []string,
+// One ranged query of LoadData or LoadNodeData
+type promQuery struct {
+	metric       string
+	metricConfig *schema.MetricConfig
+	query        string
+}
+
+// The queries for all metrics, split into parts of at most nodesPerQuery
+// nodes. Only the node scope is supported.
+func (pdb *PrometheusDataRepository) buildQueries(
+	cluster string,
+	metrics, nodes []string,
 	scopes []schema.MetricScope,
-	ctx context.Context) (schema.JobData, error) {
+	caller string) ([]promQuery, error) {
 
 	// TODO respect requested scope
-	if len(scopes) == 0 || !contains(scopes, schema.MetricScopeNode) {
-		scopes = append(scopes, schema.MetricScopeNode)
-	}
-
-	jobData := make(schema.JobData)
-	// parse job specs
-	nodes := make([]string, len(job.Resources))
-	for i, resource := range job.Resources {
-		nodes[i] = resource.Hostname
-	}
-	from := job.StartTime
-	to := job.StartTime.Add(time.Duration(job.Duration) * time.Second)
-
 	for _, scope := range scopes {
 		if scope != schema.MetricScopeNode {
 			logOnce.Do(func() {
 				log.Infof("Scope '%s' requested, but not yet supported: Will return 'node' scope only.", scope)
 			})
-			continue
 		}
+	}
 
-		for _, metric := range metrics {
-			metricConfig := archive.GetMetricConfig(job.Cluster, metric)
-			if metricConfig == nil {
-				log.Warnf("Error in LoadData: Metric %s for cluster %s not configured", metric, job.Cluster)
-				return nil, errors.New("Prometheus config error")
-			}
-			query, err := pdb.FormatQuery(metric, scope, nodes, job.Cluster)
+	chunks := chunkNodes(nodes, pdb.nodesPerQuery)
+	queries := make([]promQuery, 0, len(metrics)*len(chunks))
+	for _, metric := range metrics {
+		metricConfig := archive.GetMetricConfig(cluster, metric)
+		if metricConfig == nil {
+			log.Warnf("Error in %s: Metric %s for cluster %s not configured", caller, metric, cluster)
+			return nil, errors.New("Prometheus config error")
+		}
+		for _, chunk := range chunks {
+			query, err := pdb.FormatQuery(metric, schema.MetricScopeNode, chunk, cluster)
 			if err != nil {
 				log.Warn("Error while formatting prometheus query")
 				return nil, err
 			}
+			queries = append(queries, promQuery{metric: metric, metricConfig: metricConfig, query: query})
+		}
+	}
+	return queries, nil
+}
 
-			// ranged query over all job nodes
-			r := promv1.Range{
-				Start: from,
-				End:   to,
-				Step:  time.Duration(metricConfig.Timestep * 1e9),
-			}
-			result, warnings, err := pdb.queryClient.QueryRange(ctx, query, r)
+// Runs the queries in parallel and calls handle with the rows of each one as
+// soon as it returned. The rows are converted on the goroutine of the query,
+// calls to handle are serialized.
+func (pdb *PrometheusDataRepository) runQueries(
+	ctx context.Context,
+	queries []promQuery,
+	from, to time.Time,
+	caller string,
+	handle func(q *promQuery, series []schema.Series)) error {
+
+	var lock sync.Mutex
+	return fanOut(ctx, pdb.concurrency, len(queries), func(ctx context.Context, i int) error {
+		q := &queries[i]
+		// ranged query over the nodes of the query
+		r := promv1.Range{
+			Start: from,
+			End:   to,
+			Step:  time.Duration(q.metricConfig.Timestep * 1e9),
+		}
+		result, warnings, err := pdb.queryClient.QueryRange(ctx, q.query, r)
+		if err != nil {
+			log.Errorf("Prometheus query error in %s: %v\nQuery: %s", caller, err, q.query)
+			return errors.New("Prometheus query error")
+		}
+		if len(warnings) > 0 {
+			log.Warnf("Warnings: %v\n", warnings)
+		}
 
-			if err != nil {
-				log.Errorf("Prometheus query error in LoadData: %v\nQuery: %s", err, query)
-				return nil, errors.New("Prometheus query error")
-			}
-			if len(warnings) > 0 {
-				log.Warnf("Warnings: %v\n", warnings)
-			}
+		step := int64(q.metricConfig.Timestep)
+		steps := int64(to.Sub(from).Seconds()) / step
+		// iter rows of host, metric, values
+		matrix := result.(promm.Matrix)
+		series := make([]schema.Series, 0, len(matrix))
+		for _, row := range matrix {
+			series = append(series, pdb.RowToSeries(from, step, steps, row))
+		}
 
-			// init data structures
-			if _, ok := jobData[metric]; !ok {
-				jobData[metric] = make(map[schema.MetricScope]*schema.JobMetric)
-			}
-			jobMetric, ok := jobData[metric][scope]
-			if !ok {
-				jobMetric = &schema.JobMetric{
-					Unit:     metricConfig.Unit,
-					Timestep: metricConfig.Timestep,
-					Series:   make([]schema.Series, 0),
-				}
-			}
-			step := int64(metricConfig.Timestep)
-			steps := int64(to.Sub(from).Seconds()) / step
-			// iter rows of host, metric, values
-			for _, row := range result.(promm.Matrix) {
-				jobMetric.Series = append(jobMetric.Series,
-					pdb.RowToSeries(from, step, steps, row))
-			}
-			// only add metric if at least one host returned data
-			if !ok && len(jobMetric.Series) > 0{
-				jobData[metric][scope] = jobMetric
+		lock.Lock()
+		defer lock.Unlock()
+		handle(q, series)
+		return nil
+	})
+}
+
+func (pdb *PrometheusDataRepository) LoadData(
+	job *schema.Job,
+	metrics []string,
+	scopes []schema.MetricScope,
+	ctx context.Context) (schema.JobData, error) {
+
+	// parse job specs
+	nodes := make([]string, len(job.Resources))
+	for i, resource := range job.Resources {
+		nodes[i] = resource.Hostname
+	}
+	from := job.StartTime
+	to := job.StartTime.Add(time.Duration(job.Duration) * time.Second)
+
+	queries, err := pdb.buildQueries(job.Cluster, metrics, nodes, scopes, "LoadData")
+	if err != nil {
+		return nil, err
+	}
+
+	jobData := make(schema.JobData)
+	err = pdb.runQueries(ctx, queries, from, to, "LoadData", func(q *promQuery, series []schema.Series) {
+		// only add metric if at least one host returned data
+		if len(series) == 0 {
+			return
+		}
+
+		if _, ok := jobData[q.metric]; !ok {
+			jobData[q.metric] = make(map[schema.MetricScope]*schema.JobMetric)
+		}
+		jobMetric, ok := jobData[q.metric][schema.MetricScopeNode]
+		if !ok {
+			jobMetric = &schema.JobMetric{
+				Unit:     q.metricConfig.Unit,
+				Timestep: q.metricConfig.Timestep,
+				Series:   make([]schema.Series, 0, len(series)),
 			}
-			// sort by hostname to get uniform coloring
+			jobData[q.metric][schema.MetricScopeNode] = jobMetric
+		}
+		jobMetric.Series = append(jobMetric.Series, series...)
+	})
+	if err != nil {
+		return nil, err
+	}
+
+	// sort by hostname to get uniform coloring
+	for _, scoped := range jobData {
+		for _, jobMetric := range scoped {
 			sort.Slice(jobMetric.Series, func(i, j int) bool {
 				return (jobMetric.Series[i].Hostname < jobMetric.Series[j].Hostname)
 			})
@@ -371,6 +435,24 @@ func (pdb *PrometheusDataRepository) LoadStats(
 	return stats, nil
 }
 
+// The PromQL queries are built per job, so batches are loaded job by job.
+func (pdb *PrometheusDataRepository) LoadDataBatch(
+	jobs []*schema.Job,
+	metrics []string,
+	scopes []schema.MetricScope,
+	ctx context.Context) ([]schema.JobData, error) {
+
+	return loadDataBatchSequential(pdb, jobs, metrics, scopes, ctx)
+}
+
+func (pdb *PrometheusDataRepository) LoadStatsBatch(
+	jobs []*schema.Job,
+	metrics []string,
+	ctx context.Context) ([]map[string]map[string]schema.MetricStatistics, error) {
+
+	return loadStatsBatchSequential(pdb, jobs, metrics, ctx)
+}
+
 func (pdb *PrometheusDataRepository) LoadNodeData(
 	cluster string,
 	metrics, nodes []string,
@@ -378,68 +460,33 @@ func (pdb *PrometheusDataRepository) LoadNodeData(
 	from, to time.Time,
 	ctx context.Context) (map[string]map[string][]*schema.JobMetric, error) {
 	t0 := time.Now()
-	// Map of hosts of metrics of value slices
-	data := make(map[string]map[string][]*schema.JobMetric)
 	// query db for each metric
 	// TODO: scopes seems to be always empty
-	if len(scopes) == 0 || !contains(scopes, schema.MetricScopeNode) {
-		scopes = append(scopes, schema.MetricScopeNode)
+	queries, err := pdb.buildQueries(cluster, metrics, nodes, scopes, "LoadNodeData")
+	if err != nil {
+		return nil, err
 	}
-	for _, scope := range scopes {
-		if scope != schema.MetricScopeNode {
-			logOnce.Do(func() {
-				log.Infof("Note: Scope '%s' requested, but not yet supported: Will return 'node' scope only.", scope)
-			})
-			continue
-		}
-		for _, metric := range metrics {
-			metricConfig := archive.GetMetricConfig(cluster, metric)
-			if metricConfig == nil {
-				log.Warnf("Error in LoadNodeData: Metric %s for cluster %s not configured", metric, cluster)
-				return nil, errors.New("Prometheus config error")
-			}
-			query, err := pdb.FormatQuery(metric, scope, nodes, cluster)
-			if err != nil {
-				log.Warn("Error while formatting prometheus query")
-				return nil, err
-			}
 
-			// ranged query over all nodes
-			r := promv1.Range{
-				Start: from,
-				End:   to,
-				Step:  time.Duration(metricConfig.Timestep * 1e9),
-			}
-			result, warnings, err := pdb.queryClient.QueryRange(ctx, query, r)
-
-			if err != nil {
-				log.Errorf("Prometheus query error in LoadNodeData: %v\n", err)
-				return nil, errors.New("Prometheus query error")
-			}
-			if len(warnings) > 0 {
-				log.Warnf("Warnings: %v\n", warnings)
-			}
-
-			step := int64(metricConfig.Timestep)
-			steps := int64(to.Sub(from).Seconds()) / step
-
-			// iter rows of host, metric, values
-			for _, row := range result.(promm.Matrix) {
-				hostname := strings.TrimSuffix(string(row.Metric["exported_instance"]), pdb.suffix)
-				hostdata, ok := data[hostname]
-				if !ok {
-					hostdata = make(map[string][]*schema.JobMetric)
-					data[hostname] = hostdata
-				}
-				// output per host and metric
-				hostdata[metric] = append(hostdata[metric], &schema.JobMetric{
-					Unit:     metricConfig.Unit,
-					Timestep: metricConfig.Timestep,
-					Series:   []schema.Series{pdb.RowToSeries(from, step, steps, row)},
-				},
-				)
+	// Map of hosts of metrics of value slices
+	data := make(map[string]map[string][]*schema.JobMetric)
+	err = pdb.runQueries(ctx, queries, from, to, "LoadNodeData", func(q *promQuery, series []schema.Series) {
+		for _, s := range series {
+			hostdata, ok := data[s.Hostname]
+			if !ok {
+				hostdata = make(map[string][]*schema.JobMetric)
+				data[s.Hostname] = hostdata
 			}
+			// output per host and metric
+			hostdata[q.metric] = append(hostdata[q.metric], &schema.JobMetric{
+				Unit:     q.metricConfig.Unit,
+				Timestep: q.metricConfig.Timestep,
+				Series:   []schema.Series{s},
+			},
+			)
 		}
+	})
+	if err != nil {
+		return nil, err
 	}
 	t1 := time.Since(t0)
 	log.Debugf("LoadNodeData of %v nodes took %s", len(data), t1)
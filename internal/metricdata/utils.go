@@ -7,11 +7,138 @@ package metricdata
 import (
 	"context"
 	"encoding/json"
+	"fmt"
+	"strings"
+	"sync"
 	"time"
 
 	"github.com/ClusterCockpit/cc-backend/pkg/schema"
 )
 
+// Fallback for MetricDataRepository implementations which can not combine
+// the queries of several jobs: Loads the jobs one after another.
+func loadDataBatchSequential(
+	repo MetricDataRepository,
+	jobs []*schema.Job,
+	metrics []string,
+	scopes []schema.MetricScope,
+	ctx context.Context) ([]schema.JobData, error) {
+
+	var errors []string
+	result := make([]schema.JobData, len(jobs))
+	for i, job := range jobs {
+		jobData, err := repo.LoadData(job, metrics, scopes, ctx)
+		if err != nil {
+			errors = append(errors, fmt.Sprintf("job %d: %s", job.JobID, err.Error()))
+		}
+		result[i] = jobData
+	}
+
+	if len(errors) != 0 {
+		return result, fmt.Errorf("METRICDATA > Errors: %s", strings.Join(errors, ", "))
+	}
+
+	return result, nil
+}
+
+// See loadDataBatchSequential.
+func loadStatsBatchSequential(
+	repo MetricDataRepository,
+	jobs []*schema.Job,
+	metrics []string,
+	ctx context.Context) ([]map[string]map[string]schema.MetricStatistics, error) {
+
+	var errors []string
+	result := make([]map[string]map[string]schema.MetricStatistics, len(jobs))
+	for i, job := range jobs {
+		stats, err := repo.LoadStats(job, metrics, ctx)
+		if err != nil {
+			errors = append(errors, fmt.Sprintf("job %d: %s", job.JobID, err.Error()))
+		}
+		result[i] = stats
+	}
+
+	if len(errors) != 0 {
+		return result, fmt.Errorf("METRICDATA > Errors: %s", strings.Join(errors, ", "))
+	}
+
+	return result, nil
+}
+
+// Number of queries a backend sends at the same time if its config has no
+// "concurrency".
+const defaultQueryConcurrency = 8
+
+// Calls fn for 0 <= i < n with at most concurrency calls running at the same
+// time. After the first error or once ctx is done no new calls are started,
+// the context passed to the running ones is canceled and the first error is
+// returned.
+func fanOut(ctx context.Context, concurrency, n int, fn func(ctx context.Context, i int) error) error {
+	if concurrency <= 0 {
+		concurrency = defaultQueryConcurrency
+	}
+	if concurrency > n {
+		concurrency = n
+	}
+
+	ctx, cancel := context.WithCancel(ctx)
+	defer cancel()
+
+	var (
+		wg       sync.WaitGroup
+		errOnce  sync.Once
+		firstErr error
+	)
+	fail := func(err error) {
+		errOnce.Do(func() {
+			firstErr = err
+			cancel()
+		})
+	}
+
+	sem := make(chan struct{}, concurrency)
+	for i := 0; i < n; i++ {
+		select {
+		case sem <- struct{}{}:
+		case <-ctx.Done():
+		}
+		if ctx.Err() != nil {
+			fail(ctx.Err())
+			break
+		}
+
+		wg.Add(1)
+		go func(i int) {
+			defer func() {
+				<-sem
+				wg.Done()
+			}()
+			if err := fn(ctx, i); err != nil {
+				fail(err)
+			}
+		}(i)
+	}
+
+	wg.Wait()
+	return firstErr
+}
+
+// Splits nodes into chunks of at most size nodes so that the queries for
+// large jobs can run in parallel. All nodes are kept in one chunk if size is
+// not positive, a job without nodes gets one empty chunk.
+func chunkNodes(nodes []string, size int) [][]string {
+	if size <= 0 || len(nodes) <= size {
+		return [][]string{nodes}
+	}
+
+	chunks := make([][]string, 0, (len(nodes)+size-1)/size)
+	for len(nodes) > size {
+		chunks = append(chunks, nodes[:size:size])
+		nodes = nodes[size:]
+	}
+	return append(chunks, nodes)
+}
+
 var TestLoadDataCallback func(job *schema.Job, metrics []string, scopes []schema.MetricScope, ctx context.Context) (schema.JobData, error) = func(job *schema.Job, metrics []string, scopes []schema.MetricScope, ctx context.Context) (schema.JobData, error) {
 	panic("TODO")
 }
@@ -39,6 +166,22 @@ func (tmdr *TestMetricDataRepository) LoadStats(
 	panic("TODO")
 }
 
+func (tmdr *TestMetricDataRepository) LoadDataBatch(
+	jobs []*schema.Job,
+	metrics []string,
+	scopes []schema.MetricScope,
+	ctx context.Context) ([]schema.JobData, error) {
+
+	return loadDataBatchSequential(tmdr, jobs, metrics, scopes, ctx)
+}
+
+func (tmdr *TestMetricDataRepository) LoadStatsBatch(
+	jobs []*schema.Job,
+	metrics []string, ctx context.Context) ([]map[string]map[string]schema.MetricStatistics, error) {
+
+	return loadStatsBatchSequential(tmdr, jobs, metrics, ctx)
+}
+
 func (tmdr *TestMetricDataRepository) LoadNodeData(
 	cluster string,
 	metrics, nodes []string,
@@ -0,0 +1,79 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package metricdata
+
+import (
+	"context"
+	"errors"
+	"reflect"
+	"sync/atomic"
+	"testing"
+)
+
+func TestFanOut(t *testing.T) {
+	var running, maxRunning, calls int32
+	err := fanOut(context.Background(), 3, 20, func(ctx context.Context, i int) error {
+		n := atomic.AddInt32(&running, 1)
+		for {
+			max := atomic.LoadInt32(&maxRunning)
+			if n <= max || atomic.CompareAndSwapInt32(&maxRunning, max, n) {
+				break
+			}
+		}
+		atomic.AddInt32(&calls, 1)
+		atomic.AddInt32(&running, -1)
+		return nil
+	})
+	if err != nil {
+		t.Fatal(err)
+	}
+	if calls != 20 {
+		t.Errorf("want 20 calls, got %d", calls)
+	}
+	if maxRunning > 3 {
+		t.Errorf("want at most 3 concurrent calls, got %d", maxRunning)
+	}
+}
+
+func TestFanOutError(t *testing.T) {
+	failed := errors.New("query failed")
+	var calls int32
+	err := fanOut(context.Background(), 1, 10, func(ctx context.Context, i int) error {
+		atomic.AddInt32(&calls, 1)
+		if i == 2 {
+			return failed
+		}
+		return nil
+	})
+	if err != failed {
+		t.Errorf("want %v, got %v", failed, err)
+	}
+	if calls != 3 {
+		t.Errorf("want no calls after the error, got %d calls", calls)
+	}
+
+	ctx, cancel := context.WithCancel(context.Background())
+	cancel()
+	err = fanOut(ctx, 4, 10, func(ctx context.Context, i int) error {
+		t.Error("call after the context was canceled")
+		return nil
+	})
+	if err != context.Canceled {
+		t.Errorf("want %v, got %v", context.Canceled, err)
+	}
+}
+
+func TestChunkNodes(t *testing.T) {
+	nodes := []string{"a", "b", "c", "d", "e"}
+	if got := chunkNodes(nodes, 0); !reflect.DeepEqual(got, [][]string{nodes}) {
+		t.Errorf("unexpected chunks: %v", got)
+	}
+	if got := chunkNodes(nodes, 2); !reflect.DeepEqual(got, [][]string{{"a", "b"}, {"c", "d"}, {"e"}}) {
+		t.Errorf("unexpected chunks: %v", got)
+	}
+	if got := chunkNodes(nil, 2); len(got) != 1 || len(got[0]) != 0 {
+		t.Errorf("unexpected chunks: %v", got)
+	}
+}
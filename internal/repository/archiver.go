@@ -0,0 +1,225 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package repository
+
+import (
+	"context"
+	"sync"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/internal/config"
+	"github.com/ClusterCockpit/cc-backend/internal/metricdata"
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+	"github.com/prometheus/client_golang/prometheus"
+	"github.com/prometheus/client_golang/prometheus/promauto"
+)
+
+const (
+	defaultArchiveWorkers = 4
+	defaultArchiveTimeout = 10 * time.Minute
+)
+
+var (
+	archiveQueueDepth = promauto.NewGauge(prometheus.GaugeOpts{
+		Namespace: "cc_backend",
+		Subsystem: "archiver",
+		Name:      "queue_depth",
+		Help:      "Number of jobs waiting to be archived.",
+	})
+	archiveInFlight = promauto.NewGaugeVec(prometheus.GaugeOpts{
+		Namespace: "cc_backend",
+		Subsystem: "archiver",
+		Name:      "in_flight",
+		Help:      "Number of jobs currently being archived.",
+	}, []string{"cluster"})
+	archiveDuration = promauto.NewHistogramVec(prometheus.HistogramOpts{
+		Namespace: "cc_backend",
+		Subsystem: "archiver",
+		Name:      "duration_seconds",
+		Help:      "Time it took to archive a job.",
+		Buckets:   prometheus.ExponentialBuckets(0.1, 2, 14),
+	}, []string{"cluster"})
+	archiveWaitTime = promauto.NewHistogram(prometheus.HistogramOpts{
+		Namespace: "cc_backend",
+		Subsystem: "archiver",
+		Name:      "wait_seconds",
+		Help:      "Time a job spent in the queue before archiving started.",
+		Buckets:   prometheus.ExponentialBuckets(0.01, 4, 12),
+	})
+	archiveFailures = promauto.NewCounterVec(prometheus.CounterOpts{
+		Namespace: "cc_backend",
+		Subsystem: "archiver",
+		Name:      "failures_total",
+		Help:      "Number of failed archivings by the step they failed at.",
+	}, []string{"cluster", "step"})
+)
+
+type archivingRequest struct {
+	job      *schema.Job
+	enqueued time.Time
+}
+
+// Limits the number of concurrently archived jobs per cluster so that a
+// burst of jobs ending on one cluster does not overwhelm its metric data
+// repository. Requests of a cluster at its limit are queued here instead of
+// blocking a worker, so that the other clusters keep being archived.
+type clusterLimiter struct {
+	mu      sync.Mutex
+	limit   int
+	running map[string]int
+	waiting map[string][]archivingRequest
+}
+
+func newClusterLimiter(limit int) *clusterLimiter {
+	return &clusterLimiter{
+		limit:   limit,
+		running: make(map[string]int),
+		waiting: make(map[string][]archivingRequest),
+	}
+}
+
+// Take a slot of the cluster of req. If there is none left, req is queued
+// and false returned: The worker releasing the next slot of the cluster
+// gets it (see release).
+func (cl *clusterLimiter) acquire(req archivingRequest) bool {
+	if cl.limit <= 0 {
+		return true
+	}
+
+	cl.mu.Lock()
+	defer cl.mu.Unlock()
+	cluster := req.job.Cluster
+	if cl.running[cluster] < cl.limit {
+		cl.running[cluster]++
+		return true
+	}
+	cl.waiting[cluster] = append(cl.waiting[cluster], req)
+	return false
+}
+
+// Release a slot of cluster. If a request of the cluster is waiting, the
+// slot is passed on to it and the request is returned to be archived next.
+func (cl *clusterLimiter) release(cluster string) (archivingRequest, bool) {
+	if cl.limit <= 0 {
+		return archivingRequest{}, false
+	}
+
+	cl.mu.Lock()
+	defer cl.mu.Unlock()
+	if queue := cl.waiting[cluster]; len(queue) != 0 {
+		next := queue[0]
+		if len(queue) == 1 {
+			delete(cl.waiting, cluster)
+		} else {
+			cl.waiting[cluster] = queue[1:]
+		}
+		return next, true
+	}
+	if cl.running[cluster]--; cl.running[cluster] == 0 {
+		delete(cl.running, cluster)
+	}
+	return archivingRequest{}, false
+}
+
+// Start the pool of archiving workers as configured in config.Keys.Archiver.
+func (r *JobRepository) startArchivingWorkers() {
+	numWorkers, timeout, limit := defaultArchiveWorkers, defaultArchiveTimeout, 0
+
+	if cfg := config.Keys.Archiver; cfg != nil {
+		if cfg.NumWorkers > 0 {
+			numWorkers = cfg.NumWorkers
+		}
+		if cfg.Timeout != "" {
+			if d, err := time.ParseDuration(cfg.Timeout); err == nil {
+				timeout = d
+			} else {
+				log.Warnf("invalid archiver timeout '%s', using default of %s: %v", cfg.Timeout, defaultArchiveTimeout, err)
+			}
+		}
+		limit = cfg.ClusterConcurrency
+	}
+
+	r.archiveLimiter = newClusterLimiter(limit)
+	log.Infof("Start %d archiving workers (timeout %s)", numWorkers, timeout)
+	for i := 0; i < numWorkers; i++ {
+		go r.archivingWorker(timeout)
+	}
+}
+
+// Archiving worker thread
+func (r *JobRepository) archivingWorker(timeout time.Duration) {
+	for req := range r.archiveChannel {
+		if !r.archiveLimiter.acquire(req) {
+			// Archived by the next worker done with a job of that cluster
+			continue
+		}
+
+		for {
+			archiveQueueDepth.Dec()
+			archiveWaitTime.Observe(time.Since(req.enqueued).Seconds())
+			r.archiveJob(req.job, timeout)
+			r.archivePending.Done()
+
+			next, ok := r.archiveLimiter.release(req.job.Cluster)
+			if !ok {
+				break
+			}
+			req = next
+		}
+	}
+}
+
+func (r *JobRepository) archiveJob(job *schema.Job, timeout time.Duration) {
+	start := time.Now()
+	inFlight := archiveInFlight.WithLabelValues(job.Cluster)
+	inFlight.Inc()
+	defer inFlight.Dec()
+
+	// not using meta data, called to load JobMeta into Cache?
+	// will fail if job meta not in repository
+	if _, err := r.FetchMetadata(job); err != nil {
+		log.Errorf("archiving job (dbid: %d) failed at check metadata step: %s", job.ID, err.Error())
+		archiveFailures.WithLabelValues(job.Cluster, "metadata").Inc()
+		r.UpdateMonitoringStatus(job.ID, schema.MonitoringStatusArchivingFailed)
+		return
+	}
+
+	ctx, cancel := context.WithTimeout(context.Background(), timeout)
+	defer cancel()
+
+	// metricdata.ArchiveJob will fetch all the data from a MetricDataRepository and push into configured archive backend
+	jobMeta, err := metricdata.ArchiveJob(job, ctx)
+	if err != nil {
+		log.Errorf("archiving job (dbid: %d) failed at archiving job step: %s", job.ID, err.Error())
+		archiveFailures.WithLabelValues(job.Cluster, "archive").Inc()
+		r.UpdateMonitoringStatus(job.ID, schema.MonitoringStatusArchivingFailed)
+		return
+	}
+
+	// Update the jobs database entry one last time:
+	if err := r.MarkArchived(job.ID, schema.MonitoringStatusArchivingSuccessful, jobMeta); err != nil {
+		log.Errorf("archiving job (dbid: %d) failed at marking archived step: %s", job.ID, err.Error())
+		archiveFailures.WithLabelValues(job.Cluster, "mark").Inc()
+		return
+	}
+
+	archiveDuration.WithLabelValues(job.Cluster).Observe(time.Since(start).Seconds())
+	log.Debugf("archiving job %d took %s", job.JobID, time.Since(start))
+	log.Printf("archiving job (dbid: %d) successful", job.ID)
+}
+
+// Trigger async archiving
+func (r *JobRepository) TriggerArchiving(job *schema.Job) {
+	r.archivePending.Add(1)
+	archiveQueueDepth.Inc()
+	r.archiveChannel <- archivingRequest{job: job, enqueued: time.Now()}
+}
+
+// Wait for background threads to finish pending archiving operations
+func (r *JobRepository) WaitForArchiving() {
+	// wait for workers to process remaining jobs
+	r.archivePending.Wait()
+}
@@ -0,0 +1,57 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package repository
+
+import (
+	"testing"
+
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+func TestClusterLimiter(t *testing.T) {
+	req := func(id int64, cluster string) archivingRequest {
+		job := &schema.Job{ID: id}
+		job.Cluster = cluster
+		return archivingRequest{job: job}
+	}
+
+	cl := newClusterLimiter(2)
+	for i, want := range []bool{true, true, false, false} {
+		if got := cl.acquire(req(int64(i), "a")); got != want {
+			t.Errorf("request %d: want %v, got %v", i, want, got)
+		}
+	}
+	// Other clusters are not held up by a
+	if !cl.acquire(req(4, "b")) {
+		t.Error("cluster b blocked by cluster a")
+	}
+
+	// Slots of a are passed on to the waiting requests in order
+	for _, want := range []int64{2, 3} {
+		next, ok := cl.release("a")
+		if !ok || next.job.ID != want {
+			t.Fatalf("want request %d next, got %v (%v)", want, next.job, ok)
+		}
+	}
+	for i := 0; i < 2; i++ {
+		if _, ok := cl.release("a"); ok {
+			t.Fatal("unexpected request waiting")
+		}
+	}
+	if _, ok := cl.release("b"); ok {
+		t.Fatal("unexpected request waiting")
+	}
+	if len(cl.running) != 0 || len(cl.waiting) != 0 {
+		t.Errorf("limiter not empty: %v, %v", cl.running, cl.waiting)
+	}
+
+	// Without a limit, nothing is ever queued
+	cl = newClusterLimiter(0)
+	for i := 0; i < 10; i++ {
+		if !cl.acquire(req(int64(i), "a")) {
+			t.Fatal("request queued without limit")
+		}
+	}
+}
@@ -0,0 +1,230 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package repository
+
+import (
+	"encoding/json"
+	"fmt"
+	"sync"
+	"testing"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/internal/benchdata"
+	"github.com/ClusterCockpit/cc-backend/internal/graph/model"
+	"github.com/ClusterCockpit/cc-backend/pkg/archive"
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/lrucache"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+	sq "github.com/Masterminds/squirrel"
+	"github.com/jmoiron/sqlx"
+)
+
+// The benchmarks below run on a synthetic database with the jobs of
+// benchdata.FromEnv(), see `make bench`. The database is kept in
+// benchdata.Dir() and reused by later runs with the same settings.
+
+var (
+	benchRepoOnce sync.Once
+	benchRepo     *JobRepository
+	benchCfg      *benchdata.Config
+	benchRepoErr  error
+)
+
+func setupBench(b *testing.B) (*JobRepository, *benchdata.Config) {
+	b.Helper()
+	benchRepoOnce.Do(func() {
+		log.Init("warn", true)
+		benchCfg, benchRepoErr = benchdata.FromEnv()
+		if benchRepoErr == nil {
+			benchRepo, benchRepoErr = openBenchRepository(benchCfg)
+		}
+	})
+	noErr(b, benchRepoErr)
+	return benchRepo, benchCfg
+}
+
+// Not through Connect and GetJobRepository, the other tests and benchmarks
+// of the package use the singletons with the database in testdata.
+func newBenchRepository(dbfile string) (*JobRepository, error) {
+	db, err := sqlx.Open("sqlite3", dbfile+"?_journal=WAL&_timeout=5000&_fk=true")
+	if err != nil {
+		return nil, err
+	}
+	db.SetMaxOpenConns(4)
+
+	stmtCache := sq.NewStmtCache(db)
+	return &JobRepository{
+		DB:        db,
+		stmtCache: stmtCache,
+		reader:    db,
+		readCache: stmtCache,
+		cache:     lrucache.New(1024 * 1024),
+		driver:    "sqlite3",
+	}, nil
+}
+
+func openBenchRepository(cfg *benchdata.Config) (*JobRepository, error) {
+	if archive.GetCluster(benchdata.ClusterName) == nil {
+		archive.Clusters = append(archive.Clusters, cfg.Cluster())
+	}
+
+	dbfile, err := benchdata.Cached(cfg.Name(cfg.Jobs)+".db", func(path string) error {
+		return buildBenchDB(path, cfg)
+	})
+	if err != nil {
+		return nil, err
+	}
+
+	return newBenchRepository(dbfile)
+}
+
+func buildBenchDB(dbfile string, cfg *benchdata.Config) error {
+	start := time.Now()
+	if err := MigrateDB("sqlite3", dbfile); err != nil {
+		return err
+	}
+
+	r, err := newBenchRepository(dbfile)
+	if err != nil {
+		return err
+	}
+	defer r.DB.Close()
+
+	bl, err := r.NewBulkLoader(0)
+	if err != nil {
+		return err
+	}
+	defer bl.Close()
+
+	const jobsPerTransaction = 10000
+	g := cfg.Generator(cfg.Jobs)
+	for shard, done := 0, false; !done; shard++ {
+		if err := bl.Begin(); err != nil {
+			return err
+		}
+
+		for i := 0; i < jobsPerTransaction; i++ {
+			meta := g.Next()
+			if meta == nil {
+				done = true
+				break
+			}
+
+			job := schema.Job{
+				BaseJob:       meta.BaseJob,
+				StartTime:     time.Unix(meta.StartTime, 0),
+				StartTimeUnix: meta.StartTime,
+			}
+			job.LoadAvg, job.FlopsAnyAvg, job.MemBwAvg, job.MemUsedMax = benchdata.Footprint(meta)
+			if job.RawResources, err = json.Marshal(job.Resources); err != nil {
+				return err
+			}
+			if job.RawMetaData, err = json.Marshal(job.MetaData); err != nil {
+				return err
+			}
+			if err := bl.Add(job); err != nil {
+				return err
+			}
+		}
+
+		if err := bl.Commit(fmt.Sprintf("%s/%d", benchdata.ClusterName, shard)); err != nil {
+			return err
+		}
+	}
+
+	if err := bl.Close(); err != nil {
+		return err
+	}
+	if err := r.RebuildRollup(); err != nil {
+		return err
+	}
+	if _, err := r.DB.Exec(`PRAGMA wal_checkpoint(TRUNCATE)`); err != nil {
+		return err
+	}
+
+	inserted, failed := bl.Stats()
+	log.Printf("Synthetic database %s: %d jobs (%d failed) in %s", dbfile, inserted, failed, time.Since(start))
+	return nil
+}
+
+func benchUserFilter(user string) []*model.JobFilter {
+	return []*model.JobFilter{{User: &model.StringInput{Eq: &user}}}
+}
+
+func BenchmarkSynth_QueryJobs(b *testing.B) {
+	r, _ := setupBench(b)
+	ctx := getContext(b)
+	order := &model.OrderByInput{Field: "startTime", Order: model.SortDirectionEnumDesc}
+
+	b.Run("User", func(b *testing.B) {
+		page := &model.PageRequest{ItemsPerPage: 50, Page: 1}
+		b.RunParallel(func(pb *testing.PB) {
+			i := 0
+			for pb.Next() {
+				_, err := r.QueryJobs(ctx, benchUserFilter(fmt.Sprintf("user%03d", i%200)), page, order)
+				noErr(b, err)
+				i++
+			}
+		})
+	})
+
+	b.Run("DeepPage", func(b *testing.B) {
+		page := &model.PageRequest{ItemsPerPage: 50, Page: 100}
+		for i := 0; i < b.N; i++ {
+			_, err := r.QueryJobs(ctx, []*model.JobFilter{{}}, page, order)
+			noErr(b, err)
+		}
+	})
+
+	b.Run("Node", func(b *testing.B) {
+		page := &model.PageRequest{ItemsPerPage: 50, Page: 1}
+		for i := 0; i < b.N; i++ {
+			node := fmt.Sprintf("n%04d", i%64)
+			_, err := r.QueryJobs(ctx, []*model.JobFilter{{Node: &model.StringInput{Eq: &node}}}, page, order)
+			noErr(b, err)
+		}
+	})
+}
+
+func BenchmarkSynth_JobsStatsGrouped(b *testing.B) {
+	r, _ := setupBench(b)
+	ctx := getContext(b)
+	groupBy := model.AggregateProject
+
+	b.Run("Rollup", func(b *testing.B) {
+		for i := 0; i < b.N; i++ {
+			_, err := r.JobsStatsGrouped(ctx, []*model.JobFilter{{}}, nil, nil, &groupBy)
+			noErr(b, err)
+		}
+	})
+
+	b.Run("Filtered", func(b *testing.B) {
+		for i := 0; i < b.N; i++ {
+			_, err := r.JobsStatsGrouped(ctx, benchUserFilter(fmt.Sprintf("user%03d", i%200)), nil, nil, &groupBy)
+			noErr(b, err)
+		}
+	})
+}
+
+func BenchmarkSynth_Histograms(b *testing.B) {
+	r, _ := setupBench(b)
+	ctx := getContext(b)
+	cluster := benchdata.ClusterName
+	filter := []*model.JobFilter{{Cluster: &model.StringInput{Eq: &cluster}}}
+
+	b.Run("AddHistograms", func(b *testing.B) {
+		for i := 0; i < b.N; i++ {
+			_, err := r.AddHistograms(ctx, filter, &model.JobsStatistics{})
+			noErr(b, err)
+		}
+	})
+
+	b.Run("AddMetricHistograms", func(b *testing.B) {
+		for i := 0; i < b.N; i++ {
+			_, err := r.AddMetricHistograms(ctx, filter, benchdata.Metrics, &model.JobsStatistics{})
+			noErr(b, err)
+		}
+	})
+}
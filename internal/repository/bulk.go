@@ -0,0 +1,368 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package repository
+
+import (
+	"context"
+	"fmt"
+
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+	sq "github.com/Masterminds/squirrel"
+	"github.com/jmoiron/sqlx"
+)
+
+const (
+	defaultImportBatchSize = 500
+	// Keeps the number of parameters of one INSERT below the limit of
+	// SQLite (32766) and MySQL (65535).
+	maxImportBatchSize = 1000
+	// Same for the rows of job_node (three parameters each)
+	maxJobNodeBatchSize = 10000
+)
+
+type jobIndex struct {
+	name    string
+	columns string
+}
+
+// Secondary indexes of the job table as created by the migrations. They are
+// dropped during a bulk load and created again afterwards.
+var jobIndexes = map[string][]jobIndex{
+	"sqlite3": {
+		{"job_stats", "cluster, subcluster, user"},
+		{"job_by_user", "user"},
+		{"job_by_starttime", "start_time"},
+		{"job_by_job_id", "job_id, cluster, start_time"},
+		{"job_list", "cluster, job_state"},
+		{"job_list_user", "user, cluster, job_state"},
+		{"job_list_users", "user, job_state"},
+		{"job_list_users_start", "start_time, user, job_state"},
+	},
+	"mysql": {
+		{"job_stats", "cluster, subcluster, user"},
+		{"job_by_user", "user"},
+		{"job_by_starttime", "start_time"},
+		{"job_by_job_id", "job_id"},
+		{"job_list", "cluster, job_state"},
+		{"job_list_user", "user, cluster, job_state"},
+		{"job_list_users", "user, job_state"},
+		{"job_list_users_start", "start_time, user, job_state"},
+	},
+}
+
+// A BulkLoader inserts jobs using multi row INSERT statements on a dedicated
+// connection tuned for the load. The job ids needed for the tags are derived
+// from LastInsertId, so nothing else may insert jobs at the same time. It is
+// meant for InitDB only.
+type BulkLoader struct {
+	r         *JobRepository
+	ctx       context.Context
+	conn      *sqlx.Conn
+	tx        *sqlx.Tx
+	batchSize int
+	jobs      []schema.Job
+	tags      map[string]int64
+	restore   []string
+	inserted  int
+	failed    int
+}
+
+func (r *JobRepository) NewBulkLoader(batchSize int) (*BulkLoader, error) {
+	if batchSize <= 0 {
+		batchSize = defaultImportBatchSize
+	}
+	if batchSize > maxImportBatchSize {
+		batchSize = maxImportBatchSize
+	}
+
+	ctx := context.Background()
+	conn, err := r.DB.Connx(ctx)
+	if err != nil {
+		log.Warn("Error while getting connection for bulk load")
+		return nil, err
+	}
+
+	b := &BulkLoader{
+		r:         r,
+		ctx:       ctx,
+		conn:      conn,
+		batchSize: batchSize,
+		jobs:      make([]schema.Job, 0, batchSize),
+		tags:      make(map[string]int64),
+	}
+
+	if err := b.tune(); err != nil {
+		b.Close()
+		return nil, err
+	}
+
+	tags, err := r.GetTags(nil)
+	if err != nil {
+		b.Close()
+		return nil, err
+	}
+	for _, tag := range tags {
+		b.tags[tag.Name+":"+tag.Type] = tag.ID
+	}
+
+	for _, idx := range jobIndexes[r.driver] {
+		stmt := fmt.Sprintf("DROP INDEX IF EXISTS %s", idx.name)
+		if r.driver == "mysql" {
+			stmt += " ON job"
+		}
+		if _, err := conn.ExecContext(ctx, stmt); err != nil {
+			log.Warnf("Error while dropping index %s", idx.name)
+			b.Close()
+			return nil, err
+		}
+	}
+
+	return b, nil
+}
+
+// Relax durability and constraint checks for the duration of the load. The
+// previous settings are restored in Close.
+func (b *BulkLoader) tune() error {
+	var settings []struct{ query, set, value string }
+	switch b.r.driver {
+	case "sqlite3":
+		settings = []struct{ query, set, value string }{
+			{"PRAGMA synchronous", "PRAGMA synchronous = %s", "OFF"},
+			{"PRAGMA cache_size", "PRAGMA cache_size = %s", "-262144"}, // 256 MiB
+		}
+	case "mysql":
+		settings = []struct{ query, set, value string }{
+			{"SELECT @@SESSION.unique_checks", "SET SESSION unique_checks = %s", "0"},
+			{"SELECT @@SESSION.foreign_key_checks", "SET SESSION foreign_key_checks = %s", "0"},
+		}
+	}
+
+	for _, s := range settings {
+		var prev string
+		if err := b.conn.QueryRowContext(b.ctx, s.query).Scan(&prev); err != nil {
+			log.Warnf("Error while querying '%s'", s.query)
+			return err
+		}
+		if _, err := b.conn.ExecContext(b.ctx, fmt.Sprintf(s.set, s.value)); err != nil {
+			log.Warnf("Error while executing '%s'", fmt.Sprintf(s.set, s.value))
+			return err
+		}
+		b.restore = append(b.restore, fmt.Sprintf(s.set, prev))
+	}
+
+	return nil
+}
+
+// Start a new transaction.
+func (b *BulkLoader) Begin() error {
+	tx, err := b.conn.BeginTxx(b.ctx, nil)
+	if err != nil {
+		log.Warn("Error while starting bulk load transaction")
+		return err
+	}
+
+	b.tx = tx
+	return nil
+}
+
+// Queue a job for insertion, a full batch is inserted right away.
+func (b *BulkLoader) Add(job schema.Job) error {
+	b.jobs = append(b.jobs, job)
+	if len(b.jobs) >= b.batchSize {
+		return b.flush()
+	}
+
+	return nil
+}
+
+// Insert the remaining jobs, mark the shard (see ArchiveBackend.IterShards)
+// as done, if not empty, and commit the transaction.
+func (b *BulkLoader) Commit(shard string) error {
+	if err := b.flush(); err != nil {
+		return err
+	}
+
+	if shard != "" {
+		if _, err := b.tx.Exec(`INSERT INTO initdb_checkpoint (shard) VALUES (?)`, shard); err != nil {
+			log.Errorf("Error while inserting checkpoint into initdb_checkpoint table: %v", shard)
+			return err
+		}
+	}
+
+	if err := b.tx.Commit(); err != nil {
+		log.Warn("Error while committing bulk load transaction")
+		return err
+	}
+
+	b.tx = nil
+	return nil
+}
+
+// Number of jobs inserted and failed so far.
+func (b *BulkLoader) Stats() (inserted int, failed int) {
+	return b.inserted, b.failed
+}
+
+func (b *BulkLoader) flush() error {
+	if len(b.jobs) == 0 {
+		return nil
+	}
+
+	jobs := b.jobs
+	b.jobs = b.jobs[:0]
+
+	res, err := b.tx.NamedExec(NamedJobInsert, jobs)
+	if err != nil {
+		// Find the culprit(s) by inserting one at a time
+		log.Warnf("Error while inserting %d jobs at once, retry one by one: %v", len(jobs), err)
+		for i := range jobs {
+			if err := b.insertOne(&jobs[i]); err != nil {
+				return err
+			}
+		}
+		return nil
+	}
+
+	id, err := res.LastInsertId()
+	if err != nil {
+		log.Warn("Error while getting last insert ID")
+		return err
+	}
+	// SQLite reports the id of the last row, MySQL the one of the first row.
+	if b.r.driver == "sqlite3" {
+		id -= int64(len(jobs) - 1)
+	}
+
+	jobTags := sq.Insert("jobtag").Columns("job_id", "tag_id")
+	jobNodes := jobNodeInsert()
+	numJobTags, numJobNodes := 0, 0
+	for i := range jobs {
+		if numJobNodes > 0 && numJobNodes+len(jobs[i].Resources) > maxJobNodeBatchSize {
+			if _, err := jobNodes.RunWith(b.tx).Exec(); err != nil {
+				log.Warnf("Error while inserting %d job nodes", numJobNodes)
+				return err
+			}
+			jobNodes, numJobNodes = jobNodeInsert(), 0
+		}
+		var n int
+		jobNodes, n = addJobNodes(jobNodes, id+int64(i), jobs[i].Cluster, jobs[i].Resources)
+		numJobNodes += n
+		for _, tag := range jobs[i].Tags {
+			tagId, err := b.tagId(tag)
+			if err != nil {
+				return err
+			}
+			jobTags = jobTags.Values(id+int64(i), tagId)
+			numJobTags++
+		}
+	}
+
+	if numJobTags > 0 {
+		if _, err := jobTags.RunWith(b.tx).Exec(); err != nil {
+			log.Warnf("Error while inserting %d jobtags", numJobTags)
+			return err
+		}
+	}
+
+	if numJobNodes > 0 {
+		if _, err := jobNodes.RunWith(b.tx).Exec(); err != nil {
+			log.Warnf("Error while inserting %d job nodes", numJobNodes)
+			return err
+		}
+	}
+
+	b.inserted += len(jobs)
+	return nil
+}
+
+func (b *BulkLoader) insertOne(job *schema.Job) error {
+	res, err := b.tx.NamedExec(NamedJobInsert, job)
+	if err != nil {
+		log.Errorf("repository initDB(): %v", err)
+		b.failed++
+		return nil
+	}
+
+	id, err := res.LastInsertId()
+	if err != nil {
+		log.Warn("Error while getting last insert ID")
+		return err
+	}
+
+	if err := insertJobNodes(b.tx, id, job.Cluster, job.Resources); err != nil {
+		return err
+	}
+
+	for _, tag := range job.Tags {
+		tagId, err := b.tagId(tag)
+		if err != nil {
+			return err
+		}
+		if _, err := b.tx.Exec(`INSERT INTO jobtag (job_id, tag_id) VALUES (?, ?)`, id, tagId); err != nil {
+			log.Errorf("Error while inserting jobtag into jobtag table: %v (TagID %v)", id, tagId)
+			return err
+		}
+	}
+
+	b.inserted++
+	return nil
+}
+
+func (b *BulkLoader) tagId(tag *schema.Tag) (int64, error) {
+	tagstr := tag.Name + ":" + tag.Type
+	if id, ok := b.tags[tagstr]; ok {
+		return id, nil
+	}
+
+	res, err := b.tx.Exec(`INSERT INTO tag (tag_name, tag_type) VALUES (?, ?)`, tag.Name, tag.Type)
+	if err != nil {
+		log.Errorf("Error while inserting tag into tag table: %v (Type %v)", tag.Name, tag.Type)
+		return 0, err
+	}
+	id, err := res.LastInsertId()
+	if err != nil {
+		log.Warn("Error while getting last insert ID")
+		return 0, err
+	}
+
+	b.tags[tagstr] = id
+	return id, nil
+}
+
+// Roll back an unfinished transaction, create the indexes again, restore
+// the settings changed for the load and release the connection. Closing
+// the loader again does nothing, so that Close can also be deferred.
+func (b *BulkLoader) Close() error {
+	if b.conn == nil {
+		return nil
+	}
+	conn := b.conn
+	b.conn = nil
+	defer conn.Close()
+
+	if b.tx != nil {
+		b.tx.Rollback()
+		b.tx = nil
+	}
+
+	for _, idx := range jobIndexes[b.r.driver] {
+		log.Infof("Create index %s...", idx.name)
+		stmt := fmt.Sprintf("CREATE INDEX IF NOT EXISTS %s ON job (%s)", idx.name, idx.columns)
+		if _, err := conn.ExecContext(b.ctx, stmt); err != nil {
+			log.Errorf("Error while creating index %s: %v", idx.name, err)
+			return err
+		}
+	}
+
+	for _, stmt := range b.restore {
+		if _, err := conn.ExecContext(b.ctx, stmt); err != nil {
+			log.Warnf("Error while executing '%s'", stmt)
+			return err
+		}
+	}
+
+	return nil
+}
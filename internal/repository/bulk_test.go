@@ -0,0 +1,51 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package repository
+
+import (
+	"testing"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+	_ "github.com/mattn/go-sqlite3"
+)
+
+func TestBulkLoader(t *testing.T) {
+	r := setup(t)
+
+	bl, err := r.NewBulkLoader(2)
+	noErr(t, err)
+	noErr(t, bl.Begin())
+
+	for i := 0; i < 3; i++ {
+		job := schema.Job{BaseJob: schema.JobDefaults}
+		job.JobID = int64(9000000 + i)
+		job.User = "bulk"
+		job.Project = "bulk"
+		job.Cluster = "testcluster"
+		job.SubCluster = "sc0"
+		job.NumNodes = 1
+		job.State = schema.JobStateCompleted
+		job.StartTime = time.Unix(1700000000, 0)
+		job.StartTimeUnix = 1700000000
+		job.RawResources = []byte(`[{"hostname":"n0"}]`)
+		job.Tags = []*schema.Tag{{Type: "bulk", Name: "test"}}
+		noErr(t, bl.Add(job))
+	}
+
+	// The first two jobs are inserted as one batch, the third one is still
+	// queued. Closing rolls the transaction back, so testdata is unchanged.
+	if inserted, failed := bl.Stats(); inserted != 2 || failed != 0 {
+		t.Errorf("wrong stats\ngot: %d/%d \nwant: 2/0", inserted, failed)
+	}
+	noErr(t, bl.Close())
+	// A second Close, as deferred by the importer, does nothing
+	noErr(t, bl.Close())
+
+	jobId, cluster, startTime := int64(9000000), "testcluster", int64(1700000000)
+	if _, err := r.Find(&jobId, &cluster, &startTime); err == nil {
+		t.Error("bulk load was not rolled back")
+	}
+}
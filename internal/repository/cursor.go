@@ -0,0 +1,207 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package repository
+
+import (
+	"bytes"
+	"context"
+	"encoding/base64"
+	"encoding/json"
+	"errors"
+	"fmt"
+
+	"github.com/ClusterCockpit/cc-backend/internal/graph/model"
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+	sq "github.com/Masterminds/squirrel"
+)
+
+// Keyset pagination: instead of skipping OFFSET rows, a page continues
+// after the (sort column, id) of the last job of the previous page, so every
+// page costs the same no matter how deep. The position is handed to the
+// client as an opaque cursor.
+type cursor struct {
+	Field string      `json:"f"`
+	Desc  bool        `json:"d,omitempty"`
+	Value interface{} `json:"v"`
+	ID    int64       `json:"i"`
+}
+
+var ErrInvalidCursor = errors.New("REPOSITORY/CURSOR > invalid cursor")
+
+func (c *cursor) encode() string {
+	raw, err := json.Marshal(c)
+	if err != nil {
+		log.Warnf("Error while encoding cursor: %v", err)
+		return ""
+	}
+	return base64.RawURLEncoding.EncodeToString(raw)
+}
+
+func decodeCursor(s string) (*cursor, error) {
+	raw, err := base64.RawURLEncoding.DecodeString(s)
+	if err != nil {
+		return nil, ErrInvalidCursor
+	}
+
+	c := &cursor{}
+	dec := json.NewDecoder(bytes.NewReader(raw))
+	dec.UseNumber()
+	if err := dec.Decode(c); err != nil {
+		return nil, ErrInvalidCursor
+	}
+
+	switch v := c.Value.(type) {
+	case json.Number:
+		if i, err := v.Int64(); err == nil {
+			c.Value = i
+		} else if f, err := v.Float64(); err == nil {
+			c.Value = f
+		} else {
+			return nil, ErrInvalidCursor
+		}
+	case string, nil:
+	default:
+		return nil, ErrInvalidCursor
+	}
+	return c, nil
+}
+
+// Condition for the rows after c in the order of c. NULLs sort before all
+// other values in SQLite and MySQL.
+func (c *cursor) after(column string) sq.Sqlizer {
+	if c.Field == "" {
+		if c.Desc {
+			return sq.Lt{"job.id": c.ID}
+		}
+		return sq.Gt{"job.id": c.ID}
+	}
+
+	if c.Desc {
+		if c.Value == nil {
+			return sq.Expr(fmt.Sprintf("%s IS NULL AND job.id < ?", column), c.ID)
+		}
+		return sq.Expr(fmt.Sprintf("(%s < ? OR (%s = ? AND job.id < ?) OR %s IS NULL)", column, column, column),
+			c.Value, c.Value, c.ID)
+	}
+
+	if c.Value == nil {
+		return sq.Expr(fmt.Sprintf("(%s IS NOT NULL OR job.id > ?)", column), c.ID)
+	}
+	return sq.Expr(fmt.Sprintf("(%s > ? OR (%s = ? AND job.id > ?))", column, column), c.Value, c.ID)
+}
+
+// Appends the sort value to the columns scanned by scanJob.
+type cursorRow struct {
+	rows  interface{ Scan(...interface{}) error }
+	value *interface{}
+}
+
+func (r cursorRow) Scan(dest ...interface{}) error {
+	return r.rows.Scan(append(dest, r.value)...)
+}
+
+// Like QueryJobs, but page.Cursor (from a previous call, empty for the first
+// page) selects where the page starts and page.Page is ignored. Jobs are
+// sorted by order and then by id. The returned cursor continues after the
+// last job and is empty if there are no more jobs.
+func (r *JobRepository) QueryJobsCursor(
+	ctx context.Context,
+	filters []*model.JobFilter,
+	page *model.PageRequest,
+	order *model.OrderByInput) ([]*schema.Job, string, error) {
+
+	if page == nil {
+		page = &model.PageRequest{ItemsPerPage: -1}
+	}
+
+	field, desc := "", false
+	if order != nil {
+		field = toSnakeCase(order.Field)
+		switch order.Order {
+		case model.SortDirectionEnumAsc:
+		case model.SortDirectionEnumDesc:
+			desc = true
+		default:
+			return nil, "", errors.New("REPOSITORY/QUERY > invalid sorting order")
+		}
+	}
+	column := "job." + field
+
+	columns := jobColumns
+	if field != "" {
+		columns = append(append(make([]string, 0, len(jobColumns)+1), jobColumns...), column)
+	}
+
+	query, qerr := SecurityCheck(ctx, sq.Select(columns...).From("job"))
+	if qerr != nil {
+		return nil, "", qerr
+	}
+
+	direction := " ASC"
+	if desc {
+		direction = " DESC"
+	}
+	if field != "" {
+		query = query.OrderBy(column + direction)
+	}
+	query = query.OrderBy("job.id" + direction)
+
+	if page.Cursor != nil && *page.Cursor != "" {
+		c, err := decodeCursor(*page.Cursor)
+		if err != nil {
+			return nil, "", err
+		}
+		if c.Field != field || c.Desc != desc {
+			return nil, "", errors.New("REPOSITORY/CURSOR > cursor is for a different sort order")
+		}
+		query = query.Where(c.after(column))
+	}
+
+	limit := page.ItemsPerPage
+	if limit > 0 {
+		// One more to know if there is a next page
+		query = query.Limit(uint64(limit) + 1)
+	}
+
+	for _, f := range filters {
+		query = BuildWhereClause(f, query)
+	}
+
+	rows, err := query.RunWith(r.readCache).Query()
+	if err != nil {
+		log.Errorf("Error while running query: %v", err)
+		return nil, "", err
+	}
+	defer rows.Close()
+
+	jobs := make([]*schema.Job, 0, 50)
+	values := make([]interface{}, 0, 50)
+	for rows.Next() {
+		var value interface{}
+		var row interface{ Scan(...interface{}) error } = rows
+		if field != "" {
+			row = cursorRow{rows: rows, value: &value}
+		}
+		job, err := scanJob(row)
+		if err != nil {
+			log.Warn("Error while scanning rows (Jobs)")
+			return nil, "", err
+		}
+		if b, ok := value.([]byte); ok {
+			value = string(b)
+		}
+		jobs = append(jobs, job)
+		values = append(values, value)
+	}
+
+	if limit <= 0 || len(jobs) <= limit {
+		return jobs, "", nil
+	}
+
+	jobs, last := jobs[:limit], limit-1
+	next := &cursor{Field: field, Desc: desc, Value: values[last], ID: jobs[last].ID}
+	return jobs, next.encode(), nil
+}
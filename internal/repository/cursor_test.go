@@ -0,0 +1,68 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package repository
+
+import (
+	"testing"
+
+	"github.com/ClusterCockpit/cc-backend/internal/graph/model"
+	_ "github.com/mattn/go-sqlite3"
+)
+
+func TestQueryJobsCursor(t *testing.T) {
+	r := setup(t)
+	ctx := getContext(t)
+
+	orders := []*model.OrderByInput{
+		nil,
+		{Field: "startTime", Order: model.SortDirectionEnumDesc},
+		{Field: "cluster", Order: model.SortDirectionEnumAsc},
+	}
+
+	for _, order := range orders {
+		all, err := r.QueryJobs(ctx, []*model.JobFilter{{}}, nil, order)
+		if err != nil {
+			t.Fatal(err)
+		}
+
+		seen := make(map[int64]bool)
+		cursor, pages := "", 0
+		for {
+			jobs, next, err := r.QueryJobsCursor(ctx, []*model.JobFilter{{}},
+				&model.PageRequest{ItemsPerPage: 2, Cursor: &cursor}, order)
+			if err != nil {
+				t.Fatal(err)
+			}
+			for _, job := range jobs {
+				if seen[job.ID] {
+					t.Errorf("job %d returned twice (order %v)", job.ID, order)
+				}
+				seen[job.ID] = true
+			}
+			pages++
+			if next == "" {
+				break
+			}
+			cursor = next
+		}
+
+		if len(seen) != len(all) {
+			t.Errorf("wrong number of jobs (order %v)\ngot: %d \nwant: %d", order, len(seen), len(all))
+		}
+		if want := (len(all) + 1) / 2; pages != want {
+			t.Errorf("wrong number of pages (order %v)\ngot: %d \nwant: %d", order, pages, want)
+		}
+	}
+
+	if _, _, err := r.QueryJobsCursor(ctx, nil, &model.PageRequest{ItemsPerPage: 2, Cursor: new(string)},
+		&model.OrderByInput{Field: "user", Order: model.SortDirectionEnumAsc}); err != nil {
+		t.Fatal(err)
+	}
+
+	invalid := "not-a-cursor"
+	if _, _, err := r.QueryJobsCursor(ctx, nil, &model.PageRequest{ItemsPerPage: 2, Cursor: &invalid}, nil); err != ErrInvalidCursor {
+		t.Errorf("expected ErrInvalidCursor, got %v", err)
+	}
+}
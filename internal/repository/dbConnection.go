@@ -9,7 +9,9 @@ import (
 	"sync"
 	"time"
 
+	"github.com/ClusterCockpit/cc-backend/internal/config"
 	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/go-sql-driver/mysql"
 	"github.com/jmoiron/sqlx"
 	"github.com/mattn/go-sqlite3"
 	"github.com/qustavo/sqlhooks/v2"
@@ -21,7 +23,10 @@ var (
 )
 
 type DBConnection struct {
-	DB     *sqlx.DB
+	// Handle for writes. With a read/write split a single connection.
+	DB *sqlx.DB
+	// Handle for reads, the same as DB if reads and writes are not split.
+	Reader *sqlx.DB
 	Driver string
 }
 
@@ -31,20 +36,61 @@ type DatabaseOptions struct {
 	MaxIdleConnections    int
 	ConnectionMaxLifetime time.Duration
 	ConnectionMaxIdleTime time.Duration
+	SplitReadWrite        bool
+}
+
+// The options of config.Keys.DBPool with the defaults for everything not set.
+func databaseOptions(db string) DatabaseOptions {
+	opts := DatabaseOptions{
+		URL:                   db,
+		MaxOpenConnections:    4,
+		ConnectionMaxLifetime: time.Hour,
+		ConnectionMaxIdleTime: time.Hour,
+	}
+
+	duration := func(key, value string, d *time.Duration) {
+		if value == "" {
+			return
+		}
+		if v, err := time.ParseDuration(value); err == nil {
+			*d = v
+		} else {
+			log.Warnf("invalid db-pool %s '%s', using default of %s: %v", key, value, *d, err)
+		}
+	}
+
+	if cfg := config.Keys.DBPool; cfg != nil {
+		if cfg.MaxOpenConnections > 0 {
+			opts.MaxOpenConnections = cfg.MaxOpenConnections
+		}
+		opts.MaxIdleConnections = cfg.MaxIdleConnections
+		duration("connection-max-lifetime", cfg.ConnectionMaxLifetime, &opts.ConnectionMaxLifetime)
+		duration("connection-max-idle-time", cfg.ConnectionMaxIdleTime, &opts.ConnectionMaxIdleTime)
+		opts.SplitReadWrite = cfg.SplitReadWrite
+	}
+	if opts.MaxIdleConnections <= 0 || opts.MaxIdleConnections > opts.MaxOpenConnections {
+		opts.MaxIdleConnections = opts.MaxOpenConnections
+	}
+	return opts
+}
+
+func (opts *DatabaseOptions) apply(dbHandle *sqlx.DB, maxOpen, maxIdle int) {
+	dbHandle.SetMaxOpenConns(maxOpen)
+	dbHandle.SetMaxIdleConns(maxIdle)
+	dbHandle.SetConnMaxLifetime(opts.ConnectionMaxLifetime)
+	dbHandle.SetConnMaxIdleTime(opts.ConnectionMaxIdleTime)
 }
 
 func Connect(driver string, db string) {
 	var err error
-	var dbHandle *sqlx.DB
+	var dbHandle, readHandle *sqlx.DB
 
 	dbConnOnce.Do(func() {
-		opts := DatabaseOptions{
-			URL:                   db,
-			MaxOpenConnections:    4,
-			MaxIdleConnections:    4,
-			ConnectionMaxLifetime: time.Hour,
-			ConnectionMaxIdleTime: time.Hour,
-		}
+		opts := databaseOptions(db)
+
+		// Every query is timed for the metrics, the queries are only logged
+		// with the debug log level.
+		hooks := &Hooks{debug: log.Loglevel() == "debug"}
 
 		switch driver {
 		case "sqlite3":
@@ -53,31 +99,54 @@ func Connect(driver string, db string) {
 			// - Enable foreign key checks
 			opts.URL += "?_journal=WAL&_timeout=5000&_fk=true"
 
-			if log.Loglevel() == "debug" {
-				sql.Register("sqlite3WithHooks", sqlhooks.Wrap(&sqlite3.SQLiteDriver{}, &Hooks{}))
+			sql.Register("sqlite3WithHooks", sqlhooks.Wrap(&sqlite3.SQLiteDriver{}, hooks))
+			sqlx.BindDriver("sqlite3WithHooks", sqlx.QUESTION)
+			if !opts.SplitReadWrite {
 				dbHandle, err = sqlx.Open("sqlite3WithHooks", opts.URL)
-			} else {
-				dbHandle, err = sqlx.Open("sqlite3", opts.URL)
+				if err != nil {
+					log.Fatal(err)
+				}
+				opts.apply(dbHandle, opts.MaxOpenConnections, opts.MaxIdleConnections)
+				break
 			}
+
+			// SQLite only ever has one writer, a single connection that
+			// takes the write lock right at the start of a transaction
+			// never waits for the lock in the middle of one. In WAL mode
+			// the readers neither block the writer nor each other.
+			dbHandle, err = sqlx.Open("sqlite3WithHooks", opts.URL+"&_txlock=immediate")
 			if err != nil {
 				log.Fatal(err)
 			}
+			opts.apply(dbHandle, 1, 1)
+
+			readHandle, err = sqlx.Open("sqlite3WithHooks", opts.URL+"&_query_only=true")
+			if err != nil {
+				log.Fatal(err)
+			}
+			opts.apply(readHandle, opts.MaxOpenConnections, opts.MaxIdleConnections)
+			log.Infof("SQLite: single writer connection and %d read-only connections", opts.MaxOpenConnections)
 		case "mysql":
+			if opts.SplitReadWrite {
+				log.Warn("db-pool split-read-write is only supported for sqlite3, ignoring it")
+			}
 			opts.URL += "?multiStatements=true"
-			dbHandle, err = sqlx.Open("mysql", opts.URL)
+			sql.Register("mysqlWithHooks", sqlhooks.Wrap(&mysql.MySQLDriver{}, hooks))
+			sqlx.BindDriver("mysqlWithHooks", sqlx.QUESTION)
+			dbHandle, err = sqlx.Open("mysqlWithHooks", opts.URL)
 			if err != nil {
 				log.Fatalf("sqlx.Open() error: %v", err)
 			}
+			opts.apply(dbHandle, opts.MaxOpenConnections, opts.MaxIdleConnections)
 		default:
 			log.Fatalf("unsupported database driver: %s", driver)
 		}
 
-		dbHandle.SetMaxOpenConns(opts.MaxOpenConnections)
-		dbHandle.SetMaxIdleConns(opts.MaxIdleConnections)
-		dbHandle.SetConnMaxLifetime(opts.ConnectionMaxLifetime)
-		dbHandle.SetConnMaxIdleTime(opts.ConnectionMaxIdleTime)
+		if readHandle == nil {
+			readHandle = dbHandle
+		}
 
-		dbConnInstance = &DBConnection{DB: dbHandle, Driver: driver}
+		dbConnInstance = &DBConnection{DB: dbHandle, Reader: readHandle, Driver: driver}
 		err = checkDBVersion(driver, dbHandle.DB)
 		if err != nil {
 			log.Fatal(err)
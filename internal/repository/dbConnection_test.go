@@ -0,0 +1,43 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package repository
+
+import (
+	"testing"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/internal/config"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+func TestDatabaseOptions(t *testing.T) {
+	prev := config.Keys.DBPool
+	defer func() { config.Keys.DBPool = prev }()
+
+	config.Keys.DBPool = nil
+	opts := databaseOptions("job.db")
+	if opts.MaxOpenConnections != 4 || opts.MaxIdleConnections != 4 ||
+		opts.ConnectionMaxLifetime != time.Hour || opts.SplitReadWrite {
+		t.Errorf("wrong defaults: %#v", opts)
+	}
+
+	config.Keys.DBPool = &schema.DBPoolConfig{
+		MaxOpenConnections:    64,
+		MaxIdleConnections:    128,
+		ConnectionMaxIdleTime: "5m",
+		ConnectionMaxLifetime: "invalid",
+		SplitReadWrite:        true,
+	}
+	opts = databaseOptions("job.db")
+	if opts.MaxOpenConnections != 64 || opts.MaxIdleConnections != 64 {
+		t.Errorf("wrong pool size: %d open, %d idle", opts.MaxOpenConnections, opts.MaxIdleConnections)
+	}
+	if opts.ConnectionMaxIdleTime != 5*time.Minute || opts.ConnectionMaxLifetime != time.Hour {
+		t.Errorf("wrong durations: %s idle, %s lifetime", opts.ConnectionMaxIdleTime, opts.ConnectionMaxLifetime)
+	}
+	if !opts.SplitReadWrite {
+		t.Error("read/write split not enabled")
+	}
+}
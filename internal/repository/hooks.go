@@ -6,23 +6,125 @@ package repository
 
 import (
 	"context"
+	"runtime"
+	"strings"
+	"sync"
 	"time"
 
 	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/prometheus/client_golang/prometheus"
+	"github.com/prometheus/client_golang/prometheus/promauto"
 )
 
-// Hooks satisfies the sqlhook.Hooks interface
-type Hooks struct{}
+var (
+	queryDuration = promauto.NewHistogramVec(prometheus.HistogramOpts{
+		Namespace: "cc_backend",
+		Subsystem: "db",
+		Name:      "query_duration_seconds",
+		Help:      "Time it took to run an SQL statement by the function of cc-backend that issued it and the kind of statement.",
+		Buckets:   prometheus.ExponentialBuckets(0.0001, 2, 18),
+	}, []string{"caller", "op"})
+	queryErrors = promauto.NewCounterVec(prometheus.CounterOpts{
+		Namespace: "cc_backend",
+		Subsystem: "db",
+		Name:      "query_errors_total",
+		Help:      "Number of failed SQL statements by the function of cc-backend that issued it and the kind of statement.",
+	}, []string{"caller", "op"})
+)
+
+// Hooks satisfies the sqlhook.Hooks and sqlhooks.OnErrorer interfaces
+type Hooks struct {
+	// Log every query with its arguments and duration
+	debug bool
+}
+
+type hookKey struct{}
+
+type hookState struct {
+	begin  time.Time
+	caller string
+	op     string
+}
 
 // Before hook will print the query with it's args and return the context with the timestamp
+// and the labels of the query
 func (h *Hooks) Before(ctx context.Context, query string, args ...interface{}) (context.Context, error) {
-	log.Debugf("SQL query %s %q", query, args)
-	return context.WithValue(ctx, "begin", time.Now()), nil
+	if h.debug {
+		log.Debugf("SQL query %s %q", query, args)
+	}
+	return context.WithValue(ctx, hookKey{}, &hookState{
+		begin:  time.Now(),
+		caller: queryCaller(),
+		op:     queryKind(query),
+	}), nil
 }
 
-// After hook will get the timestamp registered on the Before hook and print the elapsed time
+// After hook will get the timestamp registered on the Before hook and record the elapsed time
 func (h *Hooks) After(ctx context.Context, query string, args ...interface{}) (context.Context, error) {
-	begin := ctx.Value("begin").(time.Time)
-	log.Debugf("Took: %s\n", time.Since(begin))
+	if state, ok := ctx.Value(hookKey{}).(*hookState); ok {
+		elapsed := time.Since(state.begin)
+		queryDuration.WithLabelValues(state.caller, state.op).Observe(elapsed.Seconds())
+		if h.debug {
+			log.Debugf("Took: %s\n", elapsed)
+		}
+	}
 	return ctx, nil
 }
+
+// OnError hook counts the failed query
+func (h *Hooks) OnError(ctx context.Context, err error, query string, args ...interface{}) error {
+	if state, ok := ctx.Value(hookKey{}).(*hookState); ok {
+		queryDuration.WithLabelValues(state.caller, state.op).Observe(time.Since(state.begin).Seconds())
+		queryErrors.WithLabelValues(state.caller, state.op).Inc()
+	}
+	return err
+}
+
+const modulePrefix = "github.com/ClusterCockpit/cc-backend/"
+
+// Label of the function a program counter belongs to, empty for functions
+// outside of cc-backend (database/sql, sqlx, squirrel, ...).
+var callerLabels sync.Map
+
+// The first function of cc-backend on the stack, that is the one that ran
+// the query through database/sql, sqlx or squirrel. The names of all program
+// counters looked up before are cached, so this is cheap.
+func queryCaller() string {
+	var pcs [32]uintptr
+	n := runtime.Callers(3, pcs[:])
+	for _, pc := range pcs[:n] {
+		label, ok := callerLabels.Load(pc)
+		if !ok {
+			label = ""
+			if fn := runtime.FuncForPC(pc - 1); fn != nil {
+				if name := fn.Name(); strings.HasPrefix(name, modulePrefix) {
+					name = strings.TrimPrefix(name, modulePrefix)
+					label = strings.TrimPrefix(name, "internal/")
+				}
+			}
+			callerLabels.Store(pc, label)
+		}
+		if label != "" {
+			return label.(string)
+		}
+	}
+	return "unknown"
+}
+
+// The kind of statement, so that the few writes of a function that mostly
+// reads are not mixed up with the reads.
+func queryKind(query string) string {
+	query = strings.TrimLeft(query, " \t\r\n(")
+	end := strings.IndexAny(query, " \t\r\n(")
+	if end < 0 {
+		end = len(query)
+	}
+
+	kind := strings.ToUpper(query[:end])
+	switch kind {
+	case "SELECT", "INSERT", "UPDATE", "DELETE", "REPLACE", "WITH", "PRAGMA", "CREATE", "DROP":
+		return kind
+	default:
+		return "OTHER"
+	}
+}
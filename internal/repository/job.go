@@ -11,11 +11,11 @@ import (
 	"errors"
 	"fmt"
 	"strconv"
+	"strings"
 	"sync"
 	"time"
 
 	"github.com/ClusterCockpit/cc-backend/internal/graph/model"
-	"github.com/ClusterCockpit/cc-backend/internal/metricdata"
 	"github.com/ClusterCockpit/cc-backend/pkg/archive"
 	"github.com/ClusterCockpit/cc-backend/pkg/log"
 	"github.com/ClusterCockpit/cc-backend/pkg/lrucache"
@@ -32,10 +32,14 @@ var (
 type JobRepository struct {
 	DB             *sqlx.DB
 	stmtCache      *sq.StmtCache
+	reader         *sqlx.DB
+	readCache      *sq.StmtCache
 	cache          *lrucache.Cache
-	archiveChannel chan *schema.Job
+	archiveChannel chan archivingRequest
+	archiveLimiter *clusterLimiter
 	driver         string
 	archivePending sync.WaitGroup
+	writer         *groupWriter
 }
 
 func GetJobRepository() *JobRepository {
@@ -47,11 +51,18 @@ func GetJobRepository() *JobRepository {
 			driver: db.Driver,
 
 			stmtCache:      sq.NewStmtCache(db.DB),
+			reader:         db.Reader,
 			cache:          lrucache.New(1024 * 1024),
-			archiveChannel: make(chan *schema.Job, 128),
+			archiveChannel: make(chan archivingRequest, 128),
 		}
-		// start archiving worker
-		go jobRepoInstance.archivingWorker()
+		// The reads go through their own pool if it is split from the writes
+		jobRepoInstance.readCache = jobRepoInstance.stmtCache
+		if db.Reader != db.DB {
+			jobRepoInstance.readCache = sq.NewStmtCache(db.Reader)
+		}
+		// start archiving workers
+		jobRepoInstance.startArchivingWorkers()
+		jobRepoInstance.startGroupWriter()
 	})
 	return jobRepoInstance
 }
@@ -116,9 +127,18 @@ func (r *JobRepository) Flush() error {
 		if _, err = r.DB.Exec(`DELETE FROM tag`); err != nil {
 			return err
 		}
+		if _, err = r.DB.Exec(`DELETE FROM job_node`); err != nil {
+			return err
+		}
 		if _, err = r.DB.Exec(`DELETE FROM job`); err != nil {
 			return err
 		}
+		if _, err = r.DB.Exec(`DELETE FROM initdb_checkpoint`); err != nil {
+			return err
+		}
+		if _, err = r.DB.Exec(`DELETE FROM job_rollup`); err != nil {
+			return err
+		}
 	case "mysql":
 		if _, err = r.DB.Exec(`SET FOREIGN_KEY_CHECKS = 0`); err != nil {
 			return err
@@ -129,9 +149,18 @@ func (r *JobRepository) Flush() error {
 		if _, err = r.DB.Exec(`TRUNCATE TABLE tag`); err != nil {
 			return err
 		}
+		if _, err = r.DB.Exec(`TRUNCATE TABLE job_node`); err != nil {
+			return err
+		}
 		if _, err = r.DB.Exec(`TRUNCATE TABLE job`); err != nil {
 			return err
 		}
+		if _, err = r.DB.Exec(`TRUNCATE TABLE initdb_checkpoint`); err != nil {
+			return err
+		}
+		if _, err = r.DB.Exec(`TRUNCATE TABLE job_rollup`); err != nil {
+			return err
+		}
 		if _, err = r.DB.Exec(`SET FOREIGN_KEY_CHECKS = 1`); err != nil {
 			return err
 		}
@@ -160,7 +189,7 @@ func (r *JobRepository) FetchMetadata(job *schema.Job) (map[string]string, error
 	}
 
 	if err := sq.Select("job.meta_data").From("job").Where("job.id = ?", job.ID).
-		RunWith(r.stmtCache).QueryRow().Scan(&job.RawMetaData); err != nil {
+		RunWith(r.readCache).QueryRow().Scan(&job.RawMetaData); err != nil {
 		log.Warn("Error while scanning for job metadata")
 		return nil, err
 	}
@@ -236,7 +265,7 @@ func (r *JobRepository) Find(
 	}
 
 	log.Debugf("Timer Find %s", time.Since(start))
-	return scanJob(q.RunWith(r.stmtCache).QueryRow())
+	return scanJob(q.RunWith(r.readCache).QueryRow())
 }
 
 // Find executes a SQL query to find a specific batch job.
@@ -260,7 +289,7 @@ func (r *JobRepository) FindAll(
 		q = q.Where("job.start_time = ?", *startTime)
 	}
 
-	rows, err := q.RunWith(r.stmtCache).Query()
+	rows, err := q.RunWith(r.readCache).Query()
 	if err != nil {
 		log.Error("Error while running query")
 		return nil, err
@@ -286,7 +315,7 @@ func (r *JobRepository) FindAll(
 func (r *JobRepository) FindById(jobId int64) (*schema.Job, error) {
 	q := sq.Select(jobColumns...).
 		From("job").Where("job.id = ?", jobId)
-	return scanJob(q.RunWith(r.stmtCache).QueryRow())
+	return scanJob(q.RunWith(r.readCache).QueryRow())
 }
 
 func (r *JobRepository) FindConcurrentJobs(
@@ -302,7 +331,7 @@ func (r *JobRepository) FindConcurrentJobs(
 		return nil, qerr
 	}
 
-	query = query.Where("cluster = ?", job.Cluster)
+	query = query.Where("job.cluster = ?", job.Cluster)
 	var startTime int64
 	var stopTime int64
 
@@ -322,13 +351,14 @@ func (r *JobRepository) FindConcurrentJobs(
 
 	queryRunning := query.Where("job.job_state = ?").Where("(job.start_time BETWEEN ? AND ? OR job.start_time < ?)",
 		"running", startTimeTail, stopTimeTail, startTime)
-	queryRunning = queryRunning.Where("job.resources LIKE ?", fmt.Sprint("%", hostname, "%"))
+	onHost := jobIdIn(jobNodeSelect().Where("job_node.hostname = ? AND job_node.cluster = ?", hostname, job.Cluster))
+	queryRunning = queryRunning.Where(onHost)
 
 	query = query.Where("job.job_state != ?").Where("((job.start_time BETWEEN ? AND ?) OR (job.start_time + job.duration) BETWEEN ? AND ? OR (job.start_time < ?) AND (job.start_time + job.duration) > ?)",
 		"running", startTimeTail, stopTimeTail, startTimeFront, stopTimeTail, startTime, stopTime)
-	query = query.Where("job.resources LIKE ?", fmt.Sprint("%", hostname, "%"))
+	query = query.Where(onHost)
 
-	rows, err := query.RunWith(r.stmtCache).Query()
+	rows, err := query.RunWith(r.readCache).Query()
 	if err != nil {
 		log.Errorf("Error while running query: %v", err)
 		return nil, err
@@ -355,7 +385,7 @@ func (r *JobRepository) FindConcurrentJobs(
 		}
 	}
 
-	rows, err = queryRunning.RunWith(r.stmtCache).Query()
+	rows, err = queryRunning.RunWith(r.readCache).Query()
 	if err != nil {
 		log.Errorf("Error while running query: %v", err)
 		return nil, err
@@ -388,6 +418,14 @@ func (r *JobRepository) FindConcurrentJobs(
 	}, nil
 }
 
+const jobStartInsert = `INSERT INTO job (
+	job_id, user, project, cluster, subcluster, ` + "`partition`" + `, array_job_id, num_nodes, num_hwthreads, num_acc,
+	exclusive, monitoring_status, smt, job_state, start_time, duration, walltime, resources, meta_data
+) VALUES (
+	:job_id, :user, :project, :cluster, :subcluster, :partition, :array_job_id, :num_nodes, :num_hwthreads, :num_acc,
+	:exclusive, :monitoring_status, :smt, :job_state, :start_time, :duration, :walltime, :resources, :meta_data
+);`
+
 // Start inserts a new job in the table, returning the unique job ID.
 // Statistics are not transfered!
 func (r *JobRepository) Start(job *schema.JobMeta) (id int64, err error) {
@@ -401,18 +439,22 @@ func (r *JobRepository) Start(job *schema.JobMeta) (id int64, err error) {
 		return -1, fmt.Errorf("REPOSITORY/JOB > encoding metaData field failed: %w", err)
 	}
 
-	res, err := r.DB.NamedExec(`INSERT INTO job (
-		job_id, user, project, cluster, subcluster, `+"`partition`"+`, array_job_id, num_nodes, num_hwthreads, num_acc,
-		exclusive, monitoring_status, smt, job_state, start_time, duration, walltime, resources, meta_data
-	) VALUES (
-		:job_id, :user, :project, :cluster, :subcluster, :partition, :array_job_id, :num_nodes, :num_hwthreads, :num_acc,
-		:exclusive, :monitoring_status, :smt, :job_state, :start_time, :duration, :walltime, :resources, :meta_data
-	);`, job)
+	res, err := r.DB.NamedExec(jobStartInsert, job)
 	if err != nil {
 		return -1, err
 	}
 
-	return res.LastInsertId()
+	id, err = res.LastInsertId()
+	if err != nil {
+		return -1, err
+	}
+
+	if err := insertJobNodes(r.DB, id, job.Cluster, job.Resources); err != nil {
+		return -1, err
+	}
+
+	r.refreshRollupOfJob(id)
+	return id, nil
 }
 
 // Stop updates the job with the database id jobId using the provided arguments.
@@ -428,7 +470,11 @@ func (r *JobRepository) Stop(
 		Set("monitoring_status", monitoringStatus).
 		Where("job.id = ?", jobId)
 
-	_, err = stmt.RunWith(r.stmtCache).Exec()
+	if _, err = stmt.RunWith(r.stmtCache).Exec(); err != nil {
+		return
+	}
+
+	r.refreshRollupOfJob(jobId)
 	return
 }
 
@@ -444,19 +490,30 @@ func (r *JobRepository) DeleteJobsBefore(startTime int64) (int, error) {
 		log.Errorf(" DeleteJobsBefore(%d) with %s: error %#v", startTime, s, err)
 	} else {
 		log.Debugf("DeleteJobsBefore(%d): Deleted %d jobs", startTime, cnt)
+		if err := r.pruneRollup(startTime); err != nil {
+			log.Errorf("Error while updating job_rollup after DeleteJobsBefore(%d): %v", startTime, err)
+		}
 	}
 	return cnt, err
 }
 
 func (r *JobRepository) DeleteJobById(id int64) error {
+	keys, err := r.rollupKeys(rollupKeysOf().Where("job.id = ?", id))
+	if err != nil {
+		log.Warnf("Error while looking up job_rollup key of job (dbid: %d)", id)
+	}
+
 	qd := sq.Delete("job").Where("job.id = ?", id)
-	_, err := qd.RunWith(r.DB).Exec()
+	_, err = qd.RunWith(r.DB).Exec()
 
 	if err != nil {
 		s, _, _ := qd.ToSql()
 		log.Errorf("DeleteJobById(%d) with %s : error %#v", id, s, err)
 	} else {
 		log.Debugf("DeleteJobById(%d): Success", id)
+		if err := r.refreshRollup(keys...); err != nil {
+			log.Errorf("Error while updating job_rollup for job (dbid: %d): %v", id, err)
+		}
 	}
 	return err
 }
@@ -470,34 +527,49 @@ func (r *JobRepository) UpdateMonitoringStatus(job int64, monitoringStatus int32
 	return
 }
 
-// Stop updates the job with the database id jobId using the provided arguments.
+// Columns of the job table with the footprint of a metric, the average or
+// (suffix _max) the maximum of the job.
+var footprintColumns = map[string]string{
+	"flops_any": "flops_any_avg",
+	"mem_used":  "mem_used_max",
+	"mem_bw":    "mem_bw_avg",
+	"load":      "load_avg",
+	"cpu_load":  "load_avg",
+	"net_bw":    "net_bw_avg",
+	"file_bw":   "file_bw_avg",
+}
+
+// MarkArchived updates the job with the database id jobId after it was
+// archived: The monitoring status, the averages of the most important metrics
+// and the roofline histogram.
 func (r *JobRepository) MarkArchived(
 	jobId int64,
 	monitoringStatus int32,
-	metricStats map[string]schema.JobStatistics,
+	jobMeta *schema.JobMeta,
 ) error {
 	stmt := sq.Update("job").
 		Set("monitoring_status", monitoringStatus).
 		Where("job.id = ?", jobId)
 
-	for metric, stats := range metricStats {
-		switch metric {
-		case "flops_any":
-			stmt = stmt.Set("flops_any_avg", stats.Avg)
-		case "mem_used":
-			stmt = stmt.Set("mem_used_max", stats.Max)
-		case "mem_bw":
-			stmt = stmt.Set("mem_bw_avg", stats.Avg)
-		case "load":
-			stmt = stmt.Set("load_avg", stats.Avg)
-		case "cpu_load":
-			stmt = stmt.Set("load_avg", stats.Avg)
-		case "net_bw":
-			stmt = stmt.Set("net_bw_avg", stats.Avg)
-		case "file_bw":
-			stmt = stmt.Set("file_bw_avg", stats.Avg)
-		default:
+	if jobMeta.Roofline != nil {
+		raw, err := json.Marshal(jobMeta.Roofline)
+		if err != nil {
+			log.Warn("Error while marshaling roofline histogram")
+			return err
+		}
+		stmt = stmt.Set("roofline", raw)
+	}
+
+	for metric, stats := range jobMeta.Statistics {
+		column, ok := footprintColumns[metric]
+		if !ok {
 			log.Debugf("MarkArchived() Metric '%v' unknown", metric)
+			continue
+		}
+		if strings.HasSuffix(column, "_max") {
+			stmt = stmt.Set(column, stats.Max)
+		} else {
+			stmt = stmt.Set(column, stats.Avg)
 		}
 	}
 
@@ -505,57 +577,9 @@ func (r *JobRepository) MarkArchived(
 		log.Warn("Error while marking job as archived")
 		return err
 	}
-	return nil
-}
-
-// Archiving worker thread
-func (r *JobRepository) archivingWorker() {
-	for {
-		select {
-		case job, ok := <-r.archiveChannel:
-			if !ok {
-				break
-			}
-			start := time.Now()
-			// not using meta data, called to load JobMeta into Cache?
-			// will fail if job meta not in repository
-			if _, err := r.FetchMetadata(job); err != nil {
-				log.Errorf("archiving job (dbid: %d) failed at check metadata step: %s", job.ID, err.Error())
-				r.UpdateMonitoringStatus(job.ID, schema.MonitoringStatusArchivingFailed)
-				continue
-			}
-
-			// metricdata.ArchiveJob will fetch all the data from a MetricDataRepository and push into configured archive backend
-			// TODO: Maybe use context with cancel/timeout here
-			jobMeta, err := metricdata.ArchiveJob(job, context.Background())
-			if err != nil {
-				log.Errorf("archiving job (dbid: %d) failed at archiving job step: %s", job.ID, err.Error())
-				r.UpdateMonitoringStatus(job.ID, schema.MonitoringStatusArchivingFailed)
-				continue
-			}
-
-			// Update the jobs database entry one last time:
-			if err := r.MarkArchived(job.ID, schema.MonitoringStatusArchivingSuccessful, jobMeta.Statistics); err != nil {
-				log.Errorf("archiving job (dbid: %d) failed at marking archived step: %s", job.ID, err.Error())
-				continue
-			}
-			log.Debugf("archiving job %d took %s", job.JobID, time.Since(start))
-			log.Printf("archiving job (dbid: %d) successful", job.ID)
-			r.archivePending.Done()
-		}
-	}
-}
 
-// Trigger async archiving
-func (r *JobRepository) TriggerArchiving(job *schema.Job) {
-	r.archivePending.Add(1)
-	r.archiveChannel <- job
-}
-
-// Wait for background thread to finish pending archiving operations
-func (r *JobRepository) WaitForArchiving() {
-	// close channel and wait for worker to process remaining jobs
-	r.archivePending.Wait()
+	r.refreshRollupOfJob(jobId)
+	return nil
 }
 
 func (r *JobRepository) FindUserOrProjectOrJobname(user *schema.User, searchterm string) (jobid string, username string, project string, jobname string) {
@@ -607,7 +631,7 @@ func (r *JobRepository) FindColumnValue(user *schema.User, searchterm string, ta
 		// }
 		// log.Debugf("SQL query (FindColumnValue): `%s`, args: %#v", theSql, args)
 
-		err := theQuery.RunWith(r.stmtCache).QueryRow().Scan(&result)
+		err := theQuery.RunWith(r.readCache).QueryRow().Scan(&result)
 
 		if err != nil && err != sql.ErrNoRows {
 			return "", err
@@ -626,7 +650,7 @@ func (r *JobRepository) FindColumnValues(user *schema.User, query string, table
 	if user.HasAnyRole([]schema.Role{schema.RoleAdmin, schema.RoleSupport, schema.RoleManager}) {
 		rows, err := sq.Select(table+"."+selectColumn).Distinct().From(table).
 			Where(table+"."+whereColumn+" LIKE ?", fmt.Sprint("%", query, "%")).
-			RunWith(r.stmtCache).Query()
+			RunWith(r.readCache).Query()
 		if err != nil && err != sql.ErrNoRows {
 			return emptyResult, err
 		} else if err == nil {
@@ -655,7 +679,7 @@ func (r *JobRepository) Partitions(cluster string) ([]string, error) {
 	start := time.Now()
 	partitions := r.cache.Get("partitions:"+cluster, func() (interface{}, time.Duration, int) {
 		parts := []string{}
-		if err = r.DB.Select(&parts, `SELECT DISTINCT job.partition FROM job WHERE job.cluster = ?;`, cluster); err != nil {
+		if err = r.reader.Select(&parts, `SELECT DISTINCT job.partition FROM job WHERE job.cluster = ?;`, cluster); err != nil {
 			return nil, 0, 1000
 		}
 
@@ -668,34 +692,70 @@ func (r *JobRepository) Partitions(cluster string) ([]string, error) {
 	return partitions.([]string), nil
 }
 
+// FetchRooflines returns the roofline histograms stored for the jobs with the
+// given database ids. Jobs without a histogram (still running or archived
+// before histograms were introduced) are missing in the result.
+func (r *JobRepository) FetchRooflines(ids []int64) (map[int64]*schema.RooflineHistogram, error) {
+	start := time.Now()
+	res := make(map[int64]*schema.RooflineHistogram, len(ids))
+	if len(ids) == 0 {
+		return res, nil
+	}
+
+	rows, err := sq.Select("job.id", "job.roofline").From("job").
+		Where(sq.Eq{"job.id": ids}).
+		Where("job.roofline IS NOT NULL").
+		RunWith(r.readCache).Query()
+	if err != nil {
+		log.Error("Error while running query")
+		return nil, err
+	}
+	defer rows.Close()
+
+	for rows.Next() {
+		var id int64
+		var raw []byte
+		if err := rows.Scan(&id, &raw); err != nil {
+			log.Warn("Error while scanning rows")
+			return nil, err
+		}
+
+		h := &schema.RooflineHistogram{}
+		if err := json.Unmarshal(raw, h); err != nil {
+			log.Warn("Error while unmarshaling raw roofline json")
+			return nil, err
+		}
+		res[id] = h
+	}
+
+	log.Debugf("Timer FetchRooflines %s", time.Since(start))
+	return res, nil
+}
+
 // AllocatedNodes returns a map of all subclusters to a map of hostnames to the amount of jobs running on that host.
 // Hosts with zero jobs running on them will not show up!
 func (r *JobRepository) AllocatedNodes(cluster string) (map[string]map[string]int, error) {
 	start := time.Now()
 	subclusters := make(map[string]map[string]int)
-	rows, err := sq.Select("resources", "subcluster").From("job").
+	rows, err := sq.Select("job.subcluster", "job_node.hostname", "COUNT(*)").From("job").
+		Join("job_node ON job_node.job_id = job.id").
 		Where("job.job_state = 'running'").
 		Where("job.cluster = ?", cluster).
-		RunWith(r.stmtCache).Query()
+		GroupBy("job.subcluster", "job_node.hostname").
+		RunWith(r.readCache).Query()
 	if err != nil {
 		log.Error("Error while running query")
 		return nil, err
 	}
 
-	var raw []byte
 	defer rows.Close()
 	for rows.Next() {
-		raw = raw[0:0]
-		var resources []*schema.Resource
-		var subcluster string
-		if err := rows.Scan(&raw, &subcluster); err != nil {
+		var subcluster, hostname string
+		var count int
+		if err := rows.Scan(&subcluster, &hostname, &count); err != nil {
 			log.Warn("Error while scanning rows")
 			return nil, err
 		}
-		if err := json.Unmarshal(raw, &resources); err != nil {
-			log.Warn("Error while unmarshaling raw resources json")
-			return nil, err
-		}
 
 		hosts, ok := subclusters[subcluster]
 		if !ok {
@@ -703,9 +763,7 @@ func (r *JobRepository) AllocatedNodes(cluster string) (map[string]map[string]in
 			subclusters[subcluster] = hosts
 		}
 
-		for _, resource := range resources {
-			hosts[resource.Hostname] += 1
-		}
+		hosts[hostname] += count
 	}
 
 	log.Debugf("Timer AllocatedNodes %s", time.Since(start))
@@ -714,13 +772,22 @@ func (r *JobRepository) AllocatedNodes(cluster string) (map[string]map[string]in
 
 func (r *JobRepository) StopJobsExceedingWalltimeBy(seconds int) error {
 	start := time.Now()
+	exceeding := fmt.Sprintf("(%d - job.start_time) > (job.walltime + %d)", start.Unix(), seconds)
+	keys, err := r.rollupKeys(rollupKeysOf().
+		Where("job.job_state = 'running'").
+		Where("job.walltime > 0").
+		Where(exceeding))
+	if err != nil {
+		log.Warn("Error while looking up job_rollup keys of jobs exceeding walltime")
+	}
+
 	res, err := sq.Update("job").
 		Set("monitoring_status", schema.MonitoringStatusArchivingFailed).
 		Set("duration", 0).
 		Set("job_state", schema.JobStateFailed).
 		Where("job.job_state = 'running'").
 		Where("job.walltime > 0").
-		Where(fmt.Sprintf("(%d - job.start_time) > (job.walltime + %d)", time.Now().Unix(), seconds)).
+		Where(exceeding).
 		RunWith(r.DB).Exec()
 	if err != nil {
 		log.Warn("Error while stopping jobs exceeding walltime")
@@ -735,6 +802,9 @@ func (r *JobRepository) StopJobsExceedingWalltimeBy(seconds int) error {
 
 	if rowsAffected > 0 {
 		log.Infof("%d jobs have been marked as failed due to running too long", rowsAffected)
+		if err := r.refreshRollup(keys...); err != nil {
+			log.Errorf("Error while updating job_rollup after stopping jobs exceeding walltime: %v", err)
+		}
 	}
 	log.Debugf("Timer StopJobsExceedingWalltimeBy %s", time.Since(start))
 	return nil
@@ -757,7 +827,7 @@ func (r *JobRepository) FindJobsBetween(startTimeBegin int64, startTimeEnd int64
 			"job.start_time BETWEEN %d AND %d", startTimeBegin, startTimeEnd))
 	}
 
-	rows, err := query.RunWith(r.stmtCache).Query()
+	rows, err := query.RunWith(r.readCache).Query()
 	if err != nil {
 		log.Error("Error while running query")
 		return nil, err
@@ -781,11 +851,11 @@ func (r *JobRepository) FindJobsBetween(startTimeBegin int64, startTimeEnd int64
 const NamedJobInsert string = `INSERT INTO job (
 	job_id, user, project, cluster, subcluster, ` + "`partition`" + `, array_job_id, num_nodes, num_hwthreads, num_acc,
 	exclusive, monitoring_status, smt, job_state, start_time, duration, walltime, resources, meta_data,
-	mem_used_max, flops_any_avg, mem_bw_avg, load_avg, net_bw_avg, net_data_vol_total, file_bw_avg, file_data_vol_total
+	mem_used_max, flops_any_avg, mem_bw_avg, load_avg, net_bw_avg, net_data_vol_total, file_bw_avg, file_data_vol_total, roofline
 ) VALUES (
 	:job_id, :user, :project, :cluster, :subcluster, :partition, :array_job_id, :num_nodes, :num_hwthreads, :num_acc,
 	:exclusive, :monitoring_status, :smt, :job_state, :start_time, :duration, :walltime, :resources, :meta_data,
-	:mem_used_max, :flops_any_avg, :mem_bw_avg, :load_avg, :net_bw_avg, :net_data_vol_total, :file_bw_avg, :file_data_vol_total
+	:mem_used_max, :flops_any_avg, :mem_bw_avg, :load_avg, :net_bw_avg, :net_data_vol_total, :file_bw_avg, :file_data_vol_total, :roofline
 );`
 
 func (r *JobRepository) InsertJob(job *schema.Job) (int64, error) {
@@ -800,5 +870,10 @@ func (r *JobRepository) InsertJob(job *schema.Job) (int64, error) {
 		return 0, err
 	}
 
+	if err := insertJobNodes(r.DB, id, job.Cluster, job.Resources); err != nil {
+		return 0, err
+	}
+
+	r.refreshRollupOfJob(id)
 	return id, nil
 }
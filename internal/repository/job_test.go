@@ -8,6 +8,7 @@ import (
 	"fmt"
 	"testing"
 
+	"github.com/ClusterCockpit/cc-backend/internal/graph/model"
 	_ "github.com/mattn/go-sqlite3"
 )
 
@@ -57,3 +58,27 @@ func TestGetTags(t *testing.T) {
 		t.Errorf("wrong tag count \ngot: %d \nwant: 0", counts["bandwidth"])
 	}
 }
+
+func TestNodeFilter(t *testing.T) {
+	r := setup(t)
+	ctx := getContext(t)
+
+	// Must match whole hostnames only, not a0223 as part of a02230
+	host := "a0223"
+	jobs, err := r.QueryJobs(ctx, []*model.JobFilter{{Node: &model.StringInput{Eq: &host}}}, nil, nil)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if len(jobs) != 1 || jobs[0].ID != 1 {
+		t.Errorf("wrong jobs on node %s\ngot: %d jobs\nwant: job 1", host, len(jobs))
+	}
+
+	prefix := "a02"
+	count, err := r.CountJobs(ctx, []*model.JobFilter{{Node: &model.StringInput{StartsWith: &prefix}}})
+	if err != nil {
+		t.Fatal(err)
+	}
+	if count != 2 {
+		t.Errorf("wrong number of jobs on nodes %s*\ngot: %d \nwant: 2", prefix, count)
+	}
+}
@@ -0,0 +1,62 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package repository
+
+import (
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+	sq "github.com/Masterminds/squirrel"
+)
+
+// The job_node table maps every host of a job to the job, so that node
+// filters, the concurrent jobs of a job and the allocated nodes of a cluster
+// are index lookups instead of scans of the JSON in job.resources. Rows are
+// deleted together with the job (ON DELETE CASCADE).
+
+// Add the rows for the hosts of the jobs to q, returns the number of rows.
+func addJobNodes(q sq.InsertBuilder, id int64, cluster string, resources []*schema.Resource) (sq.InsertBuilder, int) {
+	seen := make(map[string]bool, len(resources))
+	for _, resource := range resources {
+		if resource == nil || resource.Hostname == "" || seen[resource.Hostname] {
+			continue
+		}
+		seen[resource.Hostname] = true
+		q = q.Values(id, resource.Hostname, cluster)
+	}
+	return q, len(seen)
+}
+
+func jobNodeInsert() sq.InsertBuilder {
+	return sq.Insert("job_node").Columns("job_id", "hostname", "cluster")
+}
+
+// Insert the rows for the hosts of the job with the database id id.
+func insertJobNodes(runner sq.BaseRunner, id int64, cluster string, resources []*schema.Resource) error {
+	q, n := addJobNodes(jobNodeInsert(), id, cluster, resources)
+	if n == 0 {
+		return nil
+	}
+
+	if _, err := q.RunWith(runner).Exec(); err != nil {
+		log.Errorf("Error while inserting hosts of job (dbid: %d) into job_node table", id)
+		return err
+	}
+	return nil
+}
+
+func jobNodeSelect() sq.SelectBuilder {
+	return sq.Select("job_node.job_id").From("job_node")
+}
+
+// Condition for jobs whose database id is selected by the job_node query q
+// (see jobNodeSelect).
+func jobIdIn(q sq.SelectBuilder) sq.Sqlizer {
+	sql, args, err := q.ToSql()
+	if err != nil {
+		log.Warn("Error while converting job_node query to sql")
+		return sq.Expr("1 = 0")
+	}
+	return sq.Expr("job.id IN ("+sql+")", args...)
+}
@@ -0,0 +1 @@
+DROP TABLE IF EXISTS initdb_checkpoint;
@@ -0,0 +1,2 @@
+CREATE TABLE IF NOT EXISTS initdb_checkpoint (
+shard VARCHAR(255) PRIMARY KEY);
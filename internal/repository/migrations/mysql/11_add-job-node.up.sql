@@ -0,0 +1,13 @@
+CREATE TABLE IF NOT EXISTS job_node (
+    job_id   INTEGER NOT NULL,
+    hostname VARCHAR(255) NOT NULL,
+    cluster  VARCHAR(255) NOT NULL,
+    PRIMARY KEY (job_id, hostname),
+    FOREIGN KEY (job_id) REFERENCES job (id) ON DELETE CASCADE);
+
+CREATE INDEX job_node_by_host ON job_node (hostname, cluster);
+
+INSERT IGNORE INTO job_node (job_id, hostname, cluster)
+SELECT job.id, resource.hostname, job.cluster
+FROM job, JSON_TABLE(job.resources, '$[*]' COLUMNS (hostname VARCHAR(255) PATH '$.hostname')) AS resource
+WHERE resource.hostname IS NOT NULL;
@@ -0,0 +1,44 @@
+CREATE TABLE IF NOT EXISTS job_rollup (
+    cluster          VARCHAR(255) NOT NULL,
+    subcluster       VARCHAR(255) NOT NULL,
+    user             VARCHAR(255) NOT NULL,
+    project          VARCHAR(255) NOT NULL,
+    day              BIGINT NOT NULL, -- Unix timestamp of 00:00 UTC of the start day
+    job_state        VARCHAR(255) NOT NULL,
+
+    total_jobs       BIGINT NOT NULL DEFAULT 0,
+    -- Sums over the jobs not running (in seconds where a time)
+    total_walltime   BIGINT NOT NULL DEFAULT 0,
+    total_nodes      BIGINT NOT NULL DEFAULT 0,
+    total_node_time  BIGINT NOT NULL DEFAULT 0,
+    total_cores      BIGINT NOT NULL DEFAULT 0,
+    total_core_time  BIGINT NOT NULL DEFAULT 0,
+    total_accs       BIGINT NOT NULL DEFAULT 0,
+    total_acc_time   BIGINT NOT NULL DEFAULT 0,
+    -- Sums over the jobs running, the time is derived from the start times
+    start_time_sum   BIGINT NOT NULL DEFAULT 0,
+    start_time_nodes BIGINT NOT NULL DEFAULT 0,
+    start_time_cores BIGINT NOT NULL DEFAULT 0,
+    start_time_accs  BIGINT NOT NULL DEFAULT 0
+    );
+
+CREATE INDEX IF NOT EXISTS job_rollup_key ON job_rollup (cluster, subcluster, user, project, day);
+
+INSERT INTO job_rollup (
+    cluster, subcluster, user, project, day, job_state, total_jobs,
+    total_walltime, total_nodes, total_node_time, total_cores, total_core_time, total_accs, total_acc_time,
+    start_time_sum, start_time_nodes, start_time_cores, start_time_accs)
+SELECT cluster, subcluster, user, project, start_time - (start_time % 86400), job_state, COUNT(*),
+    SUM(CASE WHEN job_state = 'running' THEN 0 ELSE duration END),
+    SUM(num_nodes),
+    SUM(CASE WHEN job_state = 'running' THEN 0 ELSE duration * num_nodes END),
+    SUM(num_hwthreads),
+    SUM(CASE WHEN job_state = 'running' THEN 0 ELSE duration * num_hwthreads END),
+    SUM(num_acc),
+    SUM(CASE WHEN job_state = 'running' THEN 0 ELSE duration * num_acc END),
+    SUM(CASE WHEN job_state = 'running' THEN start_time ELSE 0 END),
+    SUM(CASE WHEN job_state = 'running' THEN start_time * num_nodes ELSE 0 END),
+    SUM(CASE WHEN job_state = 'running' THEN start_time * num_hwthreads ELSE 0 END),
+    SUM(CASE WHEN job_state = 'running' THEN start_time * num_acc ELSE 0 END)
+FROM job
+GROUP BY cluster, subcluster, user, project, start_time - (start_time % 86400), job_state;
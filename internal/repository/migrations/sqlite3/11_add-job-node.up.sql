@@ -0,0 +1,13 @@
+CREATE TABLE IF NOT EXISTS job_node (
+    job_id   INTEGER NOT NULL,
+    hostname VARCHAR(255) NOT NULL,
+    cluster  VARCHAR(255) NOT NULL,
+    PRIMARY KEY (job_id, hostname),
+    FOREIGN KEY (job_id) REFERENCES job (id) ON DELETE CASCADE);
+
+CREATE INDEX IF NOT EXISTS job_node_by_host ON job_node (hostname, cluster);
+
+INSERT OR IGNORE INTO job_node (job_id, hostname, cluster)
+SELECT job.id, json_extract(resource.value, '$.hostname'), job.cluster
+FROM job, json_each(job.resources) AS resource
+WHERE json_extract(resource.value, '$.hostname') IS NOT NULL;
@@ -24,6 +24,11 @@ func (r *JobRepository) QueryJobs(
 	page *model.PageRequest,
 	order *model.OrderByInput) ([]*schema.Job, error) {
 
+	if page != nil && page.Cursor != nil {
+		jobs, _, err := r.QueryJobsCursor(ctx, filters, page, order)
+		return jobs, err
+	}
+
 	query, qerr := SecurityCheck(ctx, sq.Select(jobColumns...).From("job"))
 	if qerr != nil {
 		return nil, qerr
@@ -51,7 +56,7 @@ func (r *JobRepository) QueryJobs(
 		query = BuildWhereClause(f, query)
 	}
 
-	rows, err := query.RunWith(r.stmtCache).Query()
+	rows, err := query.RunWith(r.readCache).Query()
 	if err != nil {
 		log.Errorf("Error while running query: %v", err)
 		return nil, err
@@ -85,7 +90,7 @@ func (r *JobRepository) CountJobs(
 	}
 
 	var count int
-	if err := query.RunWith(r.DB).Scan(&count); err != nil {
+	if err := query.RunWith(r.reader).Scan(&count); err != nil {
 		return 0, err
 	}
 
@@ -172,7 +177,7 @@ func BuildWhereClause(filter *model.JobFilter, query sq.SelectBuilder) sq.Select
 		query = buildIntCondition("job.num_hwthreads", filter.NumHWThreads, query)
 	}
 	if filter.Node != nil {
-		query = buildStringCondition("job.resources", filter.Node, query)
+		query = query.Where(jobIdIn(buildStringCondition("job_node.hostname", filter.Node, jobNodeSelect())))
 	}
 	if filter.FlopsAnyAvg != nil {
 		query = buildFloatCondition("job.flops_any_avg", filter.FlopsAnyAvg, query)
@@ -0,0 +1,272 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package repository
+
+import (
+	"fmt"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/internal/graph/model"
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	sq "github.com/Masterminds/squirrel"
+)
+
+// The job_rollup table holds the sums needed for the job statistics per
+// cluster, subcluster, user, project, day (UTC, of the start time) and job
+// state. Instead of maintaining it with deltas, the rows of a key are
+// computed again from the job table whenever a job of that key is started,
+// stopped, archived or deleted. This keeps it correct even if one refresh
+// fails, the next one for the same key repairs it.
+
+const secondsPerDay = 24 * 60 * 60
+
+var rollupColumns = []string{
+	"cluster", "subcluster", "user", "project", "day", "job_state", "total_jobs",
+	"total_walltime", "total_nodes", "total_node_time", "total_cores", "total_core_time", "total_accs", "total_acc_time",
+	"start_time_sum", "start_time_nodes", "start_time_cores", "start_time_accs",
+}
+
+type rollupKey struct {
+	Cluster    string `db:"cluster"`
+	SubCluster string `db:"subcluster"`
+	User       string `db:"user"`
+	Project    string `db:"project"`
+	StartTime  int64  `db:"start_time"`
+}
+
+func (k rollupKey) day() int64 {
+	return k.StartTime - k.StartTime%secondsPerDay
+}
+
+func rollupSelect() sq.SelectBuilder {
+	day := fmt.Sprintf("job.start_time - (job.start_time %% %d)", secondsPerDay)
+	finished := func(expr string) string {
+		return fmt.Sprintf("SUM(CASE WHEN job.job_state = 'running' THEN 0 ELSE %s END)", expr)
+	}
+	running := func(expr string) string {
+		return fmt.Sprintf("SUM(CASE WHEN job.job_state = 'running' THEN %s ELSE 0 END)", expr)
+	}
+
+	return sq.Select("job.cluster", "job.subcluster", "job.user", "job.project", day, "job.job_state", "COUNT(*)",
+		finished("job.duration"),
+		"SUM(job.num_nodes)",
+		finished("job.duration * job.num_nodes"),
+		"SUM(job.num_hwthreads)",
+		finished("job.duration * job.num_hwthreads"),
+		"SUM(job.num_acc)",
+		finished("job.duration * job.num_acc"),
+		running("job.start_time"),
+		running("job.start_time * job.num_nodes"),
+		running("job.start_time * job.num_hwthreads"),
+		running("job.start_time * job.num_acc"),
+	).From("job").GroupBy("job.cluster", "job.subcluster", "job.user", "job.project", day, "job.job_state")
+}
+
+// Compute the rollup rows of the keys again.
+func (r *JobRepository) refreshRollup(keys ...rollupKey) error {
+	if len(keys) == 0 {
+		return nil
+	}
+
+	tx, err := r.DB.Beginx()
+	if err != nil {
+		log.Warn("Error while starting rollup transaction")
+		return err
+	}
+	defer tx.Rollback()
+
+	for _, k := range keys {
+		if _, err := sq.Delete("job_rollup").
+			Where("cluster = ? AND subcluster = ? AND user = ? AND project = ? AND day = ?",
+				k.Cluster, k.SubCluster, k.User, k.Project, k.day()).
+			RunWith(tx).Exec(); err != nil {
+			log.Warn("Error while deleting from job_rollup")
+			return err
+		}
+
+		if _, err := sq.Insert("job_rollup").Columns(rollupColumns...).
+			Select(rollupSelect().
+				Where("job.cluster = ? AND job.subcluster = ? AND job.user = ? AND job.project = ?",
+					k.Cluster, k.SubCluster, k.User, k.Project).
+				Where("job.start_time >= ? AND job.start_time < ?", k.day(), k.day()+secondsPerDay)).
+			RunWith(tx).Exec(); err != nil {
+			log.Warn("Error while inserting into job_rollup")
+			return err
+		}
+	}
+
+	return tx.Commit()
+}
+
+func (r *JobRepository) rollupKeys(query sq.SelectBuilder) ([]rollupKey, error) {
+	sql, args, err := query.ToSql()
+	if err != nil {
+		log.Warn("Error while converting query to sql")
+		return nil, err
+	}
+
+	keys := make([]rollupKey, 0)
+	if err := r.DB.Select(&keys, sql, args...); err != nil {
+		log.Warn("Error while querying rollup keys")
+		return nil, err
+	}
+	return keys, nil
+}
+
+func rollupKeysOf() sq.SelectBuilder {
+	return sq.Select("job.cluster", "job.subcluster", "job.user", "job.project", "job.start_time").From("job")
+}
+
+// Update the rollup after the job with the database id jobId was started,
+// stopped or archived. Errors are only logged, the job table stays the
+// source of truth.
+func (r *JobRepository) refreshRollupOfJob(jobId int64) {
+	keys, err := r.rollupKeys(rollupKeysOf().Where("job.id = ?", jobId))
+	if err == nil {
+		err = r.refreshRollup(keys...)
+	}
+	if err != nil {
+		log.Errorf("Error while updating job_rollup for job (dbid: %d): %v", jobId, err)
+	}
+}
+
+// Remove the rollup rows of days before startTime and compute the partial
+// day again, called after DeleteJobsBefore.
+func (r *JobRepository) pruneRollup(startTime int64) error {
+	day := startTime - startTime%secondsPerDay
+	if _, err := sq.Delete("job_rollup").Where("day < ?", day).RunWith(r.DB).Exec(); err != nil {
+		log.Warn("Error while deleting from job_rollup")
+		return err
+	}
+
+	keys := make([]rollupKey, 0)
+	if err := r.DB.Select(&keys, `SELECT DISTINCT cluster, subcluster, user, project, day AS start_time
+		FROM job_rollup WHERE day = ?`, day); err != nil {
+		log.Warn("Error while querying rollup keys")
+		return err
+	}
+
+	return r.refreshRollup(keys...)
+}
+
+// Build the complete job_rollup table from the job table.
+func (r *JobRepository) RebuildRollup() error {
+	start := time.Now()
+	tx, err := r.DB.Beginx()
+	if err != nil {
+		log.Warn("Error while starting rollup transaction")
+		return err
+	}
+	defer tx.Rollback()
+
+	if _, err := tx.Exec(`DELETE FROM job_rollup`); err != nil {
+		log.Warn("Error while deleting from job_rollup")
+		return err
+	}
+
+	if _, err := sq.Insert("job_rollup").Columns(rollupColumns...).
+		Select(rollupSelect()).RunWith(tx).Exec(); err != nil {
+		log.Warn("Error while inserting into job_rollup")
+		return err
+	}
+
+	if err := tx.Commit(); err != nil {
+		log.Warn("Error while committing rollup transaction")
+		return err
+	}
+
+	log.Infof("Rebuilt job_rollup in %s", time.Since(start))
+	return nil
+}
+
+// Where the sums for the job statistics come from, the job table or the
+// rollup (as alias job, so that filters and SecurityCheck apply to both).
+type statsSource struct {
+	from   string
+	rollup bool
+	// Aggregate expression for the number of jobs
+	count string
+	// Per row expressions summed up, times in seconds
+	walltime, nodes, nodeTime, cores, coreTime, accs, accTime string
+}
+
+func jobStatsSource(now int64) statsSource {
+	duration := fmt.Sprintf(`(CASE WHEN job.job_state = "running" THEN %d - job.start_time ELSE job.duration END)`, now)
+	return statsSource{
+		from:     "job",
+		count:    "COUNT(job.id)",
+		walltime: duration,
+		nodes:    "job.num_nodes",
+		nodeTime: duration + " * job.num_nodes",
+		cores:    "job.num_hwthreads",
+		coreTime: duration + " * job.num_hwthreads",
+		accs:     "job.num_acc",
+		accTime:  duration + " * job.num_acc",
+	}
+}
+
+func rollupStatsSource(now int64) statsSource {
+	elapsed := func(total, start, count string) string {
+		return fmt.Sprintf(`(CASE WHEN job.job_state = "running" THEN %d * %s - %s ELSE %s END)`, now, count, start, total)
+	}
+	return statsSource{
+		from:     "job_rollup AS job",
+		rollup:   true,
+		count:    "SUM(job.total_jobs)",
+		walltime: elapsed("job.total_walltime", "job.start_time_sum", "job.total_jobs"),
+		nodes:    "job.total_nodes",
+		nodeTime: elapsed("job.total_node_time", "job.start_time_nodes", "job.total_nodes"),
+		cores:    "job.total_cores",
+		coreTime: elapsed("job.total_core_time", "job.start_time_cores", "job.total_cores"),
+		accs:     "job.total_accs",
+		accTime:  elapsed("job.total_acc_time", "job.start_time_accs", "job.total_accs"),
+	}
+}
+
+func isDayStart(t *time.Time) bool {
+	return t == nil || t.Unix()%secondsPerDay == 0
+}
+
+func isDayEnd(t *time.Time) bool {
+	return t == nil || (t.Unix()+1)%secondsPerDay == 0
+}
+
+// The rollup can answer a query if it only filters by columns of its key
+// and the start time range covers whole (UTC) days.
+func canUseRollup(filter []*model.JobFilter) bool {
+	for _, f := range filter {
+		if f.Tags != nil || f.JobID != nil || f.ArrayJobID != nil || f.JobName != nil ||
+			f.Partition != nil || f.Duration != nil || f.MinRunningFor != nil ||
+			f.NumNodes != nil || f.NumAccelerators != nil || f.NumHWThreads != nil ||
+			f.FlopsAnyAvg != nil || f.MemBwAvg != nil || f.LoadAvg != nil || f.MemUsedMax != nil ||
+			f.Exclusive != nil || f.Node != nil {
+			return false
+		}
+		if f.StartTime != nil && (!isDayStart(f.StartTime.From) || !isDayEnd(f.StartTime.To)) {
+			return false
+		}
+	}
+	return true
+}
+
+func (r *JobRepository) statsSource(filter []*model.JobFilter, now int64) statsSource {
+	if canUseRollup(filter) {
+		return rollupStatsSource(now)
+	}
+	return jobStatsSource(now)
+}
+
+func (src statsSource) where(filter []*model.JobFilter, query sq.SelectBuilder) sq.SelectBuilder {
+	for _, f := range filter {
+		if src.rollup && f.StartTime != nil {
+			rest := *f
+			rest.StartTime = nil
+			query = buildTimeCondition("job.day", f.StartTime, query)
+			f = &rest
+		}
+		query = BuildWhereClause(f, query)
+	}
+	return query
+}
@@ -45,12 +45,18 @@ func (r *JobRepository) buildCountQuery(
 
 	var query sq.SelectBuilder
 
+	// The rollup knows nothing about the duration
+	src := jobStatsSource(time.Now().Unix())
+	if kind != "short" {
+		src = r.statsSource(filter, time.Now().Unix())
+	}
+
 	if col != "" {
 		// Scan columns: id, cnt
-		query = sq.Select(col, "COUNT(job.id)").From("job").GroupBy(col)
+		query = sq.Select(col, src.count).From(src.from).GroupBy(col)
 	} else {
 		// Scan columns:  cnt
-		query = sq.Select("COUNT(job.id)").From("job")
+		query = sq.Select(src.count).From(src.from)
 	}
 
 	switch kind {
@@ -60,11 +66,7 @@ func (r *JobRepository) buildCountQuery(
 		query = query.Where("job.duration < ?", config.Keys.ShortRunningJobsDuration)
 	}
 
-	for _, f := range filter {
-		query = BuildWhereClause(f, query)
-	}
-
-	return query
+	return src.where(filter, query)
 }
 
 func (r *JobRepository) buildStatsQuery(
@@ -73,39 +75,36 @@ func (r *JobRepository) buildStatsQuery(
 
 	var query sq.SelectBuilder
 	castType := r.getCastType()
+	src := r.statsSource(filter, time.Now().Unix())
 
 	// fmt.Sprintf(`CAST(ROUND((CASE WHEN job.job_state = "running" THEN %d - job.start_time ELSE job.duration END) / 3600) as %s) as value`, time.Now().Unix(), castType)
 
 	if col != "" {
 		// Scan columns: id, totalJobs, totalWalltime, totalNodes, totalNodeHours, totalCores, totalCoreHours, totalAccs, totalAccHours
-		query = sq.Select(col, "COUNT(job.id) as totalJobs",
-			fmt.Sprintf(`CAST(ROUND(SUM((CASE WHEN job.job_state = "running" THEN %d - job.start_time ELSE job.duration END)) / 3600) as %s) as totalWalltime`, time.Now().Unix(), castType),
-			fmt.Sprintf(`CAST(SUM(job.num_nodes) as %s) as totalNodes`, castType),
-			fmt.Sprintf(`CAST(ROUND(SUM((CASE WHEN job.job_state = "running" THEN %d - job.start_time ELSE job.duration END) * job.num_nodes) / 3600) as %s) as totalNodeHours`, time.Now().Unix(), castType),
-			fmt.Sprintf(`CAST(SUM(job.num_hwthreads) as %s) as totalCores`, castType),
-			fmt.Sprintf(`CAST(ROUND(SUM((CASE WHEN job.job_state = "running" THEN %d - job.start_time ELSE job.duration END) * job.num_hwthreads) / 3600) as %s) as totalCoreHours`, time.Now().Unix(), castType),
-			fmt.Sprintf(`CAST(SUM(job.num_acc) as %s) as totalAccs`, castType),
-			fmt.Sprintf(`CAST(ROUND(SUM((CASE WHEN job.job_state = "running" THEN %d - job.start_time ELSE job.duration END) * job.num_acc) / 3600) as %s) as totalAccHours`, time.Now().Unix(), castType),
-		).From("job").GroupBy(col)
+		query = sq.Select(col, fmt.Sprintf(`CAST(%s as %s) as totalJobs`, src.count, castType),
+			fmt.Sprintf(`CAST(ROUND(SUM(%s) / 3600) as %s) as totalWalltime`, src.walltime, castType),
+			fmt.Sprintf(`CAST(SUM(%s) as %s) as totalNodes`, src.nodes, castType),
+			fmt.Sprintf(`CAST(ROUND(SUM(%s) / 3600) as %s) as totalNodeHours`, src.nodeTime, castType),
+			fmt.Sprintf(`CAST(SUM(%s) as %s) as totalCores`, src.cores, castType),
+			fmt.Sprintf(`CAST(ROUND(SUM(%s) / 3600) as %s) as totalCoreHours`, src.coreTime, castType),
+			fmt.Sprintf(`CAST(SUM(%s) as %s) as totalAccs`, src.accs, castType),
+			fmt.Sprintf(`CAST(ROUND(SUM(%s) / 3600) as %s) as totalAccHours`, src.accTime, castType),
+		).From(src.from).GroupBy(col)
 
 	} else {
 		// Scan columns: totalJobs, totalWalltime, totalNodes, totalNodeHours, totalCores, totalCoreHours, totalAccs, totalAccHours
-		query = sq.Select("COUNT(job.id)",
-			fmt.Sprintf(`CAST(ROUND(SUM((CASE WHEN job.job_state = "running" THEN %d - job.start_time ELSE job.duration END)) / 3600) as %s)`, time.Now().Unix(), castType),
-			fmt.Sprintf(`CAST(SUM(job.num_nodes) as %s)`, castType),
-			fmt.Sprintf(`CAST(ROUND(SUM((CASE WHEN job.job_state = "running" THEN %d - job.start_time ELSE job.duration END) * job.num_nodes) / 3600) as %s)`, time.Now().Unix(), castType),
-			fmt.Sprintf(`CAST(SUM(job.num_hwthreads) as %s)`, castType),
-			fmt.Sprintf(`CAST(ROUND(SUM((CASE WHEN job.job_state = "running" THEN %d - job.start_time ELSE job.duration END) * job.num_hwthreads) / 3600) as %s)`, time.Now().Unix(), castType),
-			fmt.Sprintf(`CAST(SUM(job.num_acc) as %s)`, castType),
-			fmt.Sprintf(`CAST(ROUND(SUM((CASE WHEN job.job_state = "running" THEN %d - job.start_time ELSE job.duration END) * job.num_acc) / 3600) as %s)`, time.Now().Unix(), castType),
-		).From("job")
-	}
-
-	for _, f := range filter {
-		query = BuildWhereClause(f, query)
-	}
-
-	return query
+		query = sq.Select(fmt.Sprintf(`CAST(%s as %s)`, src.count, castType),
+			fmt.Sprintf(`CAST(ROUND(SUM(%s) / 3600) as %s)`, src.walltime, castType),
+			fmt.Sprintf(`CAST(SUM(%s) as %s)`, src.nodes, castType),
+			fmt.Sprintf(`CAST(ROUND(SUM(%s) / 3600) as %s)`, src.nodeTime, castType),
+			fmt.Sprintf(`CAST(SUM(%s) as %s)`, src.cores, castType),
+			fmt.Sprintf(`CAST(ROUND(SUM(%s) / 3600) as %s)`, src.coreTime, castType),
+			fmt.Sprintf(`CAST(SUM(%s) as %s)`, src.accs, castType),
+			fmt.Sprintf(`CAST(ROUND(SUM(%s) / 3600) as %s)`, src.accTime, castType),
+		).From(src.from)
+	}
+
+	return src.where(filter, query)
 }
 
 func (r *JobRepository) getUserName(ctx context.Context, id string) string {
@@ -158,7 +157,7 @@ func (r *JobRepository) JobsStatsGrouped(
 		query = query.Offset((uint64(page.Page) - 1) * limit).Limit(limit)
 	}
 
-	rows, err := query.RunWith(r.DB).Query()
+	rows, err := query.RunWith(r.reader).Query()
 	if err != nil {
 		log.Warn("Error while querying DB for job statistics")
 		return nil, err
@@ -250,7 +249,7 @@ func (r *JobRepository) JobsStats(
 		return nil, err
 	}
 
-	row := query.RunWith(r.DB).QueryRow()
+	row := query.RunWith(r.reader).QueryRow()
 	stats := make([]*model.JobsStatistics, 0, 1)
 
 	var jobs, walltime, nodes, nodeHours, cores, coreHours, accs, accHours sql.NullInt64
@@ -296,7 +295,7 @@ func (r *JobRepository) JobCountGrouped(
 	if err != nil {
 		return nil, err
 	}
-	rows, err := query.RunWith(r.DB).Query()
+	rows, err := query.RunWith(r.reader).Query()
 	if err != nil {
 		log.Warn("Error while querying DB for job statistics")
 		return nil, err
@@ -337,7 +336,7 @@ func (r *JobRepository) AddJobCountGrouped(
 	if err != nil {
 		return nil, err
 	}
-	rows, err := query.RunWith(r.DB).Query()
+	rows, err := query.RunWith(r.reader).Query()
 	if err != nil {
 		log.Warn("Error while querying DB for job statistics")
 		return nil, err
@@ -384,7 +383,7 @@ func (r *JobRepository) AddJobCount(
 	if err != nil {
 		return nil, err
 	}
-	rows, err := query.RunWith(r.DB).Query()
+	rows, err := query.RunWith(r.reader).Query()
 	if err != nil {
 		log.Warn("Error while querying DB for job statistics")
 		return nil, err
@@ -454,7 +453,10 @@ func (r *JobRepository) AddHistograms(
 	return stat, nil
 }
 
-// Requires thresholds for metric from config for cluster? Of all clusters and use largest? split to 10 + 1 for artifacts?
+// Histograms of the footprints of the jobs matching the filter, binned
+// between 0 and the peak of each metric (see metricHistograms). For running
+// jobs the averages are loaded from the metric data repositories, otherwise
+// the footprints of all metrics are read from the job table in one pass.
 func (r *JobRepository) AddMetricHistograms(
 	ctx context.Context,
 	filter []*model.JobFilter,
@@ -473,14 +475,14 @@ func (r *JobRepository) AddMetricHistograms(
 		}
 	}
 
-	// All other cases: Query and make bins in sqlite directly
-	for _, m := range metrics {
-		metricHisto, err := r.jobsMetricStatisticsHistogram(ctx, m, filter)
-		if err != nil {
-			log.Warnf("Error while loading job metric statistics histogram: %s", m)
-			continue
-		}
-		stat.HistMetrics = append(stat.HistMetrics, metricHisto)
+	// All other cases: Stream the footprints from the database and make bins
+	histograms, err := r.jobsMetricStatisticsHistograms(ctx, metrics, filter)
+	if err != nil {
+		log.Warn("Error while loading job metric statistics histograms")
+		return nil, err
+	}
+	for _, h := range histograms {
+		stat.HistMetrics = append(stat.HistMetrics, h.result())
 	}
 
 	log.Debugf("Timer AddMetricHistograms %s", time.Since(start))
@@ -505,7 +507,7 @@ func (r *JobRepository) jobsStatisticsHistogram(
 		query = BuildWhereClause(f, query)
 	}
 
-	rows, err := query.GroupBy("value").RunWith(r.DB).Query()
+	rows, err := query.GroupBy("value").RunWith(r.reader).Query()
 	if err != nil {
 		log.Error("Error while running query")
 		return nil, err
@@ -525,133 +527,156 @@ func (r *JobRepository) jobsStatisticsHistogram(
 	return points, nil
 }
 
-func (r *JobRepository) jobsMetricStatisticsHistogram(
-	ctx context.Context,
-	metric string,
-	filters []*model.JobFilter) (*model.MetricHistoPoints, error) {
-
-	var dbMetric string
-	switch metric {
-	case "cpu_load":
-		dbMetric = "load_avg"
-	case "flops_any":
-		dbMetric = "flops_any_avg"
-	case "mem_bw":
-		dbMetric = "mem_bw_avg"
-	case "mem_used":
-		dbMetric = "mem_used_max"
-	case "net_bw":
-		dbMetric = "net_bw_avg"
-	case "file_bw":
-		dbMetric = "file_bw_avg"
-	default:
-		return nil, fmt.Errorf("%s not implemented", metric)
-	}
+const defaultMetricHistogramBins = 10
 
-	// Get specific Peak or largest Peak
-	var metricConfig *schema.MetricConfig
-	var peak float64 = 0.0
-	var unit string = ""
+// Bins of the footprint of one metric between 0 and its peak.
+type metricHistogram struct {
+	metric string
+	unit   string
+	peak   float64
+	counts []int
+}
+
+// Histograms for those of the metrics that are part of the metric config of
+// the cluster filtered for, or any cluster, with a peak. Without a cluster
+// filter the largest peak of all clusters is used.
+func metricHistograms(filters []*model.JobFilter, metrics []string) []*metricHistogram {
+	bins := defaultMetricHistogramBins
+	if config.Keys.MetricHistogramBins > 0 {
+		bins = config.Keys.MetricHistogramBins
+	}
 
+	var cluster string
 	for _, f := range filters {
-		if f.Cluster != nil {
-			metricConfig = archive.GetMetricConfig(*f.Cluster.Eq, metric)
-			peak = metricConfig.Peak
-			unit = metricConfig.Unit.Prefix + metricConfig.Unit.Base
-			log.Debugf("Cluster %s filter found with peak %f for %s", *f.Cluster.Eq, peak, metric)
+		if f.Cluster != nil && f.Cluster.Eq != nil {
+			cluster = *f.Cluster.Eq
 		}
 	}
 
-	if peak == 0.0 {
-		for _, c := range archive.Clusters {
-			for _, m := range c.MetricConfig {
-				if m.Name == metric {
-					if m.Peak > peak {
-						peak = m.Peak
-					}
-					if unit == "" {
-						unit = m.Unit.Prefix + m.Unit.Base
+	histograms := make([]*metricHistogram, 0, len(metrics))
+	for _, metric := range metrics {
+		h := &metricHistogram{metric: metric}
+		if cluster != "" {
+			if mc := archive.GetMetricConfig(cluster, metric); mc != nil {
+				h.peak, h.unit = mc.Peak, mc.Unit.Prefix+mc.Unit.Base
+			}
+		} else {
+			for _, c := range archive.Clusters {
+				for _, mc := range c.MetricConfig {
+					if mc.Name == metric {
+						if mc.Peak > h.peak {
+							h.peak = mc.Peak
+						}
+						if h.unit == "" {
+							h.unit = mc.Unit.Prefix + mc.Unit.Base
+						}
 					}
 				}
 			}
 		}
-	}
-
-	// log.Debugf("Metric %s: DB %s, Peak %f, Unit %s", metric, dbMetric, peak, unit)
-	// Make bins, see https://jereze.com/code/sql-histogram/
 
-	start := time.Now()
+		if h.peak <= 0.0 {
+			log.Debugf("no metric config with a peak for %s, no histogram", metric)
+			continue
+		}
 
-	crossJoinQuery := sq.Select(
-		fmt.Sprintf(`max(%s) as max`, dbMetric),
-		fmt.Sprintf(`min(%s) as min`, dbMetric),
-	).From("job").Where(
-		fmt.Sprintf(`%s is not null`, dbMetric),
-	).Where(
-		fmt.Sprintf(`%s <= %f`, dbMetric, peak),
-	)
+		h.counts = make([]int, bins)
+		histograms = append(histograms, h)
+	}
 
-	crossJoinQuery, cjqerr := SecurityCheck(ctx, crossJoinQuery)
+	return histograms
+}
 
-	if cjqerr != nil {
-		return nil, cjqerr
+// Values above the peak are ignored.
+func (h *metricHistogram) add(value float64) {
+	if math.IsNaN(value) || value < 0.0 || value > h.peak {
+		return
 	}
 
-	for _, f := range filters {
-		crossJoinQuery = BuildWhereClause(f, crossJoinQuery)
+	bin := int(value / h.peak * float64(len(h.counts)))
+	if bin == len(h.counts) {
+		bin -= 1
 	}
+	h.counts[bin] += 1
+}
 
-	crossJoinQuerySql, crossJoinQueryArgs, sqlerr := crossJoinQuery.ToSql()
-	if sqlerr != nil {
-		return nil, sqlerr
+func (h *metricHistogram) result() *model.MetricHistoPoints {
+	peakBin := h.peak / float64(len(h.counts))
+	points := make([]*model.MetricHistoPoint, 0, len(h.counts))
+	for b, count := range h.counts {
+		bindex := b + 1
+		bmin := int(math.Round(peakBin * float64(b)))
+		bmax := int(math.Round(peakBin * (float64(b) + 1.0)))
+		points = append(points, &model.MetricHistoPoint{Bin: &bindex, Count: count, Min: &bmin, Max: &bmax})
 	}
 
-	bins := 10
-	binQuery := fmt.Sprintf(`CAST( (case when job.%s = value.max then value.max*0.999999999 else job.%s end - value.min) / (value.max - value.min) * %d as INTEGER )`, dbMetric, dbMetric, bins)
+	return &model.MetricHistoPoints{Metric: h.metric, Unit: h.unit, Data: points}
+}
+
+// One query for the footprint columns (see footprintColumns) of all metrics.
+func (r *JobRepository) jobsMetricStatisticsHistograms(
+	ctx context.Context,
+	metrics []string,
+	filters []*model.JobFilter) ([]*metricHistogram, error) {
 
-	mainQuery := sq.Select(
-		fmt.Sprintf(`%s + 1 as bin`, binQuery),
-		fmt.Sprintf(`count(job.%s) as count`, dbMetric),
-		fmt.Sprintf(`CAST(((value.max / %d) * (%s     )) as INTEGER ) as min`, bins, binQuery),
-		fmt.Sprintf(`CAST(((value.max / %d) * (%s + 1 )) as INTEGER ) as max`, bins, binQuery),
-	).From("job").CrossJoin(
-		fmt.Sprintf(`(%s) as value`, crossJoinQuerySql), crossJoinQueryArgs...,
-	).Where(fmt.Sprintf(`job.%s is not null and job.%s <= %f`, dbMetric, dbMetric, peak))
+	start := time.Now()
+	histograms := make([]*metricHistogram, 0, len(metrics))
+	columns := make([]string, 0, len(metrics))
+	for _, h := range metricHistograms(filters, metrics) {
+		column, ok := footprintColumns[h.metric]
+		if !ok {
+			log.Debugf("no footprint of %s in the job table, no histogram", h.metric)
+			continue
+		}
+		histograms = append(histograms, h)
+		columns = append(columns, "job."+column)
+	}
 
-	mainQuery, qerr := SecurityCheck(ctx, mainQuery)
+	if len(histograms) == 0 {
+		return histograms, nil
+	}
 
+	query, qerr := SecurityCheck(ctx, sq.Select(columns...).From("job"))
 	if qerr != nil {
 		return nil, qerr
 	}
 
 	for _, f := range filters {
-		mainQuery = BuildWhereClause(f, mainQuery)
+		query = BuildWhereClause(f, query)
 	}
 
-	// Finalize query with Grouping and Ordering
-	mainQuery = mainQuery.GroupBy("bin").OrderBy("bin")
-
-	rows, err := mainQuery.RunWith(r.DB).Query()
+	rows, err := query.RunWith(r.reader).Query()
 	if err != nil {
-		log.Errorf("Error while running mainQuery: %s", err)
+		log.Errorf("Error while running query: %s", err)
 		return nil, err
 	}
+	defer rows.Close()
+
+	values := make([]sql.NullFloat64, len(histograms))
+	dest := make([]interface{}, len(histograms))
+	for i := range values {
+		dest[i] = &values[i]
+	}
 
-	points := make([]*model.MetricHistoPoint, 0)
 	for rows.Next() {
-		point := model.MetricHistoPoint{}
-		if err := rows.Scan(&point.Bin, &point.Count, &point.Min, &point.Max); err != nil {
-			log.Warnf("Error while scanning rows for %s", metric)
-			return nil, err // Totally bricks cc-backend if returned and if all metrics requested?
+		if err := rows.Scan(dest...); err != nil {
+			log.Warn("Error while scanning rows")
+			return nil, err
 		}
 
-		points = append(points, &point)
+		for i, v := range values {
+			if v.Valid {
+				histograms[i].add(v.Float64)
+			}
+		}
+	}
+	if err := rows.Err(); err != nil {
+		log.Warn("Error while iterating rows")
+		return nil, err
 	}
 
-	result := model.MetricHistoPoints{Metric: metric, Unit: unit, Data: points}
-
-	log.Debugf("Timer jobsStatisticsHistogram %s", time.Since(start))
-	return &result, nil
+	log.Debugf("Timer jobsMetricStatisticsHistograms %s", time.Since(start))
+	return histograms, nil
 }
 
 func (r *JobRepository) runningJobsMetricStatisticsHistogram(
@@ -676,78 +701,31 @@ func (r *JobRepository) runningJobsMetricStatisticsHistogram(
 		avgs[i] = make([]schema.Float, 0, len(jobs))
 	}
 
+	monitored := make([]*schema.Job, 0, len(jobs))
 	for _, job := range jobs {
 		if job.MonitoringStatus == schema.MonitoringStatusDisabled || job.MonitoringStatus == schema.MonitoringStatusArchivingFailed {
 			continue
 		}
+		monitored = append(monitored, job)
+	}
 
-		if err := metricdata.LoadAverages(job, metrics, avgs, ctx); err != nil {
-			log.Errorf("Error while loading averages for histogram: %s", err)
-			return nil
-		}
+	if err := metricdata.LoadAveragesBatch(monitored, metrics, avgs, ctx); err != nil {
+		log.Errorf("Error while loading averages for histogram: %s", err)
+		return nil
 	}
 
 	// Iterate metrics to fill endresult
 	data := make([]*model.MetricHistoPoints, 0)
-	for idx, metric := range metrics {
-		// Get specific Peak or largest Peak
-		var metricConfig *schema.MetricConfig
-		var peak float64 = 0.0
-		var unit string = ""
-
-		for _, f := range filters {
-			if f.Cluster != nil {
-				metricConfig = archive.GetMetricConfig(*f.Cluster.Eq, metric)
-				peak = metricConfig.Peak
-				unit = metricConfig.Unit.Prefix + metricConfig.Unit.Base
-				log.Debugf("Cluster %s filter found with peak %f for %s", *f.Cluster.Eq, peak, metric)
+	for _, h := range metricHistograms(filters, metrics) {
+		for idx, metric := range metrics {
+			if metric != h.metric {
+				continue
 			}
-		}
-
-		if peak == 0.0 {
-			for _, c := range archive.Clusters {
-				for _, m := range c.MetricConfig {
-					if m.Name == metric {
-						if m.Peak > peak {
-							peak = m.Peak
-						}
-						if unit == "" {
-							unit = m.Unit.Prefix + m.Unit.Base
-						}
-					}
-				}
-			}
-		}
-
-		// Make and fill bins
-		bins := 10.0
-		peakBin := peak / bins
-
-		points := make([]*model.MetricHistoPoint, 0)
-		for b := 0; b < 10; b++ {
-			count := 0
-			bindex := b + 1
-			bmin := math.Round(peakBin * float64(b))
-			bmax := math.Round(peakBin * (float64(b) + 1.0))
-
-			// Iterate AVG values for indexed metric and count for bins
 			for _, val := range avgs[idx] {
-				if float64(val) >= bmin && float64(val) < bmax {
-					count += 1
-				}
+				h.add(float64(val))
 			}
-
-			bminint := int(bmin)
-			bmaxint := int(bmax)
-
-			// Append Bin to Metric Result Array
-			point := model.MetricHistoPoint{Bin: &bindex, Count: count, Min: &bminint, Max: &bmaxint}
-			points = append(points, &point)
 		}
-
-		// Append Metric Result Array to final results array
-		result := model.MetricHistoPoints{Metric: metric, Unit: unit, Data: points}
-		data = append(data, &result)
+		data = append(data, h.result())
 	}
 
 	return data
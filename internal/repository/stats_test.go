@@ -6,9 +6,11 @@ package repository
 
 import (
 	"fmt"
+	"math"
 	"testing"
 
 	"github.com/ClusterCockpit/cc-backend/internal/graph/model"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
 )
 
 func TestBuildJobStatsQuery(t *testing.T) {
@@ -33,3 +35,60 @@ func TestJobStats(t *testing.T) {
 		t.Fatalf("Want 98, Got %d", stats[0].TotalJobs)
 	}
 }
+
+func TestJobStatsRollup(t *testing.T) {
+	r := setup(t)
+	noErr(t, r.RebuildRollup())
+
+	ctx := getContext(t)
+	groupBy := model.AggregateUser
+	if !canUseRollup([]*model.JobFilter{{}}) {
+		t.Fatal("empty filter should use the rollup")
+	}
+	fromRollup, err := r.JobsStatsGrouped(ctx, []*model.JobFilter{{}}, nil, nil, &groupBy)
+	noErr(t, err)
+
+	// Not supported by the rollup, but matches all jobs
+	filter := &model.JobFilter{Duration: &schema.IntRange{From: 0, To: math.MaxInt32}}
+	if canUseRollup([]*model.JobFilter{filter}) {
+		t.Fatal("duration filter should not use the rollup")
+	}
+	fromJobs, err := r.JobsStatsGrouped(ctx, []*model.JobFilter{filter}, nil, nil, &groupBy)
+	noErr(t, err)
+
+	if len(fromRollup) != len(fromJobs) {
+		t.Fatalf("Want %d groups, Got %d", len(fromJobs), len(fromRollup))
+	}
+	want := make(map[string][]int)
+	for _, s := range fromJobs {
+		want[s.ID] = []int{s.TotalJobs, s.TotalWalltime, s.TotalNodes, s.TotalNodeHours,
+			s.TotalCores, s.TotalCoreHours, s.TotalAccs, s.TotalAccHours}
+	}
+	for _, s := range fromRollup {
+		got := []int{s.TotalJobs, s.TotalWalltime, s.TotalNodes, s.TotalNodeHours,
+			s.TotalCores, s.TotalCoreHours, s.TotalAccs, s.TotalAccHours}
+		if fmt.Sprint(got) != fmt.Sprint(want[s.ID]) {
+			t.Errorf("%s: Want %v, Got %v", s.ID, want[s.ID], got)
+		}
+	}
+}
+
+func TestMetricHistogram(t *testing.T) {
+	h := &metricHistogram{metric: "flops_any", peak: 100, counts: make([]int, 10)}
+	for _, v := range []float64{0, 5, 9.99, 10, 55, 100, 101, -1, math.NaN()} {
+		h.add(v)
+	}
+
+	res := h.result()
+	if len(res.Data) != 10 {
+		t.Fatalf("Want 10 bins, Got %d", len(res.Data))
+	}
+
+	want := []int{3, 1, 0, 0, 0, 1, 0, 0, 0, 1}
+	for i, p := range res.Data {
+		if p.Count != want[i] || *p.Bin != i+1 || *p.Min != i*10 || *p.Max != (i+1)*10 {
+			t.Errorf("bin %d: Want count %d in [%d, %d], Got %d in [%d, %d]",
+				i+1, want[i], i*10, (i+1)*10, p.Count, *p.Min, *p.Max)
+		}
+	}
+}
@@ -79,7 +79,7 @@ func (r *JobRepository) CreateTag(tagType string, tagName string) (tagId int64,
 
 func (r *JobRepository) CountTags(user *schema.User) (tags []schema.Tag, counts map[string]int, err error) {
 	tags = make([]schema.Tag, 0, 100)
-	xrows, err := r.DB.Queryx("SELECT id, tag_type, tag_name FROM tag")
+	xrows, err := r.reader.Queryx("SELECT id, tag_type, tag_name FROM tag")
 	if err != nil {
 		return nil, nil, err
 	}
@@ -107,7 +107,7 @@ func (r *JobRepository) CountTags(user *schema.User) (tags []schema.Tag, counts
 		q = q.Where("jt.job_id IN (SELECT id FROM job WHERE job.user = ?)", user.Username)
 	}
 
-	rows, err := q.RunWith(r.stmtCache).Query()
+	rows, err := q.RunWith(r.readCache).Query()
 	if err != nil {
 		return nil, nil, err
 	}
@@ -149,7 +149,7 @@ func (r *JobRepository) TagId(tagType string, tagName string) (tagId int64, exis
 	exists = true
 	if err := sq.Select("id").From("tag").
 		Where("tag.tag_type = ?", tagType).Where("tag.tag_name = ?", tagName).
-		RunWith(r.stmtCache).QueryRow().Scan(&tagId); err != nil {
+		RunWith(r.readCache).QueryRow().Scan(&tagId); err != nil {
 		exists = false
 	}
 	return
@@ -162,7 +162,7 @@ func (r *JobRepository) GetTags(job *int64) ([]*schema.Tag, error) {
 		q = q.Join("jobtag ON jobtag.tag_id = tag.id").Where("jobtag.job_id = ?", *job)
 	}
 
-	rows, err := q.RunWith(r.stmtCache).Query()
+	rows, err := q.RunWith(r.readCache).Query()
 	if err != nil {
 		s, _, _ := q.ToSql()
 		log.Errorf("Error get tags with %s: %v", s, err)
@@ -76,6 +76,10 @@ func (r *JobRepository) TransactionAdd(t *Transaction, job schema.Job) (int64, e
 		return 0, err
 	}
 
+	if err := insertJobNodes(t.tx, id, job.Cluster, job.Resources); err != nil {
+		return 0, err
+	}
+
 	return id, nil
 }
 
@@ -102,3 +106,25 @@ func (r *JobRepository) TransactionSetTag(t *Transaction, jobId int64, tagId int
 
 	return nil
 }
+
+// Returns the archive shards already imported by InitDB.
+func (r *JobRepository) Checkpoints() (map[string]bool, error) {
+	rows, err := r.DB.Query(`SELECT shard FROM initdb_checkpoint`)
+	if err != nil {
+		log.Warn("Error while querying initdb_checkpoint table")
+		return nil, err
+	}
+	defer rows.Close()
+
+	shards := make(map[string]bool)
+	for rows.Next() {
+		var shard string
+		if err := rows.Scan(&shard); err != nil {
+			log.Warn("Error while scanning rows")
+			return nil, err
+		}
+		shards[shard] = true
+	}
+
+	return shards, nil
+}
@@ -12,9 +12,11 @@ import (
 	"fmt"
 	"strings"
 	"sync"
+	"time"
 
 	"github.com/ClusterCockpit/cc-backend/internal/graph/model"
 	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/lrucache"
 	"github.com/ClusterCockpit/cc-backend/pkg/schema"
 	sq "github.com/Masterminds/squirrel"
 	"github.com/jmoiron/sqlx"
@@ -26,9 +28,15 @@ var (
 	userRepoInstance *UserRepository
 )
 
+// Users are cached for a short time only, so that changes made by other
+// processes (e.g. `cc-backend -del-user`) show up soon. Changes made through
+// the UserRepository invalidate the cached user right away.
+const userCacheTTL = 30 * time.Second
+
 type UserRepository struct {
 	DB     *sqlx.DB
 	driver string
+	cache  *lrucache.Cache
 }
 
 func GetUserRepository() *UserRepository {
@@ -38,18 +46,50 @@ func GetUserRepository() *UserRepository {
 		userRepoInstance = &UserRepository{
 			DB:     db.DB,
 			driver: db.Driver,
+			cache:  lrucache.New(1024 * 1024),
 		}
 	})
 	return userRepoInstance
 }
 
 func (r *UserRepository) GetUser(username string) (*schema.User, error) {
+	user, err := r.getUser(username)
+	if err != nil {
+		log.Warnf("Error while querying user '%v' from database", username)
+		return nil, err
+	}
+	return user, nil
+}
+
+// The user from the cache or the database. Unknown users are cached as
+// well, as sql.ErrNoRows. The user returned is a copy that can be modified.
+func (r *UserRepository) getUser(username string) (*schema.User, error) {
+	data := r.cache.Get(username, func() (interface{}, time.Duration, int) {
+		user, err := r.queryUser(username)
+		if err == sql.ErrNoRows {
+			return err, userCacheTTL, len(username)
+		}
+		if err != nil {
+			return err, 0, len(username)
+		}
+		return user, userCacheTTL, len(username) + len(user.Password) + len(user.Name) + len(user.Email) + 64
+	})
+	if err, ok := data.(error); ok {
+		return nil, err
+	}
+
+	user := *data.(*schema.User)
+	user.Roles = append([]string(nil), user.Roles...)
+	user.Projects = append([]string(nil), user.Projects...)
+	return &user, nil
+}
+
+func (r *UserRepository) queryUser(username string) (*schema.User, error) {
 	user := &schema.User{Username: username}
 	var hashedPassword, name, rawRoles, email, rawProjects sql.NullString
 	if err := sq.Select("password", "ldap", "name", "roles", "email", "projects").From("user").
 		Where("user.username = ?", username).RunWith(r.DB).
 		QueryRow().Scan(&hashedPassword, &user.AuthSource, &name, &rawRoles, &email, &rawProjects); err != nil {
-		log.Warnf("Error while querying user '%v' from database", username)
 		return nil, err
 	}
 
@@ -71,6 +111,11 @@ func (r *UserRepository) GetUser(username string) (*schema.User, error) {
 	return user, nil
 }
 
+// Drops the cached user, called after every change of the user.
+func (r *UserRepository) InvalidateUser(username string) {
+	r.cache.Del(username)
+}
+
 func (r *UserRepository) GetLdapUsernames() ([]string, error) {
 
 	var users []string
@@ -126,6 +171,7 @@ func (r *UserRepository) AddUser(user *schema.User) error {
 		log.Errorf("Error while inserting new user '%v' into DB", user.Username)
 		return err
 	}
+	r.InvalidateUser(user.Username)
 
 	log.Infof("new user %#v created (roles: %s, auth-source: %d, projects: %s)", user.Username, rolesJson, user.AuthSource, projectsJson)
 	return nil
@@ -133,6 +179,7 @@ func (r *UserRepository) AddUser(user *schema.User) error {
 
 func (r *UserRepository) DelUser(username string) error {
 
+	defer r.InvalidateUser(username)
 	_, err := r.DB.Exec(`DELETE FROM user WHERE user.username = ?`, username)
 	if err != nil {
 		log.Errorf("Error while deleting user '%s' from DB", username)
@@ -187,6 +234,7 @@ func (r *UserRepository) AddRole(
 	ctx context.Context,
 	username string,
 	queryrole string) error {
+	defer r.InvalidateUser(username)
 
 	newRole := strings.ToLower(queryrole)
 	user, err := r.GetUser(username)
@@ -213,6 +261,7 @@ func (r *UserRepository) AddRole(
 }
 
 func (r *UserRepository) RemoveRole(ctx context.Context, username string, queryrole string) error {
+	defer r.InvalidateUser(username)
 	oldRole := strings.ToLower(queryrole)
 	user, err := r.GetUser(username)
 	if err != nil {
@@ -252,6 +301,7 @@ func (r *UserRepository) AddProject(
 	ctx context.Context,
 	username string,
 	project string) error {
+	defer r.InvalidateUser(username)
 
 	user, err := r.GetUser(username)
 	if err != nil {
@@ -275,6 +325,7 @@ func (r *UserRepository) AddProject(
 }
 
 func (r *UserRepository) RemoveProject(ctx context.Context, username string, project string) error {
+	defer r.InvalidateUser(username)
 	user, err := r.GetUser(username)
 	if err != nil {
 		return err
@@ -334,10 +385,8 @@ func (r *UserRepository) FetchUserInCtx(ctx context.Context, username string) (*
 		return nil, errors.New("forbidden")
 	}
 
-	user := &model.User{Username: username}
-	var name, email sql.NullString
-	if err := sq.Select("name", "email").From("user").Where("user.username = ?", username).
-		RunWith(r.DB).QueryRow().Scan(&name, &email); err != nil {
+	user, err := r.getUser(username)
+	if err != nil {
 		if err == sql.ErrNoRows {
 			/* This warning will be logged *often* for non-local users, i.e. users mentioned only in job-table or archive, */
 			/* since FetchUser will be called to retrieve full name and mail for every job in query/list									 */
@@ -349,7 +398,5 @@ func (r *UserRepository) FetchUserInCtx(ctx context.Context, username string) (*
 		return nil, err
 	}
 
-	user.Name = name.String
-	user.Email = email.String
-	return user, nil
+	return &model.User{Username: username, Name: user.Name, Email: user.Email}, nil
 }
@@ -0,0 +1,57 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package repository
+
+import (
+	"context"
+	"database/sql"
+	"testing"
+
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+	_ "github.com/mattn/go-sqlite3"
+)
+
+func TestUserCache(t *testing.T) {
+	setup(t)
+	r := GetUserRepository()
+	const username = "usercachetest"
+
+	r.DelUser(username)
+	if _, err := r.GetUser(username); err != sql.ErrNoRows {
+		t.Fatalf("want sql.ErrNoRows, got %v", err)
+	}
+
+	// Adding the user has to drop the cached sql.ErrNoRows
+	noErr(t, r.AddUser(&schema.User{Username: username, Roles: []string{"user"}, AuthSource: -1}))
+	defer r.DelUser(username)
+	user, err := r.GetUser(username)
+	noErr(t, err)
+	if !user.HasRole(schema.RoleUser) {
+		t.Fatalf("unexpected roles: %v", user.Roles)
+	}
+
+	// The user returned is a copy
+	user.Roles[0] = "admin"
+	user, err = r.GetUser(username)
+	noErr(t, err)
+	if user.Roles[0] != "user" {
+		t.Fatalf("cached user was modified: %v", user.Roles)
+	}
+
+	noErr(t, r.AddRole(context.Background(), username, "support"))
+	user, err = r.GetUser(username)
+	noErr(t, err)
+	if !user.HasRole(schema.RoleSupport) {
+		t.Errorf("new role missing: %v", user.Roles)
+	}
+
+	noErr(t, r.DelUser(username))
+	if _, err := r.GetUser(username); err != sql.ErrNoRows {
+		t.Errorf("deleted user still found: %v", err)
+	}
+	if u, err := r.FetchUserInCtx(context.Background(), username); u != nil || err != nil {
+		t.Errorf("want no user, got %v (%v)", u, err)
+	}
+}
@@ -0,0 +1,343 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package repository
+
+import (
+	"database/sql"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/internal/config"
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+	sq "github.com/Masterminds/squirrel"
+	"github.com/jmoiron/sqlx"
+	"github.com/prometheus/client_golang/prometheus"
+	"github.com/prometheus/client_golang/prometheus/promauto"
+)
+
+const (
+	defaultGroupCommitDelay     = 5 * time.Millisecond
+	defaultGroupCommitBatchSize = 256
+)
+
+var (
+	groupCommitSize = promauto.NewHistogram(prometheus.HistogramOpts{
+		Namespace: "cc_backend",
+		Subsystem: "db_writer",
+		Name:      "batch_size",
+		Help:      "Number of job starts and stops committed in one transaction.",
+		Buckets:   prometheus.ExponentialBuckets(1, 2, 10),
+	})
+	groupCommitDuration = promauto.NewHistogram(prometheus.HistogramOpts{
+		Namespace: "cc_backend",
+		Subsystem: "db_writer",
+		Name:      "commit_seconds",
+		Help:      "Time it took to write and commit a batch.",
+		Buckets:   prometheus.ExponentialBuckets(0.001, 2, 14),
+	})
+)
+
+// Returned by StartJobs for a job with the same jobId and cluster as one
+// started less than a day before.
+var ErrJobExists = errors.New("a job with that jobId, cluster and startTime already exists")
+
+// Returned by StopJobs for a job that is not running (anymore), for example
+// because it was stopped by an earlier request of the same batch.
+var ErrJobNotRunning = errors.New("job is not running")
+
+// JobStop describes the update of StopJobs to a running job.
+type JobStop struct {
+	ID               int64
+	Duration         int32
+	State            schema.JobState
+	MonitoringStatus int32
+}
+
+// A write to the job table waiting for the group commit writer.
+type writeRequest struct {
+	apply func(tx *sqlx.Tx) (int64, error)
+	id    int64
+	err   error
+	done  chan struct{}
+}
+
+// The group commit writer collects the job starts and stops arriving within
+// a few milliseconds of each other and writes them in one transaction. With
+// SQLite only one transaction can write at a time, so this turns a burst of
+// single requests fighting for the lock into a few commits. Every request is
+// applied in its own savepoint, a failing one does not affect the others.
+type groupWriter struct {
+	r         *JobRepository
+	queue     chan *writeRequest
+	delay     time.Duration
+	batchSize int
+}
+
+// Start the group commit writer as configured in config.Keys.GroupCommit.
+func (r *JobRepository) startGroupWriter() {
+	delay, batchSize := defaultGroupCommitDelay, defaultGroupCommitBatchSize
+	if cfg := config.Keys.GroupCommit; cfg != nil {
+		if cfg.MaxDelay != "" {
+			if d, err := time.ParseDuration(cfg.MaxDelay); err == nil {
+				delay = d
+			} else {
+				log.Warnf("invalid group commit max-delay '%s', using default of %s: %v", cfg.MaxDelay, defaultGroupCommitDelay, err)
+			}
+		}
+		if cfg.MaxBatchSize > 0 {
+			batchSize = cfg.MaxBatchSize
+		}
+	}
+
+	r.writer = &groupWriter{
+		r:         r,
+		queue:     make(chan *writeRequest, batchSize),
+		delay:     delay,
+		batchSize: batchSize,
+	}
+	go r.writer.run()
+}
+
+func (w *groupWriter) submit(apply func(tx *sqlx.Tx) (int64, error)) *writeRequest {
+	req := &writeRequest{apply: apply, done: make(chan struct{})}
+	w.queue <- req
+	return req
+}
+
+func (w *groupWriter) run() {
+	timer := time.NewTimer(w.delay)
+	timer.Stop()
+	for req := range w.queue {
+		batch := []*writeRequest{req}
+		timer.Reset(w.delay)
+	collect:
+		for len(batch) < w.batchSize {
+			select {
+			case req := <-w.queue:
+				batch = append(batch, req)
+			case <-timer.C:
+				break collect
+			}
+		}
+		if !timer.Stop() {
+			select {
+			case <-timer.C:
+			default:
+			}
+		}
+
+		w.commit(batch)
+	}
+}
+
+func (w *groupWriter) commit(batch []*writeRequest) {
+	start := time.Now()
+	defer func() {
+		for _, req := range batch {
+			close(req.done)
+		}
+	}()
+
+	fail := func(err error) {
+		for _, req := range batch {
+			if req.err == nil {
+				req.err = err
+			}
+		}
+	}
+
+	tx, err := w.r.DB.Beginx()
+	if err != nil {
+		log.Warn("Error while starting group commit transaction")
+		fail(err)
+		return
+	}
+
+	ids := make([]int64, 0, len(batch))
+	for _, req := range batch {
+		if _, err := tx.Exec(`SAVEPOINT job_write`); err != nil {
+			log.Warn("Error while creating savepoint")
+			tx.Rollback()
+			fail(err)
+			return
+		}
+
+		req.id, req.err = req.apply(tx)
+		if req.err != nil {
+			if _, err := tx.Exec(`ROLLBACK TO SAVEPOINT job_write`); err != nil {
+				log.Warn("Error while rolling back to savepoint")
+				tx.Rollback()
+				fail(err)
+				return
+			}
+		} else {
+			ids = append(ids, req.id)
+		}
+
+		if _, err := tx.Exec(`RELEASE SAVEPOINT job_write`); err != nil {
+			log.Warn("Error while releasing savepoint")
+			tx.Rollback()
+			fail(err)
+			return
+		}
+	}
+
+	if err := tx.Commit(); err != nil {
+		log.Warn("Error while committing group commit transaction")
+		fail(err)
+		return
+	}
+
+	groupCommitSize.Observe(float64(len(batch)))
+	groupCommitDuration.Observe(time.Since(start).Seconds())
+	w.r.refreshRollupOfJobs(ids)
+}
+
+// Update the rollup after the jobs with the database ids were written, each
+// affected key is only computed once.
+func (r *JobRepository) refreshRollupOfJobs(ids []int64) {
+	if len(ids) == 0 {
+		return
+	}
+
+	keys, err := r.rollupKeys(rollupKeysOf().Where(sq.Eq{"job.id": ids}))
+	if err == nil {
+		seen := make(map[rollupKey]bool, len(keys))
+		unique := keys[:0]
+		for _, k := range keys {
+			k.StartTime = k.day()
+			if !seen[k] {
+				seen[k] = true
+				unique = append(unique, k)
+			}
+		}
+		err = r.refreshRollup(unique...)
+	}
+	if err != nil {
+		log.Errorf("Error while updating job_rollup for %d jobs: %v", len(ids), err)
+	}
+}
+
+func findTagId(tx *sqlx.Tx, tag *schema.Tag) (int64, error) {
+	var id int64
+	err := tx.QueryRow(`SELECT id FROM tag WHERE tag_type = ? AND tag_name = ?`, tag.Type, tag.Name).Scan(&id)
+	if err == nil {
+		return id, nil
+	}
+
+	res, err := tx.Exec(`INSERT INTO tag (tag_type, tag_name) VALUES (?, ?)`, tag.Type, tag.Name)
+	if err != nil {
+		log.Errorf("Error while inserting tag into tag table: %v (Type %v)", tag.Name, tag.Type)
+		return 0, err
+	}
+	return res.LastInsertId()
+}
+
+// Insert the job with its hosts and tags, fails with ErrJobExists if the
+// same jobId was started on the cluster less than a day before.
+func startJobTx(tx *sqlx.Tx, job *schema.JobMeta) (int64, error) {
+	var existing int64
+	err := tx.QueryRow(`SELECT id FROM job WHERE job_id = ? AND cluster = ? AND ? - start_time < 86400 LIMIT 1`,
+		job.JobID, job.Cluster, job.StartTime).Scan(&existing)
+	if err == nil {
+		return 0, fmt.Errorf("%w: dbid: %d, jobid: %d", ErrJobExists, existing, job.JobID)
+	} else if err != sql.ErrNoRows {
+		log.Warn("Error while checking for an existing job")
+		return 0, err
+	}
+
+	job.RawResources, err = json.Marshal(job.Resources)
+	if err != nil {
+		return 0, fmt.Errorf("REPOSITORY/JOB > encoding resources field failed: %w", err)
+	}
+
+	job.RawMetaData, err = json.Marshal(job.MetaData)
+	if err != nil {
+		return 0, fmt.Errorf("REPOSITORY/JOB > encoding metaData field failed: %w", err)
+	}
+
+	res, err := tx.NamedExec(jobStartInsert, job)
+	if err != nil {
+		return 0, err
+	}
+
+	id, err := res.LastInsertId()
+	if err != nil {
+		return 0, err
+	}
+
+	if err := insertJobNodes(tx, id, job.Cluster, job.Resources); err != nil {
+		return 0, err
+	}
+
+	for _, tag := range job.Tags {
+		tagId, err := findTagId(tx, tag)
+		if err != nil {
+			return 0, err
+		}
+		if _, err := tx.Exec(`INSERT INTO jobtag (job_id, tag_id) VALUES (?, ?)`, id, tagId); err != nil {
+			log.Errorf("Error while inserting jobtag into jobtag table: %v (TagID %v)", id, tagId)
+			return 0, err
+		}
+	}
+
+	return id, nil
+}
+
+// StartJobs inserts the jobs together with their tags through the group
+// commit writer. The database ids and errors are returned per job.
+func (r *JobRepository) StartJobs(jobs []*schema.JobMeta) ([]int64, []error) {
+	reqs := make([]*writeRequest, len(jobs))
+	for i, job := range jobs {
+		job := job
+		reqs[i] = r.writer.submit(func(tx *sqlx.Tx) (int64, error) {
+			return startJobTx(tx, job)
+		})
+	}
+
+	ids, errs := make([]int64, len(jobs)), make([]error, len(jobs))
+	for i, req := range reqs {
+		<-req.done
+		ids[i], errs[i] = req.id, req.err
+	}
+	return ids, errs
+}
+
+// StopJobs updates the jobs like Stop does through the group commit writer.
+// The errors are returned per job, ErrJobNotRunning for a job not running.
+func (r *JobRepository) StopJobs(stops []JobStop) []error {
+	reqs := make([]*writeRequest, len(stops))
+	for i, stop := range stops {
+		stop := stop
+		reqs[i] = r.writer.submit(func(tx *sqlx.Tx) (int64, error) {
+			res, err := sq.Update("job").
+				Set("job_state", stop.State).
+				Set("duration", stop.Duration).
+				Set("monitoring_status", stop.MonitoringStatus).
+				Where("job.id = ?", stop.ID).
+				Where("job.job_state = ?", schema.JobStateRunning).
+				RunWith(tx).Exec()
+			if err != nil {
+				return 0, err
+			}
+			if n, err := res.RowsAffected(); err != nil {
+				return 0, err
+			} else if n == 0 {
+				return 0, fmt.Errorf("REPOSITORY/JOB > %w (dbid: %d)", ErrJobNotRunning, stop.ID)
+			}
+			return stop.ID, nil
+		})
+	}
+
+	errs := make([]error, len(stops))
+	for i, req := range reqs {
+		<-req.done
+		errs[i] = req.err
+	}
+	return errs
+}
@@ -12,7 +12,17 @@ import (
 	"github.com/ClusterCockpit/cc-backend/pkg/log"
 )
 
+// Compresses fileIn to fileOut with gzip and removes fileIn. fileOut is
+// written under a temporary name first, so an interrupted run never leaves a
+// truncated fileOut or removes fileIn before fileOut is complete.
 func CompressFile(fileIn string, fileOut string) error {
+	return CompressFileWith(fileIn, fileOut, func(w io.Writer) (io.WriteCloser, error) {
+		return gzip.NewWriter(w), nil
+	})
+}
+
+// Like CompressFile, with the compressor returned by newWriter.
+func CompressFileWith(fileIn string, fileOut string, newWriter func(w io.Writer) (io.WriteCloser, error)) error {
 	originalFile, err := os.Open(fileIn)
 	if err != nil {
 		log.Errorf("CompressFile() error: %v", err)
@@ -20,23 +30,32 @@ func CompressFile(fileIn string, fileOut string) error {
 	}
 	defer originalFile.Close()
 
-	gzippedFile, err := os.Create(fileOut)
-
+	tmpFile := fileOut + ".tmp"
+	compressedFile, err := os.Create(tmpFile)
 	if err != nil {
 		log.Errorf("CompressFile() error: %v", err)
 		return err
 	}
-	defer gzippedFile.Close()
-
-	gzipWriter := gzip.NewWriter(gzippedFile)
-	defer gzipWriter.Close()
 
-	_, err = io.Copy(gzipWriter, originalFile)
+	writer, err := newWriter(compressedFile)
+	if err == nil {
+		_, err = io.Copy(writer, originalFile)
+		if cerr := writer.Close(); err == nil {
+			err = cerr
+		}
+	}
+	if cerr := compressedFile.Close(); err == nil {
+		err = cerr
+	}
+	if err == nil {
+		err = os.Rename(tmpFile, fileOut)
+	}
 	if err != nil {
 		log.Errorf("CompressFile() error: %v", err)
+		os.Remove(tmpFile)
 		return err
 	}
-	gzipWriter.Flush()
+
 	if err := os.Remove(fileIn); err != nil {
 		log.Errorf("CompressFile() error: %v", err)
 		return err
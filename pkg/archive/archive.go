@@ -26,6 +26,10 @@ type ArchiveBackend interface {
 
 	LoadJobData(job *schema.Job) (schema.JobData, error)
 
+	// Like LoadJobData, but only metrics and scopes requested are loaded
+	// (nil selects all). See SubsetScopes for how scopes are selected.
+	LoadJobDataSubset(job *schema.Job, metrics []string, scopes []schema.MetricScope) (schema.JobData, error)
+
 	LoadClusterCfg(name string) (*schema.Cluster, error)
 
 	StoreJobMeta(jobMeta *schema.JobMeta) error
@@ -34,17 +38,28 @@ type ArchiveBackend interface {
 
 	GetClusters() []string
 
+	// CleanUp, Move and Compress process the jobs in parallel, with the
+	// workers and bandwidth of the maintenance config.
 	CleanUp(jobs []*schema.Job)
 
 	Move(jobs []*schema.Job, path string)
 
 	Clean(before int64, after int64)
 
+	// Compress persists the start time up to which all jobs are done while
+	// it runs, so that an interrupted run resumes from there.
 	Compress(jobs []*schema.Job)
 
+	// The start time persisted by Compress, starttime if there was no
+	// run yet.
 	CompressLast(starttime int64) int64
 
 	Iter(loadMetricData bool) <-chan JobContainer
+
+	// Scan the archive shard by shard using numWorkers goroutines (0 for
+	// one per CPU). Every shard is sent with all of its jobs at once, shards
+	// in skip are left out. Used to resume an interrupted scan.
+	IterShards(skip map[string]bool, numWorkers int) <-chan JobShard
 }
 
 type JobContainer struct {
@@ -52,8 +67,13 @@ type JobContainer struct {
 	Data *schema.JobData
 }
 
+type JobShard struct {
+	Name string
+	Jobs []*schema.JobMeta
+}
+
 var (
-	cache      *lrucache.Cache = lrucache.New(128 * 1024 * 1024)
+	cache      *lrucache.Cache = lrucache.NewSharded(128*1024*1024, lrucache.DefaultShards)
 	ar         ArchiveBackend
 	useArchive bool
 )
@@ -62,7 +82,9 @@ func Init(rawConfig json.RawMessage, disableArchive bool) error {
 	useArchive = !disableArchive
 
 	var cfg struct {
-		Kind string `json:"kind"`
+		Kind        string             `json:"kind"`
+		Codec       string             `json:"compression-codec"`
+		Maintenance *MaintenanceConfig `json:"maintenance"`
 	}
 
 	if err := json.Unmarshal(rawConfig, &cfg); err != nil {
@@ -70,11 +92,17 @@ func Init(rawConfig json.RawMessage, disableArchive bool) error {
 		return err
 	}
 
+	initMaintenance(cfg.Maintenance)
+	if err := initCodec(cfg.Codec); err != nil {
+		log.Error("Error while initializing compression codec")
+		return err
+	}
+
 	switch cfg.Kind {
 	case "file":
 		ar = &FsArchive{}
-		// case "s3":
-		// 	ar = &S3Archive{}
+	case "s3":
+		ar = &S3Archive{}
 	default:
 		return fmt.Errorf("ARCHIVE/ARCHIVE > unkown archive backend '%s''", cfg.Kind)
 	}
@@ -93,6 +121,11 @@ func GetHandle() ArchiveBackend {
 	return ar
 }
 
+// The cache of job data decoded from the archive, for its metrics.
+func Cache() *lrucache.Cache {
+	return cache
+}
+
 // Helper to metricdata.LoadAverages().
 func LoadAveragesFromArchive(
 	job *schema.Job,
@@ -169,3 +202,77 @@ func UpdateTags(job *schema.Job, tags []*schema.Tag) error {
 
 	return ar.StoreJobMeta(jobMeta)
 }
+
+// SubsetScopes returns which of the scopes available for a metric are loaded
+// for the scopes requested. If a metric is only available at one scope or at
+// none of the requested, all scopes are returned so that the caller can
+// derive the requested scope (e.g. node from core using AddNodeScope).
+func SubsetScopes(available []schema.MetricScope, scopes []schema.MetricScope) []schema.MetricScope {
+	if scopes == nil || len(available) <= 1 {
+		return available
+	}
+
+	subset := make([]schema.MetricScope, 0, len(scopes))
+	for _, scope := range available {
+		if containsScope(scopes, scope) {
+			subset = append(subset, scope)
+		}
+	}
+	if len(subset) == 0 {
+		return available
+	}
+
+	return subset
+}
+
+// FilterJobData returns the subset of an already loaded job data set as
+// selected by LoadJobDataSubset. Metrics are not copied.
+func FilterJobData(jd schema.JobData, metrics []string, scopes []schema.MetricScope) schema.JobData {
+	if metrics == nil && scopes == nil {
+		return jd
+	}
+
+	res := make(schema.JobData, len(jd))
+	for metric, perScope := range jd {
+		if !containsMetric(metrics, metric) {
+			continue
+		}
+
+		available := make([]schema.MetricScope, 0, len(perScope))
+		for scope := range perScope {
+			available = append(available, scope)
+		}
+
+		subset := make(map[schema.MetricScope]*schema.JobMetric, len(perScope))
+		for _, scope := range SubsetScopes(available, scopes) {
+			subset[scope] = perScope[scope]
+		}
+		res[metric] = subset
+	}
+
+	return res
+}
+
+func containsMetric(metrics []string, metric string) bool {
+	if metrics == nil {
+		return true
+	}
+	for _, m := range metrics {
+		if m == metric {
+			return true
+		}
+	}
+	return false
+}
+
+func containsScope(scopes []schema.MetricScope, scope schema.MetricScope) bool {
+	if scopes == nil {
+		return true
+	}
+	for _, s := range scopes {
+		if s == scope {
+			return true
+		}
+	}
+	return false
+}
@@ -0,0 +1,104 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package archive
+
+import (
+	"encoding/json"
+	"fmt"
+	"testing"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/internal/benchdata"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+// A synthetic archive with the jobs of benchdata.FromEnv() in the format
+// "json" or "binary", kept in benchdata.Dir() for later runs. Returns the
+// archive and the archived jobs.
+func setupBenchArchive(b *testing.B, format string) (*FsArchive, []*schema.Job) {
+	b.Helper()
+	cfg, err := benchdata.FromEnv()
+	if err != nil {
+		b.Fatal(err)
+	}
+
+	archiveCfg := func(path string) json.RawMessage {
+		return json.RawMessage(fmt.Sprintf(`{"path": "%s", "format": "%s"}`, path, format))
+	}
+
+	path, err := benchdata.Cached(cfg.DataName(cfg.ArchiveJobs)+"-archive-"+format, func(path string) error {
+		if err := cfg.InitArchive(path, Version); err != nil {
+			return err
+		}
+		var fsa FsArchive
+		if _, err := fsa.Init(archiveCfg(path)); err != nil {
+			return err
+		}
+		return cfg.ImportJobs(cfg.ArchiveJobs, true, fsa.ImportJob)
+	})
+	if err != nil {
+		b.Fatal(err)
+	}
+
+	fsa := &FsArchive{}
+	if _, err := fsa.Init(archiveCfg(path)); err != nil {
+		b.Fatal(err)
+	}
+
+	jobs := make([]*schema.Job, 0, cfg.ArchiveJobs)
+	g := cfg.Generator(cfg.ArchiveJobs)
+	for meta := g.Next(); meta != nil; meta = g.Next() {
+		if meta.State != schema.JobStateRunning {
+			jobs = append(jobs, &schema.Job{
+				BaseJob:       meta.BaseJob,
+				StartTime:     time.Unix(meta.StartTime, 0),
+				StartTimeUnix: meta.StartTime,
+			})
+		}
+	}
+	return fsa, jobs
+}
+
+func BenchmarkFsArchive_LoadJobData(b *testing.B) {
+	for _, format := range []string{"json", "binary"} {
+		fsa, jobs := setupBenchArchive(b, format)
+
+		b.Run(format, func(b *testing.B) {
+			for i := 0; i < b.N; i++ {
+				if _, err := fsa.LoadJobData(jobs[i%len(jobs)]); err != nil {
+					b.Fatal(err)
+				}
+			}
+		})
+
+		b.Run(format+"/Subset", func(b *testing.B) {
+			metrics := []string{"flops_any", "mem_bw"}
+			scopes := []schema.MetricScope{schema.MetricScopeNode}
+			for i := 0; i < b.N; i++ {
+				if _, err := fsa.LoadJobDataSubset(jobs[i%len(jobs)], metrics, scopes); err != nil {
+					b.Fatal(err)
+				}
+			}
+		})
+	}
+}
+
+func BenchmarkFsArchive_Iter(b *testing.B) {
+	fsa, jobs := setupBenchArchive(b, "json")
+
+	for _, loadMetricData := range []bool{false, true} {
+		b.Run(fmt.Sprintf("metricData=%v", loadMetricData), func(b *testing.B) {
+			for i := 0; i < b.N; i++ {
+				n := 0
+				for range fsa.Iter(loadMetricData) {
+					n++
+				}
+				if n != len(jobs) {
+					b.Fatalf("Want %d jobs, Got %d", len(jobs), n)
+				}
+			}
+		})
+	}
+}
@@ -0,0 +1,374 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package archive
+
+import (
+	"bufio"
+	"bytes"
+	"encoding/binary"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"io"
+	"math"
+	"os"
+	"sort"
+	"strconv"
+
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+// Columnar binary job data format (data.bin):
+//
+//	magic      [4]byte "CCJD"
+//	version    uint32
+//	indexSize  uint32
+//	index      indexSize bytes of JSON (binaryIndex)
+//	columns    raw little endian float32 or float64 values
+//
+// The index describes every metric/scope and the position of its columns
+// relative to the start of the column section. All columns of one metric and
+// scope are stored contiguously so that they can be read with a single
+// ReadAt, the remaining file is never touched.
+
+var binaryMagic = [4]byte{'C', 'C', 'J', 'D'}
+
+const (
+	binaryVersion    uint32 = 1
+	binaryHeaderSize        = 12
+
+	columnFloat32 uint8 = 4
+	columnFloat64 uint8 = 8
+)
+
+// Returned for offsets, sizes and lengths in the index not matching the file.
+var errBinaryCorrupt = errors.New("ARCHIVE/BINARY > corrupt binary job data")
+
+// The size of the binary job data behind r, so that sizes taken from the
+// index can be checked before anything is allocated for them.
+func binarySize(r io.ReaderAt) (int64, error) {
+	switch r := r.(type) {
+	case interface{ Size() int64 }:
+		return r.Size(), nil
+	case *os.File:
+		fi, err := r.Stat()
+		if err != nil {
+			log.Warn("Error while reading size of binary job data file")
+			return 0, err
+		}
+		return fi.Size(), nil
+	}
+	return 0, errors.New("ARCHIVE/BINARY > size of binary job data unknown")
+}
+
+type binaryColumn struct {
+	Offset int64 `json:"o"`
+	Len    int   `json:"n"`
+	Type   uint8 `json:"t"`
+}
+
+type binarySeries struct {
+	Hostname   string                  `json:"hostname"`
+	Id         *string                 `json:"id,omitempty"`
+	Statistics schema.MetricStatistics `json:"statistics"`
+	Data       binaryColumn            `json:"data"`
+}
+
+type binaryStatsSeries struct {
+	Mean        binaryColumn         `json:"mean"`
+	Min         binaryColumn         `json:"min"`
+	Max         binaryColumn         `json:"max"`
+	Percentiles map[int]binaryColumn `json:"percentiles,omitempty"`
+}
+
+type binaryMetric struct {
+	Metric           string             `json:"metric"`
+	Scope            schema.MetricScope `json:"scope"`
+	Unit             schema.Unit        `json:"unit"`
+	Timestep         int                `json:"timestep"`
+	Offset           int64              `json:"offset"`
+	Size             int64              `json:"size"`
+	Series           []binarySeries     `json:"series"`
+	StatisticsSeries *binaryStatsSeries `json:"statisticsSeries,omitempty"`
+}
+
+type binaryIndex struct {
+	Metrics []binaryMetric `json:"metrics"`
+}
+
+type columnWriter struct {
+	buf    bytes.Buffer
+	offset int64
+}
+
+// The JSON encoding of schema.Float has two decimal places. If every value of
+// a column has the same representation as float32 (NaN included) it is stored
+// with 4 bytes, otherwise with 8.
+func (cw *columnWriter) write(data []schema.Float) binaryColumn {
+	typ := columnFloat32
+	var b1, b2 [32]byte
+	for _, v := range data {
+		f := float64(v)
+		if math.IsNaN(f) || float64(float32(f)) == f {
+			continue
+		}
+		if !bytes.Equal(strconv.AppendFloat(b1[:0], f, 'f', 2, 64),
+			strconv.AppendFloat(b2[:0], float64(float32(f)), 'f', 2, 64)) {
+			typ = columnFloat64
+			break
+		}
+	}
+
+	col := binaryColumn{Offset: cw.offset, Len: len(data), Type: typ}
+	var b [8]byte
+	for _, v := range data {
+		if typ == columnFloat32 {
+			binary.LittleEndian.PutUint32(b[:4], math.Float32bits(float32(v)))
+			cw.buf.Write(b[:4])
+		} else {
+			binary.LittleEndian.PutUint64(b[:], math.Float64bits(float64(v)))
+			cw.buf.Write(b[:])
+		}
+	}
+	cw.offset += int64(len(data)) * int64(typ)
+	return col
+}
+
+func EncodeJobDataBinary(w io.Writer, d *schema.JobData) error {
+	metrics := make([]string, 0, len(*d))
+	for metric := range *d {
+		metrics = append(metrics, metric)
+	}
+	sort.Strings(metrics)
+
+	cw := &columnWriter{}
+	index := binaryIndex{Metrics: make([]binaryMetric, 0, len(metrics))}
+	for _, metric := range metrics {
+		scopes := make([]string, 0, len((*d)[metric]))
+		for scope := range (*d)[metric] {
+			scopes = append(scopes, string(scope))
+		}
+		sort.Strings(scopes)
+
+		for _, scope := range scopes {
+			jm := (*d)[metric][schema.MetricScope(scope)]
+			bm := binaryMetric{
+				Metric:   metric,
+				Scope:    schema.MetricScope(scope),
+				Unit:     jm.Unit,
+				Timestep: jm.Timestep,
+				Offset:   cw.offset,
+				Series:   make([]binarySeries, 0, len(jm.Series)),
+			}
+
+			for _, s := range jm.Series {
+				bm.Series = append(bm.Series, binarySeries{
+					Hostname:   s.Hostname,
+					Id:         s.Id,
+					Statistics: s.Statistics,
+					Data:       cw.write(s.Data),
+				})
+			}
+
+			if ss := jm.StatisticsSeries; ss != nil {
+				bm.StatisticsSeries = &binaryStatsSeries{
+					Mean: cw.write(ss.Mean),
+					Min:  cw.write(ss.Min),
+					Max:  cw.write(ss.Max),
+				}
+				if len(ss.Percentiles) > 0 {
+					bm.StatisticsSeries.Percentiles = make(map[int]binaryColumn, len(ss.Percentiles))
+					for p, data := range ss.Percentiles {
+						bm.StatisticsSeries.Percentiles[p] = cw.write(data)
+					}
+				}
+			}
+
+			bm.Size = cw.offset - bm.Offset
+			index.Metrics = append(index.Metrics, bm)
+		}
+	}
+
+	rawIndex, err := json.Marshal(index)
+	if err != nil {
+		log.Warn("Error while encoding binary job data index")
+		return err
+	}
+
+	bw := bufio.NewWriter(w)
+	var header [binaryHeaderSize]byte
+	copy(header[:4], binaryMagic[:])
+	binary.LittleEndian.PutUint32(header[4:8], binaryVersion)
+	binary.LittleEndian.PutUint32(header[8:12], uint32(len(rawIndex)))
+	bw.Write(header[:])
+	bw.Write(rawIndex)
+	if _, err := cw.buf.WriteTo(bw); err != nil {
+		log.Warn("Error while writing binary job data columns")
+		return err
+	}
+
+	return bw.Flush()
+}
+
+func readBinaryIndex(r io.ReaderAt, size int64) (*binaryIndex, int64, error) {
+	var header [binaryHeaderSize]byte
+	if _, err := r.ReadAt(header[:], 0); err != nil {
+		log.Warn("Error while reading binary job data header")
+		return nil, 0, err
+	}
+	if !bytes.Equal(header[:4], binaryMagic[:]) {
+		return nil, 0, errors.New("ARCHIVE/BINARY > not a binary job data file")
+	}
+	if version := binary.LittleEndian.Uint32(header[4:8]); version != binaryVersion {
+		return nil, 0, fmt.Errorf("ARCHIVE/BINARY > unsupported binary job data version %d", version)
+	}
+
+	indexSize := int64(binary.LittleEndian.Uint32(header[8:12]))
+	if indexSize > size-binaryHeaderSize {
+		return nil, 0, errBinaryCorrupt
+	}
+	rawIndex := make([]byte, indexSize)
+	if _, err := r.ReadAt(rawIndex, binaryHeaderSize); err != nil {
+		log.Warn("Error while reading binary job data index")
+		return nil, 0, err
+	}
+
+	index := &binaryIndex{}
+	if err := json.Unmarshal(rawIndex, index); err != nil {
+		log.Warn("Error while decoding binary job data index")
+		return nil, 0, err
+	}
+
+	return index, binaryHeaderSize + int64(len(rawIndex)), nil
+}
+
+func decodeColumn(buf []byte, base int64, col binaryColumn) ([]schema.Float, error) {
+	if col.Type != columnFloat32 && col.Type != columnFloat64 {
+		return nil, errBinaryCorrupt
+	}
+	// Checked one by one so that nothing overflows
+	start := col.Offset - base
+	if start < 0 || start > int64(len(buf)) || col.Len < 0 ||
+		int64(col.Len) > (int64(len(buf))-start)/int64(col.Type) {
+		return nil, errBinaryCorrupt
+	}
+	end := start + int64(col.Len)*int64(col.Type)
+
+	data := make([]schema.Float, col.Len)
+	b := buf[start:end]
+	if col.Type == columnFloat32 {
+		for i := range data {
+			data[i] = schema.Float(math.Float32frombits(binary.LittleEndian.Uint32(b[i*4:])))
+		}
+	} else {
+		for i := range data {
+			data[i] = schema.Float(math.Float64frombits(binary.LittleEndian.Uint64(b[i*8:])))
+		}
+	}
+
+	return data, nil
+}
+
+func decodeBinaryMetric(r io.ReaderAt, size, dataStart int64, bm *binaryMetric) (*schema.JobMetric, error) {
+	if bm.Offset < 0 || bm.Size < 0 || bm.Size > size-dataStart-bm.Offset {
+		return nil, errBinaryCorrupt
+	}
+	buf := make([]byte, bm.Size)
+	if _, err := r.ReadAt(buf, dataStart+bm.Offset); err != nil {
+		log.Warnf("Error while reading binary job data columns of %s/%s", bm.Metric, bm.Scope)
+		return nil, err
+	}
+
+	jm := &schema.JobMetric{
+		Unit:     bm.Unit,
+		Timestep: bm.Timestep,
+		Series:   make([]schema.Series, 0, len(bm.Series)),
+	}
+
+	var err error
+	for _, bs := range bm.Series {
+		s := schema.Series{
+			Hostname:   bs.Hostname,
+			Id:         bs.Id,
+			Statistics: bs.Statistics,
+		}
+		if s.Data, err = decodeColumn(buf, bm.Offset, bs.Data); err != nil {
+			return nil, err
+		}
+		jm.Series = append(jm.Series, s)
+	}
+
+	if bss := bm.StatisticsSeries; bss != nil {
+		ss := &schema.StatsSeries{}
+		if ss.Mean, err = decodeColumn(buf, bm.Offset, bss.Mean); err != nil {
+			return nil, err
+		}
+		if ss.Min, err = decodeColumn(buf, bm.Offset, bss.Min); err != nil {
+			return nil, err
+		}
+		if ss.Max, err = decodeColumn(buf, bm.Offset, bss.Max); err != nil {
+			return nil, err
+		}
+		if len(bss.Percentiles) > 0 {
+			ss.Percentiles = make(map[int][]schema.Float, len(bss.Percentiles))
+			for p, col := range bss.Percentiles {
+				if ss.Percentiles[p], err = decodeColumn(buf, bm.Offset, col); err != nil {
+					return nil, err
+				}
+			}
+		}
+		jm.StatisticsSeries = ss
+	}
+
+	return jm, nil
+}
+
+// DecodeJobDataBinary reads the metrics and scopes requested from a binary
+// job data file (see SubsetScopes for how scopes are selected). Nil slices
+// for metrics or scopes select everything. Only the header and the columns
+// selected are read from r.
+func DecodeJobDataBinary(
+	r io.ReaderAt,
+	metrics []string,
+	scopes []schema.MetricScope) (schema.JobData, error) {
+
+	size, err := binarySize(r)
+	if err != nil {
+		return nil, err
+	}
+	index, dataStart, err := readBinaryIndex(r, size)
+	if err != nil {
+		return nil, err
+	}
+
+	available := make(map[string][]schema.MetricScope)
+	for _, bm := range index.Metrics {
+		if containsMetric(metrics, bm.Metric) {
+			available[bm.Metric] = append(available[bm.Metric], bm.Scope)
+		}
+	}
+
+	jd := make(schema.JobData, len(available))
+	for i := range index.Metrics {
+		bm := &index.Metrics[i]
+		if !containsMetric(metrics, bm.Metric) ||
+			!containsScope(SubsetScopes(available[bm.Metric], scopes), bm.Scope) {
+			continue
+		}
+
+		jm, err := decodeBinaryMetric(r, size, dataStart, bm)
+		if err != nil {
+			return nil, err
+		}
+
+		if _, ok := jd[bm.Metric]; !ok {
+			jd[bm.Metric] = make(map[schema.MetricScope]*schema.JobMetric)
+		}
+		jd[bm.Metric][bm.Scope] = jm
+	}
+
+	return jd, nil
+}
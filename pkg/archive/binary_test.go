@@ -0,0 +1,136 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package archive
+
+import (
+	"bytes"
+	"encoding/binary"
+	"encoding/json"
+	"fmt"
+	"math"
+	"os"
+	"path/filepath"
+	"testing"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/internal/util"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+func TestJobDataBinary(t *testing.T) {
+	data, err := loadJobData("testdata/archive/emmy/1403/244/1608923076/data.json.gz", true)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	var buf bytes.Buffer
+	if err := EncodeJobDataBinary(&buf, &data); err != nil {
+		t.Fatal(err)
+	}
+
+	decoded, err := DecodeJobDataBinary(bytes.NewReader(buf.Bytes()), nil, nil)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	// Compare the json encodings as NaN != NaN
+	expected, _ := json.Marshal(data)
+	got, _ := json.Marshal(decoded)
+	if !bytes.Equal(expected, got) {
+		t.Error("decoded binary job data differs from the original")
+	}
+
+	subset, err := DecodeJobDataBinary(bytes.NewReader(buf.Bytes()),
+		[]string{"flops_any", "no_such_metric"}, []schema.MetricScope{schema.MetricScopeNode})
+	if err != nil {
+		t.Fatal(err)
+	}
+	if len(subset) != 1 || len(subset["flops_any"]) != 1 || subset["flops_any"][schema.MetricScopeNode] == nil {
+		t.Errorf("unexpected subset: %v", subset)
+	}
+}
+
+func TestJobDataBinaryCorrupt(t *testing.T) {
+	data := schema.JobData{"flops_any": {schema.MetricScopeNode: &schema.JobMetric{
+		Timestep: 60,
+		Series:   []schema.Series{{Hostname: "a", Data: []schema.Float{1, 2, 3}}},
+	}}}
+	var buf bytes.Buffer
+	if err := EncodeJobDataBinary(&buf, &data); err != nil {
+		t.Fatal(err)
+	}
+	raw := buf.Bytes()
+	index, dataStart, err := readBinaryIndex(bytes.NewReader(raw), int64(len(raw)))
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	// Rewrite the file with the index modified by fn
+	corrupt := func(fn func(bm *binaryMetric)) []byte {
+		index := *index
+		index.Metrics = append([]binaryMetric{}, index.Metrics...)
+		index.Metrics[0].Series = append([]binarySeries{}, index.Metrics[0].Series...)
+		fn(&index.Metrics[0])
+		rawIndex, err := json.Marshal(index)
+		if err != nil {
+			t.Fatal(err)
+		}
+		var out bytes.Buffer
+		out.Write(raw[:8])
+		binary.Write(&out, binary.LittleEndian, uint32(len(rawIndex)))
+		out.Write(rawIndex)
+		out.Write(raw[dataStart:])
+		return out.Bytes()
+	}
+
+	for name, file := range map[string][]byte{
+		"negative size":      corrupt(func(bm *binaryMetric) { bm.Size = -1 }),
+		"size beyond file":   corrupt(func(bm *binaryMetric) { bm.Size = 1 << 40 }),
+		"negative offset":    corrupt(func(bm *binaryMetric) { bm.Offset = -8 }),
+		"offset beyond file": corrupt(func(bm *binaryMetric) { bm.Offset = math.MaxInt64 }),
+		"negative length":    corrupt(func(bm *binaryMetric) { bm.Series[0].Data.Len = -1 }),
+		"overflowing length": corrupt(func(bm *binaryMetric) { bm.Series[0].Data.Len = math.MaxInt64 / 2 }),
+		"unknown type":       corrupt(func(bm *binaryMetric) { bm.Series[0].Data.Type = 0 }),
+		"index beyond file":  append(append([]byte{}, raw[:8]...), 0xff, 0xff, 0xff, 0x7f),
+	} {
+		if _, err := DecodeJobDataBinary(bytes.NewReader(file), nil, nil); err != errBinaryCorrupt {
+			t.Errorf("%s: want %v, got %v", name, errBinaryCorrupt, err)
+		}
+	}
+}
+
+func BenchmarkLoadJobDataBinary(b *testing.B) {
+
+	tmpdir := b.TempDir()
+	jobarchive := filepath.Join(tmpdir, "job-archive")
+	util.CopyDir("./testdata/archive/", jobarchive)
+	archiveCfg := fmt.Sprintf("{\"path\": \"%s\"}", jobarchive)
+
+	var fsa FsArchive
+	fsa.Init(json.RawMessage(archiveCfg))
+
+	jobIn := schema.Job{BaseJob: schema.JobDefaults}
+	jobIn.StartTime = time.Unix(1608923076, 0)
+	jobIn.JobID = 1403244
+	jobIn.Cluster = "emmy"
+
+	data, err := fsa.LoadJobData(&jobIn)
+	if err != nil {
+		b.Fatal(err)
+	}
+	f, err := os.Create(filepath.Join(jobarchive, "emmy/1403/244/1608923076/data.bin"))
+	if err != nil {
+		b.Fatal(err)
+	}
+	if err := EncodeJobDataBinary(f, &data); err != nil {
+		b.Fatal(err)
+	}
+	f.Close()
+
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		fsa.LoadJobData(&jobIn)
+	}
+}
@@ -13,12 +13,12 @@ import (
 )
 
 var Clusters []*schema.Cluster
-var nodeLists map[string]map[string]NodeList
+var nodeIndices map[string]*nodeIndex
 
 func initClusterConfig() error {
 
 	Clusters = []*schema.Cluster{}
-	nodeLists = map[string]map[string]NodeList{}
+	nodeIndices = map[string]*nodeIndex{}
 
 	for _, c := range ar.GetClusters() {
 
@@ -53,7 +53,7 @@ func initClusterConfig() error {
 
 		Clusters = append(Clusters, cluster)
 
-		nodeLists[cluster.Name] = make(map[string]NodeList)
+		index := newNodeIndex()
 		for _, sc := range cluster.SubClusters {
 			if sc.Nodes == "*" {
 				continue
@@ -63,8 +63,9 @@ func initClusterConfig() error {
 			if err != nil {
 				return fmt.Errorf("ARCHIVE/CLUSTERCONFIG > in %s/cluster.json: %w", cluster.Name, err)
 			}
-			nodeLists[cluster.Name][sc.Name] = nl
+			index.add(sc.Name, nl)
 		}
+		nodeIndices[cluster.Name] = index
 	}
 
 	return nil
@@ -130,11 +131,9 @@ func AssignSubCluster(job *schema.BaseJob) error {
 	}
 
 	host0 := job.Resources[0].Hostname
-	for sc, nl := range nodeLists[job.Cluster] {
-		if nl != nil && nl.Contains(host0) {
-			job.SubCluster = sc
-			return nil
-		}
+	if sc, ok := lookupSubCluster(job.Cluster, host0); ok {
+		job.SubCluster = sc
+		return nil
 	}
 
 	if cluster.SubClusters[0].Nodes == "*" {
@@ -145,12 +144,17 @@ func AssignSubCluster(job *schema.BaseJob) error {
 	return fmt.Errorf("ARCHIVE/CLUSTERCONFIG > no subcluster found for cluster %v and host %v", job.Cluster, host0)
 }
 
+func lookupSubCluster(cluster, hostname string) (string, bool) {
+	if index := nodeIndices[cluster]; index != nil {
+		return index.lookup(hostname)
+	}
+	return "", false
+}
+
 func GetSubClusterByNode(cluster, hostname string) (string, error) {
 
-	for sc, nl := range nodeLists[cluster] {
-		if nl != nil && nl.Contains(hostname) {
-			return sc, nil
-		}
+	if sc, ok := lookupSubCluster(cluster, hostname); ok {
+		return sc, nil
 	}
 
 	c := GetCluster(cluster)
@@ -164,3 +168,24 @@ func GetSubClusterByNode(cluster, hostname string) (string, error) {
 
 	return "", fmt.Errorf("ARCHIVE/CLUSTERCONFIG > no subcluster found for cluster %v and host %v", cluster, hostname)
 }
+
+// GetSubClustersByNodes is GetSubClusterByNode for many hostnames of a
+// cluster, the result has the same order as hostnames. Hostnames without a
+// subcluster get an empty name and the error of the first of them.
+func GetSubClustersByNodes(cluster string, hostnames []string) ([]string, error) {
+	var err error
+	subClusters := make([]string, len(hostnames))
+	for i, hostname := range hostnames {
+		if sc, ok := lookupSubCluster(cluster, hostname); ok {
+			subClusters[i] = sc
+			continue
+		}
+
+		sc, e := GetSubClusterByNode(cluster, hostname)
+		if e != nil && err == nil {
+			err = e
+		}
+		subClusters[i] = sc
+	}
+	return subClusters, err
+}
@@ -0,0 +1,376 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package archive
+
+import (
+	"bufio"
+	"bytes"
+	"compress/gzip"
+	"compress/zlib"
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"hash/adler32"
+	"io"
+	"sort"
+	"strings"
+	"sync"
+
+	"github.com/ClusterCockpit/cc-backend/internal/util"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+// Codecs for compressed job data. New files are written with the codec of
+// the archive config key "compression-codec", on read the codec is detected
+// from the header of the stream, so an archive can contain both.
+const (
+	// data.json.gz, the default
+	CodecGzip = "gzip"
+	// data.json.zz, deflate with the preset dictionary of the cluster if
+	// there is one (see TrainDictionary)
+	CodecZlib = "zlib"
+)
+
+// Name of the current preset dictionary of a cluster, next to its
+// cluster.json. Every dictionary files of the cluster may be compressed with
+// is kept next to it under DictionaryFileName as well.
+const DictionaryFile = "compression.dict"
+
+// The name dict is kept under, from its Adler-32 checksum.
+func DictionaryFileName(dict []byte) string {
+	return fmt.Sprintf("compression.%08x.dict", adler32.Checksum(dict))
+}
+
+// Whether name is a dictionary kept under DictionaryFileName.
+func isDictionaryFileName(name string) bool {
+	return name != DictionaryFile && strings.HasPrefix(name, "compression.") && strings.HasSuffix(name, ".dict")
+}
+
+// Deflate only looks back 32 KiB, a larger dictionary is of no use.
+const MaxDictionarySize = 32 * 1024
+
+// The job data files in the order they are preferred if a job has several.
+var jobDataFiles = []string{"data.bin", "data.json.zz", "data.json.gz", "data.json"}
+
+var compressionCodec = CodecGzip
+
+func initCodec(codec string) error {
+	switch codec {
+	case "":
+		compressionCodec = CodecGzip
+	case CodecGzip, CodecZlib:
+		compressionCodec = codec
+	default:
+		return fmt.Errorf("ARCHIVE/CODEC > unknown compression codec '%s'", codec)
+	}
+	return nil
+}
+
+// The name of the job data file compressed with codec.
+func CompressedName(codec string) string {
+	if codec == CodecZlib {
+		return "data.json.zz"
+	}
+	return "data.json.gz"
+}
+
+func isCompressedName(name string) bool {
+	return name == "data.json.gz" || name == "data.json.zz"
+}
+
+// The preset dictionaries by cluster and by their Adler-32 checksum, which
+// zlib stores in the stream header to identify the dictionary.
+var dictionaries = struct {
+	lock      sync.RWMutex
+	byCluster map[string][]byte
+	byID      map[uint32][]byte
+}{
+	byCluster: make(map[string][]byte),
+	byID:      make(map[uint32][]byte),
+}
+
+// Make dict the dictionary used for new files of cluster. Files compressed
+// with a previous dictionary of the cluster can still be read.
+func RegisterDictionary(cluster string, dict []byte) {
+	dictionaries.lock.Lock()
+	defer dictionaries.lock.Unlock()
+	dictionaries.byCluster[cluster] = dict
+	dictionaries.byID[adler32.Checksum(dict)] = dict
+}
+
+// Make files compressed with dict readable, without using it for new files.
+func addDictionary(dict []byte) {
+	dictionaries.lock.Lock()
+	defer dictionaries.lock.Unlock()
+	dictionaries.byID[adler32.Checksum(dict)] = dict
+}
+
+func clusterDictionary(cluster string) []byte {
+	dictionaries.lock.RLock()
+	defer dictionaries.lock.RUnlock()
+	return dictionaries.byCluster[cluster]
+}
+
+var (
+	gzipWriters = sync.Pool{New: func() interface{} { return gzip.NewWriter(nil) }}
+	gzipReaders sync.Pool
+	zlibReaders sync.Pool
+	bufReaders  = sync.Pool{New: func() interface{} { return bufio.NewReaderSize(nil, 64*1024) }}
+)
+
+// A pooled gzip writer, put back on Close.
+type compressWriter struct {
+	io.WriteCloser
+	gz *gzip.Writer
+}
+
+func (cw *compressWriter) Close() error {
+	err := cw.WriteCloser.Close()
+	if cw.gz != nil {
+		gzipWriters.Put(cw.gz)
+		cw.gz = nil
+	}
+	return err
+}
+
+// Compresses with codec and for zlib with the dictionary of cluster.
+func newCompressWriter(w io.Writer, codec string, cluster string) (io.WriteCloser, error) {
+	switch codec {
+	case CodecGzip:
+		gz := gzipWriters.Get().(*gzip.Writer)
+		gz.Reset(w)
+		return &compressWriter{WriteCloser: gz, gz: gz}, nil
+	case CodecZlib:
+		return zlib.NewWriterLevelDict(w, zlib.DefaultCompression, clusterDictionary(cluster))
+	default:
+		return nil, fmt.Errorf("ARCHIVE/CODEC > unknown compression codec '%s'", codec)
+	}
+}
+
+// Encodes the job data as JSON compressed with codec, for zlib with the
+// dictionary of cluster.
+func EncodeJobDataCompressed(w io.Writer, d *schema.JobData, codec string, cluster string) error {
+	cw, err := newCompressWriter(w, codec, cluster)
+	if err != nil {
+		return err
+	}
+	if err := EncodeJobData(cw, d); err != nil {
+		cw.Close()
+		return err
+	}
+	return cw.Close()
+}
+
+// Compresses data with codec in memory.
+func compressBytes(data []byte, codec string, cluster string) ([]byte, error) {
+	var buf bytes.Buffer
+	w, err := newCompressWriter(&buf, codec, cluster)
+	if err != nil {
+		return nil, err
+	}
+	if _, err := w.Write(data); err != nil {
+		w.Close()
+		return nil, err
+	}
+	if err := w.Close(); err != nil {
+		return nil, err
+	}
+	return buf.Bytes(), nil
+}
+
+// Decompresses a gzip or zlib stream, the decompressor is returned to a pool
+// on Close.
+type decompressReader struct {
+	io.Reader
+	br   *bufio.Reader
+	gz   *gzip.Reader
+	zlib io.ReadCloser
+}
+
+func (dr *decompressReader) Close() error {
+	var err error
+	if dr.gz != nil {
+		err = dr.gz.Close()
+		gzipReaders.Put(dr.gz)
+		dr.gz = nil
+	}
+	if dr.zlib != nil {
+		err = dr.zlib.Close()
+		zlibReaders.Put(dr.zlib)
+		dr.zlib = nil
+	}
+	if dr.br != nil {
+		dr.br.Reset(nil)
+		bufReaders.Put(dr.br)
+		dr.br = nil
+	}
+	return err
+}
+
+var (
+	errUnknownFormat     = errors.New("ARCHIVE/CODEC > unknown compression format")
+	errUnknownDictionary = errors.New("ARCHIVE/CODEC > unknown compression dictionary")
+)
+
+// Detects the codec of a compressed stream from its header and returns a
+// reader of the decompressed data.
+func newDecompressReader(r io.Reader) (io.ReadCloser, error) {
+	br := bufReaders.Get().(*bufio.Reader)
+	br.Reset(r)
+	dr := &decompressReader{Reader: br, br: br}
+
+	hdr, err := br.Peek(2)
+	if err != nil {
+		dr.Close()
+		return nil, err
+	}
+
+	switch {
+	case hdr[0] == 0x1f && hdr[1] == 0x8b:
+		if gz, ok := gzipReaders.Get().(*gzip.Reader); ok {
+			err = gz.Reset(br)
+			dr.gz = gz
+		} else {
+			dr.gz, err = gzip.NewReader(br)
+		}
+		if dr.gz != nil {
+			dr.Reader = dr.gz
+		}
+	case hdr[0]&0x0f == 8 && binary.BigEndian.Uint16(hdr)%31 == 0:
+		var dict []byte
+		if hdr[1]&0x20 != 0 {
+			if hdr, err = br.Peek(6); err != nil {
+				break
+			}
+			id := binary.BigEndian.Uint32(hdr[2:])
+			dictionaries.lock.RLock()
+			dict = dictionaries.byID[id]
+			dictionaries.lock.RUnlock()
+			if dict == nil {
+				err = fmt.Errorf("%w %08x", errUnknownDictionary, id)
+				break
+			}
+		}
+		if zr, ok := zlibReaders.Get().(io.ReadCloser); ok {
+			err = zr.(zlib.Resetter).Reset(br, dict)
+			dr.zlib = zr
+		} else {
+			dr.zlib, err = zlib.NewReaderDict(br, dict)
+		}
+		if dr.zlib != nil {
+			dr.Reader = dr.zlib
+		}
+	default:
+		err = errUnknownFormat
+	}
+
+	if err != nil {
+		dr.Close()
+		return nil, err
+	}
+	return dr, nil
+}
+
+// Builds a preset dictionary of at most size bytes from sample job data
+// files of a cluster. The dictionary is made of the segments of the samples
+// that contain the most substrings common to many samples (keys, metric
+// names, units, hostnames, ...). The samples are split into one epoch per
+// segment of the dictionary and the segment of every epoch is the one adding
+// the most substrings not covered by the segments chosen before. The best
+// segments are at the end, as deflate encodes short distances with fewer
+// bits.
+func TrainDictionary(samples [][]byte, size int) []byte {
+	const (
+		k          = 8
+		segmentLen = 64
+		step       = 16
+		// Only the start of large samples is used, the structure of a file
+		// repeats from there on
+		maxSample = 64 * 1024
+	)
+	if size <= 0 || size > MaxDictionarySize {
+		size = MaxDictionarySize
+	}
+
+	kmer := func(b []byte, i int) uint64 {
+		return binary.LittleEndian.Uint64(b[i : i+k])
+	}
+
+	// Number of samples every k-mer is in
+	freq := make(map[uint64]int)
+	seen := make(map[uint64]bool)
+	var candidates [][]byte
+	for _, s := range samples {
+		if len(s) > maxSample {
+			s = s[:maxSample]
+		}
+		for key := range seen {
+			delete(seen, key)
+		}
+		for j := 0; j+k <= len(s); j++ {
+			if m := kmer(s, j); !seen[m] {
+				seen[m] = true
+				freq[m]++
+			}
+		}
+		for off := 0; off+segmentLen <= len(s); off += step {
+			candidates = append(candidates, s[off:off+segmentLen])
+		}
+	}
+	// From here on the scratch set of score, the k-mers of the last sample
+	// must not count as seen
+	for key := range seen {
+		delete(seen, key)
+	}
+
+	covered := make(map[uint64]bool)
+	score := func(seg []byte) int {
+		n := 0
+		for j := 0; j+k <= len(seg); j++ {
+			m := kmer(seg, j)
+			if f := freq[m]; f > 1 && !covered[m] && !seen[m] {
+				seen[m] = true
+				n += f
+			}
+		}
+		for j := 0; j+k <= len(seg); j++ {
+			delete(seen, kmer(seg, j))
+		}
+		return n
+	}
+
+	epochs := size / segmentLen
+	epochLen := (len(candidates) + epochs - 1) / util.Max(epochs, 1)
+	type segment struct {
+		data  []byte
+		score int
+	}
+	var selected []segment
+	for start := 0; start < len(candidates) && epochLen > 0; start += epochLen {
+		var best []byte
+		bestScore := 0
+		for _, seg := range candidates[start:util.Min(start+epochLen, len(candidates))] {
+			if sc := score(seg); sc > bestScore {
+				best, bestScore = seg, sc
+			}
+		}
+		if best == nil {
+			continue
+		}
+		for j := 0; j+k <= len(best); j++ {
+			covered[kmer(best, j)] = true
+		}
+		selected = append(selected, segment{best, bestScore})
+	}
+
+	sort.SliceStable(selected, func(i, j int) bool {
+		return selected[i].score < selected[j].score
+	})
+	dict := make([]byte, 0, len(selected)*segmentLen)
+	for _, seg := range selected {
+		dict = append(dict, seg.data...)
+	}
+	return dict
+}
@@ -0,0 +1,230 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package archive
+
+import (
+	"bytes"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"hash/adler32"
+	"io"
+	"os"
+	"path/filepath"
+	"testing"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/internal/util"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+// The job data of a test job encoded metric by metric, as samples of small
+// job data files.
+func metricSamples(t testing.TB, file string) [][]byte {
+	jd, err := loadJobData(file, true)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	var samples [][]byte
+	for metric, scopes := range jd {
+		var buf bytes.Buffer
+		if err := EncodeJobData(&buf, &schema.JobData{metric: scopes}); err != nil {
+			t.Fatal(err)
+		}
+		samples = append(samples, buf.Bytes())
+	}
+	return samples
+}
+
+func decompress(t testing.TB, b []byte) []byte {
+	r, err := newDecompressReader(bytes.NewReader(b))
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer r.Close()
+	raw, err := io.ReadAll(r)
+	if err != nil {
+		t.Fatal(err)
+	}
+	return raw
+}
+
+func TestCodecs(t *testing.T) {
+	train := metricSamples(t, "testdata/archive/emmy/1403/244/1608923076/data.json.gz")
+	samples := metricSamples(t, "testdata/archive/emmy/1404/397/1609300556/data.json.gz")
+
+	dict := TrainDictionary(train, 0)
+	if len(dict) == 0 || len(dict) > MaxDictionarySize {
+		t.Fatalf("unexpected dictionary size %d", len(dict))
+	}
+	RegisterDictionary("codec-test", dict)
+
+	sizes := make(map[string]int)
+	for _, c := range []struct{ codec, cluster string }{
+		{CodecGzip, "codec-test"},
+		{CodecZlib, "no-dictionary"},
+		{CodecZlib, "codec-test"},
+	} {
+		name := c.codec + "/" + c.cluster
+		for _, sample := range samples {
+			b, err := compressBytes(sample, c.codec, c.cluster)
+			if err != nil {
+				t.Fatal(err)
+			}
+			if !bytes.Equal(decompress(t, b), sample) {
+				t.Fatalf("%s: decompressed data differs", name)
+			}
+			sizes[name] += len(b)
+		}
+	}
+
+	t.Logf("compressed sizes: %v", sizes)
+	// The repetitive metric JSON is the point of the dictionary
+	if sizes["zlib/codec-test"] >= sizes["zlib/no-dictionary"] {
+		t.Errorf("dictionary does not help: %v", sizes)
+	}
+}
+
+// The k-mers common to all samples are in the last one as well, they must
+// count for the segments of all samples. All samples score the same here, so
+// the first one is chosen.
+func TestTrainDictionaryCommon(t *testing.T) {
+	common := `{"hostname": "e0101", "statistics": {"min": 0.00`
+	samples := [][]byte{
+		[]byte(common + "1111111111111111"),
+		[]byte(common + "2222222222222222"),
+		[]byte(common + "3333333333333333"),
+	}
+	if dict := TrainDictionary(samples, 64); !bytes.Equal(dict, samples[0]) {
+		t.Errorf("want %q, got %q", samples[0], dict)
+	}
+}
+
+func TestDecompressErrors(t *testing.T) {
+	if _, err := newDecompressReader(bytes.NewReader([]byte(`{"flops_any": {}}`))); !errors.Is(err, errUnknownFormat) {
+		t.Errorf("want errUnknownFormat, got %v", err)
+	}
+
+	old := []byte(`{"hostname": "e0101", "statistics": {"min": 0.0}}`)
+	RegisterDictionary("codec-test-old", old)
+	b, err := compressBytes([]byte(`{"hostname": "e0102"}`), CodecZlib, "codec-test-old")
+	if err != nil {
+		t.Fatal(err)
+	}
+	dictionaries.lock.Lock()
+	delete(dictionaries.byID, adler32.Checksum(old))
+	dictionaries.lock.Unlock()
+	if _, err := newDecompressReader(bytes.NewReader(b)); !errors.Is(err, errUnknownDictionary) {
+		t.Errorf("want errUnknownDictionary, got %v", err)
+	}
+}
+
+// Files compressed with a previous dictionary of a cluster stay readable
+// after a restart.
+func TestKeptDictionaries(t *testing.T) {
+	jobarchive := filepath.Join(t.TempDir(), "job-archive")
+	util.CopyDir("./testdata/archive/", jobarchive)
+	defer func() {
+		dictionaries.lock.Lock()
+		delete(dictionaries.byCluster, "emmy")
+		dictionaries.lock.Unlock()
+	}()
+
+	old := []byte(`{"hostname": "e0101", "statistics": {"min": 0.0}}`)
+	current := []byte(`{"hostname": "e0201", "statistics": {"max": 1.0}}`)
+	for name, dict := range map[string][]byte{
+		DictionaryFileName(old):     old,
+		DictionaryFileName(current): current,
+		DictionaryFile:              current,
+	} {
+		if err := os.WriteFile(filepath.Join(jobarchive, "emmy", name), dict, 0644); err != nil {
+			t.Fatal(err)
+		}
+	}
+	RegisterDictionary("emmy", old)
+	b, err := compressBytes([]byte(`{"hostname": "e0102"}`), CodecZlib, "emmy")
+	if err != nil {
+		t.Fatal(err)
+	}
+	dictionaries.lock.Lock()
+	delete(dictionaries.byID, adler32.Checksum(old))
+	dictionaries.lock.Unlock()
+
+	var fsa FsArchive
+	if _, err := fsa.Init(json.RawMessage(fmt.Sprintf(`{"path": "%s"}`, jobarchive))); err != nil {
+		t.Fatal(err)
+	}
+	if !bytes.Equal(clusterDictionary("emmy"), current) {
+		t.Errorf("want the current dictionary for new files, got %q", clusterDictionary("emmy"))
+	}
+	if raw := decompress(t, b); string(raw) != `{"hostname": "e0102"}` {
+		t.Errorf("unexpected data: %q", raw)
+	}
+}
+
+func TestCompressZlib(t *testing.T) {
+	if err := initCodec(CodecZlib); err != nil {
+		t.Fatal(err)
+	}
+	defer initCodec("")
+
+	jobarchive := filepath.Join(t.TempDir(), "job-archive")
+	util.CopyDir("./testdata/archive/", jobarchive)
+	dir := filepath.Join(jobarchive, "emmy/1403/244/1608923076")
+	util.UncompressFile(filepath.Join(dir, "data.json.gz"), filepath.Join(dir, "data.json"))
+
+	var fsa FsArchive
+	if _, err := fsa.Init(json.RawMessage(fmt.Sprintf(`{"path": "%s"}`, jobarchive))); err != nil {
+		t.Fatal(err)
+	}
+
+	job := &schema.Job{BaseJob: schema.BaseJob{JobID: 1403244, Cluster: "emmy"}, StartTime: time.Unix(1608923076, 0)}
+	fsa.Compress([]*schema.Job{job})
+	if !util.CheckFileExists(filepath.Join(dir, "data.json.zz")) || util.CheckFileExists(filepath.Join(dir, "data.json")) {
+		t.Fatal("data.json not compressed to data.json.zz")
+	}
+
+	data, err := fsa.LoadJobData(job)
+	if err != nil {
+		t.Fatal(err)
+	}
+	subset, err := fsa.LoadJobDataSubset(job, []string{"flops_any"}, nil)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if len(data) == 0 || len(subset) != 1 {
+		t.Errorf("unexpected job data: %d metrics, subset %d metrics", len(data), len(subset))
+	}
+}
+
+func BenchmarkDecompress(b *testing.B) {
+	samples := metricSamples(b, "testdata/archive/emmy/1403/244/1608923076/data.json.gz")
+	RegisterDictionary("codec-bench", TrainDictionary(samples, 0))
+
+	for _, codec := range []string{CodecGzip, CodecZlib} {
+		compressed := make([][]byte, len(samples))
+		for i, sample := range samples {
+			var err error
+			if compressed[i], err = compressBytes(sample, codec, "codec-bench"); err != nil {
+				b.Fatal(err)
+			}
+		}
+
+		b.Run(codec, func(b *testing.B) {
+			b.ReportAllocs()
+			for i := 0; i < b.N; i++ {
+				r, err := newDecompressReader(bytes.NewReader(compressed[i%len(compressed)]))
+				if err != nil {
+					b.Fatal(err)
+				}
+				if _, err := io.Copy(io.Discard, r); err != nil {
+					b.Fatal(err)
+				}
+				r.Close()
+			}
+		})
+	}
+}
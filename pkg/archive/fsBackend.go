@@ -7,16 +7,18 @@ package archive
 import (
 	"bufio"
 	"bytes"
-	"compress/gzip"
 	"encoding/json"
 	"errors"
 	"fmt"
+	"io"
 	"math"
 	"os"
 	"path"
 	"path/filepath"
+	"runtime"
 	"strconv"
 	"strings"
+	"sync"
 	"text/tabwriter"
 	"time"
 
@@ -29,10 +31,13 @@ import (
 
 type FsArchiveConfig struct {
 	Path string `json:"path"`
+	// Format used for newly archived job data: "json" (default) or "binary"
+	Format string `json:"format"`
 }
 
 type FsArchive struct {
 	path     string
+	binary   bool
 	clusters []string
 }
 
@@ -72,6 +77,12 @@ func loadJobMeta(filename string) (*schema.JobMeta, error) {
 		log.Errorf("loadJobMeta() > open file error: %v", err)
 		return &schema.JobMeta{}, err
 	}
+
+	return decodeJobMeta(b)
+}
+
+// Decodes a raw meta.json, validated first if enabled in the config.
+func decodeJobMeta(b []byte) (*schema.JobMeta, error) {
 	if config.Keys.Validate {
 		if err := schema.Validate(schema.Meta, bytes.NewReader(b)); err != nil {
 			return &schema.JobMeta{}, fmt.Errorf("validate job meta: %v", err)
@@ -91,9 +102,9 @@ func loadJobData(filename string, isCompressed bool) (schema.JobData, error) {
 	defer f.Close()
 
 	if isCompressed {
-		r, err := gzip.NewReader(f)
+		r, err := newDecompressReader(f)
 		if err != nil {
-			log.Errorf(" %v", err)
+			log.Errorf("fsBackend LoadJobData()- %s: %v", filename, err)
 			return nil, err
 		}
 		defer r.Close()
@@ -115,6 +126,53 @@ func loadJobData(filename string, isCompressed bool) (schema.JobData, error) {
 	}
 }
 
+func loadJobDataBinary(filename string) (schema.JobData, error) {
+	data := cache.Get(filename, func() (value interface{}, ttl time.Duration, size int) {
+		f, err := os.Open(filename)
+		if err != nil {
+			log.Errorf("fsBackend LoadJobData()- %v", err)
+			return err, 0, 1000
+		}
+		defer f.Close()
+
+		d, err := DecodeJobDataBinary(f, nil, nil)
+		if err != nil {
+			log.Warn("Error while decoding binary job data")
+			return err, 0, 1000
+		}
+
+		return d, 1 * time.Hour, d.Size()
+	})
+
+	if err, ok := data.(error); ok {
+		return nil, err
+	}
+
+	return data.(schema.JobData), nil
+}
+
+// The job data file of a job directory, see jobDataFiles. data.json if
+// there is none.
+func jobDataFile(dir string) (filename string, name string) {
+	for _, name := range jobDataFiles {
+		if filename := filepath.Join(dir, name); util.CheckFileExists(filename) {
+			return filename, name
+		}
+	}
+	return filepath.Join(dir, "data.json"), "data.json"
+}
+
+// Load the job data from a job directory in whatever format it is stored:
+// data.bin, data.json.zz, data.json.gz or data.json.
+func loadJobDataDir(dir string) (schema.JobData, error) {
+	filename, name := jobDataFile(dir)
+	if name == "data.bin" {
+		return loadJobDataBinary(filename)
+	}
+
+	return loadJobData(filename, isCompressedName(name))
+}
+
 func (fsa *FsArchive) Init(rawConfig json.RawMessage) (uint64, error) {
 
 	var config FsArchiveConfig
@@ -129,6 +187,16 @@ func (fsa *FsArchive) Init(rawConfig json.RawMessage) (uint64, error) {
 	}
 	fsa.path = config.Path
 
+	switch config.Format {
+	case "", "json":
+	case "binary":
+		fsa.binary = true
+	default:
+		err := fmt.Errorf("Init() : unknown job data format '%s'", config.Format)
+		log.Errorf("Init() > config.Format error: %v", err)
+		return 0, err
+	}
+
 	b, err := os.ReadFile(filepath.Join(fsa.path, "version.txt"))
 	if err != nil {
 		log.Warnf("fsBackend Init() - %v", err)
@@ -156,11 +224,39 @@ func (fsa *FsArchive) Init(rawConfig json.RawMessage) (uint64, error) {
 			continue
 		}
 		fsa.clusters = append(fsa.clusters, de.Name())
+		fsa.loadDictionaries(de.Name())
 	}
 
 	return version, nil
 }
 
+// Register the dictionaries of cluster, all kept ones for reading and the
+// current one for new files as well.
+func (fsa *FsArchive) loadDictionaries(cluster string) {
+	names, err := filepath.Glob(filepath.Join(fsa.path, cluster, "compression.*.dict"))
+	if err != nil {
+		log.Warnf("fsBackend Init() - %v", err)
+	}
+	for _, name := range names {
+		if !isDictionaryFileName(filepath.Base(name)) {
+			continue
+		}
+		dict, err := os.ReadFile(name)
+		if err != nil {
+			log.Warnf("fsBackend Init() - %v", err)
+			continue
+		}
+		addDictionary(dict)
+	}
+
+	dict, err := os.ReadFile(filepath.Join(fsa.path, cluster, DictionaryFile))
+	if err == nil {
+		RegisterDictionary(cluster, dict)
+	} else if !errors.Is(err, os.ErrNotExist) {
+		log.Warnf("fsBackend Init() - %v", err)
+	}
+}
+
 func (fsa *FsArchive) Info() {
 	fmt.Printf("Job archive %s\n", fsa.path)
 	clusters, err := os.ReadDir(fsa.path)
@@ -302,59 +398,85 @@ func (fsa *FsArchive) Clean(before int64, after int64) {
 	}
 }
 
+// Removes dir if it is empty. Jobs in the same directory are processed in
+// parallel, so the directory may already be gone.
+func removeEmptyDir(dir string) error {
+	if util.GetFilecount(dir) != 0 {
+		return nil
+	}
+	if err := os.Remove(dir); err != nil && !errors.Is(err, os.ErrNotExist) {
+		return err
+	}
+	return nil
+}
+
+// Jobs already moved by an earlier, interrupted run are skipped.
 func (fsa *FsArchive) Move(jobs []*schema.Job, path string) {
-	for _, job := range jobs {
-		source := getDirectory(job, fsa.path)
-		target := getDirectory(job, path)
+	runService("Retention", len(jobs), func(i int) (int64, error) {
+		source := getDirectory(jobs[i], fsa.path)
+		target := getDirectory(jobs[i], path)
+		if !util.CheckFileExists(source) {
+			return 0, nil
+		}
+		size := int64(util.DiskUsage(source) * 1e6)
 
 		if err := os.MkdirAll(filepath.Clean(filepath.Join(target, "..")), 0777); err != nil {
-			log.Errorf("JobArchive Move MkDir error: %v", err)
+			return 0, fmt.Errorf("JobArchive Move MkDir error: %v", err)
 		}
 		if err := os.Rename(source, target); err != nil {
-			log.Errorf("JobArchive Move() error: %v", err)
+			return 0, fmt.Errorf("JobArchive Move() error: %v", err)
 		}
 
-		parent := filepath.Clean(filepath.Join(source, ".."))
-		if util.GetFilecount(parent) == 0 {
-			if err := os.Remove(parent); err != nil {
-				log.Errorf("JobArchive Move() error: %v", err)
-			}
+		if err := removeEmptyDir(filepath.Clean(filepath.Join(source, ".."))); err != nil {
+			return size, fmt.Errorf("JobArchive Move() error: %v", err)
 		}
-	}
+		return size, nil
+	}, nil)
 }
 
 func (fsa *FsArchive) CleanUp(jobs []*schema.Job) {
-	start := time.Now()
-	for _, job := range jobs {
-		dir := getDirectory(job, fsa.path)
+	runService("Retention", len(jobs), func(i int) (int64, error) {
+		dir := getDirectory(jobs[i], fsa.path)
 		if err := os.RemoveAll(dir); err != nil {
-			log.Errorf("JobArchive Cleanup() error: %v", err)
+			return 0, fmt.Errorf("JobArchive Cleanup() error: %v", err)
 		}
 
-		parent := filepath.Clean(filepath.Join(dir, ".."))
-		if util.GetFilecount(parent) == 0 {
-			if err := os.Remove(parent); err != nil {
-				log.Errorf("JobArchive Cleanup() error: %v", err)
-			}
+		if err := removeEmptyDir(filepath.Clean(filepath.Join(dir, ".."))); err != nil {
+			return 0, fmt.Errorf("JobArchive Cleanup() error: %v", err)
 		}
-	}
-
-	log.Infof("Retention Service - Remove %d files in %s", len(jobs), time.Since(start))
+		return 0, nil
+	}, nil)
 }
 
 func (fsa *FsArchive) Compress(jobs []*schema.Job) {
-	var cnt int
-	start := time.Now()
-
-	for _, job := range jobs {
-		fileIn := getPath(job, fsa.path, "data.json")
-		if util.CheckFileExists(fileIn) && util.GetFilesize(fileIn) > 2000 {
-			util.CompressFile(fileIn, getPath(job, fsa.path, "data.json.gz"))
-			cnt++
+	jobs = sortByStartTime(jobs)
+	runService("Compression", len(jobs), func(i int) (int64, error) {
+		fileIn := getPath(jobs[i], fsa.path, "data.json")
+		if !util.CheckFileExists(fileIn) {
+			return 0, nil
 		}
-	}
+		size := util.GetFilesize(fileIn)
+		if size <= 2000 {
+			return 0, nil
+		}
+		return size, util.CompressFileWith(fileIn, getPath(jobs[i], fsa.path, CompressedName(compressionCodec)),
+			func(w io.Writer) (io.WriteCloser, error) {
+				return newCompressWriter(w, compressionCodec, jobs[i].Cluster)
+			})
+	}, func(i int) {
+		filename := filepath.Join(fsa.path, "compress.txt")
+		if err := writeFileAtomic(filename, []byte(fmt.Sprintf("%d", jobs[i].StartTime.Unix()))); err != nil {
+			log.Errorf("fsBackend Compress - %v", err)
+		}
+	})
+}
 
-	log.Infof("Compression Service - %d files took %s", cnt, time.Since(start))
+func writeFileAtomic(filename string, data []byte) error {
+	tmp := filename + ".tmp"
+	if err := os.WriteFile(tmp, data, 0644); err != nil {
+		return err
+	}
+	return os.Rename(tmp, filename)
 }
 
 func (fsa *FsArchive) CompressLast(starttime int64) int64 {
@@ -362,8 +484,7 @@ func (fsa *FsArchive) CompressLast(starttime int64) int64 {
 	filename := filepath.Join(fsa.path, "compress.txt")
 	b, err := os.ReadFile(filename)
 	if err != nil {
-		log.Errorf("fsBackend Compress - %v", err)
-		os.WriteFile(filename, []byte(fmt.Sprintf("%d", starttime)), 0644)
+		log.Infof("fsBackend Compress - no previous run: %v", err)
 		return starttime
 	}
 	last, err := strconv.ParseInt(strings.TrimSuffix(string(b), "\n"), 10, 64)
@@ -373,20 +494,68 @@ func (fsa *FsArchive) CompressLast(starttime int64) int64 {
 	}
 
 	log.Infof("fsBackend Compress - start %d last %d", starttime, last)
-	os.WriteFile(filename, []byte(fmt.Sprintf("%d", starttime)), 0644)
 	return last
 }
 
 func (fsa *FsArchive) LoadJobData(job *schema.Job) (schema.JobData, error) {
-	var isCompressed bool = true
-	filename := getPath(job, fsa.path, "data.json.gz")
+	return loadJobDataDir(getDirectory(job, fsa.path))
+}
+
+func (fsa *FsArchive) LoadJobDataSubset(
+	job *schema.Job,
+	metrics []string,
+	scopes []schema.MetricScope) (schema.JobData, error) {
+
+	dir := getDirectory(job, fsa.path)
+	if filename := filepath.Join(dir, "data.bin"); util.CheckFileExists(filename) {
+		if jd, ok := cache.Get(filename, nil).(schema.JobData); ok {
+			return FilterJobData(jd, metrics, scopes), nil
+		}
+
+		f, err := os.Open(filename)
+		if err != nil {
+			log.Errorf("fsBackend LoadJobDataSubset()- %v", err)
+			return nil, err
+		}
+		defer f.Close()
 
-	if !util.CheckFileExists(filename) {
-		filename = getPath(job, fsa.path, "data.json")
-		isCompressed = false
+		return DecodeJobDataBinary(f, metrics, scopes)
 	}
 
-	return loadJobData(filename, isCompressed)
+	filename, name := jobDataFile(dir)
+	isCompressed := isCompressedName(name)
+
+	// Validation needs the complete document anyways
+	if config.Keys.Validate {
+		jd, err := loadJobData(filename, isCompressed)
+		if err != nil {
+			return nil, err
+		}
+		return FilterJobData(jd, metrics, scopes), nil
+	}
+	if jd, ok := cache.Get(filename, nil).(schema.JobData); ok {
+		return FilterJobData(jd, metrics, scopes), nil
+	}
+
+	f, err := os.Open(filename)
+	if err != nil {
+		log.Errorf("fsBackend LoadJobDataSubset()- %v", err)
+		return nil, err
+	}
+	defer f.Close()
+
+	if isCompressed {
+		r, err := newDecompressReader(f)
+		if err != nil {
+			log.Errorf("fsBackend LoadJobDataSubset()- %s: %v", filename, err)
+			return nil, err
+		}
+		defer r.Close()
+
+		return DecodeJobDataSubset(r, metrics, scopes)
+	}
+
+	return DecodeJobDataSubset(bufio.NewReader(f), metrics, scopes)
 }
 
 func (fsa *FsArchive) LoadJobMeta(job *schema.Job) (*schema.JobMeta, error) {
@@ -409,9 +578,10 @@ func (fsa *FsArchive) LoadClusterCfg(name string) (*schema.Cluster, error) {
 	return DecodeCluster(bytes.NewReader(b))
 }
 
-func (fsa *FsArchive) Iter(loadMetricData bool) <-chan JobContainer {
-
-	ch := make(chan JobContainer)
+// A shard of the file archive is a lvl1 directory of a cluster, for example
+// "emmy/1403". Sends the names of all shards not in skip.
+func (fsa *FsArchive) shards(skip map[string]bool) <-chan string {
+	ch := make(chan string)
 	go func() {
 		clustersDir, err := os.ReadDir(fsa.path)
 		if err != nil {
@@ -433,50 +603,97 @@ func (fsa *FsArchive) Iter(loadMetricData bool) <-chan JobContainer {
 					continue
 				}
 
-				lvl2Dirs, err := os.ReadDir(filepath.Join(fsa.path, clusterDir.Name(), lvl1Dir.Name()))
-				if err != nil {
-					log.Fatalf("Reading jobs failed @ lvl2 dirs: %s", err.Error())
+				shard := clusterDir.Name() + "/" + lvl1Dir.Name()
+				if !skip[shard] {
+					ch <- shard
 				}
+			}
+		}
+		close(ch)
+	}()
+	return ch
+}
 
-				for _, lvl2Dir := range lvl2Dirs {
-					dirpath := filepath.Join(fsa.path, clusterDir.Name(), lvl1Dir.Name(), lvl2Dir.Name())
-					startTimeDirs, err := os.ReadDir(dirpath)
-					if err != nil {
-						log.Fatalf("Reading jobs failed @ starttime dirs: %s", err.Error())
-					}
+func (fsa *FsArchive) scanShard(shard string, loadMetricData bool, emit func(JobContainer)) {
+	lvl2Dirs, err := os.ReadDir(filepath.Join(fsa.path, shard))
+	if err != nil {
+		log.Fatalf("Reading jobs failed @ lvl2 dirs: %s", err.Error())
+	}
 
-					for _, startTimeDir := range startTimeDirs {
-						if startTimeDir.IsDir() {
-							job, err := loadJobMeta(filepath.Join(dirpath, startTimeDir.Name(), "meta.json"))
-							if err != nil && !errors.Is(err, &jsonschema.ValidationError{}) {
-								log.Errorf("in %s: %s", filepath.Join(dirpath, startTimeDir.Name()), err.Error())
-							}
+	for _, lvl2Dir := range lvl2Dirs {
+		dirpath := filepath.Join(fsa.path, shard, lvl2Dir.Name())
+		startTimeDirs, err := os.ReadDir(dirpath)
+		if err != nil {
+			log.Fatalf("Reading jobs failed @ starttime dirs: %s", err.Error())
+		}
 
-							if loadMetricData {
-								var isCompressed bool = true
-								filename := filepath.Join(dirpath, startTimeDir.Name(), "data.json.gz")
-
-								if !util.CheckFileExists(filename) {
-									filename = filepath.Join(dirpath, startTimeDir.Name(), "data.json")
-									isCompressed = false
-								}
-
-								data, err := loadJobData(filename, isCompressed)
-								if err != nil && !errors.Is(err, &jsonschema.ValidationError{}) {
-									log.Errorf("in %s: %s", filepath.Join(dirpath, startTimeDir.Name()), err.Error())
-								}
-								ch <- JobContainer{Meta: job, Data: &data}
-								log.Errorf("in %s: %s", filepath.Join(dirpath, startTimeDir.Name()), err.Error())
-							} else {
-								ch <- JobContainer{Meta: job, Data: nil}
-							}
-						}
-					}
+		for _, startTimeDir := range startTimeDirs {
+			if !startTimeDir.IsDir() {
+				continue
+			}
+
+			job, err := loadJobMeta(filepath.Join(dirpath, startTimeDir.Name(), "meta.json"))
+			if err != nil && !errors.Is(err, &jsonschema.ValidationError{}) {
+				log.Errorf("in %s: %s", filepath.Join(dirpath, startTimeDir.Name()), err.Error())
+			}
+
+			if loadMetricData {
+				data, err := loadJobDataDir(filepath.Join(dirpath, startTimeDir.Name()))
+				if err != nil && !errors.Is(err, &jsonschema.ValidationError{}) {
+					log.Errorf("in %s: %s", filepath.Join(dirpath, startTimeDir.Name()), err.Error())
 				}
+				emit(JobContainer{Meta: job, Data: &data})
+			} else {
+				emit(JobContainer{Meta: job, Data: nil})
 			}
 		}
-		close(ch)
+	}
+}
+
+// Run numWorkers goroutines scanning the shards sent on shards in parallel.
+// done is called once all of them are finished.
+func scanShards(shards <-chan string, numWorkers int, scan func(shard string), done func()) {
+	if numWorkers <= 0 {
+		numWorkers = runtime.NumCPU()
+	}
+
+	var wg sync.WaitGroup
+	wg.Add(numWorkers)
+	for w := 0; w < numWorkers; w++ {
+		go func() {
+			defer wg.Done()
+			for shard := range shards {
+				scan(shard)
+			}
+		}()
+	}
+
+	go func() {
+		wg.Wait()
+		done()
 	}()
+}
+
+// Iter sends all jobs of the archive. The lvl1 directories are scanned in
+// parallel, so the order of the jobs is not defined.
+func (fsa *FsArchive) Iter(loadMetricData bool) <-chan JobContainer {
+	numWorkers := runtime.NumCPU()
+	ch := make(chan JobContainer, numWorkers)
+	scanShards(fsa.shards(nil), numWorkers, func(shard string) {
+		fsa.scanShard(shard, loadMetricData, func(job JobContainer) { ch <- job })
+	}, func() { close(ch) })
+
+	return ch
+}
+
+func (fsa *FsArchive) IterShards(skip map[string]bool, numWorkers int) <-chan JobShard {
+	ch := make(chan JobShard, numWorkers)
+	scanShards(fsa.shards(skip), numWorkers, func(shard string) {
+		js := JobShard{Name: shard}
+		fsa.scanShard(shard, false, func(job JobContainer) { js.Jobs = append(js.Jobs, job.Meta) })
+		ch <- js
+	}, func() { close(ch) })
+
 	return ch
 }
 
@@ -559,6 +776,22 @@ func (fsa *FsArchive) ImportJob(
 	// 	}
 	// }
 
+	if fsa.binary {
+		f, err = os.Create(path.Join(dir, "data.bin"))
+		if err != nil {
+			log.Error("Error while creating filepath for data.bin")
+			return err
+		}
+		if err := EncodeJobDataBinary(f, jobData); err != nil {
+			log.Error("Error while encoding job metricdata to data.bin file")
+			return err
+		}
+		if err := f.Close(); err != nil {
+			log.Warn("Error while closing data.bin file")
+		}
+		return err
+	}
+
 	f, err = os.Create(path.Join(dir, "data.json"))
 	if err != nil {
 		log.Error("Error while creating filepath for data.json")
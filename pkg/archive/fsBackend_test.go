@@ -132,6 +132,48 @@ func TestLoadJobData(t *testing.T) {
 	}
 }
 
+func TestLoadJobDataSubset(t *testing.T) {
+	var fsa FsArchive
+	_, err := fsa.Init(json.RawMessage("{\"path\": \"testdata/archive\"}"))
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	jobIn := schema.Job{BaseJob: schema.JobDefaults}
+	jobIn.StartTime = time.Unix(1609300556, 0)
+	jobIn.JobID = 1404397
+	jobIn.Cluster = "emmy"
+
+	data, err := fsa.LoadJobDataSubset(&jobIn, []string{"flops_any", "mem_bw"}, []schema.MetricScope{schema.MetricScopeNode})
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	if len(data) != 2 {
+		t.Errorf("expected 2 metrics, got %d", len(data))
+	}
+	for _, scopes := range data {
+		if _, exists := scopes[schema.MetricScopeNode]; !exists {
+			t.Fail()
+		}
+	}
+}
+
+func TestSubsetScopes(t *testing.T) {
+	available := []schema.MetricScope{schema.MetricScopeCore, schema.MetricScopeSocket}
+
+	subset := SubsetScopes(available, []schema.MetricScope{schema.MetricScopeSocket})
+	if len(subset) != 1 || subset[0] != schema.MetricScopeSocket {
+		t.Errorf("unexpected subset %v", subset)
+	}
+
+	// Node scope has to be derived from the other scopes
+	subset = SubsetScopes(available, []schema.MetricScope{schema.MetricScopeNode})
+	if len(subset) != 2 {
+		t.Errorf("unexpected subset %v", subset)
+	}
+}
+
 func BenchmarkLoadJobData(b *testing.B) {
 
 	tmpdir := b.TempDir()
@@ -209,3 +251,20 @@ func TestIter(t *testing.T) {
 		}
 	}
 }
+
+func TestIterShards(t *testing.T) {
+	var fsa FsArchive
+	_, err := fsa.Init(json.RawMessage("{\"path\":\"testdata/archive\"}"))
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	shards := make(map[string]int)
+	for shard := range fsa.IterShards(map[string]bool{"emmy/1404": true}, 2) {
+		shards[shard.Name] = len(shard.Jobs)
+	}
+
+	if len(shards) != 1 || shards["emmy/1403"] != 1 {
+		t.Errorf("unexpected shards: %v", shards)
+	}
+}
@@ -9,15 +9,14 @@ import (
 	"io"
 	"time"
 
-	"github.com/ClusterCockpit/cc-backend/pkg/schema"
 	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
 )
 
 func DecodeJobData(r io.Reader, k string) (schema.JobData, error) {
 	data := cache.Get(k, func() (value interface{}, ttl time.Duration, size int) {
-		var d schema.JobData
-		if err := json.NewDecoder(r).Decode(&d); err != nil {
-			log.Warn("Error while decoding raw job data json")
+		d, err := decodeJobData(r)
+		if err != nil {
 			return err, 0, 1000
 		}
 
@@ -32,6 +31,57 @@ func DecodeJobData(r io.Reader, k string) (schema.JobData, error) {
 	return data.(schema.JobData), nil
 }
 
+// Like DecodeJobData, but not cached. For callers caching the result under a
+// key of their own.
+func decodeJobData(r io.Reader) (schema.JobData, error) {
+	var d schema.JobData
+	if err := json.NewDecoder(r).Decode(&d); err != nil {
+		log.Warn("Error while decoding raw job data json")
+		return nil, err
+	}
+	return d, nil
+}
+
+// DecodeJobDataSubset decodes only the metrics and scopes requested (see
+// SubsetScopes). Everything else is skipped without parsing the series.
+// The result is not cached.
+func DecodeJobDataSubset(
+	r io.Reader,
+	metrics []string,
+	scopes []schema.MetricScope) (schema.JobData, error) {
+
+	var raw map[string]map[schema.MetricScope]json.RawMessage
+	if err := json.NewDecoder(r).Decode(&raw); err != nil {
+		log.Warn("Error while decoding raw job data json")
+		return nil, err
+	}
+
+	jd := make(schema.JobData, len(raw))
+	for metric, perScope := range raw {
+		if !containsMetric(metrics, metric) {
+			continue
+		}
+
+		available := make([]schema.MetricScope, 0, len(perScope))
+		for scope := range perScope {
+			available = append(available, scope)
+		}
+
+		subset := make(map[schema.MetricScope]*schema.JobMetric, len(perScope))
+		for _, scope := range SubsetScopes(available, scopes) {
+			jm := &schema.JobMetric{}
+			if err := json.Unmarshal(perScope[scope], jm); err != nil {
+				log.Warnf("Error while decoding job data of %s/%s", metric, scope)
+				return nil, err
+			}
+			subset[scope] = jm
+		}
+		jd[metric] = subset
+	}
+
+	return jd, nil
+}
+
 func DecodeJobMeta(r io.Reader) (*schema.JobMeta, error) {
 	var d schema.JobMeta
 	if err := json.NewDecoder(r).Decode(&d); err != nil {
@@ -58,7 +108,7 @@ func DecodeCluster(r io.Reader) (*schema.Cluster, error) {
 
 func EncodeJobData(w io.Writer, d *schema.JobData) error {
 	// Sanitize parameters
-	if err := json.NewEncoder(w).Encode(d); err != nil {
+	if err := d.WriteJSON(w); err != nil {
 		log.Warn("Error while encoding new job data json")
 		return err
 	}
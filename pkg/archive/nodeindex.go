@@ -0,0 +1,118 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package archive
+
+import (
+	"fmt"
+	"strings"
+)
+
+// Terms of a node list with more nodes than this are not expanded into the
+// index but matched against every hostname not found in it.
+const maxIndexedNodes = 1 << 16
+
+// A comma separated part of a node list.
+type nodeListTerm = []interface {
+	consume(input string) (next string, ok bool)
+	limits() []map[string]int
+	prefix() string
+}
+
+// The subclusters of the hostnames of a cluster, compiled once from the node
+// lists of its subclusters. If node lists overlap, the subcluster listed
+// first in the cluster config wins.
+type nodeIndex struct {
+	hosts map[string]string
+	terms []nodeIndexTerm
+}
+
+type nodeIndexTerm struct {
+	prefix     string
+	term       NodeList
+	subCluster string
+}
+
+func newNodeIndex() *nodeIndex {
+	return &nodeIndex{hosts: make(map[string]string)}
+}
+
+// Adds the nodes of nl to the index as nodes of subCluster.
+func (ni *nodeIndex) add(subCluster string, nl NodeList) {
+	for _, term := range nl {
+		if len(term) == 0 {
+			continue
+		}
+		if termNodeCount(term) > maxIndexedNodes {
+			prefix := ""
+			if s, ok := term[0].(NLExprString); ok {
+				prefix = string(s)
+			}
+			ni.terms = append(ni.terms, nodeIndexTerm{prefix: prefix, term: NodeList{term}, subCluster: subCluster})
+			continue
+		}
+
+		expandTerm(term, "", func(hostname string) {
+			if _, ok := ni.hosts[hostname]; !ok {
+				ni.hosts[hostname] = subCluster
+			}
+		})
+	}
+}
+
+func (ni *nodeIndex) lookup(hostname string) (string, bool) {
+	if sc, ok := ni.hosts[hostname]; ok {
+		return sc, true
+	}
+	for i := range ni.terms {
+		t := &ni.terms[i]
+		if strings.HasPrefix(hostname, t.prefix) && t.term.Contains(hostname) {
+			return t.subCluster, true
+		}
+	}
+	return "", false
+}
+
+func termNodeCount(term nodeListTerm) int {
+	count := 1
+	for _, expr := range term {
+		if ranges, ok := expr.(NLExprIntRanges); ok {
+			n := 0
+			for _, r := range ranges {
+				if r.end >= r.start {
+					n += int(r.end-r.start) + 1
+				}
+			}
+			if count *= n; count > maxIndexedNodes || count == 0 {
+				return count
+			}
+		}
+	}
+	return count
+}
+
+// Calls fn for every hostname the term of a node list matches.
+func expandTerm(term nodeListTerm, prefix string, fn func(hostname string)) {
+	if len(term) == 0 {
+		fn(prefix)
+		return
+	}
+
+	switch expr := term[0].(type) {
+	case NLExprString:
+		expandTerm(term[1:], prefix+string(expr), fn)
+	case NLExprIntRanges:
+		for _, r := range expr {
+			// NLExprIntRange.consume reads exactly r.digits numerals, so
+			// wider values of the range never match a hostname
+			for x := r.start; x <= r.end; x++ {
+				s := fmt.Sprintf("%0*d", r.digits, x)
+				if len(s) > r.digits {
+					break
+				}
+				expandTerm(term[1:], prefix+s, fn)
+			}
+		}
+	}
+}
@@ -0,0 +1,87 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package archive
+
+import (
+	"fmt"
+	"testing"
+)
+
+func TestNodeIndex(t *testing.T) {
+	lists := []struct{ subCluster, nodes string }{
+		{"a", "hallo,emmy[01-99],fritz[005-500]x,,w[1-2]n[01-03]"},
+		{"b", "emmy[50-60,100-120],woody[100-200]"},
+		// Too large to be expanded
+		{"c", "big[0000000-9999999]"},
+	}
+
+	ni := newNodeIndex()
+	nls := make([]NodeList, len(lists))
+	for i, l := range lists {
+		nl, err := ParseNodeList(l.nodes)
+		if err != nil {
+			t.Fatal(err)
+		}
+		nls[i] = nl
+		ni.add(l.subCluster, nl)
+	}
+	// Not accepted by ParseNodeList, values wider than the start of the
+	// range never match
+	lists = append(lists, struct{ subCluster, nodes string }{"d", "x[8-12]"})
+	nls = append(nls, NodeList{{NLExprString("x"), NLExprIntRanges{{start: 8, end: 12, zeroPadded: true, digits: 1}}}})
+	ni.add("d", nls[len(nls)-1])
+	if len(ni.terms) != 1 {
+		t.Errorf("want one term matched on lookup, got %d", len(ni.terms))
+	}
+
+	for _, hostname := range []string{
+		"", "hallo", "hallo1", "emmy00", "emmy01", "emmy55", "emmy99", "emmy100", "emmy1",
+		"fritz004x", "fritz005x", "fritz500x", "fritz500", "w1n01", "w2n03", "w3n01", "w1n1",
+		"woody099", "woody100", "woody200", "big0000000", "big1234567", "big123456", "bigger",
+		"x8", "x9", "x10", "x12", "x1",
+	} {
+		want := ""
+		for i, nl := range nls {
+			if nl.Contains(hostname) {
+				want = lists[i].subCluster
+				break
+			}
+		}
+
+		got, ok := ni.lookup(hostname)
+		if got != want || ok != (want != "") {
+			t.Errorf("%#v: want subcluster %#v, got %#v (%v)", hostname, want, got, ok)
+		}
+	}
+}
+
+func BenchmarkSubClusterLookup(b *testing.B) {
+	var nodes string
+	for i := 0; i < 20; i++ {
+		nodes += fmt.Sprintf("r%02d[0001-0500],", i)
+	}
+	nl, err := ParseNodeList(nodes[:len(nodes)-1])
+	if err != nil {
+		b.Fatal(err)
+	}
+	ni := newNodeIndex()
+	ni.add("sc", nl)
+
+	hostnames := nl.PrintList()
+	b.Run("NodeList", func(b *testing.B) {
+		for i := 0; i < b.N; i++ {
+			if !nl.Contains(hostnames[i%len(hostnames)]) {
+				b.Fatal("not found")
+			}
+		}
+	})
+	b.Run("nodeIndex", func(b *testing.B) {
+		for i := 0; i < b.N; i++ {
+			if _, ok := ni.lookup(hostnames[i%len(hostnames)]); !ok {
+				b.Fatal("not found")
+			}
+		}
+	})
+}
@@ -4,10 +4,877 @@
 // license that can be found in the LICENSE file.
 package archive
 
+import (
+	"bufio"
+	"bytes"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"io"
+	"math"
+	"os"
+	"path"
+	"path/filepath"
+	"runtime"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+	"text/tabwriter"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/internal/config"
+	"github.com/ClusterCockpit/cc-backend/internal/util"
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+// The S3 archive stores the same objects as the file archive in a bucket:
+// <prefix>/version.txt, <prefix>/<cluster>/cluster.json and the job
+// directories <prefix>/<cluster>/<lvl1>/<lvl2>/<starttime>/ with meta.json
+// and one of data.bin, data.json.zz, data.json.gz or data.json.
+//
+// The metadata of all jobs is kept in a local index file, so that Iter,
+// Exists and Info never list the bucket. The index is built from the bucket
+// if the file does not exist, it assumes that only this instance writes to
+// the archive. Delete the file to rebuild it after changes by other tools.
 type S3ArchiveConfig struct {
-	Path string `json:"filePath"`
+	// URL of the S3 API, for example https://s3.eu-central-1.amazonaws.com
+	Endpoint string `json:"endpoint"`
+	Bucket   string `json:"bucket"`
+	// Key prefix of the archive in the bucket (default: the bucket root)
+	Prefix string `json:"prefix"`
+	Region string `json:"region"`
+	// Access key id, the secret key is read from S3_SECRET_KEY. Both
+	// default to the AWS_ACCESS_KEY_ID and AWS_SECRET_ACCESS_KEY variables.
+	AccessKey string `json:"access-key"`
+	// Format used for newly archived job data: "binary" (default) or "json"
+	Format string `json:"format"`
+	// Local metadata index (default: ./var/job-archive-s3.index)
+	Index string `json:"index"`
+	// Job data larger than this is uploaded in parts (MiB, default: 8)
+	PartSize int `json:"part-size"`
+	// Number of parts uploaded at the same time (default: 4)
+	UploadConcurrency int `json:"upload-concurrency"`
 }
 
 type S3Archive struct {
-	path string
+	client            *s3Client
+	prefix            string
+	binary            bool
+	clusters          []string
+	partSize          int
+	uploadConcurrency int
+
+	// Local metadata index, by job directory relative to the prefix
+	lock      sync.RWMutex
+	index     map[string]*s3IndexEntry
+	indexFile *os.File
+}
+
+// Line of the index file. A line with only Dir removes the job.
+type s3IndexEntry struct {
+	Dir  string          `json:"dir"`
+	Meta json.RawMessage `json:"meta,omitempty"`
+	// Name and size of the job data object
+	Data string `json:"data,omitempty"`
+	Size int64  `json:"size,omitempty"`
+}
+
+// The shard of a job directory, see FsArchive.shards.
+func (e *s3IndexEntry) shard() string {
+	parts := strings.SplitN(e.Dir, "/", 3)
+	if len(parts) < 2 {
+		return e.Dir
+	}
+	return parts[0] + "/" + parts[1]
+}
+
+func (e *s3IndexEntry) startTime() int64 {
+	startTime, err := strconv.ParseInt(path.Base(e.Dir), 10, 64)
+	if err != nil {
+		log.Warnf("S3 archive index: cannot parse starttime of %s", e.Dir)
+	}
+	return startTime
+}
+
+func s3JobDir(job *schema.Job) string {
+	return filepath.ToSlash(getDirectory(job, ""))
+}
+
+func (s3a *S3Archive) key(elem ...string) string {
+	return path.Join(append([]string{s3a.prefix}, elem...)...)
+}
+
+func (s3a *S3Archive) Init(rawConfig json.RawMessage) (uint64, error) {
+	var cfg S3ArchiveConfig
+	if err := json.Unmarshal(rawConfig, &cfg); err != nil {
+		log.Warnf("Init() > Unmarshal error: %#v", err)
+		return 0, err
+	}
+	if cfg.Endpoint == "" || cfg.Bucket == "" {
+		err := fmt.Errorf("Init() : empty config.Endpoint or config.Bucket")
+		log.Errorf("Init() > config error: %v", err)
+		return 0, err
+	}
+
+	switch cfg.Format {
+	case "", "binary":
+		s3a.binary = true
+	case "json":
+	default:
+		err := fmt.Errorf("Init() : unknown job data format '%s'", cfg.Format)
+		log.Errorf("Init() > config.Format error: %v", err)
+		return 0, err
+	}
+
+	accessKey, secretKey := cfg.AccessKey, os.Getenv("S3_SECRET_KEY")
+	if accessKey == "" {
+		accessKey = os.Getenv("AWS_ACCESS_KEY_ID")
+	}
+	if secretKey == "" {
+		secretKey = os.Getenv("AWS_SECRET_ACCESS_KEY")
+	}
+	if accessKey != "" && secretKey == "" {
+		return 0, errors.New("ARCHIVE/S3 > access key provided, but S3_SECRET_KEY not set")
+	}
+
+	client, err := newS3Client(cfg.Endpoint, cfg.Bucket, cfg.Region, accessKey, secretKey)
+	if err != nil {
+		log.Errorf("Init() > S3 client error: %v", err)
+		return 0, err
+	}
+	s3a.client = client
+	s3a.prefix = strings.Trim(cfg.Prefix, "/")
+	s3a.partSize = 8 * 1024 * 1024
+	if cfg.PartSize > 0 {
+		// S3 rejects parts smaller than 5 MiB
+		s3a.partSize = util.Max(cfg.PartSize, 5) * 1024 * 1024
+	}
+	s3a.uploadConcurrency = 4
+	if cfg.UploadConcurrency > 0 {
+		s3a.uploadConcurrency = cfg.UploadConcurrency
+	}
+
+	b, err := s3a.client.get(s3a.key("version.txt"))
+	if err != nil {
+		log.Warnf("s3Backend Init() - %v", err)
+		return 0, err
+	}
+
+	version, err := strconv.ParseUint(strings.TrimSpace(string(b)), 10, 64)
+	if err != nil {
+		log.Errorf("s3Backend Init()- %v", err)
+		return 0, err
+	}
+
+	if version != Version {
+		return version, fmt.Errorf("unsupported version %d, need %d", version, Version)
+	}
+
+	clusterPrefix := ""
+	if s3a.prefix != "" {
+		clusterPrefix = s3a.prefix + "/"
+	}
+	err = s3a.client.list(clusterPrefix, "/", func(page *s3ListResult) error {
+		for _, p := range page.CommonPrefixes {
+			s3a.clusters = append(s3a.clusters, strings.TrimSuffix(strings.TrimPrefix(p.Prefix, clusterPrefix), "/"))
+		}
+		return nil
+	})
+	if err != nil {
+		log.Errorf("Init() > list clusters error: %v", err)
+		return 0, err
+	}
+
+	for _, cluster := range s3a.clusters {
+		s3a.loadDictionaries(cluster)
+	}
+
+	if cfg.Index == "" {
+		cfg.Index = "./var/job-archive-s3.index"
+	}
+	if err := s3a.openIndex(cfg.Index); err != nil {
+		log.Errorf("Init() > index error: %v", err)
+		return 0, err
+	}
+
+	return version, nil
+}
+
+// Loads the index file, or builds it from the bucket if it does not exist,
+// and opens it for appending. Superseded lines are dropped on every load.
+func (s3a *S3Archive) openIndex(filename string) error {
+	s3a.index = make(map[string]*s3IndexEntry)
+
+	f, err := os.Open(filename)
+	if err == nil {
+		dec := json.NewDecoder(bufio.NewReader(f))
+		for {
+			e := &s3IndexEntry{}
+			if err := dec.Decode(e); err == io.EOF {
+				break
+			} else if err != nil {
+				// An interrupted last write only loses that line
+				log.Warnf("S3 archive index %s: %v", filename, err)
+				break
+			}
+			if e.Meta == nil {
+				delete(s3a.index, e.Dir)
+			} else {
+				s3a.index[e.Dir] = e
+			}
+		}
+		f.Close()
+	} else if errors.Is(err, os.ErrNotExist) {
+		start := time.Now()
+		if err := s3a.buildIndex(); err != nil {
+			return err
+		}
+		log.Infof("Built S3 archive index of %d jobs in %s", len(s3a.index), time.Since(start))
+	} else {
+		return err
+	}
+
+	if err := os.MkdirAll(filepath.Dir(filename), 0777); err != nil {
+		return err
+	}
+	tmp := filename + ".tmp"
+	out, err := os.Create(tmp)
+	if err != nil {
+		return err
+	}
+	bw := bufio.NewWriter(out)
+	enc := json.NewEncoder(bw)
+	for _, e := range s3a.index {
+		if err := enc.Encode(e); err != nil {
+			out.Close()
+			return err
+		}
+	}
+	if err := bw.Flush(); err != nil {
+		out.Close()
+		return err
+	}
+	if err := out.Close(); err != nil {
+		return err
+	}
+	if err := os.Rename(tmp, filename); err != nil {
+		return err
+	}
+
+	s3a.indexFile, err = os.OpenFile(filename, os.O_WRONLY|os.O_APPEND, 0666)
+	return err
+}
+
+// Lists all objects of the archive and loads the meta.json of every job.
+func (s3a *S3Archive) buildIndex() error {
+	listPrefix := ""
+	if s3a.prefix != "" {
+		listPrefix = s3a.prefix + "/"
+	}
+
+	// Job data in the order loadJobDataDir prefers it
+	rank := make(map[string]int, len(jobDataFiles))
+	for i, name := range jobDataFiles {
+		rank[name] = len(jobDataFiles) - i
+	}
+	entries := make(map[string]*s3IndexEntry)
+	hasMeta := make(map[string]bool)
+	err := s3a.client.list(listPrefix, "", func(page *s3ListResult) error {
+		for _, obj := range page.Contents {
+			dir, name := path.Split(strings.TrimPrefix(obj.Key, listPrefix))
+			dir = strings.TrimSuffix(dir, "/")
+			if strings.Count(dir, "/") != 3 {
+				// version.txt, cluster.json, ...
+				continue
+			}
+
+			e, ok := entries[dir]
+			if !ok {
+				e = &s3IndexEntry{Dir: dir}
+				entries[dir] = e
+			}
+			if name == "meta.json" {
+				hasMeta[dir] = true
+			} else if rank[name] > rank[e.Data] {
+				e.Data, e.Size = name, obj.Size
+			}
+		}
+		return nil
+	})
+	if err != nil {
+		return err
+	}
+
+	dirs := make(chan string)
+	var wg sync.WaitGroup
+	var lock sync.Mutex
+	for w := 0; w < 4*runtime.NumCPU(); w++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for dir := range dirs {
+				b, err := s3a.client.get(s3a.key(dir, "meta.json"))
+				if err != nil {
+					log.Errorf("in %s: %s", dir, err.Error())
+					continue
+				}
+				var meta bytes.Buffer
+				if err := json.Compact(&meta, b); err != nil {
+					log.Errorf("in %s: %s", dir, err.Error())
+					continue
+				}
+
+				lock.Lock()
+				e := entries[dir]
+				e.Meta = meta.Bytes()
+				s3a.index[dir] = e
+				lock.Unlock()
+			}
+		}()
+	}
+	for dir := range entries {
+		if hasMeta[dir] {
+			dirs <- dir
+		}
+	}
+	close(dirs)
+	wg.Wait()
+
+	return nil
+}
+
+func (s3a *S3Archive) writeIndex(e *s3IndexEntry) {
+	b, err := json.Marshal(e)
+	if err != nil {
+		log.Errorf("S3 archive index: %v", err)
+		return
+	}
+
+	s3a.lock.Lock()
+	defer s3a.lock.Unlock()
+	if e.Meta == nil {
+		delete(s3a.index, e.Dir)
+	} else {
+		s3a.index[e.Dir] = e
+	}
+	if _, err := s3a.indexFile.Write(append(b, '\n')); err != nil {
+		log.Errorf("S3 archive index: %v", err)
+	}
+}
+
+func (s3a *S3Archive) lookup(job *schema.Job) (*s3IndexEntry, error) {
+	s3a.lock.RLock()
+	defer s3a.lock.RUnlock()
+	e, ok := s3a.index[s3JobDir(job)]
+	if !ok {
+		return nil, fmt.Errorf("ARCHIVE/S3 > job %s not in archive: %w", s3JobDir(job), os.ErrNotExist)
+	}
+	return e, nil
+}
+
+// All index entries sorted by directory.
+func (s3a *S3Archive) entries() []*s3IndexEntry {
+	s3a.lock.RLock()
+	entries := make([]*s3IndexEntry, 0, len(s3a.index))
+	for _, e := range s3a.index {
+		entries = append(entries, e)
+	}
+	s3a.lock.RUnlock()
+
+	sort.Slice(entries, func(i, j int) bool { return entries[i].Dir < entries[j].Dir })
+	return entries
+}
+
+func (s3a *S3Archive) Info() {
+	fmt.Printf("Job archive s3://%s/%s\n", s3a.client.bucket, s3a.prefix)
+
+	ci := make(map[string]*clusterInfo)
+	for _, e := range s3a.entries() {
+		cc := e.Dir[:strings.IndexByte(e.Dir, '/')]
+		if _, ok := ci[cc]; !ok {
+			ci[cc] = &clusterInfo{dateFirst: time.Now().Unix()}
+		}
+		startTime := e.startTime()
+		ci[cc].numJobs++
+		ci[cc].dateFirst = util.Min(ci[cc].dateFirst, startTime)
+		ci[cc].dateLast = util.Max(ci[cc].dateLast, startTime)
+		ci[cc].diskSize += float64(e.Size+int64(len(e.Meta))) * 1e-6
+	}
+
+	cit := clusterInfo{dateFirst: time.Now().Unix()}
+	w := tabwriter.NewWriter(os.Stdout, 0, 0, 2, ' ', tabwriter.Debug)
+	fmt.Fprintln(w, "cluster\t#jobs\tfrom\tto\tdu (MB)")
+	for cluster, clusterInfo := range ci {
+		fmt.Fprintf(w, "%s\t%d\t%s\t%s\t%.2f\n", cluster,
+			clusterInfo.numJobs,
+			time.Unix(clusterInfo.dateFirst, 0),
+			time.Unix(clusterInfo.dateLast, 0),
+			clusterInfo.diskSize)
+
+		cit.numJobs += clusterInfo.numJobs
+		cit.dateFirst = util.Min(cit.dateFirst, clusterInfo.dateFirst)
+		cit.dateLast = util.Max(cit.dateLast, clusterInfo.dateLast)
+		cit.diskSize += clusterInfo.diskSize
+	}
+
+	fmt.Fprintf(w, "TOTAL\t%d\t%s\t%s\t%.2f\n",
+		cit.numJobs, time.Unix(cit.dateFirst, 0), time.Unix(cit.dateLast, 0), cit.diskSize)
+	w.Flush()
+}
+
+func (s3a *S3Archive) Exists(job *schema.Job) bool {
+	_, err := s3a.lookup(job)
+	return err == nil
+}
+
+func (s3a *S3Archive) LoadJobMeta(job *schema.Job) (*schema.JobMeta, error) {
+	e, err := s3a.lookup(job)
+	if err != nil {
+		log.Errorf("LoadJobMeta() > %v", err)
+		return &schema.JobMeta{}, err
+	}
+	return decodeJobMeta(e.Meta)
+}
+
+// Register the dictionaries of cluster, all kept ones for reading and the
+// current one for new files as well.
+func (s3a *S3Archive) loadDictionaries(cluster string) {
+	var keys []string
+	err := s3a.client.list(s3a.key(cluster, "compression."), "/", func(page *s3ListResult) error {
+		for _, obj := range page.Contents {
+			if isDictionaryFileName(path.Base(obj.Key)) {
+				keys = append(keys, obj.Key)
+			}
+		}
+		return nil
+	})
+	if err != nil {
+		log.Warnf("s3Backend Init() - %v", err)
+	}
+	for _, key := range keys {
+		dict, err := s3a.client.get(key)
+		if err != nil {
+			log.Warnf("s3Backend Init() - %v", err)
+			continue
+		}
+		addDictionary(dict)
+	}
+
+	dict, err := s3a.client.get(s3a.key(cluster, DictionaryFile))
+	if err == nil {
+		RegisterDictionary(cluster, dict)
+	} else if !errors.Is(err, os.ErrNotExist) {
+		log.Warnf("s3Backend Init() - %v", err)
+	}
+}
+
+func (s3a *S3Archive) cacheKey(e *s3IndexEntry) string {
+	return "s3://" + s3a.client.bucket + "/" + s3a.key(e.Dir, e.Data)
+}
+
+// Decodes job data in any of the formats of the archive. The result is not
+// cached, see loadJobData.
+func decodeJobDataObject(b []byte, name string) (schema.JobData, error) {
+	if name == "data.bin" {
+		return DecodeJobDataBinary(bytes.NewReader(b), nil, nil)
+	}
+
+	var r io.Reader = bytes.NewReader(b)
+	if isCompressedName(name) {
+		dr, err := newDecompressReader(r)
+		if err != nil {
+			log.Errorf("s3Backend decodeJobDataObject()- %v", err)
+			return nil, err
+		}
+		defer dr.Close()
+		r = dr
+	}
+
+	if config.Keys.Validate {
+		// The stream is read twice
+		raw, err := io.ReadAll(r)
+		if err != nil {
+			return nil, err
+		}
+		if err := schema.Validate(schema.Data, bytes.NewReader(raw)); err != nil {
+			return schema.JobData{}, fmt.Errorf("validate job data: %v", err)
+		}
+		r = bytes.NewReader(raw)
+	}
+	return decodeJobData(r)
+}
+
+func (s3a *S3Archive) loadJobData(e *s3IndexEntry) (schema.JobData, error) {
+	data := cache.Get(s3a.cacheKey(e), func() (value interface{}, ttl time.Duration, size int) {
+		b, err := s3a.client.get(s3a.key(e.Dir, e.Data))
+		if err != nil {
+			log.Errorf("s3Backend LoadJobData()- %v", err)
+			return err, 0, 1000
+		}
+
+		d, err := decodeJobDataObject(b, e.Data)
+		if err != nil {
+			log.Warnf("Error while decoding job data %s/%s", e.Dir, e.Data)
+			return err, 0, 1000
+		}
+
+		return d, 1 * time.Hour, d.Size()
+	})
+
+	if err, ok := data.(error); ok {
+		return nil, err
+	}
+
+	return data.(schema.JobData), nil
+}
+
+func (s3a *S3Archive) LoadJobData(job *schema.Job) (schema.JobData, error) {
+	e, err := s3a.lookup(job)
+	if err != nil {
+		log.Errorf("LoadJobData() > %v", err)
+		return nil, err
+	}
+	return s3a.loadJobData(e)
+}
+
+// Binary job data is read with ranged GETs: one for the header and index
+// and one per metric and scope selected. JSON job data is loaded completely
+// and filtered.
+func (s3a *S3Archive) LoadJobDataSubset(
+	job *schema.Job,
+	metrics []string,
+	scopes []schema.MetricScope) (schema.JobData, error) {
+
+	e, err := s3a.lookup(job)
+	if err != nil {
+		log.Errorf("LoadJobDataSubset() > %v", err)
+		return nil, err
+	}
+
+	if jd, ok := cache.Get(s3a.cacheKey(e), nil).(schema.JobData); ok {
+		return FilterJobData(jd, metrics, scopes), nil
+	}
+
+	if e.Data != "data.bin" {
+		jd, err := s3a.loadJobData(e)
+		if err != nil {
+			return nil, err
+		}
+		return FilterJobData(jd, metrics, scopes), nil
+	}
+
+	r := &s3RangeReader{client: s3a.client, key: s3a.key(e.Dir, e.Data), size: e.Size}
+	return DecodeJobDataBinary(r, metrics, scopes)
+}
+
+func (s3a *S3Archive) LoadClusterCfg(name string) (*schema.Cluster, error) {
+	b, err := s3a.client.get(s3a.key(name, "cluster.json"))
+	if err != nil {
+		log.Errorf("LoadClusterCfg() > get object error: %v", err)
+		return &schema.Cluster{}, err
+	}
+	if config.Keys.Validate {
+		if err := schema.Validate(schema.ClusterCfg, bytes.NewReader(b)); err != nil {
+			log.Warnf("Validate cluster config: %v\n", err)
+			return &schema.Cluster{}, fmt.Errorf("validate cluster config: %v", err)
+		}
+	}
+	return DecodeCluster(bytes.NewReader(b))
+}
+
+func encodeJobMetaCompact(jobMeta *schema.JobMeta) ([]byte, error) {
+	var buf bytes.Buffer
+	if err := EncodeJobMeta(&buf, jobMeta); err != nil {
+		return nil, err
+	}
+	var meta bytes.Buffer
+	if err := json.Compact(&meta, buf.Bytes()); err != nil {
+		return nil, err
+	}
+	return meta.Bytes(), nil
+}
+
+func (s3a *S3Archive) StoreJobMeta(jobMeta *schema.JobMeta) error {
+	job := schema.Job{
+		BaseJob:       jobMeta.BaseJob,
+		StartTime:     time.Unix(jobMeta.StartTime, 0),
+		StartTimeUnix: jobMeta.StartTime,
+	}
+	e, err := s3a.lookup(&job)
+	if err != nil {
+		log.Errorf("StoreJobMeta() > %v", err)
+		return err
+	}
+
+	meta, err := encodeJobMetaCompact(jobMeta)
+	if err != nil {
+		log.Error("Error while encoding job metadata to meta.json file")
+		return err
+	}
+	if err := s3a.client.put(s3a.key(e.Dir, "meta.json"), meta); err != nil {
+		log.Error("Error while uploading meta.json")
+		return err
+	}
+
+	s3a.writeIndex(&s3IndexEntry{Dir: e.Dir, Meta: meta, Data: e.Data, Size: e.Size})
+	return nil
+}
+
+func (s3a *S3Archive) GetClusters() []string {
+	return s3a.clusters
+}
+
+// The job data is uploaded before meta.json, so that a job directory without
+// meta.json is never taken for a complete job when the index is rebuilt.
+func (s3a *S3Archive) ImportJob(
+	jobMeta *schema.JobMeta,
+	jobData *schema.JobData) error {
+
+	job := schema.Job{
+		BaseJob:       jobMeta.BaseJob,
+		StartTime:     time.Unix(jobMeta.StartTime, 0),
+		StartTimeUnix: jobMeta.StartTime,
+	}
+	dir := s3JobDir(&job)
+
+	meta, err := encodeJobMetaCompact(jobMeta)
+	if err != nil {
+		log.Error("Error while encoding job metadata to meta.json file")
+		return err
+	}
+
+	var data bytes.Buffer
+	name := "data.json"
+	if s3a.binary {
+		name = "data.bin"
+		err = EncodeJobDataBinary(&data, jobData)
+	} else {
+		err = EncodeJobData(&data, jobData)
+	}
+	if err != nil {
+		log.Errorf("Error while encoding job metricdata to %s file", name)
+		return err
+	}
+
+	if err := s3a.client.upload(s3a.key(dir, name), data.Bytes(), s3a.partSize, s3a.uploadConcurrency); err != nil {
+		log.Errorf("Error while uploading %s", name)
+		return err
+	}
+	if err := s3a.client.put(s3a.key(dir, "meta.json"), meta); err != nil {
+		log.Error("Error while uploading meta.json")
+		return err
+	}
+
+	if old, err := s3a.lookup(&job); err == nil && old.Data != "" && old.Data != name {
+		if err := s3a.client.delete(s3a.key(dir, old.Data)); err != nil {
+			log.Warnf("Error while removing %s/%s: %v", dir, old.Data, err)
+		}
+	}
+	s3a.writeIndex(&s3IndexEntry{Dir: dir, Meta: meta, Data: name, Size: int64(data.Len())})
+	return nil
+}
+
+// Removes the objects of a job directory and its index entry.
+func (s3a *S3Archive) remove(e *s3IndexEntry) error {
+	if e.Data != "" {
+		if err := s3a.client.delete(s3a.key(e.Dir, e.Data)); err != nil {
+			return err
+		}
+	}
+	if err := s3a.client.delete(s3a.key(e.Dir, "meta.json")); err != nil {
+		return err
+	}
+	s3a.writeIndex(&s3IndexEntry{Dir: e.Dir})
+	return nil
+}
+
+// Runs the service on the index entries of the jobs, jobs not in the
+// index (as those already removed by an interrupted run) are skipped.
+func (s3a *S3Archive) runJobService(name string, jobs []*schema.Job, process func(e *s3IndexEntry) (int64, error), checkpoint func(i int)) {
+	runService(name, len(jobs), func(i int) (int64, error) {
+		e, err := s3a.lookup(jobs[i])
+		if err != nil {
+			return 0, nil
+		}
+		return process(e)
+	}, checkpoint)
+}
+
+func (s3a *S3Archive) CleanUp(jobs []*schema.Job) {
+	s3a.runJobService("Retention", jobs, func(e *s3IndexEntry) (int64, error) {
+		if err := s3a.remove(e); err != nil {
+			return 0, fmt.Errorf("JobArchive Cleanup() error: %v", err)
+		}
+		return 0, nil
+	}, nil)
+}
+
+// The jobs are moved to the directory path on the local file system, in the
+// layout of the file archive.
+func (s3a *S3Archive) Move(jobs []*schema.Job, path string) {
+	s3a.runJobService("Retention", jobs, func(e *s3IndexEntry) (int64, error) {
+		target := filepath.Join(path, filepath.FromSlash(e.Dir))
+		if err := os.MkdirAll(target, 0777); err != nil {
+			return 0, fmt.Errorf("JobArchive Move MkDir error: %v", err)
+		}
+		if err := os.WriteFile(filepath.Join(target, "meta.json"), e.Meta, 0666); err != nil {
+			return 0, fmt.Errorf("JobArchive Move() error: %v", err)
+		}
+		if e.Data != "" {
+			b, err := s3a.client.get(s3a.key(e.Dir, e.Data))
+			if err == nil {
+				err = os.WriteFile(filepath.Join(target, e.Data), b, 0666)
+			}
+			if err != nil {
+				return 0, fmt.Errorf("JobArchive Move() error: %v", err)
+			}
+		}
+		if err := s3a.remove(e); err != nil {
+			return e.Size, fmt.Errorf("JobArchive Move() error: %v", err)
+		}
+		return e.Size, nil
+	}, nil)
+}
+
+func (s3a *S3Archive) Clean(before int64, after int64) {
+	if after == 0 {
+		after = math.MaxInt64
+	}
+
+	entries := make([]*s3IndexEntry, 0)
+	for _, e := range s3a.entries() {
+		if startTime := e.startTime(); startTime < before || startTime > after {
+			entries = append(entries, e)
+		}
+	}
+	runService("Retention", len(entries), func(i int) (int64, error) {
+		if err := s3a.remove(entries[i]); err != nil {
+			return 0, fmt.Errorf("JobArchive Clean() error: %v", err)
+		}
+		return 0, nil
+	}, nil)
+}
+
+func (s3a *S3Archive) Compress(jobs []*schema.Job) {
+	jobs = sortByStartTime(jobs)
+	s3a.runJobService("Compression", jobs, func(e *s3IndexEntry) (int64, error) {
+		if e.Data != "data.json" || e.Size <= 2000 {
+			return 0, nil
+		}
+
+		b, err := s3a.client.get(s3a.key(e.Dir, e.Data))
+		if err != nil {
+			return 0, fmt.Errorf("JobArchive Compress() error: %v", err)
+		}
+		cluster := strings.SplitN(e.Dir, "/", 2)[0]
+		compressed, err := compressBytes(b, compressionCodec, cluster)
+		if err != nil {
+			return int64(len(b)), fmt.Errorf("JobArchive Compress() error: %v", err)
+		}
+		name := CompressedName(compressionCodec)
+		if err := s3a.client.upload(s3a.key(e.Dir, name), compressed, s3a.partSize, s3a.uploadConcurrency); err != nil {
+			return int64(len(b)), fmt.Errorf("JobArchive Compress() error: %v", err)
+		}
+
+		s3a.writeIndex(&s3IndexEntry{Dir: e.Dir, Meta: e.Meta, Data: name, Size: int64(len(compressed))})
+		if err := s3a.client.delete(s3a.key(e.Dir, "data.json")); err != nil {
+			return int64(len(b)), fmt.Errorf("JobArchive Compress() error: %v", err)
+		}
+		return int64(len(b)), nil
+	}, func(i int) {
+		if err := s3a.client.put(s3a.key("compress.txt"), []byte(fmt.Sprintf("%d", jobs[i].StartTime.Unix()))); err != nil {
+			log.Errorf("s3Backend Compress - %v", err)
+		}
+	})
+}
+
+func (s3a *S3Archive) CompressLast(starttime int64) int64 {
+	b, err := s3a.client.get(s3a.key("compress.txt"))
+	if err != nil {
+		log.Infof("s3Backend Compress - no previous run: %v", err)
+		return starttime
+	}
+	last, err := strconv.ParseInt(strings.TrimSpace(string(b)), 10, 64)
+	if err != nil {
+		log.Errorf("s3Backend Compress - %v", err)
+		return starttime
+	}
+
+	log.Infof("s3Backend Compress - start %d last %d", starttime, last)
+	return last
+}
+
+// The index entries grouped by shard, shards in skip are left out.
+func (s3a *S3Archive) shards(skip map[string]bool) (<-chan string, map[string][]*s3IndexEntry) {
+	shards := make(map[string][]*s3IndexEntry)
+	names := make([]string, 0)
+	for _, e := range s3a.entries() {
+		shard := e.shard()
+		if skip[shard] {
+			continue
+		}
+		if _, ok := shards[shard]; !ok {
+			names = append(names, shard)
+		}
+		shards[shard] = append(shards[shard], e)
+	}
+
+	ch := make(chan string)
+	go func() {
+		for _, name := range names {
+			ch <- name
+		}
+		close(ch)
+	}()
+	return ch, shards
+}
+
+func (s3a *S3Archive) scanShard(entries []*s3IndexEntry, loadMetricData bool, emit func(JobContainer)) {
+	for _, e := range entries {
+		job, err := decodeJobMeta(e.Meta)
+		if err != nil {
+			log.Errorf("in %s: %s", e.Dir, err.Error())
+		}
+
+		if loadMetricData {
+			data, err := s3a.loadJobData(e)
+			if err != nil {
+				log.Errorf("in %s: %s", e.Dir, err.Error())
+			}
+			emit(JobContainer{Meta: job, Data: &data})
+		} else {
+			emit(JobContainer{Meta: job, Data: nil})
+		}
+	}
+}
+
+// Iter sends all jobs of the index. With loadMetricData the job data of
+// several jobs is downloaded in parallel, so the order is not defined.
+func (s3a *S3Archive) Iter(loadMetricData bool) <-chan JobContainer {
+	numWorkers := runtime.NumCPU()
+	if loadMetricData {
+		numWorkers *= 4
+	}
+
+	ch := make(chan JobContainer, numWorkers)
+	names, shards := s3a.shards(nil)
+	scanShards(names, numWorkers, func(shard string) {
+		s3a.scanShard(shards[shard], loadMetricData, func(job JobContainer) { ch <- job })
+	}, func() { close(ch) })
+
+	return ch
+}
+
+func (s3a *S3Archive) IterShards(skip map[string]bool, numWorkers int) <-chan JobShard {
+	ch := make(chan JobShard, numWorkers)
+	names, shards := s3a.shards(skip)
+	scanShards(names, numWorkers, func(shard string) {
+		js := JobShard{Name: shard}
+		s3a.scanShard(shards[shard], false, func(job JobContainer) { js.Jobs = append(js.Jobs, job.Meta) })
+		ch <- js
+	}, func() { close(ch) })
+
+	return ch
 }
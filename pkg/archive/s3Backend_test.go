@@ -0,0 +1,183 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package archive
+
+import (
+	"encoding/json"
+	"fmt"
+	"os"
+	"path/filepath"
+	"testing"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+// A fake bucket with the test archive below the prefix "cc".
+func setupS3Archive(t *testing.T) (*fakeS3, string) {
+	fs, srv := newFakeS3(t, "archive")
+	err := filepath.Walk("testdata/archive", func(path string, info os.FileInfo, err error) error {
+		if err != nil || info.IsDir() {
+			return err
+		}
+		b, err := os.ReadFile(path)
+		if err != nil {
+			return err
+		}
+		rel, _ := filepath.Rel("testdata/archive", path)
+		fs.objects["cc/"+filepath.ToSlash(rel)] = b
+		return nil
+	})
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	index := filepath.Join(t.TempDir(), "s3.index")
+	return fs, fmt.Sprintf(`{"endpoint": "%s", "bucket": "archive", "prefix": "cc", "index": "%s"}`, srv.URL, index)
+}
+
+func initS3Archive(t *testing.T, config string) *S3Archive {
+	s3a := &S3Archive{}
+	version, err := s3a.Init(json.RawMessage(config))
+	if err != nil {
+		t.Fatal(err)
+	}
+	if version != Version {
+		t.Fatalf("want version %d, got %d", Version, version)
+	}
+	return s3a
+}
+
+func TestS3Archive(t *testing.T) {
+	fs, config := setupS3Archive(t)
+	s3a := initS3Archive(t, config)
+
+	if len(s3a.clusters) != 1 || s3a.clusters[0] != "emmy" {
+		t.Fatalf("unexpected clusters: %v", s3a.clusters)
+	}
+	if len(s3a.index) != 2 {
+		t.Fatalf("want 2 jobs in the index, got %d", len(s3a.index))
+	}
+
+	job := &schema.Job{BaseJob: schema.BaseJob{JobID: 1403244, Cluster: "emmy"}, StartTime: time.Unix(1608923076, 0)}
+	if !s3a.Exists(job) {
+		t.Fatal("job 1403244 should exist")
+	}
+	meta, err := s3a.LoadJobMeta(job)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if meta.JobID != 1403244 || int(meta.NumNodes) != len(meta.Resources) {
+		t.Errorf("unexpected job meta: %d with %d nodes", meta.JobID, meta.NumNodes)
+	}
+
+	data, err := s3a.LoadJobData(job)
+	if err != nil {
+		t.Fatal(err)
+	}
+	for _, scopes := range data {
+		if jm, ok := scopes[schema.MetricScopeNode]; ok && len(jm.Series) != int(meta.NumNodes) {
+			t.Errorf("want %d series, got %d", meta.NumNodes, len(jm.Series))
+		}
+	}
+
+	// Import a copy in the binary format, read back with ranged GETs
+	meta.JobID = 1403999
+	if err := s3a.ImportJob(meta, &data); err != nil {
+		t.Fatal(err)
+	}
+	copyJob := &schema.Job{BaseJob: meta.BaseJob, StartTime: time.Unix(meta.StartTime, 0)}
+	if _, ok := fs.objects["cc/emmy/1403/999/1608923076/data.bin"]; !ok {
+		t.Fatal("data.bin not uploaded")
+	}
+
+	gets := fs.count("GET")
+	subset, err := s3a.LoadJobDataSubset(copyJob, []string{"flops_any"}, []schema.MetricScope{schema.MetricScopeNode})
+	if err != nil {
+		t.Fatal(err)
+	}
+	if len(subset) != 1 || subset["flops_any"][schema.MetricScopeNode] == nil {
+		t.Errorf("unexpected subset: %v", subset)
+	}
+	if fs.count("GET") != gets || fs.count("GET range") == 0 {
+		t.Errorf("the subset should be loaded with ranged GETs only")
+	}
+
+	// A second instance uses the index file instead of the bucket
+	lists := fs.count("LIST")
+	s3a = initS3Archive(t, config)
+	if fs.count("LIST") != lists+1+len(s3a.clusters) {
+		t.Errorf("only the clusters and their dictionaries should be listed with an existing index")
+	}
+	if len(s3a.index) != 3 || !s3a.Exists(copyJob) {
+		t.Fatalf("want 3 jobs in the index, got %d", len(s3a.index))
+	}
+
+	n := 0
+	for range s3a.Iter(false) {
+		n++
+	}
+	if n != 3 {
+		t.Errorf("want 3 jobs from Iter, got %d", n)
+	}
+
+	s3a.CleanUp([]*schema.Job{copyJob})
+	if s3a.Exists(copyJob) {
+		t.Error("job should not exist after CleanUp")
+	}
+	if _, ok := fs.objects["cc/emmy/1403/999/1608923076/meta.json"]; ok {
+		t.Error("meta.json not deleted")
+	}
+
+	shards := 0
+	for shard := range s3a.IterShards(map[string]bool{"emmy/1404": true}, 2) {
+		if shard.Name != "emmy/1403" || len(shard.Jobs) != 1 {
+			t.Errorf("unexpected shard %s with %d jobs", shard.Name, len(shard.Jobs))
+		}
+		shards++
+	}
+	if shards != 1 {
+		t.Errorf("want 1 shard, got %d", shards)
+	}
+}
+
+// The data of every job is cached under its own key
+func TestS3ArchiveJobData(t *testing.T) {
+	_, config := setupS3Archive(t)
+	s3a := initS3Archive(t, config)
+
+	first := map[string]bool{}
+	for _, job := range []*schema.Job{
+		{BaseJob: schema.BaseJob{JobID: 1403244, Cluster: "emmy"}, StartTime: time.Unix(1608923076, 0)},
+		{BaseJob: schema.BaseJob{JobID: 1404397, Cluster: "emmy"}, StartTime: time.Unix(1609300556, 0)},
+	} {
+		meta, err := s3a.LoadJobMeta(job)
+		if err != nil {
+			t.Fatal(err)
+		}
+		hosts := map[string]bool{}
+		for _, res := range meta.Resources {
+			hosts[res.Hostname] = true
+		}
+
+		data, err := s3a.LoadJobData(job)
+		if err != nil {
+			t.Fatal(err)
+		}
+		for metric, scopes := range data {
+			for _, jm := range scopes {
+				for _, s := range jm.Series {
+					if !hosts[s.Hostname] {
+						t.Fatalf("job %d: %s series of %s, not a node of the job", job.JobID, metric, s.Hostname)
+					}
+				}
+			}
+		}
+		first[meta.Resources[0].Hostname] = true
+	}
+	if len(first) != 2 {
+		t.Errorf("both jobs have the same first node: %v", first)
+	}
+}
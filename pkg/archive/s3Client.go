@@ -0,0 +1,443 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package archive
+
+import (
+	"bytes"
+	"crypto/hmac"
+	"crypto/sha256"
+	"encoding/hex"
+	"encoding/xml"
+	"fmt"
+	"io"
+	"net/http"
+	"net/url"
+	"os"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+	"time"
+)
+
+// Minimal client for the part of the S3 REST API used by S3Archive. Requests
+// use path-style URLs (<endpoint>/<bucket>/<key>), which works with AWS as
+// well as with MinIO, Ceph and other S3-compatible stores, and are signed
+// with AWS Signature Version 4 if credentials are set.
+type s3Client struct {
+	endpoint  *url.URL
+	bucket    string
+	region    string
+	accessKey string
+	secretKey string
+	http      *http.Client
+}
+
+// Hash of an empty payload, used for all requests without a body
+const emptyPayloadHash = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"
+
+type s3Object struct {
+	Key  string `xml:"Key"`
+	Size int64  `xml:"Size"`
+}
+
+type s3ListResult struct {
+	Contents       []s3Object `xml:"Contents"`
+	CommonPrefixes []struct {
+		Prefix string `xml:"Prefix"`
+	} `xml:"CommonPrefixes"`
+	IsTruncated           bool   `xml:"IsTruncated"`
+	NextContinuationToken string `xml:"NextContinuationToken"`
+}
+
+type s3Error struct {
+	Code    string `xml:"Code"`
+	Message string `xml:"Message"`
+}
+
+type s3CompletedPart struct {
+	PartNumber int    `xml:"PartNumber"`
+	ETag       string `xml:"ETag"`
+}
+
+type s3CompleteMultipartUpload struct {
+	XMLName xml.Name          `xml:"CompleteMultipartUpload"`
+	Parts   []s3CompletedPart `xml:"Part"`
+}
+
+func newS3Client(endpoint, bucket, region, accessKey, secretKey string) (*s3Client, error) {
+	u, err := url.Parse(strings.TrimSuffix(endpoint, "/"))
+	if err != nil {
+		return nil, err
+	}
+	if u.Scheme != "http" && u.Scheme != "https" {
+		return nil, fmt.Errorf("ARCHIVE/S3 > invalid endpoint '%s'", endpoint)
+	}
+	if region == "" {
+		region = "us-east-1"
+	}
+
+	return &s3Client{
+		endpoint:  u,
+		bucket:    bucket,
+		region:    region,
+		accessKey: accessKey,
+		secretKey: secretKey,
+		http:      &http.Client{Timeout: 5 * time.Minute},
+	}, nil
+}
+
+// Escapes a path or query component as required by Signature Version 4:
+// everything but unreserved characters is percent-encoded, '/' only if
+// encodeSlash is set.
+func s3Escape(s string, encodeSlash bool) string {
+	var b strings.Builder
+	for i := 0; i < len(s); i++ {
+		c := s[i]
+		if 'A' <= c && c <= 'Z' || 'a' <= c && c <= 'z' || '0' <= c && c <= '9' ||
+			c == '-' || c == '_' || c == '.' || c == '~' || (c == '/' && !encodeSlash) {
+			b.WriteByte(c)
+		} else {
+			fmt.Fprintf(&b, "%%%02X", c)
+		}
+	}
+	return b.String()
+}
+
+func s3Query(query url.Values) string {
+	keys := make([]string, 0, len(query))
+	for k := range query {
+		keys = append(keys, k)
+	}
+	sort.Strings(keys)
+
+	parts := make([]string, 0, len(keys))
+	for _, k := range keys {
+		for _, v := range query[k] {
+			parts = append(parts, s3Escape(k, true)+"="+s3Escape(v, true))
+		}
+	}
+	return strings.Join(parts, "&")
+}
+
+func hmacSHA256(key []byte, data string) []byte {
+	h := hmac.New(sha256.New, key)
+	h.Write([]byte(data))
+	return h.Sum(nil)
+}
+
+// Adds the Signature Version 4 authorization header to req.
+func (c *s3Client) sign(req *http.Request, payloadHash string, now time.Time) {
+	amzDate := now.UTC().Format("20060102T150405Z")
+	date := amzDate[:8]
+	req.Header.Set("X-Amz-Date", amzDate)
+	req.Header.Set("X-Amz-Content-Sha256", payloadHash)
+	if c.accessKey == "" {
+		return
+	}
+
+	signedHeaders := "host;x-amz-content-sha256;x-amz-date"
+	canonicalRequest := strings.Join([]string{
+		req.Method,
+		req.URL.EscapedPath(),
+		req.URL.RawQuery,
+		"host:" + req.URL.Host,
+		"x-amz-content-sha256:" + payloadHash,
+		"x-amz-date:" + amzDate,
+		"",
+		signedHeaders,
+		payloadHash,
+	}, "\n")
+
+	scope := date + "/" + c.region + "/s3/aws4_request"
+	hash := sha256.Sum256([]byte(canonicalRequest))
+	stringToSign := "AWS4-HMAC-SHA256\n" + amzDate + "\n" + scope + "\n" + hex.EncodeToString(hash[:])
+
+	key := hmacSHA256([]byte("AWS4"+c.secretKey), date)
+	key = hmacSHA256(key, c.region)
+	key = hmacSHA256(key, "s3")
+	key = hmacSHA256(key, "aws4_request")
+	signature := hex.EncodeToString(hmacSHA256(key, stringToSign))
+
+	req.Header.Set("Authorization", fmt.Sprintf("AWS4-HMAC-SHA256 Credential=%s/%s, SignedHeaders=%s, Signature=%s",
+		c.accessKey, scope, signedHeaders, signature))
+}
+
+// Sends a signed request for key (the bucket itself if empty). Responses
+// with a status other than 2xx are returned as error, 404 wraps
+// os.ErrNotExist. The caller has to close the body of the response.
+func (c *s3Client) do(method, key string, query url.Values, body []byte, header http.Header) (*http.Response, error) {
+	u := *c.endpoint
+	u.Path = c.endpoint.Path + "/" + c.bucket
+	if key != "" {
+		u.Path += "/" + key
+	}
+	u.RawPath = s3Escape(u.Path, false)
+	u.RawQuery = s3Query(query)
+
+	req, err := http.NewRequest(method, u.String(), bytes.NewReader(body))
+	if err != nil {
+		return nil, err
+	}
+	req.ContentLength = int64(len(body))
+	for k, v := range header {
+		req.Header[k] = v
+	}
+
+	payloadHash := emptyPayloadHash
+	if len(body) > 0 {
+		hash := sha256.Sum256(body)
+		payloadHash = hex.EncodeToString(hash[:])
+	}
+	c.sign(req, payloadHash, time.Now())
+
+	res, err := c.http.Do(req)
+	if err != nil {
+		return nil, err
+	}
+	if res.StatusCode/100 == 2 {
+		return res, nil
+	}
+
+	defer res.Body.Close()
+	s3err := s3Error{Code: res.Status}
+	if b, err := io.ReadAll(io.LimitReader(res.Body, 64*1024)); err == nil {
+		xml.Unmarshal(b, &s3err)
+	}
+	if res.StatusCode == http.StatusNotFound {
+		return nil, fmt.Errorf("ARCHIVE/S3 > %s %s: %s: %w", method, key, s3err.Code, os.ErrNotExist)
+	}
+	return nil, fmt.Errorf("ARCHIVE/S3 > %s %s: %s %s", method, key, s3err.Code, s3err.Message)
+}
+
+func (c *s3Client) get(key string) ([]byte, error) {
+	res, err := c.do(http.MethodGet, key, nil, nil, nil)
+	if err != nil {
+		return nil, err
+	}
+	defer res.Body.Close()
+	return io.ReadAll(res.Body)
+}
+
+// Reads len(buf) bytes starting at offset of an object.
+func (c *s3Client) getRange(key string, buf []byte, offset int64) error {
+	if len(buf) == 0 {
+		return nil
+	}
+
+	header := http.Header{}
+	header.Set("Range", fmt.Sprintf("bytes=%d-%d", offset, offset+int64(len(buf))-1))
+	res, err := c.do(http.MethodGet, key, nil, nil, header)
+	if err != nil {
+		return err
+	}
+	defer res.Body.Close()
+
+	// A server ignoring the range sends the complete object
+	if res.StatusCode != http.StatusPartialContent {
+		if _, err := io.CopyN(io.Discard, res.Body, offset); err != nil {
+			return err
+		}
+	}
+	_, err = io.ReadFull(res.Body, buf)
+	return err
+}
+
+func (c *s3Client) put(key string, body []byte) error {
+	res, err := c.do(http.MethodPut, key, nil, body, nil)
+	if err != nil {
+		return err
+	}
+	res.Body.Close()
+	return nil
+}
+
+func (c *s3Client) delete(key string) error {
+	res, err := c.do(http.MethodDelete, key, nil, nil, nil)
+	if err != nil {
+		return err
+	}
+	res.Body.Close()
+	return nil
+}
+
+// Calls fn for every page of objects below prefix. With a delimiter, keys
+// containing it after the prefix are only returned as common prefixes.
+func (c *s3Client) list(prefix, delimiter string, fn func(page *s3ListResult) error) error {
+	query := url.Values{"list-type": {"2"}, "prefix": {prefix}}
+	if delimiter != "" {
+		query.Set("delimiter", delimiter)
+	}
+
+	for {
+		res, err := c.do(http.MethodGet, "", query, nil, nil)
+		if err != nil {
+			return err
+		}
+		page := &s3ListResult{}
+		err = xml.NewDecoder(res.Body).Decode(page)
+		res.Body.Close()
+		if err != nil {
+			return err
+		}
+		if err := fn(page); err != nil {
+			return err
+		}
+		if !page.IsTruncated || page.NextContinuationToken == "" {
+			return nil
+		}
+		query.Set("continuation-token", page.NextContinuationToken)
+	}
+}
+
+// Stores body as key. Objects larger than partSize are sent as multipart
+// upload with up to concurrency parts in flight at the same time.
+func (c *s3Client) upload(key string, body []byte, partSize, concurrency int) error {
+	if partSize <= 0 || len(body) <= partSize {
+		return c.put(key, body)
+	}
+	if concurrency <= 0 {
+		concurrency = 1
+	}
+
+	res, err := c.do(http.MethodPost, key, url.Values{"uploads": {""}}, nil, nil)
+	if err != nil {
+		return err
+	}
+	var initiated struct {
+		UploadId string `xml:"UploadId"`
+	}
+	err = xml.NewDecoder(res.Body).Decode(&initiated)
+	res.Body.Close()
+	if err != nil {
+		return err
+	}
+
+	numParts := (len(body) + partSize - 1) / partSize
+	parts := make([]s3CompletedPart, numParts)
+	errs := make([]error, numParts)
+	sem := make(chan struct{}, concurrency)
+	var wg sync.WaitGroup
+	for i := 0; i < numParts; i++ {
+		end := (i + 1) * partSize
+		if end > len(body) {
+			end = len(body)
+		}
+
+		sem <- struct{}{}
+		wg.Add(1)
+		go func(i int, part []byte) {
+			defer func() {
+				<-sem
+				wg.Done()
+			}()
+
+			query := url.Values{
+				"partNumber": {strconv.Itoa(i + 1)},
+				"uploadId":   {initiated.UploadId},
+			}
+			res, err := c.do(http.MethodPut, key, query, part, nil)
+			if err != nil {
+				errs[i] = err
+				return
+			}
+			res.Body.Close()
+			parts[i] = s3CompletedPart{PartNumber: i + 1, ETag: res.Header.Get("ETag")}
+		}(i, body[i*partSize:end])
+	}
+	wg.Wait()
+
+	for _, err := range errs {
+		if err != nil {
+			c.abortUpload(key, initiated.UploadId)
+			return err
+		}
+	}
+
+	complete, err := xml.Marshal(s3CompleteMultipartUpload{Parts: parts})
+	if err != nil {
+		c.abortUpload(key, initiated.UploadId)
+		return err
+	}
+	res, err = c.do(http.MethodPost, key, url.Values{"uploadId": {initiated.UploadId}}, complete, nil)
+	if err != nil {
+		c.abortUpload(key, initiated.UploadId)
+		return err
+	}
+	defer res.Body.Close()
+
+	// The upload can still fail after the status was sent
+	var result struct {
+		XMLName xml.Name
+		s3Error
+	}
+	if err := xml.NewDecoder(res.Body).Decode(&result); err == nil && result.XMLName.Local == "Error" {
+		return fmt.Errorf("ARCHIVE/S3 > complete upload of %s: %s %s", key, result.Code, result.Message)
+	}
+	return nil
+}
+
+func (c *s3Client) abortUpload(key, uploadId string) {
+	if res, err := c.do(http.MethodDelete, key, url.Values{"uploadId": {uploadId}}, nil, nil); err == nil {
+		res.Body.Close()
+	}
+}
+
+// io.ReaderAt on an object of known size using ranged GETs. The first
+// headSize bytes are fetched with the first read in them and kept, so that the
+// header and index of a binary job data file only cost one request. Safe for
+// parallel reads like any io.ReaderAt.
+type s3RangeReader struct {
+	client *s3Client
+	key    string
+	size   int64
+
+	headOnce sync.Once
+	head     []byte
+	headErr  error
+}
+
+const s3HeadSize = 64 * 1024
+
+func (r *s3RangeReader) Size() int64 {
+	return r.size
+}
+
+func (r *s3RangeReader) ReadAt(p []byte, off int64) (int, error) {
+	if off >= r.size {
+		return 0, io.EOF
+	}
+	n := len(p)
+	if off+int64(n) > r.size {
+		n = int(r.size - off)
+	}
+
+	if off < s3HeadSize {
+		r.headOnce.Do(func() {
+			headSize := int64(s3HeadSize)
+			if headSize > r.size {
+				headSize = r.size
+			}
+			head := make([]byte, headSize)
+			if r.headErr = r.client.getRange(r.key, head, 0); r.headErr == nil {
+				r.head = head
+			}
+		})
+		if r.headErr != nil {
+			return 0, r.headErr
+		}
+	}
+
+	if off+int64(n) <= int64(len(r.head)) {
+		copy(p, r.head[off:off+int64(n)])
+	} else if err := r.client.getRange(r.key, p[:n], off); err != nil {
+		return 0, err
+	}
+
+	if n < len(p) {
+		return n, io.EOF
+	}
+	return n, nil
+}
@@ -0,0 +1,186 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package archive
+
+import (
+	"sort"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+	"github.com/ClusterCockpit/cc-backend/pkg/schema"
+)
+
+// Settings for the compression and retention services, key "maintenance"
+// of the archive config.
+type MaintenanceConfig struct {
+	// Number of jobs processed concurrently (default: 4)
+	NumWorkers int `json:"num-workers"`
+	// Upper limit for the job data read and written per second in MB/s
+	// (default: unlimited)
+	MaxBandwidth float64 `json:"max-bandwidth"`
+	// Interval of the progress messages, e.g. "30s" (default: 1m)
+	ProgressInterval string `json:"progress-interval"`
+}
+
+const (
+	defaultServiceWorkers          = 4
+	defaultServiceProgressInterval = time.Minute
+)
+
+var (
+	serviceWorkers          int           = defaultServiceWorkers
+	serviceProgressInterval time.Duration = defaultServiceProgressInterval
+	serviceLimiter          *bandwidthLimiter
+)
+
+func initMaintenance(cfg *MaintenanceConfig) {
+	serviceWorkers = defaultServiceWorkers
+	serviceProgressInterval = defaultServiceProgressInterval
+	serviceLimiter = nil
+	if cfg == nil {
+		return
+	}
+
+	if cfg.NumWorkers > 0 {
+		serviceWorkers = cfg.NumWorkers
+	}
+	if cfg.MaxBandwidth > 0 {
+		serviceLimiter = &bandwidthLimiter{bytesPerSecond: cfg.MaxBandwidth * 1e6}
+	}
+	if cfg.ProgressInterval != "" {
+		interval, err := time.ParseDuration(cfg.ProgressInterval)
+		if err != nil || interval <= 0 {
+			log.Warnf("invalid maintenance progress-interval '%s', using default of %s", cfg.ProgressInterval, defaultServiceProgressInterval)
+		} else {
+			serviceProgressInterval = interval
+		}
+	}
+}
+
+// Paces the workers of all services to a common bandwidth. Every worker
+// reports the bytes of a job after processing it and is held back until the
+// average is below the limit again.
+type bandwidthLimiter struct {
+	lock           sync.Mutex
+	bytesPerSecond float64
+	next           time.Time
+}
+
+func (bl *bandwidthLimiter) wait(bytes int64) {
+	if bl == nil || bytes <= 0 {
+		return
+	}
+
+	bl.lock.Lock()
+	now := time.Now()
+	if bl.next.Before(now) {
+		bl.next = now
+	}
+	bl.next = bl.next.Add(time.Duration(float64(bytes) / bl.bytesPerSecond * float64(time.Second)))
+	delay := bl.next.Sub(now)
+	bl.lock.Unlock()
+
+	time.Sleep(delay)
+}
+
+// Runs process for 0 <= i < n on the workers of the maintenance config and
+// logs the progress. process returns the bytes of job data it read.
+// checkpoint is called with the largest i for which it and all items before
+// it are done, at most once per progress interval and at the end of the run,
+// so that an interrupted run can be resumed from there.
+func runService(name string, n int, process func(i int) (int64, error), checkpoint func(i int)) {
+	start := time.Now()
+	var done, failed, bytes int64
+	interval, limiter := serviceProgressInterval, serviceLimiter
+
+	// prefix is the number of items done without a gap
+	var lock sync.Mutex
+	finished := make([]bool, n)
+	prefix := 0
+	lastCheckpoint := start
+	complete := func(i int) {
+		lock.Lock()
+		defer lock.Unlock()
+		finished[i] = true
+		for prefix < n && finished[prefix] {
+			prefix++
+		}
+		if checkpoint != nil && prefix > 0 && time.Since(lastCheckpoint) >= interval {
+			checkpoint(prefix - 1)
+			lastCheckpoint = time.Now()
+		}
+	}
+
+	stop := make(chan struct{})
+	go func() {
+		ticker := time.NewTicker(interval)
+		defer ticker.Stop()
+		for {
+			select {
+			case <-stop:
+				return
+			case <-ticker.C:
+				elapsed := time.Since(start)
+				d := atomic.LoadInt64(&done)
+				rate := float64(d) / elapsed.Seconds()
+				eta := "unknown"
+				if rate > 0 {
+					eta = (time.Duration(float64(int64(n)-d)/rate) * time.Second).String()
+				}
+				log.Infof("%s Service - %d/%d jobs (%d failed), %.2f MB/s, ETA %s", name, d, n,
+					atomic.LoadInt64(&failed), float64(atomic.LoadInt64(&bytes))*1e-6/elapsed.Seconds(), eta)
+			}
+		}
+	}()
+
+	items := make(chan int)
+	var wg sync.WaitGroup
+	for w := 0; w < serviceWorkers; w++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for i := range items {
+				size, err := process(i)
+				if err != nil {
+					// A job failing again and again must not hold back the
+					// checkpoint, it is logged and counted only.
+					log.Errorf("%s Service - %v", name, err)
+					atomic.AddInt64(&failed, 1)
+				}
+				atomic.AddInt64(&bytes, size)
+				atomic.AddInt64(&done, 1)
+				complete(i)
+				limiter.wait(size)
+			}
+		}()
+	}
+	for i := 0; i < n; i++ {
+		items <- i
+	}
+	close(items)
+	wg.Wait()
+	close(stop)
+
+	if checkpoint != nil && n > 0 {
+		checkpoint(n - 1)
+	}
+
+	elapsed := time.Since(start)
+	log.Infof("%s Service - %d jobs (%d failed), %.2f MB in %s (%.2f MB/s)", name, n, failed,
+		float64(bytes)*1e-6, elapsed, float64(bytes)*1e-6/elapsed.Seconds())
+}
+
+// The jobs sorted by start time, for the checkpoints of the compression
+// service. The slice passed in is not modified.
+func sortByStartTime(jobs []*schema.Job) []*schema.Job {
+	sorted := make([]*schema.Job, len(jobs))
+	copy(sorted, jobs)
+	sort.SliceStable(sorted, func(i, j int) bool {
+		return sorted[i].StartTime.Before(sorted[j].StartTime)
+	})
+	return sorted
+}
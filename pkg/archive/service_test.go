@@ -0,0 +1,53 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package archive
+
+import (
+	"errors"
+	"sync/atomic"
+	"testing"
+	"time"
+)
+
+func TestRunService(t *testing.T) {
+	initMaintenance(&MaintenanceConfig{NumWorkers: 3, ProgressInterval: "1h"})
+	defer initMaintenance(nil)
+
+	var processed int32
+	checkpoints := []int{}
+	runService("Test", 10, func(i int) (int64, error) {
+		atomic.AddInt32(&processed, 1)
+		if i == 4 {
+			return 0, errors.New("failed")
+		}
+		return 100, nil
+	}, func(i int) {
+		checkpoints = append(checkpoints, i)
+	})
+
+	if processed != 10 {
+		t.Errorf("want 10 jobs processed, got %d", processed)
+	}
+	// Only the final checkpoint within the progress interval, failed jobs
+	// do not hold it back
+	if len(checkpoints) != 1 || checkpoints[0] != 9 {
+		t.Errorf("unexpected checkpoints: %v", checkpoints)
+	}
+}
+
+func TestBandwidthLimiter(t *testing.T) {
+	bl := &bandwidthLimiter{bytesPerSecond: 1e6}
+	start := time.Now()
+	for i := 0; i < 5; i++ {
+		bl.wait(20000)
+	}
+	if elapsed := time.Since(start); elapsed < 100*time.Millisecond {
+		t.Errorf("want at least 100ms for 100KB at 1MB/s, took %s", elapsed)
+	}
+
+	// No limit configured
+	var none *bandwidthLimiter
+	none.wait(1e9)
+}
@@ -6,9 +6,13 @@ package lrucache
 
 import (
 	"sync"
+	"sync/atomic"
 	"time"
 )
 
+// Number of shards used by `NewSharded` if none is given.
+const DefaultShards = 16
+
 // Type of the closure that must be passed to `Get` to
 // compute the value in case it is not cached.
 //
@@ -27,26 +31,108 @@ type cacheEntry struct {
 	next, prev *cacheEntry
 }
 
+// A shard holds a subset of the keys of a cache with its own lock
+// and LRU list. The memory used is accounted per shard and
+// globally in the cache the shard belongs to.
+type shard struct {
+	mutex      sync.Mutex
+	cond       *sync.Cond
+	usedmemory int
+	entries    map[string]*cacheEntry
+	head, tail *cacheEntry
+}
+
 type Cache struct {
-	mutex                 sync.Mutex
-	cond                  *sync.Cond
-	maxmemory, usedmemory int
-	entries               map[string]*cacheEntry
-	head, tail            *cacheEntry
+	// Accessed atomically, keep them first for 64 bit alignment.
+	usedmemory              int64
+	hits, misses, evictions uint64
+	maxmemory               int64
+	shards                  []*shard
+	// Shard where the next global eviction starts.
+	nextVictim uint32
+	onEvict    func(key string, value interface{}, expiration time.Time)
 }
 
 // Return a new instance of a LRU In-Memory Cache.
 // Read [the README](./README.md) for more information
 // on what is going on with `maxmemory`.
 func New(maxmemory int) *Cache {
+	return NewSharded(maxmemory, 1)
+}
+
+// Return a new instance of a LRU In-Memory Cache with the keys
+// distributed over `shards` independently locked shards (or
+// `DefaultShards` if `shards` is not positive). This reduces lock contention
+// for caches used by many goroutines at once. `maxmemory` is a budget
+// for all shards together, but the eviction order is only LRU within a
+// shard.
+func NewSharded(maxmemory int, shards int) *Cache {
+	if shards <= 0 {
+		shards = DefaultShards
+	}
+
 	cache := &Cache{
-		maxmemory: maxmemory,
-		entries:   map[string]*cacheEntry{},
+		maxmemory: int64(maxmemory),
+		shards:    make([]*shard, shards),
+	}
+	for i := range cache.shards {
+		s := &shard{entries: map[string]*cacheEntry{}}
+		s.cond = sync.NewCond(&s.mutex)
+		cache.shards[i] = s
 	}
-	cache.cond = sync.NewCond(&cache.mutex)
 	return cache
 }
 
+// Register f to be called for every entry evicted because the cache ran out
+// of memory (not for expired or deleted entries). It can be used to move
+// entries to a slower, second level cache. f is called while a part of the
+// cache is locked, so it must return quickly and __shall not call methods on
+// the same cache__. Must be called before the cache is used.
+func (c *Cache) OnEvict(f func(key string, value interface{}, expiration time.Time)) {
+	c.onEvict = f
+}
+
+// Counters of a cache since it was created.
+type Stats struct {
+	// Calls of `Get` that found a value (or waited for its computation)
+	Hits uint64
+	// Calls of `Get` that did not
+	Misses uint64
+	// Entries evicted because the cache ran out of memory
+	Evictions uint64
+	// Sum of the size estimates of all entries
+	UsedMemory int64
+}
+
+// Return the counters of the cache. Cheap enough to be called for
+// every scrape of a metrics endpoint.
+func (c *Cache) Stats() Stats {
+	return Stats{
+		Hits:       atomic.LoadUint64(&c.hits),
+		Misses:     atomic.LoadUint64(&c.misses),
+		Evictions:  atomic.LoadUint64(&c.evictions),
+		UsedMemory: atomic.LoadInt64(&c.usedmemory),
+	}
+}
+
+// FNV-1a, inlined to not allocate a hash.Hash32 for every call.
+func (c *Cache) shard(key string) *shard {
+	if len(c.shards) == 1 {
+		return c.shards[0]
+	}
+
+	h := uint32(2166136261)
+	for i := 0; i < len(key); i++ {
+		h ^= uint32(key[i])
+		h *= 16777619
+	}
+	return c.shards[h%uint32(len(c.shards))]
+}
+
+func (c *Cache) overBudget() bool {
+	return atomic.LoadInt64(&c.usedmemory) > c.maxmemory
+}
+
 // Return the cached value for key `key` or call `computeValue` and
 // store its return value in the cache. If called, the closure will be
 // called synchronous and __shall not call methods on the same cache__
@@ -54,39 +140,51 @@ func New(maxmemory int) *Cache {
 // and if no entry was found, nil is returned. If another goroutine is currently
 // computing that value, the result is waited for.
 func (c *Cache) Get(key string, computeValue ComputeValue) interface{} {
+	s := c.shard(key)
+	value, inserted := s.get(c, key, computeValue)
+	if inserted && len(c.shards) > 1 && c.overBudget() {
+		c.evictGlobal(s)
+	}
+	return value
+}
+
+func (s *shard) get(c *Cache, key string, computeValue ComputeValue) (interface{}, bool) {
 	now := time.Now()
 
-	c.mutex.Lock()
-	if entry, ok := c.entries[key]; ok {
+	s.mutex.Lock()
+	if entry, ok := s.entries[key]; ok {
 		// The expiration not being set is what shows us that
 		// the computation of that value is still ongoing.
 		for entry.expiration.IsZero() {
 			entry.waitingForComputation += 1
-			c.cond.Wait()
+			s.cond.Wait()
 			entry.waitingForComputation -= 1
 		}
 
 		if now.After(entry.expiration) {
-			if !c.evictEntry(entry) {
+			if !s.evictEntry(c, entry) {
 				if entry.expiration.IsZero() {
 					panic("LRUCACHE/CACHE > cache entry that shoud have been waited for could not be evicted.")
 				}
-				c.mutex.Unlock()
-				return entry.value
+				s.mutex.Unlock()
+				atomic.AddUint64(&c.hits, 1)
+				return entry.value, false
 			}
 		} else {
-			if entry != c.head {
-				c.unlinkEntry(entry)
-				c.insertFront(entry)
+			if entry != s.head {
+				s.unlinkEntry(entry)
+				s.insertFront(entry)
 			}
-			c.mutex.Unlock()
-			return entry.value
+			s.mutex.Unlock()
+			atomic.AddUint64(&c.hits, 1)
+			return entry.value, false
 		}
 	}
 
+	atomic.AddUint64(&c.misses, 1)
 	if computeValue == nil {
-		c.mutex.Unlock()
-		return nil
+		s.mutex.Unlock()
+		return nil, false
 	}
 
 	entry := &cacheEntry{
@@ -94,22 +192,22 @@ func (c *Cache) Get(key string, computeValue ComputeValue) interface{} {
 		waitingForComputation: 1,
 	}
 
-	c.entries[key] = entry
+	s.entries[key] = entry
 
 	hasPaniced := true
 	defer func() {
 		if hasPaniced {
-			c.mutex.Lock()
-			delete(c.entries, key)
+			s.mutex.Lock()
+			delete(s.entries, key)
 			entry.expiration = now
 			entry.waitingForComputation -= 1
 		}
-		c.mutex.Unlock()
+		s.mutex.Unlock()
 	}()
 
-	c.mutex.Unlock()
+	s.mutex.Unlock()
 	value, ttl, size := computeValue()
-	c.mutex.Lock()
+	s.mutex.Lock()
 	hasPaniced = false
 
 	entry.value = value
@@ -122,61 +220,95 @@ func (c *Cache) Get(key string, computeValue ComputeValue) interface{} {
 	if entry.waitingForComputation > 0 {
 		// TODO: Have more than one condition variable so that there are
 		// less unnecessary wakeups.
-		c.cond.Broadcast()
+		s.cond.Broadcast()
 	}
 
-	c.usedmemory += size
-	c.insertFront(entry)
+	s.account(c, size)
+	s.insertFront(entry)
+	s.evict(c, now)
+
+	return value, true
+}
 
-	// Evict only entries with a size of more than zero.
-	// This is the only loop in the implementation outside of the `Keys`
-	// method.
-	evictionCandidate := c.tail
-	for c.usedmemory > c.maxmemory && evictionCandidate != nil {
+// Evict entries from the end of the LRU list until the cache is within its
+// budget again. Only entries with a size of more than zero are evicted.
+// This is the only loop in the implementation outside of the `Keys`
+// method.
+func (s *shard) evict(c *Cache, now time.Time) {
+	evictionCandidate := s.tail
+	for c.overBudget() && evictionCandidate != nil {
 		nextCandidate := evictionCandidate.prev
 		if (evictionCandidate.size > 0 || now.After(evictionCandidate.expiration)) &&
 			evictionCandidate.waitingForComputation == 0 {
-			c.evictEntry(evictionCandidate)
+			s.evictEntry(c, evictionCandidate)
+			atomic.AddUint64(&c.evictions, 1)
+			if c.onEvict != nil && !now.After(evictionCandidate.expiration) {
+				c.onEvict(evictionCandidate.key, evictionCandidate.value, evictionCandidate.expiration)
+			}
 		}
 		evictionCandidate = nextCandidate
 	}
+}
 
-	return value
+// Called if evicting from the shard of a new entry was not enough to get
+// back within budget (the shard ran empty). The other shards are visited
+// one at a time, starting at a different one each time, so that no shard
+// is drained more than the others.
+func (c *Cache) evictGlobal(skip *shard) {
+	now := time.Now()
+	start := atomic.AddUint32(&c.nextVictim, 1)
+	for i := 0; i < len(c.shards) && c.overBudget(); i++ {
+		s := c.shards[(start+uint32(i))%uint32(len(c.shards))]
+		if s == skip {
+			continue
+		}
+
+		s.mutex.Lock()
+		s.evict(c, now)
+		s.mutex.Unlock()
+	}
 }
 
 // Put a new value in the cache. If another goroutine is calling `Get` and
 // computing the value, this function waits for the computation to be done
 // before it overwrites the value.
 func (c *Cache) Put(key string, value interface{}, size int, ttl time.Duration) {
+	s := c.shard(key)
 	now := time.Now()
-	c.mutex.Lock()
-	defer c.mutex.Unlock()
+	s.mutex.Lock()
 
-	if entry, ok := c.entries[key]; ok {
+	if entry, ok := s.entries[key]; ok {
 		for entry.expiration.IsZero() {
 			entry.waitingForComputation += 1
-			c.cond.Wait()
+			s.cond.Wait()
 			entry.waitingForComputation -= 1
 		}
 
-		c.usedmemory -= entry.size
+		s.account(c, size-entry.size)
 		entry.expiration = now.Add(ttl)
 		entry.size = size
 		entry.value = value
-		c.usedmemory += entry.size
 
-		c.unlinkEntry(entry)
-		c.insertFront(entry)
-		return
+		s.unlinkEntry(entry)
+		s.insertFront(entry)
+	} else {
+		entry := &cacheEntry{
+			key:        key,
+			value:      value,
+			expiration: now.Add(ttl),
+			size:       size,
+		}
+		s.entries[key] = entry
+		s.account(c, size)
+		s.insertFront(entry)
 	}
 
-	entry := &cacheEntry{
-		key:        key,
-		value:      value,
-		expiration: now.Add(ttl),
+	s.evict(c, now)
+	s.mutex.Unlock()
+
+	if len(c.shards) > 1 && c.overBudget() {
+		c.evictGlobal(s)
 	}
-	c.entries[key] = entry
-	c.insertFront(entry)
 }
 
 // Remove the value at key `key` from the cache.
@@ -187,11 +319,12 @@ func (c *Cache) Put(key string, value interface{}, size int, ttl time.Duration)
 // will show up in the cache if this function is called on a key
 // while that key is beeing computed.
 func (c *Cache) Del(key string) bool {
-	c.mutex.Lock()
-	defer c.mutex.Unlock()
+	s := c.shard(key)
+	s.mutex.Lock()
+	defer s.mutex.Unlock()
 
-	if entry, ok := c.entries[key]; ok {
-		return c.evictEntry(entry)
+	if entry, ok := s.entries[key]; ok {
+		return s.evictEntry(c, entry)
 	}
 	return false
 }
@@ -200,19 +333,34 @@ func (c *Cache) Del(key string) bool {
 // and eviction of expired keys are done as well.
 // The cache is fully locked for the complete duration of this call!
 func (c *Cache) Keys(f func(key string, val interface{})) {
-	c.mutex.Lock()
-	defer c.mutex.Unlock()
+	// Always locked in the same order, all other methods hold
+	// at most one shard lock at a time.
+	for _, s := range c.shards {
+		s.mutex.Lock()
+		defer s.mutex.Unlock()
+	}
 
 	now := time.Now()
 
+	total := 0
+	for _, s := range c.shards {
+		total += s.keys(c, now, f)
+	}
+
+	if int64(total) != atomic.LoadInt64(&c.usedmemory) {
+		panic("LRUCACHE/CACHE > size calculations failed")
+	}
+}
+
+func (s *shard) keys(c *Cache, now time.Time, f func(key string, val interface{})) int {
 	size := 0
-	for key, e := range c.entries {
+	for key, e := range s.entries {
 		if key != e.key {
 			panic("LRUCACHE/CACHE > key mismatch")
 		}
 
 		if now.After(e.expiration) {
-			if c.evictEntry(e) {
+			if s.evictEntry(c, e) {
 				continue
 			}
 		}
@@ -233,40 +381,47 @@ func (c *Cache) Keys(f func(key string, val interface{})) {
 		f(key, e.value)
 	}
 
-	if size != c.usedmemory {
+	if size != s.usedmemory {
 		panic("LRUCACHE/CACHE > size calculations failed")
 	}
 
-	if c.head != nil {
-		if c.tail == nil || c.head.prev != nil {
+	if s.head != nil {
+		if s.tail == nil || s.head.prev != nil {
 			panic("LRUCACHE/CACHE > head/tail corrupted")
 		}
 	}
 
-	if c.tail != nil {
-		if c.head == nil || c.tail.next != nil {
+	if s.tail != nil {
+		if s.head == nil || s.tail.next != nil {
 			panic("LRUCACHE/CACHE > head/tail corrupted")
 		}
 	}
+
+	return size
+}
+
+func (s *shard) account(c *Cache, delta int) {
+	s.usedmemory += delta
+	atomic.AddInt64(&c.usedmemory, int64(delta))
 }
 
-func (c *Cache) insertFront(e *cacheEntry) {
-	e.next = c.head
-	c.head = e
+func (s *shard) insertFront(e *cacheEntry) {
+	e.next = s.head
+	s.head = e
 
 	e.prev = nil
 	if e.next != nil {
 		e.next.prev = e
 	}
 
-	if c.tail == nil {
-		c.tail = e
+	if s.tail == nil {
+		s.tail = e
 	}
 }
 
-func (c *Cache) unlinkEntry(e *cacheEntry) {
-	if e == c.head {
-		c.head = e.next
+func (s *shard) unlinkEntry(e *cacheEntry) {
+	if e == s.head {
+		s.head = e.next
 	}
 	if e.prev != nil {
 		e.prev.next = e.next
@@ -274,19 +429,19 @@ func (c *Cache) unlinkEntry(e *cacheEntry) {
 	if e.next != nil {
 		e.next.prev = e.prev
 	}
-	if e == c.tail {
-		c.tail = e.prev
+	if e == s.tail {
+		s.tail = e.prev
 	}
 }
 
-func (c *Cache) evictEntry(e *cacheEntry) bool {
+func (s *shard) evictEntry(c *Cache, e *cacheEntry) bool {
 	if e.waitingForComputation != 0 {
 		// panic("LRUCACHE/CACHE > cannot evict this entry as other goroutines need the value")
 		return false
 	}
 
-	c.unlinkEntry(e)
-	c.usedmemory -= e.size
-	delete(c.entries, e.key)
+	s.unlinkEntry(e)
+	s.account(c, -e.size)
+	delete(s.entries, e.key)
 	return true
 }
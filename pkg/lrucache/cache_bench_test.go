@@ -0,0 +1,92 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package lrucache
+
+import (
+	"fmt"
+	"strings"
+	"testing"
+	"time"
+)
+
+const benchKeys = 4096
+
+func benchmarkKeys() []string {
+	keys := make([]string, benchKeys)
+	for i := range keys {
+		keys[i] = fmt.Sprintf("metricdata:%d:cluster:node%04d", i, i)
+	}
+	return keys
+}
+
+// Parallel lookups of cached values only.
+func benchmarkHit(b *testing.B, c *Cache) {
+	keys := benchmarkKeys()
+	for _, key := range keys {
+		c.Put(key, key, 1, time.Hour)
+	}
+
+	b.ResetTimer()
+	b.RunParallel(func(pb *testing.PB) {
+		i := 0
+		for pb.Next() {
+			_ = c.Get(keys[i%benchKeys], nil)
+			i++
+		}
+	})
+}
+
+// Parallel lookups with a budget for half of the keys, so that values
+// are computed and entries evicted all the time.
+func benchmarkMiss(b *testing.B, c *Cache) {
+	keys := benchmarkKeys()
+	compute := func() (interface{}, time.Duration, int) {
+		return "value", time.Hour, 1
+	}
+
+	b.ResetTimer()
+	b.RunParallel(func(pb *testing.PB) {
+		i := 0
+		for pb.Next() {
+			_ = c.Get(keys[(i*7919)%benchKeys], compute)
+			i++
+		}
+	})
+}
+
+func BenchmarkGetHit(b *testing.B) {
+	benchmarkHit(b, New(benchKeys))
+}
+
+func BenchmarkGetHitSharded(b *testing.B) {
+	benchmarkHit(b, NewSharded(benchKeys, DefaultShards))
+}
+
+func BenchmarkGetMiss(b *testing.B) {
+	benchmarkMiss(b, New(benchKeys/2))
+}
+
+func BenchmarkGetMissSharded(b *testing.B) {
+	benchmarkMiss(b, NewSharded(benchKeys/2, DefaultShards))
+}
+
+// Parallel lookups of a few hot keys with a budget for half of them, so that
+// goroutines wait for the values computed by others.
+func BenchmarkGetContended(b *testing.B) {
+	keys := benchmarkKeys()[:16]
+	c := NewSharded(len(keys)/2, DefaultShards)
+	compute := func() (interface{}, time.Duration, int) {
+		return strings.Repeat("value", 64), time.Hour, 1
+	}
+
+	b.ResetTimer()
+	b.RunParallel(func(pb *testing.PB) {
+		i := 0
+		for pb.Next() {
+			_ = c.Get(keys[i%len(keys)], compute)
+			i++
+		}
+	})
+}
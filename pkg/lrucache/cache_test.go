@@ -5,6 +5,7 @@
 package lrucache
 
 import (
+	"fmt"
 	"sync"
 	"sync/atomic"
 	"testing"
@@ -151,6 +152,43 @@ func TestEviction(t *testing.T) {
 	})
 }
 
+func TestOnEvict(t *testing.T) {
+	c := New(100)
+	evicted := map[string]interface{}{}
+	c.OnEvict(func(key string, value interface{}, expiration time.Time) {
+		evicted[key] = value
+	})
+
+	_ = c.Get("A", func() (interface{}, time.Duration, int) {
+		return "a", 1 * time.Second, 60
+	})
+	_ = c.Get("B", func() (interface{}, time.Duration, int) {
+		return "b", 1 * time.Second, 60
+	})
+	c.Del("B")
+
+	if len(evicted) != 1 || evicted["A"] != "a" {
+		t.Errorf("only 'A' should have been evicted, got %v", evicted)
+	}
+}
+
+func TestStats(t *testing.T) {
+	c := New(100)
+	compute := func() (interface{}, time.Duration, int) {
+		return "x", 1 * time.Second, 60
+	}
+
+	c.Get("A", compute)
+	c.Get("A", compute)
+	c.Get("B", nil)
+	c.Get("B", compute)
+
+	stats := c.Stats()
+	if stats.Hits != 1 || stats.Misses != 3 || stats.Evictions != 1 || stats.UsedMemory != 60 {
+		t.Errorf("unexpected stats: %+v", stats)
+	}
+}
+
 // I know that this is a shity test,
 // time is relative and unreliable.
 func TestConcurrency(t *testing.T) {
@@ -221,3 +259,66 @@ func TestPanic(t *testing.T) {
 
 	testpanic()
 }
+
+func TestShardedEviction(t *testing.T) {
+	c := NewSharded(100, 4)
+
+	for i := 0; i < 20; i++ {
+		key := fmt.Sprintf("key-%d", i)
+		_ = c.Get(key, func() (interface{}, time.Duration, int) {
+			return key, 1 * time.Minute, 10
+		})
+	}
+
+	if c.usedmemory > c.maxmemory {
+		t.Errorf("budget exceeded: %d > %d", c.usedmemory, c.maxmemory)
+	}
+
+	// The latest entry must have survived, no matter its shard.
+	v := c.Get("key-19", nil)
+	if v == nil || v.(string) != "key-19" {
+		t.Error("latest entry should be cached")
+	}
+
+	n := 0
+	c.Keys(func(key string, val interface{}) {
+		n += 1
+	})
+	if n == 0 || n > 10 {
+		t.Errorf("unexpected number of entries: %d", n)
+	}
+
+	c.Put("big", "big", 95, 1*time.Minute)
+	if c.usedmemory > c.maxmemory {
+		t.Errorf("budget exceeded after put: %d > %d", c.usedmemory, c.maxmemory)
+	}
+	c.Keys(func(key string, val interface{}) {})
+}
+
+func TestShardedConcurrency(t *testing.T) {
+	c := NewSharded(1000, 8)
+	var wg sync.WaitGroup
+
+	numThreads := 8
+	wg.Add(numThreads)
+
+	var computations int32 = 0
+	for i := 0; i < numThreads; i++ {
+		go func() {
+			defer wg.Done()
+			for j := 0; j < 1000; j++ {
+				_ = c.Get(fmt.Sprintf("key-%d", j%50), func() (interface{}, time.Duration, int) {
+					atomic.AddInt32(&computations, 1)
+					return "value", 1 * time.Minute, 1
+				})
+			}
+		}()
+	}
+
+	wg.Wait()
+
+	if computations != 50 {
+		t.Errorf("every value should have been computed exactly once, got %d computations", computations)
+	}
+	c.Keys(func(key string, val interface{}) {})
+}
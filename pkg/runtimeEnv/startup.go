@@ -0,0 +1,129 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package runtimeEnv
+
+import (
+	"encoding/json"
+	"net/http"
+	"sync"
+	"time"
+
+	"github.com/ClusterCockpit/cc-backend/pkg/log"
+)
+
+// States of a startup step.
+const (
+	StepRunning = "running"
+	StepDone    = "done"
+	StepFailed  = "failed"
+)
+
+// A part of the startup of the server, as reported by ReadinessHandler.
+type StartupStep struct {
+	Name string `json:"name"`
+	// Background steps do not hold back readiness (see StartupTask)
+	Background bool      `json:"background"`
+	State      string    `json:"state"`
+	Error      string    `json:"error,omitempty"`
+	Started    time.Time `json:"started"`
+	Duration   string    `json:"duration,omitempty"`
+}
+
+var startup struct {
+	lock  sync.Mutex
+	ready bool
+	steps []*StartupStep
+}
+
+func beginStep(name string, background bool) *StartupStep {
+	step := &StartupStep{Name: name, Background: background, State: StepRunning, Started: time.Now()}
+	startup.lock.Lock()
+	startup.steps = append(startup.steps, step)
+	startup.lock.Unlock()
+	return step
+}
+
+func endStep(step *StartupStep, err error) {
+	startup.lock.Lock()
+	defer startup.lock.Unlock()
+	step.Duration = time.Since(step.Started).String()
+	if err != nil {
+		step.State, step.Error = StepFailed, err.Error()
+		return
+	}
+	step.State = StepDone
+}
+
+// Run fn as the startup step name and return its error.
+func Startup(name string, fn func() error) error {
+	step := beginStep(name, false)
+	err := fn()
+	endStep(step, err)
+	if err == nil {
+		log.Infof("startup: %s done in %s", name, step.Duration)
+	}
+	return err
+}
+
+// Run fn in the background as the startup step name. Errors are logged and
+// reported, the server is ready without waiting for it.
+func StartupTask(name string, fn func() error) {
+	step := beginStep(name, true)
+	go func() {
+		err := fn()
+		endStep(step, err)
+		if err != nil {
+			log.Errorf("startup: %s failed: %v", name, err)
+			return
+		}
+		log.Infof("startup: %s done in %s", name, step.Duration)
+	}()
+}
+
+// Mark the server as ready to serve all requests.
+func SetReady() {
+	startup.lock.Lock()
+	startup.ready = true
+	startup.lock.Unlock()
+}
+
+func IsReady() bool {
+	startup.lock.Lock()
+	defer startup.lock.Unlock()
+	return startup.ready
+}
+
+// Replies with the startup steps, with status 200 once the server is ready
+// and 503 before.
+func ReadinessHandler(rw http.ResponseWriter, r *http.Request) {
+	startup.lock.Lock()
+	res := struct {
+		Ready bool          `json:"ready"`
+		Steps []StartupStep `json:"steps"`
+	}{Ready: startup.ready, Steps: make([]StartupStep, 0, len(startup.steps))}
+	for _, step := range startup.steps {
+		res.Steps = append(res.Steps, *step)
+	}
+	startup.lock.Unlock()
+
+	rw.Header().Add("Content-Type", "application/json")
+	if res.Ready {
+		rw.WriteHeader(http.StatusOK)
+	} else {
+		rw.WriteHeader(http.StatusServiceUnavailable)
+	}
+	json.NewEncoder(rw).Encode(res)
+}
+
+// Serves /readyz only, for a server listening before it is set up.
+func StartupHandler(rw http.ResponseWriter, r *http.Request) {
+	if r.URL.Path == "/readyz" {
+		ReadinessHandler(rw, r)
+		return
+	}
+
+	rw.Header().Add("Retry-After", "5")
+	http.Error(rw, "cc-backend is starting up", http.StatusServiceUnavailable)
+}
@@ -76,6 +76,67 @@ type Retention struct {
 	IncludeDB bool   `json:"includeDB"`
 }
 
+type ArchiverConfig struct {
+	// Number of jobs archived concurrently (default: 4).
+	NumWorkers int `json:"num-workers"`
+
+	// Maximum number of jobs of a single cluster archived concurrently.
+	// If 0 or empty, only the number of workers limits concurrency.
+	ClusterConcurrency int `json:"cluster-concurrency"`
+
+	// Timeout for archiving a single job
+	// as a string parsable by time.ParseDuration() (default: 10m).
+	Timeout string `json:"timeout"`
+}
+
+type GroupCommitConfig struct {
+	// Maximum time a job start or stop waits for others to be committed
+	// together with, as a string parsable by time.ParseDuration() (default: 5ms).
+	MaxDelay string `json:"max-delay"`
+
+	// Maximum number of job starts and stops per transaction (default: 256).
+	MaxBatchSize int `json:"max-batch-size"`
+}
+
+type DBPoolConfig struct {
+	// Maximum number of open connections (default: 4). With a read/write
+	// split, the size of the read-only pool.
+	MaxOpenConnections int `json:"max-open-connections"`
+
+	// Maximum number of idle connections kept open (default: max-open-connections).
+	MaxIdleConnections int `json:"max-idle-connections"`
+
+	// Maximum time a connection is reused and kept idle, as strings
+	// parsable by time.ParseDuration() (default: 1h).
+	ConnectionMaxLifetime string `json:"connection-max-lifetime"`
+	ConnectionMaxIdleTime string `json:"connection-max-idle-time"`
+
+	// SQLite only: write through a single connection and read through a
+	// separate pool of read-only connections, so that long running
+	// queries and writes do not wait for each other.
+	SplitReadWrite bool `json:"split-read-write"`
+}
+
+type MetricDataCacheConfig struct {
+	// Memory budget of the in-memory metric data cache in MB (default: 128).
+	MemoryBudget int `json:"memory-budget"`
+
+	// Directory on a fast local disk for a second level cache of the
+	// metric data evicted from memory. If empty, there is none.
+	DiskPath string `json:"disk-path"`
+
+	// Disk budget of the second level cache in MB (default: 1024).
+	DiskBudget int `json:"disk-budget"`
+}
+
+type MetricDataPrefetchConfig struct {
+	// Number of prefetch tasks run concurrently (default: 4).
+	NumWorkers int `json:"num-workers"`
+
+	// Maximum number of jobs of a page prefetched (default: 50).
+	MaxJobs int `json:"max-jobs"`
+}
+
 // Format of the configuration (file). See below for the defaults.
 type ProgramConfig struct {
 	// Address where the http (or https) server will listen on (for example: 'localhost:80').
@@ -103,6 +164,17 @@ type ProgramConfig struct {
 	// For sqlite3 a filename, for mysql a DSN in this format: https://github.com/go-sql-driver/mysql#dsn-data-source-name (Without query parameters!).
 	DB string `json:"db"`
 
+	// Size of the database connection pool(s)
+	DBPool *DBPoolConfig `json:"db-pool"`
+
+	// Number of jobs inserted with a single statement when the job table is
+	// built from the job archive (-init-db). Default: 500, maximum: 1000.
+	ImportBatchSize int `json:"import-batch-size"`
+
+	// Number of bins of the metric footprint histograms in the
+	// statistics views (default: 10).
+	MetricHistogramBins int `json:"metric-histogram-bins"`
+
 	// Config for job archive
 	Archive json.RawMessage `json:"archive"`
 
@@ -113,6 +185,25 @@ type ProgramConfig struct {
 	// Validate json input against schema
 	Validate bool `json:"validate"`
 
+	// Start the HTTP server before the rest of the startup and run scans
+	// of local state (the metric data cache on disk) in the background.
+	// Until the server is ready, only /readyz is answered.
+	FastStartup bool `json:"fast-startup"`
+
+	// Settings for the background worker pool archiving stopped jobs
+	Archiver *ArchiverConfig `json:"archiver"`
+
+	// Settings for batching the job starts and stops of the REST API into
+	// transactions
+	GroupCommit *GroupCommitConfig `json:"group-commit"`
+
+	// Size and location of the caches for metric data
+	MetricDataCache *MetricDataCacheConfig `json:"metric-data-cache"`
+
+	// If set, the metric data of the jobs of a job list page is loaded
+	// into the cache in the background, before the rows request it.
+	MetricDataPrefetch *MetricDataPrefetchConfig `json:"metric-data-prefetch"`
+
 	// For LDAP Authentication and user synchronisation.
 	LdapConfig   *LdapConfig    `json:"ldap"`
 	JwtConfig    *JWTAuthConfig `json:"jwts"`
@@ -0,0 +1,157 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package schema
+
+import "math"
+
+// A copy of the job data with a timestep of at most resolution seconds, see
+// JobMetric.Downsample. The job data itself is not modified.
+func (jd JobData) Downsample(resolution int) JobData {
+	res := make(JobData, len(jd))
+	for metric, scopes := range jd {
+		res[metric] = make(map[MetricScope]*JobMetric, len(scopes))
+		for scope, jm := range scopes {
+			res[metric][scope] = jm.Downsample(resolution)
+		}
+	}
+	return res
+}
+
+// Downsample returns a copy of the metric with a timestep of at most
+// resolution seconds, or the metric itself if its timestep is not finer than
+// that. The series are split into buckets of two new samples each and the
+// minimum and maximum of a bucket are kept in the order they occur, so every
+// peak is still there and no sample is moved by more than one bucket. The
+// statistics series keep the minimum, maximum and mean of every new sample.
+// The statistics of a series are those of the full data.
+func (jm *JobMetric) Downsample(resolution int) *JobMetric {
+	factor := 0
+	if jm.Timestep > 0 {
+		factor = resolution / jm.Timestep
+	}
+	if factor < 2 {
+		return jm
+	}
+
+	res := &JobMetric{
+		Unit:     jm.Unit,
+		Timestep: jm.Timestep * factor,
+		Series:   make([]Series, len(jm.Series)),
+	}
+	for i, series := range jm.Series {
+		res.Series[i] = series
+		res.Series[i].Data = downsampleMinMax(series.Data, factor)
+	}
+
+	if ss := jm.StatisticsSeries; ss != nil {
+		res.StatisticsSeries = &StatsSeries{
+			Min:  downsampleReduce(ss.Min, factor, math.Min),
+			Max:  downsampleReduce(ss.Max, factor, math.Max),
+			Mean: downsampleMean(ss.Mean, factor),
+		}
+		if ss.Percentiles != nil {
+			res.StatisticsSeries.Percentiles = make(map[int][]Float, len(ss.Percentiles))
+			for p, data := range ss.Percentiles {
+				res.StatisticsSeries.Percentiles[p] = downsampleMean(data, factor)
+			}
+		}
+	}
+
+	return res
+}
+
+// One sample for every factor samples of data, the minimum and maximum of
+// every two of them. A last bucket with only one sample keeps the maximum.
+func downsampleMinMax(data []Float, factor int) []Float {
+	res := make([]Float, 0, (len(data)+factor-1)/factor)
+	for start := 0; start < len(data); start += 2 * factor {
+		end := start + 2*factor
+		if end > len(data) {
+			end = len(data)
+		}
+
+		lo, hi := -1, -1
+		for i := start; i < end; i++ {
+			if data[i].IsNaN() {
+				continue
+			}
+			if lo == -1 || data[i] < data[lo] {
+				lo = i
+			}
+			if hi == -1 || data[i] > data[hi] {
+				hi = i
+			}
+		}
+
+		if end-start <= factor {
+			if hi == -1 {
+				res = append(res, NaN)
+			} else {
+				res = append(res, data[hi])
+			}
+			continue
+		}
+
+		switch {
+		case lo == -1:
+			res = append(res, NaN, NaN)
+		case lo < hi:
+			res = append(res, data[lo], data[hi])
+		default:
+			res = append(res, data[hi], data[lo])
+		}
+	}
+	return res
+}
+
+// One sample for every factor samples of data, reduced with f. NaNs are
+// skipped, a sample is NaN if all of its samples are.
+func downsampleReduce(data []Float, factor int, f func(a, b float64) float64) []Float {
+	res := make([]Float, 0, (len(data)+factor-1)/factor)
+	for start := 0; start < len(data); start += factor {
+		end := start + factor
+		if end > len(data) {
+			end = len(data)
+		}
+
+		x := NaN
+		for _, v := range data[start:end] {
+			if v.IsNaN() {
+				continue
+			}
+			if x.IsNaN() {
+				x = v
+			} else {
+				x = Float(f(float64(x), float64(v)))
+			}
+		}
+		res = append(res, x)
+	}
+	return res
+}
+
+func downsampleMean(data []Float, factor int) []Float {
+	res := make([]Float, 0, (len(data)+factor-1)/factor)
+	for start := 0; start < len(data); start += factor {
+		end := start + factor
+		if end > len(data) {
+			end = len(data)
+		}
+
+		sum, n := 0.0, 0
+		for _, v := range data[start:end] {
+			if !v.IsNaN() {
+				sum += float64(v)
+				n++
+			}
+		}
+		if n == 0 {
+			res = append(res, NaN)
+		} else {
+			res = append(res, Float(sum/float64(n)))
+		}
+	}
+	return res
+}
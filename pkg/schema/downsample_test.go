@@ -0,0 +1,69 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package schema
+
+import (
+	"reflect"
+	"testing"
+)
+
+func TestDownsample(t *testing.T) {
+	jm := &JobMetric{
+		Timestep: 60,
+		Series: []Series{
+			{Hostname: "a", Statistics: MetricStatistics{Max: 100}, Data: []Float{1, 5, 2, 3, 9, 4, 0, 2, 7}},
+			{Hostname: "b", Data: []Float{NaN, NaN, NaN, NaN, 4, NaN, 3}},
+		},
+		StatisticsSeries: &StatsSeries{
+			Min:  []Float{1, 2, 3, 4, 5},
+			Max:  []Float{1, 2, 3, 4, 5},
+			Mean: []Float{1, 2, NaN, 4, 6},
+		},
+	}
+
+	if jm.Downsample(60) != jm || jm.Downsample(90) != jm {
+		t.Error("metrics that are fine enough should not be copied")
+	}
+
+	ds := jm.Downsample(120)
+	if ds.Timestep != 120 {
+		t.Errorf("want timestep 120, got %d", ds.Timestep)
+	}
+
+	for i, want := range [][]Float{
+		// min/max of [1 5 2 3], [9 4 0 2] in order, max of [7]
+		{1, 5, 9, 0, 7},
+		{NaN, NaN, 4, 3},
+	} {
+		got := ds.Series[i].Data
+		if len(got) != len(want) {
+			t.Fatalf("series %d: want %v, got %v", i, want, got)
+		}
+		for j := range want {
+			if got[j] != want[j] && !(got[j].IsNaN() && want[j].IsNaN()) {
+				t.Errorf("series %d: want %v, got %v", i, want, got)
+				break
+			}
+		}
+	}
+	if ds.Series[0].Statistics.Max != 100 || ds.Series[0].Hostname != "a" {
+		t.Error("the series statistics should be kept")
+	}
+
+	ss := ds.StatisticsSeries
+	if !reflect.DeepEqual(ss.Min, []Float{1, 3, 5}) || !reflect.DeepEqual(ss.Max, []Float{2, 4, 5}) ||
+		!reflect.DeepEqual(ss.Mean, []Float{1.5, 4, 6}) {
+		t.Errorf("unexpected statistics series: %v %v %v", ss.Min, ss.Mean, ss.Max)
+	}
+
+	if len(jm.Series[0].Data) != 9 || len(jm.StatisticsSeries.Min) != 5 {
+		t.Error("the original metric should not be modified")
+	}
+
+	jd := JobData{"flops_any": {MetricScopeNode: jm}}
+	if got := jd.Downsample(600)["flops_any"][MetricScopeNode]; got.Timestep != 600 || len(got.Series[0].Data) != 1 {
+		t.Errorf("unexpected downsampled job data: %d %v", got.Timestep, got.Series[0].Data)
+	}
+}
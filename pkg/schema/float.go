@@ -8,7 +8,9 @@ import (
 	"errors"
 	"io"
 	"math"
+	"sort"
 	"strconv"
+	"sync"
 
 	"github.com/ClusterCockpit/cc-backend/pkg/log"
 )
@@ -32,7 +34,7 @@ func (f Float) MarshalJSON() ([]byte, error) {
 		return nullAsBytes, nil
 	}
 
-	return strconv.AppendFloat(make([]byte, 0, 10), float64(f), 'f', 2, 64), nil
+	return appendFloat(make([]byte, 0, 10), f), nil
 }
 
 // `null` will be unserialized to NaN.
@@ -68,46 +70,304 @@ func (f *Float) UnmarshalGQL(v interface{}) error {
 func (f Float) MarshalGQL(w io.Writer) {
 	if f.IsNaN() {
 		w.Write(nullAsBytes)
-	} else {
-		w.Write(strconv.AppendFloat(make([]byte, 0, 10), float64(f), 'f', 2, 64))
+		return
 	}
+
+	buf := getBuffer()
+	defer putBuffer(buf)
+	*buf = appendFloat(*buf, f)
+	w.Write(*buf)
 }
 
-// Only used via REST-API, not via GraphQL.
-// This uses a lot less allocations per series,
-// but it turns out that the performance increase
-// from using this is not that big.
-func (s *Series) MarshalJSON() ([]byte, error) {
-	buf := make([]byte, 0, 512+len(s.Data)*8)
-	buf = append(buf, `{"hostname":"`...)
-	buf = append(buf, s.Hostname...)
+// Buffers for the encoders below, only buffers of up to maxPooledBuffer
+// bytes are put back.
+var bufferPool = sync.Pool{New: func() interface{} { b := make([]byte, 0, 4096); return &b }}
+
+const maxPooledBuffer = 1 << 20
+
+func getBuffer() *[]byte {
+	return bufferPool.Get().(*[]byte)
+}
+
+func putBuffer(b *[]byte) {
+	if cap(*b) <= maxPooledBuffer {
+		*b = (*b)[:0]
+		bufferPool.Put(b)
+	}
+}
+
+// Like strconv.AppendFloat(buf, f, 'f', 2, 64), NaN as `null`.
+func appendFloat(buf []byte, f Float) []byte {
+	if f.IsNaN() {
+		return append(buf, nullAsBytes...)
+	}
+
+	// f*100 is off by less than 0.002 below 1e13, so unless it is close to
+	// halfway between two integers, rounding it gives the same digits as
+	// the exact decimal value strconv rounds. The integer is formatted a lot
+	// faster than the float.
+	x := float64(f) * 100
+	r := math.Round(x)
+	if math.Abs(x) >= 1e13 || math.Abs(x-r) > 0.49 {
+		return strconv.AppendFloat(buf, float64(f), 'f', 2, 64)
+	}
+
+	n := int64(r)
+	if math.Signbit(float64(f)) {
+		buf = append(buf, '-')
+		n = -n
+	}
+	buf = strconv.AppendInt(buf, n/100, 10)
+	cents := n % 100
+	return append(buf, '.', byte('0'+cents/10), byte('0'+cents%10))
+}
+
+// Like encoding/json encodes a float64, NaN as `null`.
+func appendFloat64(buf []byte, f float64) []byte {
+	if math.IsNaN(f) {
+		return append(buf, nullAsBytes...)
+	}
+
+	format := byte('f')
+	if abs := math.Abs(f); abs != 0 && (abs < 1e-6 || abs >= 1e21) {
+		format = 'e'
+	}
+	buf = strconv.AppendFloat(buf, f, format, -1, 64)
+	if format == 'e' {
+		// clean up e-09 to e-9
+		n := len(buf)
+		if n >= 4 && buf[n-4] == 'e' && buf[n-3] == '-' && buf[n-2] == '0' {
+			buf[n-2] = buf[n-1]
+			buf = buf[:n-1]
+		}
+	}
+	return buf
+}
+
+// Appends data as a JSON array, NaN as `null`.
+func AppendFloats(buf []byte, data []Float) []byte {
+	buf = append(buf, '[')
+	for i, f := range data {
+		if i != 0 {
+			buf = append(buf, ',')
+		}
+		buf = appendFloat(buf, f)
+	}
+	return append(buf, ']')
+}
+
+// Appends s as a JSON string. Only '"', '\\' and control characters are
+// escaped, unlike encoding/json this does not escape HTML.
+func appendString(buf []byte, s string) []byte {
+	const hex = "0123456789abcdef"
 	buf = append(buf, '"')
+	start := 0
+	for i := 0; i < len(s); i++ {
+		c := s[i]
+		if c >= 0x20 && c != '"' && c != '\\' {
+			continue
+		}
+		buf = append(buf, s[start:i]...)
+		switch c {
+		case '"', '\\':
+			buf = append(buf, '\\', c)
+		case '\n':
+			buf = append(buf, '\\', 'n')
+		case '\t':
+			buf = append(buf, '\\', 't')
+		default:
+			buf = append(buf, '\\', 'u', '0', '0', hex[c>>4], hex[c&0xf])
+		}
+		start = i + 1
+	}
+	buf = append(buf, s[start:]...)
+	return append(buf, '"')
+}
+
+func (u *Unit) appendJSON(buf []byte) []byte {
+	buf = append(buf, `{"base":`...)
+	buf = appendString(buf, u.Base)
+	if u.Prefix != "" {
+		buf = append(buf, `,"prefix":`...)
+		buf = appendString(buf, u.Prefix)
+	}
+	return append(buf, '}')
+}
+
+// The encoders below write the same JSON as encoding/json would (except
+// for HTML escaping), but without reflection and one allocation per value
+// of a series: The arrays of floats are written directly into one buffer.
+
+// Appends the JSON encoding of s to buf.
+func (s *Series) AppendJSON(buf []byte) []byte {
+	buf = append(buf, `{"hostname":`...)
+	buf = appendString(buf, s.Hostname)
 	if s.Id != nil {
-		buf = append(buf, `,"id":"`...)
-		buf = append(buf, *s.Id...)
-		buf = append(buf, '"')
-	}
-	buf = append(buf, `,"statistics":{"min":`...)
-	buf = strconv.AppendFloat(buf, s.Statistics.Min, 'f', 2, 64)
-	buf = append(buf, `,"avg":`...)
-	buf = strconv.AppendFloat(buf, s.Statistics.Avg, 'f', 2, 64)
+		buf = append(buf, `,"id":`...)
+		buf = appendString(buf, *s.Id)
+	}
+	buf = append(buf, `,"statistics":{"avg":`...)
+	buf = appendFloat64(buf, s.Statistics.Avg)
+	buf = append(buf, `,"min":`...)
+	buf = appendFloat64(buf, s.Statistics.Min)
 	buf = append(buf, `,"max":`...)
-	buf = strconv.AppendFloat(buf, s.Statistics.Max, 'f', 2, 64)
-	buf = append(buf, '}')
-	buf = append(buf, `,"data":[`...)
-	for i := 0; i < len(s.Data); i++ {
+	buf = appendFloat64(buf, s.Statistics.Max)
+	buf = append(buf, `},"data":`...)
+	if s.Data == nil {
+		buf = append(buf, nullAsBytes...)
+	} else {
+		buf = AppendFloats(buf, s.Data)
+	}
+	return append(buf, '}')
+}
+
+// Appends the JSON encoding of ss to buf.
+func (ss *StatsSeries) AppendJSON(buf []byte) []byte {
+	appendArray := func(buf []byte, name string, data []Float) []byte {
+		buf = append(buf, name...)
+		if data == nil {
+			return append(buf, nullAsBytes...)
+		}
+		return AppendFloats(buf, data)
+	}
+
+	buf = appendArray(buf, `{"mean":`, ss.Mean)
+	buf = appendArray(buf, `,"min":`, ss.Min)
+	buf = appendArray(buf, `,"max":`, ss.Max)
+	if len(ss.Percentiles) != 0 {
+		// encoding/json sorts the keys as strings
+		keys := make([]string, 0, len(ss.Percentiles))
+		for p := range ss.Percentiles {
+			keys = append(keys, strconv.Itoa(p))
+		}
+		sort.Strings(keys)
+
+		buf = append(buf, `,"percentiles":{`...)
+		for i, key := range keys {
+			if i != 0 {
+				buf = append(buf, ',')
+			}
+			p, _ := strconv.Atoi(key)
+			buf = appendArray(buf, `"`+key+`":`, ss.Percentiles[p])
+		}
+		buf = append(buf, '}')
+	}
+	return append(buf, '}')
+}
+
+// Appends the JSON encoding of jm to buf.
+func (jm *JobMetric) AppendJSON(buf []byte) []byte {
+	buf = append(buf, `{"unit":`...)
+	buf = jm.Unit.appendJSON(buf)
+	buf = append(buf, `,"timestep":`...)
+	buf = strconv.AppendInt(buf, int64(jm.Timestep), 10)
+	buf = append(buf, `,"series":`...)
+	if jm.Series == nil {
+		buf = append(buf, nullAsBytes...)
+	} else {
+		buf = append(buf, '[')
+		for i := range jm.Series {
+			if i != 0 {
+				buf = append(buf, ',')
+			}
+			buf = jm.Series[i].AppendJSON(buf)
+		}
+		buf = append(buf, ']')
+	}
+	if jm.StatisticsSeries != nil {
+		buf = append(buf, `,"statisticsSeries":`...)
+		buf = jm.StatisticsSeries.AppendJSON(buf)
+	}
+	return append(buf, '}')
+}
+
+// Appends the JSON encoding of jd to buf.
+func (jd JobData) AppendJSON(buf []byte) []byte {
+	if jd == nil {
+		return append(buf, nullAsBytes...)
+	}
+
+	metrics := make([]string, 0, len(jd))
+	for metric := range jd {
+		metrics = append(metrics, metric)
+	}
+	sort.Strings(metrics)
+
+	buf = append(buf, '{')
+	for i, metric := range metrics {
 		if i != 0 {
 			buf = append(buf, ',')
 		}
+		buf = appendString(buf, metric)
+		buf = append(buf, ':')
+
+		scopes := make([]string, 0, len(jd[metric]))
+		for scope := range jd[metric] {
+			scopes = append(scopes, string(scope))
+		}
+		sort.Strings(scopes)
 
-		if s.Data[i].IsNaN() {
-			buf = append(buf, `null`...)
-		} else {
-			buf = strconv.AppendFloat(buf, float64(s.Data[i]), 'f', 2, 32)
+		buf = append(buf, '{')
+		for j, scope := range scopes {
+			if j != 0 {
+				buf = append(buf, ',')
+			}
+			buf = appendString(buf, scope)
+			buf = append(buf, ':')
+			if jm := jd[metric][MetricScope(scope)]; jm == nil {
+				buf = append(buf, nullAsBytes...)
+			} else {
+				buf = jm.AppendJSON(buf)
+			}
 		}
+		buf = append(buf, '}')
+	}
+	return append(buf, '}')
+}
+
+// Writes the JSON encoding of jd, followed by a newline like
+// json.Encoder.Encode, to w using a pooled buffer.
+func (jd JobData) WriteJSON(w io.Writer) error {
+	buf := getBuffer()
+	defer putBuffer(buf)
+
+	*buf = append(jd.AppendJSON(*buf), '\n')
+	_, err := w.Write(*buf)
+	return err
+}
+
+func (s *Series) MarshalJSON() ([]byte, error) {
+	return s.AppendJSON(make([]byte, 0, 128+len(s.Data)*8)), nil
+}
+
+func (ss *StatsSeries) MarshalJSON() ([]byte, error) {
+	return ss.AppendJSON(make([]byte, 0, 64+len(ss.Mean)*24)), nil
+}
+
+func (jm *JobMetric) MarshalJSON() ([]byte, error) {
+	n := 128
+	for i := range jm.Series {
+		n += 128 + len(jm.Series[i].Data)*8
 	}
-	buf = append(buf, ']', '}')
-	return buf, nil
+	return jm.AppendJSON(make([]byte, 0, n)), nil
+}
+
+func (jd JobData) MarshalJSON() ([]byte, error) {
+	return jd.AppendJSON(make([]byte, 0, jd.Size())), nil
+}
+
+// A []Float that is marshaled to GraphQL in one piece, see MarshalGQL.
+type FloatArray []Float
+
+// MarshalGQL implements the graphql.Marshaler interface. The array is
+// written into a pooled buffer and to w at once, instead of boxing and
+// writing every value on its own.
+func (fa FloatArray) MarshalGQL(w io.Writer) {
+	buf := getBuffer()
+	defer putBuffer(buf)
+
+	*buf = AppendFloats(*buf, fa)
+	w.Write(*buf)
 }
 
 func ConvertFloatToFloat64(s []Float) []float64 {
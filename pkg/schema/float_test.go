@@ -0,0 +1,217 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package schema
+
+import (
+	"bytes"
+	"encoding/json"
+	"fmt"
+	"io"
+	"math"
+	"strconv"
+	"testing"
+)
+
+// A series with one NaN for every 10 values, like a node that did not report.
+func benchSeries(n int) []Float {
+	data := make([]Float, n)
+	for i := range data {
+		if i%10 == 9 {
+			data[i] = NaN
+		} else {
+			data[i] = Float(math.Sin(float64(i)) * 1000)
+		}
+	}
+	return data
+}
+
+func BenchmarkFloatMarshalJSON(b *testing.B) {
+	data := benchSeries(1000)
+
+	b.Run("Slice", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			if _, err := json.Marshal(data); err != nil {
+				b.Fatal(err)
+			}
+		}
+	})
+
+	b.Run("Series", func(b *testing.B) {
+		s := &Series{Hostname: "n0001", Data: data}
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			if _, err := json.Marshal(s); err != nil {
+				b.Fatal(err)
+			}
+		}
+	})
+
+	b.Run("MarshalGQL", func(b *testing.B) {
+		var buf bytes.Buffer
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			buf.Reset()
+			for _, f := range data {
+				f.MarshalGQL(&buf)
+			}
+		}
+	})
+}
+
+func BenchmarkFloatUnmarshalJSON(b *testing.B) {
+	raw, err := json.Marshal(benchSeries(1000))
+	if err != nil {
+		b.Fatal(err)
+	}
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		var data []Float
+		if err := json.Unmarshal(raw, &data); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func testJobData() JobData {
+	id := "0"
+	jm := &JobMetric{
+		Unit:     Unit{Base: "F/s", Prefix: "G"},
+		Timestep: 60,
+		Series: []Series{
+			{Hostname: "n0001", Id: &id, Statistics: MetricStatistics{Avg: 1.5, Min: 1e-7, Max: 3.25e21}, Data: benchSeries(100)},
+			{Hostname: "n\"0002\"\n", Data: []Float{}},
+		},
+		StatisticsSeries: &StatsSeries{
+			Mean:        []Float{1, 2},
+			Min:         []Float{0, NaN},
+			Max:         []Float{3, 4},
+			Percentiles: map[int][]Float{5: {1, 1}, 50: {2, 2}, 25: {1.5, 1.5}},
+		},
+	}
+	return JobData{
+		"flops_any": {MetricScopeNode: jm, MetricScopeCore: &JobMetric{Unit: Unit{Base: "F/s"}, Timestep: 60}},
+		"mem_bw":    {MetricScopeNode: &JobMetric{Timestep: 30, Series: []Series{{Hostname: "n0001"}}}},
+	}
+}
+
+func TestJobDataJSON(t *testing.T) {
+	jd := testJobData()
+
+	// The same document as encoding/json without the custom encoders
+	type plainSeries struct {
+		Hostname   string           `json:"hostname"`
+		Id         *string          `json:"id,omitempty"`
+		Statistics MetricStatistics `json:"statistics"`
+		Data       []Float          `json:"data"`
+	}
+	type plainStatsSeries struct {
+		Mean        []Float         `json:"mean"`
+		Min         []Float         `json:"min"`
+		Max         []Float         `json:"max"`
+		Percentiles map[int][]Float `json:"percentiles,omitempty"`
+	}
+	type plainMetric struct {
+		Unit             Unit              `json:"unit"`
+		Timestep         int               `json:"timestep"`
+		Series           []plainSeries     `json:"series"`
+		StatisticsSeries *plainStatsSeries `json:"statisticsSeries,omitempty"`
+	}
+	plain := make(map[string]map[MetricScope]plainMetric)
+	for metric, scopes := range jd {
+		plain[metric] = make(map[MetricScope]plainMetric)
+		for scope, jm := range scopes {
+			pm := plainMetric{Unit: jm.Unit, Timestep: jm.Timestep}
+			if jm.Series != nil {
+				pm.Series = []plainSeries{}
+			}
+			for _, s := range jm.Series {
+				pm.Series = append(pm.Series, plainSeries(s))
+			}
+			if jm.StatisticsSeries != nil {
+				ss := plainStatsSeries(*jm.StatisticsSeries)
+				pm.StatisticsSeries = &ss
+			}
+			plain[metric][scope] = pm
+		}
+	}
+
+	want, err := json.Marshal(plain)
+	if err != nil {
+		t.Fatal(err)
+	}
+	got, err := json.Marshal(jd)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if !bytes.Equal(got, want) {
+		t.Errorf("unexpected JSON:\nwant %s\ngot  %s", want, got)
+	}
+
+	var buf bytes.Buffer
+	if err := jd.WriteJSON(&buf); err != nil {
+		t.Fatal(err)
+	}
+	if !bytes.Equal(buf.Bytes(), append(want, '\n')) {
+		t.Errorf("WriteJSON differs from json.Marshal")
+	}
+
+	var decoded JobData
+	if err := json.Unmarshal(got, &decoded); err != nil {
+		t.Fatal(err)
+	}
+	if s := decoded["flops_any"][MetricScopeNode].Series[1].Hostname; s != "n\"0002\"\n" {
+		t.Errorf("hostname not escaped properly: %q", s)
+	}
+
+	buf.Reset()
+	FloatArray{1, NaN, 2.5}.MarshalGQL(&buf)
+	if buf.String() != "[1.00,null,2.50]" {
+		t.Errorf("unexpected GraphQL array: %s", buf.String())
+	}
+}
+
+func BenchmarkJobDataMarshalJSON(b *testing.B) {
+	jd := JobData{"flops_any": {MetricScopeNode: &JobMetric{Timestep: 60}}}
+	for i := 0; i < 64; i++ {
+		jm := jd["flops_any"][MetricScopeNode]
+		jm.Series = append(jm.Series, Series{Hostname: fmt.Sprintf("n%04d", i), Data: benchSeries(1000)})
+	}
+
+	b.Run("Marshal", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			if _, err := json.Marshal(jd); err != nil {
+				b.Fatal(err)
+			}
+		}
+	})
+
+	b.Run("WriteJSON", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			if err := jd.WriteJSON(io.Discard); err != nil {
+				b.Fatal(err)
+			}
+		}
+	})
+}
+
+func TestAppendFloat(t *testing.T) {
+	values := []float64{0, 1, -1, 0.005, 0.015, 0.125, -0.001, math.Copysign(0, -1), 99.995,
+		1234567.891, -9.999, 1e12 + 0.5, 1e13, 1e300, math.Inf(1), 0.1 + 0.2}
+	for i := 0; i < 100000; i++ {
+		values = append(values, math.Sin(float64(i))*math.Pow(10, float64(i%16-4)))
+	}
+
+	for _, v := range values {
+		want := strconv.AppendFloat(nil, v, 'f', 2, 64)
+		if got := appendFloat(nil, Float(v)); !bytes.Equal(got, want) {
+			t.Errorf("%v: want %s, got %s", v, want, got)
+		}
+	}
+}
@@ -62,6 +62,7 @@ type Job struct {
 	NetDataVolTotal  float64   `json:"-" db:"net_data_vol_total"`              // NetDataVolTotal as Float64
 	FileBwAvg        float64   `json:"-" db:"file_bw_avg"`                     // FileBwAvg as Float64
 	FileDataVolTotal float64   `json:"-" db:"file_data_vol_total"`             // FileDataVolTotal as Float64
+	RawRoofline      []byte    `json:"-" db:"roofline"`                        // Roofline histogram of the archived job [As Bytes]
 }
 
 //	JobMeta struct type
@@ -93,6 +94,7 @@ type JobMeta struct {
 	BaseJob
 	StartTime  int64                    `json:"startTime" db:"start_time" example:"1649723812" minimum:"1"` // Start epoch time stamp in seconds (Min > 0)
 	Statistics map[string]JobStatistics `json:"statistics"`                                                 // Metric statistics of job
+	Roofline   *RooflineHistogram       `json:"roofline,omitempty"`                                         // Roofline histogram of job, computed when archived
 }
 
 const (
@@ -8,8 +8,13 @@ import (
 	"fmt"
 	"io"
 	"math"
+	"runtime"
 	"sort"
+	"sync"
+	"sync/atomic"
 	"unsafe"
+
+	"github.com/ClusterCockpit/cc-backend/internal/util"
 )
 
 type JobData map[string]map[MetricScope]*JobMetric
@@ -134,6 +139,59 @@ func (jd *JobData) Size() int {
 
 const smooth bool = false
 
+// Metrics with more series than this get a statistics series, so that a
+// min/mean/max graph can be used instead of a lot of single lines.
+const StatisticsSeriesThreshold int = 15
+
+// Add the statistics series to all metrics with more than
+// StatisticsSeriesThreshold series that do not have one yet.
+func (jd *JobData) AddStatisticsSeries() {
+	for _, scopes := range *jd {
+		for _, jm := range scopes {
+			if jm.StatisticsSeries != nil || len(jm.Series) <= StatisticsSeriesThreshold {
+				continue
+			}
+
+			jm.AddStatisticsSeries()
+		}
+	}
+}
+
+// The kernels below work on chunks of this many samples of every series,
+// so that the columns of a chunk stay in the cache while the series are
+// added up one after the other.
+const chunkSize = 2048
+
+// Below this number of samples in total the kernels do not start goroutines.
+const parallelThreshold = 1 << 18
+
+// Calls fn for the chunks [lo, hi) of [0, n), on several goroutines if
+// samples, the number of values processed in total, is large enough.
+func forEachChunk(n int, samples int, fn func(lo, hi int)) {
+	chunks := (n + chunkSize - 1) / chunkSize
+	workers := runtime.GOMAXPROCS(0)
+	if samples < parallelThreshold || chunks < 2 || workers < 2 {
+		for lo := 0; lo < n; lo += chunkSize {
+			fn(lo, util.Min(lo+chunkSize, n))
+		}
+		return
+	}
+
+	var next int64 = -1
+	var wg sync.WaitGroup
+	for w := 0; w < util.Min(workers, chunks); w++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for c := int(atomic.AddInt64(&next, 1)); c < chunks; c = int(atomic.AddInt64(&next, 1)) {
+				lo := c * chunkSize
+				fn(lo, util.Min(lo+chunkSize, n))
+			}
+		}()
+	}
+	wg.Wait()
+}
+
 func (jm *JobMetric) AddStatisticsSeries() {
 	if jm.StatisticsSeries != nil || len(jm.Series) < 4 {
 		return
@@ -150,34 +208,43 @@ func (jm *JobMetric) AddStatisticsSeries() {
 	}
 
 	min, mean, max := make([]Float, n), make([]Float, n), make([]Float, n)
-	i := 0
-	for ; i < m; i++ {
-		smin, ssum, smax := math.MaxFloat32, 0.0, -math.MaxFloat32
-		notnan := 0
-		for j := 0; j < len(jm.Series); j++ {
-			x := float64(jm.Series[j].Data[i])
-			if math.IsNaN(x) {
-				continue
-			}
+	forEachChunk(m, m*len(jm.Series), func(lo, hi int) {
+		var count [chunkSize]int32
+		cmin, csum, cmax := min[lo:hi], mean[lo:hi], max[lo:hi]
+		for i := range cmin {
+			cmin[i], cmax[i] = Float(math.Inf(1)), Float(math.Inf(-1))
+		}
 
-			notnan += 1
-			ssum += x
-			smin = math.Min(smin, x)
-			smax = math.Max(smax, x)
+		for j := range jm.Series {
+			data := jm.Series[j].Data[lo:hi]
+			// The slices have the same length, so that the compiler can
+			// remove the bounds checks
+			cmin, csum, cmax, cnt := cmin[:len(data)], csum[:len(data)], cmax[:len(data)], count[:len(data)]
+			for i, x := range data {
+				if x != x { // NaN
+					continue
+				}
+				cnt[i]++
+				csum[i] += x
+				if x < cmin[i] {
+					cmin[i] = x
+				}
+				if x > cmax[i] {
+					cmax[i] = x
+				}
+			}
 		}
 
-		if notnan < 3 {
-			min[i] = NaN
-			mean[i] = NaN
-			max[i] = NaN
-		} else {
-			min[i] = Float(smin)
-			mean[i] = Float(ssum / float64(notnan))
-			max[i] = Float(smax)
+		for i := range csum {
+			if count[i] < 3 {
+				cmin[i], csum[i], cmax[i] = NaN, NaN, NaN
+			} else {
+				csum[i] /= Float(count[i])
+			}
 		}
-	}
+	})
 
-	for ; i < n; i++ {
+	for i := m; i < n; i++ {
 		min[i] = NaN
 		mean[i] = NaN
 		max[i] = NaN
@@ -198,6 +265,9 @@ func (jm *JobMetric) AddStatisticsSeries() {
 	jm.StatisticsSeries = &StatsSeries{Mean: mean, Min: min, Max: max}
 }
 
+// Adds the node scope for metric, the series of every node are the sum of
+// the series of the node at the finest scope there is. The sum is NaN where
+// one of them is.
 func (jd *JobData) AddNodeScope(metric string) bool {
 	scopes, ok := (*jd)[metric]
 	if !ok {
@@ -214,9 +284,14 @@ func (jd *JobData) AddNodeScope(metric string) bool {
 	}
 
 	jm := scopes[maxScope]
-	hosts := make(map[string][]Series, 32)
-	for _, series := range jm.Series {
-		hosts[series.Hostname] = append(hosts[series.Hostname], series)
+	hosts := make(map[string][]*Series, 32)
+	order := make([]string, 0, 32)
+	for i := range jm.Series {
+		hostname := jm.Series[i].Hostname
+		if _, ok := hosts[hostname]; !ok {
+			order = append(order, hostname)
+		}
+		hosts[hostname] = append(hosts[hostname], &jm.Series[i])
 	}
 
 	nodeJm := &JobMetric{
@@ -224,34 +299,31 @@ func (jd *JobData) AddNodeScope(metric string) bool {
 		Timestep: jm.Timestep,
 		Series:   make([]Series, 0, len(hosts)),
 	}
-	for hostname, series := range hosts {
+	for _, hostname := range order {
+		series := hosts[hostname]
 		min, sum, max := math.MaxFloat32, 0.0, -math.MaxFloat32
-		for _, series := range series {
-			sum += series.Statistics.Avg
-			min = math.Min(min, series.Statistics.Min)
-			max = math.Max(max, series.Statistics.Max)
+		n, m := 0, len(series[0].Data)
+		for _, s := range series {
+			sum += s.Statistics.Avg
+			min = math.Min(min, s.Statistics.Min)
+			max = math.Max(max, s.Statistics.Max)
+			n = util.Max(n, len(s.Data))
+			m = util.Min(m, len(s.Data))
 		}
 
-		n, m := 0, len(jm.Series[0].Data)
-		for _, series := range jm.Series {
-			if len(series.Data) > n {
-				n = len(series.Data)
+		data := make([]Float, n)
+		forEachChunk(m, m*len(series), func(lo, hi int) {
+			acc := data[lo:hi]
+			copy(acc, series[0].Data[lo:hi])
+			for _, s := range series[1:] {
+				values := s.Data[lo:hi]
+				acc := acc[:len(values)]
+				for i, x := range values {
+					acc[i] += x
+				}
 			}
-			if len(series.Data) < m {
-				m = len(series.Data)
-			}
-		}
-
-		i, data := 0, make([]Float, len(series[0].Data))
-		for ; i < m; i++ {
-			x := Float(0.0)
-			for _, series := range jm.Series {
-				x += series.Data[i]
-			}
-			data[i] = x
-		}
-
-		for ; i < n; i++ {
+		})
+		for i := m; i < n; i++ {
 			data[i] = NaN
 		}
 
@@ -266,6 +338,10 @@ func (jd *JobData) AddNodeScope(metric string) bool {
 	return true
 }
 
+// Adds the percentiles ps (1 to 99) over all series to the statistics
+// series. NaNs are left out, a percentile is NaN where all series are. Every
+// percentile is found by selection in linear time instead of sorting the
+// values of every sample.
 func (jm *JobMetric) AddPercentiles(ps []int) bool {
 	if jm.StatisticsSeries == nil {
 		jm.AddStatisticsSeries()
@@ -286,19 +362,7 @@ func (jm *JobMetric) AddPercentiles(ps []int) bool {
 		}
 	}
 
-	data := make([][]float64, n)
-	for i := 0; i < n; i++ {
-		vals := make([]float64, 0, len(jm.Series))
-		for _, series := range jm.Series {
-			if i < len(series.Data) {
-				vals = append(vals, float64(series.Data[i]))
-			}
-		}
-
-		sort.Float64s(vals)
-		data[i] = vals
-	}
-
+	var todo []int
 	for _, p := range ps {
 		if p < 1 || p > 99 {
 			panic("SCHEMA/METRICS > invalid percentile")
@@ -307,15 +371,82 @@ func (jm *JobMetric) AddPercentiles(ps []int) bool {
 		if _, ok := jm.StatisticsSeries.Percentiles[p]; ok {
 			continue
 		}
+		jm.StatisticsSeries.Percentiles[p] = make([]Float, n)
+		todo = append(todo, p)
+	}
+	if len(todo) == 0 {
+		return true
+	}
+	sort.Ints(todo)
+
+	forEachChunk(n, n*len(jm.Series), func(lo, hi int) {
+		vals := make([]Float, 0, len(jm.Series))
+		for i := lo; i < hi; i++ {
+			vals = vals[:0]
+			for j := range jm.Series {
+				if data := jm.Series[j].Data; i < len(data) && !data[i].IsNaN() {
+					vals = append(vals, data[i])
+				}
+			}
 
-		percentiles := make([]Float, n)
-		for i := 0; i < n; i++ {
-			sorted := data[i]
-			percentiles[i] = Float(sorted[(len(sorted)*p)/100])
+			// Selecting the k-th value partitions vals, so the larger
+			// percentiles are only searched for right of it.
+			start := 0
+			for _, p := range todo {
+				x := NaN
+				if len(vals) > 0 {
+					k := (len(vals) * p) / 100
+					selectKth(vals[start:], k-start)
+					x, start = vals[k], k
+				}
+				jm.StatisticsSeries.Percentiles[p][i] = x
+			}
 		}
-
-		jm.StatisticsSeries.Percentiles[p] = percentiles
-	}
+	})
 
 	return true
 }
+
+// Moves the k-th smallest value of vals to vals[k], with the smaller
+// values before and the larger ones after it (quickselect).
+func selectKth(vals []Float, k int) {
+	lo, hi := 0, len(vals)-1
+	for lo < hi {
+		// Median of three as pivot
+		mid := lo + (hi-lo)/2
+		if vals[mid] < vals[lo] {
+			vals[mid], vals[lo] = vals[lo], vals[mid]
+		}
+		if vals[hi] < vals[lo] {
+			vals[hi], vals[lo] = vals[lo], vals[hi]
+		}
+		if vals[hi] < vals[mid] {
+			vals[hi], vals[mid] = vals[mid], vals[hi]
+		}
+		pivot := vals[mid]
+
+		i, j := lo, hi
+		for i <= j {
+			for vals[i] < pivot {
+				i++
+			}
+			for vals[j] > pivot {
+				j--
+			}
+			if i <= j {
+				vals[i], vals[j] = vals[j], vals[i]
+				i++
+				j--
+			}
+		}
+
+		switch {
+		case k <= j:
+			hi = j
+		case k >= i:
+			lo = i
+		default:
+			return
+		}
+	}
+}
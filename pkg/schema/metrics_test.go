@@ -0,0 +1,167 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package schema
+
+import (
+	"fmt"
+	"math"
+	"math/rand"
+	"sort"
+	"testing"
+)
+
+// A metric of n series with m samples each, some of them NaN. Series j has
+// j%7 samples less, so that the lengths differ.
+func randomMetric(n, m int) *JobMetric {
+	rng := rand.New(rand.NewSource(int64(n*m + 1)))
+	jm := &JobMetric{Timestep: 60, Series: make([]Series, n)}
+	for j := range jm.Series {
+		data := make([]Float, m-j%7)
+		for i := range data {
+			if rng.Intn(50) == 0 {
+				data[i] = NaN
+			} else {
+				data[i] = Float(rng.Intn(1000)) / 8
+			}
+		}
+		jm.Series[j] = Series{
+			Hostname:   fmt.Sprintf("e%04d", j/4),
+			Statistics: MetricStatistics{Min: float64(j), Avg: float64(j + 1), Max: float64(j + 2)},
+			Data:       data,
+		}
+	}
+	return jm
+}
+
+func equalSeries(a, b []Float) bool {
+	if len(a) != len(b) {
+		return false
+	}
+	for i := range a {
+		if a[i] != b[i] && !(a[i].IsNaN() && b[i].IsNaN()) {
+			return false
+		}
+	}
+	return true
+}
+
+func TestAddStatisticsSeries(t *testing.T) {
+	for _, size := range [][2]int{{16, 100}, {300, 5000}} {
+		jm := randomMetric(size[0], size[1])
+		jm.AddStatisticsSeries()
+		ss := jm.StatisticsSeries
+
+		if len(ss.Mean) != size[1] {
+			t.Fatalf("want %d samples, got %d", size[1], len(ss.Mean))
+		}
+		for i := range ss.Mean {
+			min, sum, max, cnt := math.Inf(1), 0.0, math.Inf(-1), 0
+			for _, series := range jm.Series {
+				if i >= size[1]-6 {
+					cnt = 0
+					break
+				}
+				if x := float64(series.Data[i]); !math.IsNaN(x) {
+					min, sum, max, cnt = math.Min(min, x), sum+x, math.Max(max, x), cnt+1
+				}
+			}
+			want := [3]Float{NaN, NaN, NaN}
+			if cnt >= 3 {
+				want = [3]Float{Float(min), Float(sum / float64(cnt)), Float(max)}
+			}
+			if got := [3]Float{ss.Min[i], ss.Mean[i], ss.Max[i]}; !equalSeries(got[:], want[:]) {
+				t.Fatalf("%v: sample %d: want %v, got %v", size, i, want, got)
+			}
+		}
+	}
+}
+
+func TestAddNodeScope(t *testing.T) {
+	jm := randomMetric(8, 10)
+	jd := JobData{"flops_any": {MetricScopeCore: jm}}
+	if !jd.AddNodeScope("flops_any") {
+		t.Fatal("node scope not added")
+	}
+	if jd.AddNodeScope("mem_bw") {
+		t.Error("node scope added for missing metric")
+	}
+
+	nodes := jd["flops_any"][MetricScopeNode].Series
+	if len(nodes) != 2 || nodes[0].Hostname != "e0000" || nodes[1].Hostname != "e0001" {
+		t.Fatalf("unexpected node series: %v", nodes)
+	}
+	for h, node := range nodes {
+		// Series 4*h to 4*h+3 are on the node, NaN after the shortest one
+		m := 10
+		for _, series := range jm.Series[4*h : 4*h+4] {
+			m = int(math.Min(float64(m), float64(len(series.Data))))
+		}
+		want := make([]Float, 10)
+		for i := range want {
+			for _, series := range jm.Series[4*h : 4*h+4] {
+				if i < m {
+					want[i] += series.Data[i]
+				} else {
+					want[i] = NaN
+				}
+			}
+		}
+		if !equalSeries(node.Data, want) {
+			t.Errorf("%s: want %v, got %v", node.Hostname, want, node.Data)
+		}
+		if s := node.Statistics; s.Min != float64(4*h) || s.Max != float64(4*h+5) || s.Avg != float64(4*h)+2.5 {
+			t.Errorf("%s: unexpected statistics %v", node.Hostname, s)
+		}
+	}
+}
+
+func TestAddPercentiles(t *testing.T) {
+	jm := randomMetric(301, 3000)
+	ps := []int{90, 10, 50, 25, 75}
+	if !jm.AddPercentiles(ps) {
+		t.Fatal("percentiles not added")
+	}
+
+	for i := 0; i < 3000; i++ {
+		var vals []float64
+		for _, series := range jm.Series {
+			if i < len(series.Data) && !series.Data[i].IsNaN() {
+				vals = append(vals, float64(series.Data[i]))
+			}
+		}
+		sort.Float64s(vals)
+		for _, p := range ps {
+			if got, want := jm.StatisticsSeries.Percentiles[p][i], Float(vals[len(vals)*p/100]); got != want {
+				t.Fatalf("sample %d: percentile %d: want %v, got %v", i, p, want, got)
+			}
+		}
+	}
+
+	jm = &JobMetric{Series: []Series{{Data: []Float{NaN, 1}}, {Data: []Float{NaN, 2}}, {Data: []Float{NaN}}}}
+	jm.StatisticsSeries = &StatsSeries{}
+	jm.AddPercentiles([]int{50})
+	if got := jm.StatisticsSeries.Percentiles[50]; !equalSeries(got, []Float{NaN, 2}) {
+		t.Errorf("want [NaN 2], got %v", got)
+	}
+}
+
+func BenchmarkAddStatisticsSeries(b *testing.B) {
+	jm := randomMetric(512, 8640)
+	b.SetBytes(int64(512 * 8640 * 4))
+	for i := 0; i < b.N; i++ {
+		jm.StatisticsSeries = nil
+		jm.AddStatisticsSeries()
+	}
+}
+
+func BenchmarkAddPercentiles(b *testing.B) {
+	jm := randomMetric(512, 8640)
+	jm.AddStatisticsSeries()
+	b.SetBytes(int64(512 * 8640 * 4))
+	for i := 0; i < b.N; i++ {
+		jm.StatisticsSeries.Percentiles = nil
+		jm.AddPercentiles([]int{10, 25, 50, 75, 90})
+	}
+}
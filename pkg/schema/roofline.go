@@ -0,0 +1,116 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package schema
+
+import (
+	"math"
+	"sort"
+)
+
+// Fixed resolution of the roofline histograms built when a job is archived.
+// Both axes are binned logarithmically: X is the arithmetic intensity
+// (flops_any / mem_bw), Y the flop rate (flops_any), each as log10 of the
+// value in the unit of the metric.
+const (
+	RooflineMinX          float64 = -3
+	RooflineMaxX          float64 = 4
+	RooflineMinY          float64 = -2
+	RooflineMaxY          float64 = 6
+	RooflineBinsPerDecade int     = 20
+)
+
+// RooflineHistogram is a sparse log-log histogram of all node level
+// (flops_any, mem_bw) samples of a job. Only non-empty bins are stored,
+// bin i is at (X[i], Y[i]) and contains Count[i] samples.
+type RooflineHistogram struct {
+	X     []uint16 `json:"x"`
+	Y     []uint16 `json:"y"`
+	Count []uint32 `json:"count"`
+}
+
+func rooflineCols() int {
+	return int(RooflineMaxX-RooflineMinX) * RooflineBinsPerDecade
+}
+
+func rooflineRows() int {
+	return int(RooflineMaxY-RooflineMinY) * RooflineBinsPerDecade
+}
+
+// NewRooflineHistogram bins the samples of the node scope metrics flops_any
+// and mem_bw of a job. Returns nil if there is no valid sample.
+func NewRooflineHistogram(flops, membw *JobMetric) *RooflineHistogram {
+	if flops == nil || membw == nil {
+		return nil
+	}
+
+	cols, rows := rooflineCols(), rooflineRows()
+	bpd := float64(RooflineBinsPerDecade)
+	bins := make(map[int]uint32)
+	for n := 0; n < len(flops.Series) && n < len(membw.Series); n++ {
+		flopsData, membwData := flops.Series[n].Data, membw.Series[n].Data
+		for i := 0; i < len(flopsData) && i < len(membwData); i++ {
+			x, y := math.Log10(float64(flopsData[i]/membwData[i])), math.Log10(float64(flopsData[i]))
+			if math.IsNaN(x) || math.IsNaN(y) || math.IsInf(x, 0) || math.IsInf(y, 0) {
+				continue
+			}
+
+			col, row := int(math.Floor((x-RooflineMinX)*bpd)), int(math.Floor((y-RooflineMinY)*bpd))
+			if col < 0 || col >= cols || row < 0 || row >= rows {
+				continue
+			}
+
+			bins[row*cols+col] += 1
+		}
+	}
+
+	if len(bins) == 0 {
+		return nil
+	}
+
+	keys := make([]int, 0, len(bins))
+	for k := range bins {
+		keys = append(keys, k)
+	}
+	sort.Ints(keys)
+
+	h := &RooflineHistogram{
+		X:     make([]uint16, len(keys)),
+		Y:     make([]uint16, len(keys)),
+		Count: make([]uint32, len(keys)),
+	}
+	for i, k := range keys {
+		h.X[i], h.Y[i], h.Count[i] = uint16(k%cols), uint16(k/cols), bins[k]
+	}
+
+	return h
+}
+
+// AddTo adds the histogram to the tiles of a roofline heatmap. The bounds are
+// log10 values as used by the rooflineHeatmap query. Every bin is counted in
+// the tile containing its center, so the result is exact up to the
+// resolution of RooflineBinsPerDecade.
+func (h *RooflineHistogram) AddTo(tiles [][]float64, minX, minY, maxX, maxY float64) {
+	rows := len(tiles)
+	if rows == 0 {
+		return
+	}
+	frows, fcols := float64(rows), float64(len(tiles[0]))
+	bpd := float64(RooflineBinsPerDecade)
+
+	for i := range h.Count {
+		x := RooflineMinX + (float64(h.X[i])+0.5)/bpd
+		y := RooflineMinY + (float64(h.Y[i])+0.5)/bpd
+		if x < minX || x >= maxX || y < minY || y > maxY {
+			continue
+		}
+
+		x, y = math.Floor(((x-minX)/(maxX-minX))*fcols), math.Floor(((y-minY)/(maxY-minY))*frows)
+		if x < 0 || x >= fcols || y < 0 || y >= frows {
+			continue
+		}
+
+		tiles[int(y)][int(x)] += float64(h.Count[i])
+	}
+}
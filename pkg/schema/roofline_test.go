@@ -0,0 +1,51 @@
+// Copyright (C) NHR@FAU, University Erlangen-Nuremberg.
+// All rights reserved.
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file.
+package schema
+
+import (
+	"math"
+	"testing"
+)
+
+func TestRooflineHistogram(t *testing.T) {
+	flops := &JobMetric{Series: []Series{
+		{Hostname: "a", Data: []Float{100, 100, NaN, 1000}},
+		{Hostname: "b", Data: []Float{100, 0}},
+	}}
+	membw := &JobMetric{Series: []Series{
+		{Hostname: "a", Data: []Float{10, 10, 10, 10}},
+		{Hostname: "b", Data: []Float{10, 10}},
+	}}
+
+	h := NewRooflineHistogram(flops, membw)
+	if h == nil {
+		t.Fatal("expected histogram")
+	}
+
+	var total uint32
+	for _, c := range h.Count {
+		total += c
+	}
+	if total != 4 || len(h.Count) != 2 {
+		t.Errorf("expected 4 samples in 2 bins, got %d in %d", total, len(h.Count))
+	}
+
+	rows, cols := 10, 10
+	tiles := make([][]float64, rows)
+	for i := range tiles {
+		tiles[i] = make([]float64, cols)
+	}
+	h.AddTo(tiles, math.Log10(0.01), math.Log10(1.), math.Log10(1000.), math.Log10(100000.))
+
+	// Intensity 10 and 100 flops fall into column 6, row 4, intensity 100
+	// and 1000 flops into column 8, row 6.
+	if tiles[4][6] != 3 || tiles[6][8] != 1 {
+		t.Errorf("unexpected tiles: %v", tiles)
+	}
+
+	if NewRooflineHistogram(flops, nil) != nil {
+		t.Error("expected nil histogram without mem_bw")
+	}
+}
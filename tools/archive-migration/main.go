@@ -6,6 +6,7 @@ package main
 
 import (
 	"bufio"
+	"bytes"
 	"encoding/json"
 	"errors"
 	"flag"
@@ -13,8 +14,10 @@ import (
 	"os"
 	"path/filepath"
 	"sync"
+	"time"
 
 	"github.com/ClusterCockpit/cc-backend/internal/config"
+	"github.com/ClusterCockpit/cc-backend/pkg/archive"
 	"github.com/ClusterCockpit/cc-backend/pkg/log"
 	"github.com/ClusterCockpit/cc-backend/pkg/schema"
 	ccunits "github.com/ClusterCockpit/cc-units"
@@ -25,6 +28,7 @@ const Version = 1
 var ar FsArchive
 var srcPath string
 var dstPath string
+var binaryFormat bool
 
 func loadJobData(filename string) (*JobData, error) {
 
@@ -275,28 +279,231 @@ func convertJob(job *JobMeta) {
 		log.Fatal(err)
 	}
 
-	f, err = os.Create(getPath(job, dstPath, "data.json"))
-	if err != nil {
-		log.Fatal(err)
-	}
-
 	var jd *JobData
 	jd, err = loadJobData(src_data_path)
 	if err != nil {
 		log.Fatal(err)
 	}
 	jdn := deepCopyJobData(jd, job.Cluster, job.SubCluster)
-	if err := EncodeJobData(f, jdn); err != nil {
-		log.Fatal(err)
+
+	if binaryFormat {
+		f, err = os.Create(getPath(job, dstPath, "data.bin"))
+		if err != nil {
+			log.Fatal(err)
+		}
+		if err := archive.EncodeJobDataBinary(f, jdn); err != nil {
+			log.Fatal(err)
+		}
+	} else {
+		f, err = os.Create(getPath(job, dstPath, "data.json"))
+		if err != nil {
+			log.Fatal(err)
+		}
+		if err := EncodeJobData(f, jdn); err != nil {
+			log.Fatal(err)
+		}
 	}
 	if err := f.Close(); err != nil {
 		log.Fatal(err)
 	}
 }
 
+// Convert the job data of an archive in the current version in place to the
+// columnar binary format. The data.json(.gz) files are removed once the
+// data.bin file is written completely.
+func convertToBinary(debug bool) {
+	archiveCfg := fmt.Sprintf("{\"kind\": \"file\",\"path\": \"%s\"}", srcPath)
+	if err := archive.Init(json.RawMessage(archiveCfg), false); err != nil {
+		log.Fatal(err)
+	}
+
+	convert := func(job archive.JobContainer) {
+		dir := filepath.Join(srcPath, job.Meta.Cluster,
+			fmt.Sprintf("%d", job.Meta.JobID/1000), fmt.Sprintf("%03d", job.Meta.JobID%1000),
+			fmt.Sprintf("%d", job.Meta.StartTime))
+		if job.Data == nil || len(*job.Data) == 0 {
+			fmt.Printf("Skip path %s, no job data.\n", dir)
+			return
+		}
+
+		tmp := filepath.Join(dir, "data.bin.tmp")
+		f, err := os.Create(tmp)
+		if err != nil {
+			log.Fatal(err)
+		}
+		if err := archive.EncodeJobDataBinary(f, job.Data); err != nil {
+			log.Fatal(err)
+		}
+		if err := f.Close(); err != nil {
+			log.Fatal(err)
+		}
+		if err := os.Rename(tmp, filepath.Join(dir, "data.bin")); err != nil {
+			log.Fatal(err)
+		}
+
+		for _, name := range []string{"data.json", "data.json.gz", "data.json.zz"} {
+			if err := os.Remove(filepath.Join(dir, name)); err != nil && !errors.Is(err, os.ErrNotExist) {
+				log.Errorf("remove %s: %v", filepath.Join(dir, name), err)
+			}
+		}
+	}
+
+	forEachJob(debug, true, convert)
+}
+
+// Run fn for every job of the archive initialized with archive.Init, in
+// parallel unless debug is set.
+func forEachJob(debug bool, loadMetricData bool, fn func(job archive.JobContainer)) {
+	var wg sync.WaitGroup
+	sem := make(chan struct{}, 16)
+	for job := range archive.GetHandle().Iter(loadMetricData) {
+		if job.Meta == nil {
+			continue
+		}
+		if debug {
+			fmt.Printf("Job %d\n", job.Meta.JobID)
+			fn(job)
+		} else {
+			job := job
+			wg.Add(1)
+			sem <- struct{}{}
+
+			go func() {
+				defer wg.Done()
+				fn(job)
+				<-sem
+			}()
+		}
+	}
+
+	wg.Wait()
+}
+
+// Train a preset dictionary for every cluster of the archive from the job
+// data of its first samples jobs and store it next to cluster.json, where
+// the archive backends load it from.
+func trainDictionaries(samples int) {
+	data := make(map[string][][]byte)
+	for job := range archive.GetHandle().Iter(false) {
+		if job.Meta == nil || len(data[job.Meta.Cluster]) >= samples {
+			continue
+		}
+		jd, err := archive.GetHandle().LoadJobData(&schema.Job{
+			BaseJob: job.Meta.BaseJob, StartTime: time.Unix(job.Meta.StartTime, 0)})
+		if err != nil {
+			log.Errorf("load job data of job %d: %v", job.Meta.JobID, err)
+			continue
+		}
+		var buf bytes.Buffer
+		if err := archive.EncodeJobData(&buf, &jd); err != nil {
+			log.Fatal(err)
+		}
+		data[job.Meta.Cluster] = append(data[job.Meta.Cluster], buf.Bytes())
+	}
+
+	for cluster, samples := range data {
+		dict := archive.TrainDictionary(samples, archive.MaxDictionarySize)
+		if err := storeDictionary(filepath.Join(srcPath, cluster), dict); err != nil {
+			log.Fatal(err)
+		}
+		archive.RegisterDictionary(cluster, dict)
+		fmt.Printf("Cluster %s: dictionary of %d bytes from %d jobs\n", cluster, len(dict), len(samples))
+	}
+}
+
+// Make dict the current dictionary of the cluster in dir. The files
+// compressed so far may use the previous one, so every dictionary is kept
+// under its own name before the current one is replaced, and that is
+// replaced atomically. An interrupted recompression leaves no file behind
+// that cannot be read.
+func storeDictionary(dir string, dict []byte) error {
+	current := filepath.Join(dir, archive.DictionaryFile)
+	// Archives from before dictionaries were kept by name
+	if old, err := os.ReadFile(current); err == nil {
+		if err := writeFileIfMissing(filepath.Join(dir, archive.DictionaryFileName(old)), old); err != nil {
+			return err
+		}
+	} else if !errors.Is(err, os.ErrNotExist) {
+		return err
+	}
+
+	if err := writeFileIfMissing(filepath.Join(dir, archive.DictionaryFileName(dict)), dict); err != nil {
+		return err
+	}
+
+	tmp := current + ".tmp"
+	if err := os.WriteFile(tmp, dict, 0644); err != nil {
+		return err
+	}
+	return os.Rename(tmp, current)
+}
+
+func writeFileIfMissing(name string, data []byte) error {
+	if _, err := os.Stat(name); err == nil {
+		return nil
+	}
+	tmp := name + ".tmp"
+	if err := os.WriteFile(tmp, data, 0644); err != nil {
+		return err
+	}
+	return os.Rename(tmp, name)
+}
+
+// Recompress the JSON job data of an archive in the current version in place
+// with codec. Jobs in the binary format are left as they are.
+func recompress(codec string, samples int, debug bool) {
+	archiveCfg := fmt.Sprintf("{\"kind\": \"file\",\"path\": \"%s\",\"compression-codec\": \"%s\"}", srcPath, codec)
+	if err := archive.Init(json.RawMessage(archiveCfg), false); err != nil {
+		log.Fatal(err)
+	}
+	if samples > 0 {
+		trainDictionaries(samples)
+	}
+
+	name := archive.CompressedName(codec)
+	forEachJob(debug, true, func(job archive.JobContainer) {
+		dir := filepath.Join(srcPath, job.Meta.Cluster,
+			fmt.Sprintf("%d", job.Meta.JobID/1000), fmt.Sprintf("%03d", job.Meta.JobID%1000),
+			fmt.Sprintf("%d", job.Meta.StartTime))
+		if _, err := os.Stat(filepath.Join(dir, "data.bin")); err == nil {
+			return
+		}
+		if job.Data == nil || len(*job.Data) == 0 {
+			fmt.Printf("Skip path %s, no job data.\n", dir)
+			return
+		}
+
+		tmp := filepath.Join(dir, name+".tmp")
+		f, err := os.Create(tmp)
+		if err != nil {
+			log.Fatal(err)
+		}
+		if err := archive.EncodeJobDataCompressed(f, job.Data, codec, job.Meta.Cluster); err != nil {
+			log.Fatal(err)
+		}
+		if err := f.Close(); err != nil {
+			log.Fatal(err)
+		}
+		if err := os.Rename(tmp, filepath.Join(dir, name)); err != nil {
+			log.Fatal(err)
+		}
+
+		for _, old := range []string{"data.json", "data.json.gz", "data.json.zz"} {
+			if old == name {
+				continue
+			}
+			if err := os.Remove(filepath.Join(dir, old)); err != nil && !errors.Is(err, os.ErrNotExist) {
+				log.Errorf("remove %s: %v", filepath.Join(dir, old), err)
+			}
+		}
+	})
+}
+
 func main() {
 	var flagLogLevel, flagConfigFile string
 	var flagLogDateTime, debug bool
+	var flagRecompress string
+	var flagDictSamples int
 
 	flag.BoolVar(&flagLogDateTime, "logdate", false, "Set this flag to add date and time to log messages")
 	flag.BoolVar(&debug, "debug", false, "Set this flag to force sequential execution for debugging")
@@ -304,10 +511,24 @@ func main() {
 	flag.StringVar(&flagConfigFile, "config", "./config.json", "Specify alternative path to `config.json`")
 	flag.StringVar(&srcPath, "src", "./var/job-archive", "Specify the source job archive path")
 	flag.StringVar(&dstPath, "dst", "./var/job-archive-new", "Specify the destination job archive path")
+	flag.BoolVar(&binaryFormat, "binary", false, "Write job data in the columnar binary format (data.bin). If the source archive already has the current version, it is converted in place")
+	flag.StringVar(&flagRecompress, "recompress", "", "Recompress the JSON job data of a source archive in the current version in place with the `codec` [gzip,zlib]")
+	flag.IntVar(&flagDictSamples, "train-dictionary", 0, "Before recompressing, train the preset dictionary of every cluster from the job data of this `number` of jobs")
 	flag.Parse()
 
 	if _, err := os.Stat(filepath.Join(srcPath, "version.txt")); !errors.Is(err, os.ErrNotExist) {
-		log.Fatal("Archive version exists!")
+		if !binaryFormat && flagRecompress == "" {
+			log.Fatal("Archive version exists!")
+		}
+
+		log.Init(flagLogLevel, flagLogDateTime)
+		config.Init(flagConfigFile)
+		if binaryFormat {
+			convertToBinary(debug)
+		} else {
+			recompress(flagRecompress, flagDictSamples, debug)
+		}
+		os.Exit(0)
 	}
 
 	log.Init(flagLogLevel, flagLogDateTime)